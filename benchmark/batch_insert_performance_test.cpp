@@ -0,0 +1,130 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+/**
+ * @file batch_insert_performance_test.cpp
+ * @brief 测试逐条插入和批量插入记录的性能
+ * @details 表上有一个索引，使用 vacuous 事务和 vacuous 日志。参数是每批插入的记录个数，1 表示逐条调用
+ * Table::insert_record，其它值调用 Table::insert_records。rows 是每秒插入的记录数。
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/filesystem.h"
+#include "common/lang/stdexcept.h"
+#include "common/log/log.h"
+#include "common/math/integer_generator.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+static constexpr int ROUND_RECORD_NUM = 10000;
+
+class BatchInsertBenchmark : public Fixture
+{
+public:
+  void SetUp(const State &state) override
+  {
+    LoggerFactory::init_default("batch_insert.log", LOG_LEVEL_WARN);
+
+    filesystem::remove_all(directory_);
+    filesystem::create_directories(directory_);
+
+    db_ = make_unique<Db>();
+    if (OB_FAIL(db_->init("batch_insert", directory_.c_str(), "vacuous", "vacuous"))) {
+      throw runtime_error("failed to init db");
+    }
+
+    vector<AttrInfoSqlNode> attr_infos(2);
+    attr_infos[0].name   = "id";
+    attr_infos[0].type   = AttrType::INTS;
+    attr_infos[0].length = 4;
+    attr_infos[1].name   = "value";
+    attr_infos[1].type   = AttrType::INTS;
+    attr_infos[1].length = 4;
+    if (OB_FAIL(db_->create_table("t", attr_infos))) {
+      throw runtime_error("failed to create table");
+    }
+    table_ = db_->find_table("t");
+
+    Trx *trx = db_->trx_kit().create_trx(db_->log_handler());
+    RC   rc  = table_->create_index(trx, {table_->table_meta().field("id")}, "t_id");
+    db_->trx_kit().destroy_trx(trx);
+    if (OB_FAIL(rc)) {
+      throw runtime_error("failed to create index");
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    table_ = nullptr;
+    db_.reset();
+    filesystem::remove_all(directory_);
+  }
+
+  void Insert(int batch_size)
+  {
+    vector<Record> records;
+    records.reserve(batch_size);
+    for (int i = 0; i < ROUND_RECORD_NUM; i++) {
+      Value  values[2] = {Value(static_cast<int>(random_.next())), Value(i)};
+      Record record;
+      if (OB_FAIL(table_->make_record(2, values, record))) {
+        throw runtime_error("failed to make record");
+      }
+      records.emplace_back(std::move(record));
+
+      if (static_cast<int>(records.size()) >= batch_size || i == ROUND_RECORD_NUM - 1) {
+        RC rc = batch_size == 1 ? table_->insert_record(records[0]) : table_->insert_records(records);
+        if (OB_FAIL(rc)) {
+          throw runtime_error("failed to insert records");
+        }
+        records.clear();
+      }
+    }
+  }
+
+protected:
+  string           directory_ = "batch_insert_benchmark";
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+  IntegerGenerator random_{0, INT32_MAX};
+};
+
+BENCHMARK_DEFINE_F(BatchInsertBenchmark, Insert)(State &state)
+{
+  const int batch_size = static_cast<int>(state.range(0));
+
+  int64_t rows = 0;
+  for (auto _ : state) {
+    Insert(batch_size);
+    rows += ROUND_RECORD_NUM;
+  }
+
+  state.counters["rows"] = Counter(rows, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(BatchInsertBenchmark, Insert)
+    ->ArgNames({"batch"})
+    ->Arg(1)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,112 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "common/log/log.h"
+#include "common/math/integer_generator.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+/**
+ * @brief 测试页帧管理器在多线程下的扩展性
+ * @details 参数是页帧管理器的分片个数。分片个数为1时，所有的线程都在竞争同一把锁。
+ */
+class FrameManagerBenchmark : public Fixture
+{
+public:
+  static constexpr int POOL_NUM       = 64;    // 一共 64 * 128 个页帧
+  static constexpr int HOT_PAGE_NUM   = 4096;  // 预先加载到内存中的页面
+  static constexpr int BUFFER_POOL_ID = 1;
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    LoggerFactory::init_default("bp_frame_manager_concurrency_test.log", LOG_LEVEL_WARN);
+
+    frame_manager_ = make_unique<BPFrameManager>("Benchmark");
+    frame_manager_->init(POOL_NUM, static_cast<int>(state.range(0)));
+
+    for (PageNum page_num = 0; page_num < HOT_PAGE_NUM; page_num++) {
+      Frame *frame = frame_manager_->alloc(BUFFER_POOL_ID, page_num);
+      ASSERT(frame != nullptr, "failed to alloc frame. page_num=%d", page_num);
+      frame->unpin();
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    for (Frame *frame : frame_manager_->find_list(BUFFER_POOL_ID)) {
+      frame_manager_->free(BUFFER_POOL_ID, frame->page_num(), frame);
+    }
+    frame_manager_->cleanup();
+    frame_manager_.reset();
+  }
+
+protected:
+  unique_ptr<BPFrameManager> frame_manager_;
+};
+
+BENCHMARK_DEFINE_F(FrameManagerBenchmark, Get)(State &state)
+{
+  IntegerGenerator generator(0, HOT_PAGE_NUM - 1);
+
+  int64_t miss_count = 0;
+  for (auto _ : state) {
+    Frame *frame = frame_manager_->get(BUFFER_POOL_ID, generator.next());
+    if (frame != nullptr) {
+      frame->unpin();
+    } else {
+      miss_count++;
+    }
+  }
+
+  state.counters["miss"] = Counter(miss_count, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(FrameManagerBenchmark, Get)->Arg(1)->Arg(16)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK_DEFINE_F(FrameManagerBenchmark, AllocFree)(State &state)
+{
+  // 每个线程使用不同的页面，避免相互释放对方的页帧
+  const PageNum page_begin = HOT_PAGE_NUM + state.thread_index() * 16;
+
+  int64_t failed_count = 0;
+  int64_t i            = 0;
+  for (auto _ : state) {
+    PageNum page_num = page_begin + (i++ % 16);
+    Frame  *frame    = frame_manager_->alloc(BUFFER_POOL_ID, page_num);
+    if (frame != nullptr) {
+      frame_manager_->free(BUFFER_POOL_ID, page_num, frame);
+    } else {
+      failed_count++;
+    }
+  }
+
+  state.counters["failed"] = Counter(failed_count, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(FrameManagerBenchmark, AllocFree)->Arg(1)->Arg(16)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,175 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+/**
+ * @file page_compression_performance_test.cpp
+ * @brief 对比页面压缩前后的读写吞吐量与磁盘占用
+ * @details 页面中填充类似记录的数据，后半部分是空闲空间。参数是压缩算法(PageCompression)。
+ * 写测试每次把所有页面标记为脏页并刷盘；读测试每次淘汰所有页面后重新加载，
+ * 文件内容通常在操作系统的缓存中，测试的主要是压缩与解压的开销。
+ * disk_bytes 是文件实际占用的磁盘空间，file_bytes 是文件的逻辑大小。
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/stat.h>
+
+#include "common/lang/stdexcept.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/buffer/page_compressor.h"
+#include "storage/clog/vacuous_log_handler.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+static constexpr int PAGE_NUM = 1000;
+
+class PageCompressionBenchmark : public Fixture
+{
+public:
+  virtual string Name() const = 0;
+
+  void SetUp(const State &state) override
+  {
+    const auto compression = static_cast<PageCompression>(state.range(0));
+
+    filename_ = this->Name() + "_" + page_compression_to_string(compression) + ".bp";
+
+    string log_name = this->Name() + ".log";
+    LoggerFactory::init_default(log_name.c_str(), LOG_LEVEL_WARN);
+
+    ::remove(filename_.c_str());
+
+    bpm_ = make_unique<BufferPoolManager>();
+    bpm_->init(make_unique<VacuousDoubleWriteBuffer>());
+
+    if (OB_FAIL(bpm_->create_file(filename_.c_str(), 0 /*page_size*/, compression)) ||
+        OB_FAIL(bpm_->open_file(log_handler_, filename_.c_str(), buffer_pool_))) {
+      throw runtime_error("failed to create buffer pool file");
+    }
+
+    for (int i = 0; i < PAGE_NUM; i++) {
+      Frame *frame = nullptr;
+      if (OB_FAIL(buffer_pool_->allocate_page(&frame))) {
+        throw runtime_error("failed to allocate page");
+      }
+      fill_page(frame->data(), frame->data_size(), i);
+      frame->mark_dirty();
+      buffer_pool_->unpin_page(frame);
+    }
+    buffer_pool_->flush_all_pages();
+  }
+
+  void TearDown(const State &state) override
+  {
+    bpm_->close_file(filename_.c_str());
+    bpm_.reset();
+    ::remove(filename_.c_str());
+  }
+
+protected:
+  /// 每个页面存放一半的记录，记录之间有很多重复的内容
+  static void fill_page(char *data, int size, int page_num)
+  {
+    memset(data, 0, size);
+    const int record_size = 64;
+    for (int offset = 0; offset + record_size <= size / 2; offset += record_size) {
+      snprintf(data + offset, record_size, "%08d|%08d|name_%d|city_%d|", page_num, offset, offset % 97, page_num % 13);
+    }
+  }
+
+  void report_disk_usage(State &state)
+  {
+    struct stat st;
+    if (0 == stat(filename_.c_str(), &st)) {
+      state.counters["disk_bytes"] = Counter(static_cast<double>(st.st_blocks) * 512);
+      state.counters["file_bytes"] = Counter(static_cast<double>(st.st_size));
+    }
+  }
+
+protected:
+  string                        filename_;
+  unique_ptr<BufferPoolManager> bpm_;
+  DiskBufferPool               *buffer_pool_ = nullptr;
+  VacuousLogHandler             log_handler_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct WriteBenchmark : public PageCompressionBenchmark
+{
+  string Name() const override { return "page_compression_write"; }
+};
+
+BENCHMARK_DEFINE_F(WriteBenchmark, Write)(State &state)
+{
+  int64_t page_count = 0;
+  for (auto _ : state) {
+    for (PageNum page_num = 1; page_num <= PAGE_NUM; page_num++) {
+      Frame *frame = nullptr;
+      if (OB_FAIL(buffer_pool_->get_this_page(page_num, &frame))) {
+        state.SkipWithError("failed to get page");
+        return;
+      }
+      frame->mark_dirty();
+      buffer_pool_->unpin_page(frame);
+    }
+    buffer_pool_->flush_all_pages();
+    page_count += PAGE_NUM;
+  }
+
+  state.counters["pages"] = Counter(page_count, Counter::kIsRate);
+  report_disk_usage(state);
+}
+
+BENCHMARK_REGISTER_F(WriteBenchmark, Write)
+    ->Arg(static_cast<int>(PageCompression::NONE))
+    ->Arg(static_cast<int>(PageCompression::LZ4));
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ReadBenchmark : public PageCompressionBenchmark
+{
+  string Name() const override { return "page_compression_read"; }
+};
+
+BENCHMARK_DEFINE_F(ReadBenchmark, Read)(State &state)
+{
+  int64_t page_count = 0;
+  for (auto _ : state) {
+    buffer_pool_->purge_all_pages();
+    for (PageNum page_num = 1; page_num <= PAGE_NUM; page_num++) {
+      Frame *frame = nullptr;
+      if (OB_FAIL(buffer_pool_->get_this_page(page_num, &frame))) {
+        state.SkipWithError("failed to get page");
+        return;
+      }
+      buffer_pool_->unpin_page(frame);
+    }
+    page_count += PAGE_NUM;
+  }
+
+  state.counters["pages"] = Counter(page_count, Counter::kIsRate);
+  report_disk_usage(state);
+}
+
+BENCHMARK_REGISTER_F(ReadBenchmark, Read)
+    ->Arg(static_cast<int>(PageCompression::NONE))
+    ->Arg(static_cast<int>(PageCompression::LZ4));
+
+////////////////////////////////////////////////////////////////////////////////
+
+BENCHMARK_MAIN();
@@ -0,0 +1,197 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2024/03/18
+//
+
+/**
+ * @file page_size_performance_test.cpp
+ * @brief 对比不同页面大小下 B+树点查和范围扫描的性能
+ * @details 使用比较宽的字符串索引键，页面越大，B+树的层数越少，点查访问的页面越少；
+ * 范围扫描时每个叶子节点上的记录越多，切换页面的次数越少。
+ * 参数是页面大小，每个页面大小的测试都会重新创建一个 B+树文件。
+ */
+
+#include <benchmark/benchmark.h>
+#include <inttypes.h>
+
+#include "common/lang/stdexcept.h"
+#include "common/log/log.h"
+#include "common/math/integer_generator.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/index/bplus_tree.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/buffer/double_write_buffer.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+static constexpr int KEY_LENGTH = 64;
+static constexpr int KEY_NUM    = 100 * 1000;
+
+struct Stat
+{
+  int64_t success_count = 0;
+  int64_t failed_count  = 0;
+  int64_t entry_count   = 0;
+};
+
+class PageSizeBenchmark : public Fixture
+{
+public:
+  virtual string Name() const = 0;
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    const int page_size = static_cast<int>(state.range(0));
+
+    filename_ = this->Name() + "_" + to_string(page_size) + ".btree";
+
+    string log_name = this->Name() + ".log";
+    LoggerFactory::init_default(log_name.c_str(), LOG_LEVEL_WARN);
+
+    ::remove(filename_.c_str());
+
+    bpm_ = make_unique<BufferPoolManager>();
+    bpm_->init(make_unique<VacuousDoubleWriteBuffer>());
+
+    DiskBufferPool *buffer_pool = nullptr;
+    if (OB_FAIL(bpm_->create_file(filename_.c_str(), page_size)) ||
+        OB_FAIL(bpm_->open_file(log_handler_, filename_.c_str(), buffer_pool))) {
+      throw runtime_error("failed to create buffer pool file");
+    }
+
+    handler_ = make_unique<BplusTreeHandler>();
+    RC rc    = handler_->create(log_handler_, *buffer_pool, AttrType::CHARS, KEY_LENGTH);
+    if (OB_FAIL(rc)) {
+      throw runtime_error("failed to create btree handler");
+    }
+
+    for (int i = 0; i < KEY_NUM; i++) {
+      char key[KEY_LENGTH + 1];
+      make_key(i, key);
+      RID rid(i, i);
+      rc = handler_->insert_entry(key, &rid);
+      if (OB_FAIL(rc)) {
+        throw runtime_error("failed to fill up btree");
+      }
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    bpm_->close_file(filename_.c_str());
+    handler_.reset();
+    bpm_.reset();
+    ::remove(filename_.c_str());
+  }
+
+protected:
+  /// 索引键占满 KEY_LENGTH 个字符，末尾多留一个结束符
+  static void make_key(int value, char key[KEY_LENGTH + 1]) { snprintf(key, KEY_LENGTH + 1, "%0*d", KEY_LENGTH, value); }
+
+  void Scan(int begin, int end, Stat &stat)
+  {
+    char begin_key[KEY_LENGTH + 1];
+    char end_key[KEY_LENGTH + 1];
+    make_key(begin, begin_key);
+    make_key(end, end_key);
+
+    BplusTreeScanner scanner(*handler_);
+
+    RC rc = scanner.open(begin_key, KEY_LENGTH, true /*inclusive*/, end_key, KEY_LENGTH, true /*inclusive*/);
+    if (OB_FAIL(rc)) {
+      stat.failed_count++;
+      return;
+    }
+
+    RID     rid;
+    int64_t count = 0;
+    while (RC::SUCCESS == (rc = scanner.next_entry(rid))) {
+      count++;
+    }
+    scanner.close();
+
+    if (rc != RC::RECORD_EOF || count != end - begin + 1) {
+      stat.failed_count++;
+    } else {
+      stat.success_count++;
+      stat.entry_count += count;
+    }
+  }
+
+protected:
+  string                        filename_;
+  unique_ptr<BufferPoolManager> bpm_;
+  unique_ptr<BplusTreeHandler>  handler_;
+  VacuousLogHandler             log_handler_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct LookupBenchmark : public PageSizeBenchmark
+{
+  string Name() const override { return "page_size_lookup"; }
+};
+
+BENCHMARK_DEFINE_F(LookupBenchmark, Lookup)(State &state)
+{
+  IntegerGenerator generator(0, KEY_NUM - 1);
+  Stat             stat;
+
+  for (auto _ : state) {
+    int value = static_cast<int>(generator.next());
+    Scan(value, value, stat);
+  }
+
+  state.counters["success"] = Counter(stat.success_count, Counter::kIsRate);
+  state.counters["failed"]  = Counter(stat.failed_count, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(LookupBenchmark, Lookup)->Threads(4)->RangeMultiplier(2)->Range(BP_MIN_PAGE_SIZE, BP_MAX_PAGE_SIZE);
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ScanBenchmark : public PageSizeBenchmark
+{
+  string Name() const override { return "page_size_scan"; }
+};
+
+BENCHMARK_DEFINE_F(ScanBenchmark, Scan)(State &state)
+{
+  const int        range_size = 1000;
+  IntegerGenerator generator(0, KEY_NUM - range_size);
+  Stat             stat;
+
+  for (auto _ : state) {
+    int begin = static_cast<int>(generator.next());
+    Scan(begin, begin + range_size - 1, stat);
+  }
+
+  state.counters["success"] = Counter(stat.success_count, Counter::kIsRate);
+  state.counters["failed"]  = Counter(stat.failed_count, Counter::kIsRate);
+  state.counters["entries"] = Counter(stat.entry_count, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(ScanBenchmark, Scan)->Threads(4)->RangeMultiplier(2)->Range(BP_MIN_PAGE_SIZE, BP_MAX_PAGE_SIZE);
+
+////////////////////////////////////////////////////////////////////////////////
+
+BENCHMARK_MAIN();
@@ -0,0 +1,133 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+/**
+ * @file parallel_scan_performance_test.cpp
+ * @brief 测试不同并行度下，向量化执行的 `SELECT SUM(value) FROM t WHERE id >= x` 的性能
+ * @details 表使用 PAX 格式，数据都在 buffer pool 中。参数是扫描使用的线程个数，需要 CONCURRENCY 模式编译，
+ * 否则总是使用一个线程。rows 是每秒扫描的记录数。
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/filesystem.h"
+#include "common/lang/stdexcept.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/aggregate_vec_physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+static constexpr int RECORD_NUM = 2000 * 1000;
+
+class ParallelScanBenchmark : public Fixture
+{
+public:
+  void SetUp(const State &state) override
+  {
+    LoggerFactory::init_default("parallel_scan.log", LOG_LEVEL_WARN);
+
+    filesystem::remove_all(directory_);
+    filesystem::create_directories(directory_);
+
+    db_ = make_unique<Db>();
+    if (OB_FAIL(db_->init("parallel_scan", directory_.c_str(), "vacuous", "vacuous"))) {
+      throw runtime_error("failed to init db");
+    }
+
+    vector<AttrInfoSqlNode> attr_infos(2);
+    attr_infos[0].name   = "id";
+    attr_infos[0].type   = AttrType::INTS;
+    attr_infos[0].length = 4;
+    attr_infos[1].name   = "value";
+    attr_infos[1].type   = AttrType::INTS;
+    attr_infos[1].length = 4;
+    if (OB_FAIL(db_->create_table("t", attr_infos, StorageFormat::PAX_FORMAT))) {
+      throw runtime_error("failed to create table");
+    }
+    table_ = db_->find_table("t");
+
+    for (int i = 0; i < RECORD_NUM; i++) {
+      // value 不使用有规律的数据，避免页面被压缩得太小
+      Value  values[2] = {Value(i), Value(static_cast<int>((i * 2654435761U) >> 8))};
+      Record record;
+      if (OB_FAIL(table_->make_record(2, values, record)) || OB_FAIL(table_->insert_record(record))) {
+        throw runtime_error("failed to insert record");
+      }
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    table_ = nullptr;
+    db_.reset();
+    filesystem::remove_all(directory_);
+  }
+
+  int64_t Sum(int parallelism)
+  {
+    const TableMeta &table_meta = table_->table_meta();
+
+    auto scan = make_unique<TableScanVecPhysicalOperator>(table_, ReadWriteMode::READ_ONLY);
+    vector<unique_ptr<Expression>> predicates;
+    predicates.push_back(make_unique<ComparisonExpr>(GREAT_EQUAL,
+        make_unique<FieldExpr>(table_, table_meta.field("id")),
+        make_unique<ValueExpr>(Value(RECORD_NUM / 10))));
+    scan->set_predicates(std::move(predicates));
+    scan->set_parallelism(parallelism);
+
+    AggregateExpr aggregate_expr(AggregateExpr::Type::SUM, make_unique<FieldExpr>(table_, table_meta.field("value")));
+    AggregateVecPhysicalOperator aggregate_oper({&aggregate_expr});
+    aggregate_oper.add_child(std::move(scan));
+    if (OB_FAIL(aggregate_oper.open(nullptr))) {
+      throw runtime_error("failed to run aggregation");
+    }
+    aggregate_oper.close();
+    return RECORD_NUM;
+  }
+
+protected:
+  string         directory_ = "parallel_scan_benchmark";
+  unique_ptr<Db> db_;
+  Table         *table_ = nullptr;
+};
+
+BENCHMARK_DEFINE_F(ParallelScanBenchmark, Sum)(State &state)
+{
+  const int parallelism = static_cast<int>(state.range(0));
+
+  int64_t rows = 0;
+  for (auto _ : state) {
+    rows += Sum(parallelism);
+  }
+
+  state.counters["rows"] = Counter(rows, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(ParallelScanBenchmark, Sum)
+    ->ArgNames({"threads"})
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,179 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+/**
+ * @file pax_column_encoding_performance_test.cpp
+ * @brief 对比扫描封存(列编码)与没有封存的 PAX 页面的性能
+ * @details 只有开启了页面压缩的文件才会封存页面，第一个参数为1时使用 LZ4 压缩的文件，页面写满之后都会封存，
+ * 为0时使用不压缩的文件。数据都在 buffer pool 中，不包含读取磁盘和解压缩的开销。
+ * 第二个参数为1时使用零拷贝的 next_chunk(chunk, select)，为0时复制数据。rows 是每秒扫描的记录数。
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/filesystem.h"
+#define private public
+#define protected public
+#include "storage/table/table.h"
+#undef private
+#undef protected
+
+#include "common/lang/stdexcept.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/record/record_manager.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+static constexpr int RECORD_NUM = 200 * 1000;
+
+struct TestRecord
+{
+  int32_t id;
+  int32_t group;
+  char    name[12];
+};
+
+class PaxColumnEncodingBenchmark : public Fixture
+{
+public:
+  void SetUp(const State &state) override
+  {
+    LoggerFactory::init_default("pax_column_encoding.log", LOG_LEVEL_WARN);
+
+    const PageCompression compression = state.range(0) != 0 ? PageCompression::LZ4 : PageCompression::NONE;
+
+    filesystem::remove(filename_);
+    filesystem::remove(filename_ + FreeSpaceMap::FILE_SUFFIX);
+
+    bpm_ = make_unique<BufferPoolManager>();
+    bpm_->init(make_unique<VacuousDoubleWriteBuffer>());
+    if (OB_FAIL(bpm_->create_file(filename_.c_str(), 0, compression)) ||
+        OB_FAIL(bpm_->open_file(log_handler_, filename_.c_str(), buffer_pool_))) {
+      throw runtime_error("failed to create buffer pool file");
+    }
+
+    table_.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+    TableMeta &table_meta              = table_.table_meta_;
+    table_meta.fields_.resize(3);
+    table_meta.fields_[0].attr_type_ = AttrType::INTS;
+    table_meta.fields_[0].attr_len_  = 4;
+    table_meta.fields_[0].field_id_  = 0;
+    table_meta.fields_[1].attr_type_ = AttrType::INTS;
+    table_meta.fields_[1].attr_len_  = 4;
+    table_meta.fields_[1].field_id_  = 1;
+    table_meta.fields_[2].attr_type_ = AttrType::CHARS;
+    table_meta.fields_[2].attr_len_  = 12;
+    table_meta.fields_[2].field_id_  = 2;
+
+    handler_ = make_unique<RecordFileHandler>(StorageFormat::PAX_FORMAT);
+    if (OB_FAIL(handler_->init(*buffer_pool_, log_handler_, &table_meta))) {
+      throw runtime_error("failed to init record file handler");
+    }
+
+    // 三列分别适合 FOR、RLE 和字典编码
+    TestRecord record;
+    memset(&record, 0, sizeof(record));
+    for (int32_t i = 0; i < RECORD_NUM; i++) {
+      record.id    = i;
+      record.group = i / 100;
+      snprintf(record.name, sizeof(record.name), "name_%d", i % 16);
+      RID rid;
+      if (OB_FAIL(handler_->insert_record(reinterpret_cast<const char *>(&record), sizeof(record), &rid))) {
+        throw runtime_error("failed to insert record");
+      }
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    handler_->close();
+    handler_.reset();
+    bpm_->close_file(filename_.c_str());
+    bpm_.reset();
+    filesystem::remove(filename_);
+    filesystem::remove(filename_ + FreeSpaceMap::FILE_SUFFIX);
+  }
+
+  /**
+   * @brief 扫描所有记录，计算第一列的和，返回扫描的记录数
+   */
+  int64_t Scan(bool zero_copy, int64_t &sum)
+  {
+    ChunkFileScanner scanner;
+    if (OB_FAIL(scanner.open_scan_chunk(&table_, *buffer_pool_, log_handler_, ReadWriteMode::READ_ONLY))) {
+      throw runtime_error("failed to open chunk scanner");
+    }
+
+    Chunk chunk;
+    chunk.add_column(make_unique<Column>(*table_.table_meta_.field(0)), 0);
+    chunk.add_column(make_unique<Column>(*table_.table_meta_.field(2)), 2);
+
+    int64_t         rows = 0;
+    RC              rc   = RC::SUCCESS;
+    vector<uint8_t> select;
+    while (OB_SUCC(rc = zero_copy ? scanner.next_chunk(chunk, select) : scanner.next_chunk(chunk))) {
+      const int32_t *values = reinterpret_cast<const int32_t *>(chunk.column(0).data());
+      for (int i = 0; i < chunk.rows(); i++) {
+        if (!zero_copy || select[i]) {
+          sum += values[i];
+          rows++;
+        }
+      }
+      chunk.reset_data();
+    }
+    if (rc != RC::RECORD_EOF) {
+      throw runtime_error("failed to scan chunk");
+    }
+
+    scanner.close_scan();
+    return rows;
+  }
+
+protected:
+  string                        filename_ = "pax_column_encoding.bp";
+  unique_ptr<BufferPoolManager> bpm_;
+  DiskBufferPool               *buffer_pool_ = nullptr;
+  VacuousLogHandler             log_handler_;
+  unique_ptr<RecordFileHandler> handler_;
+  Table                         table_;
+};
+
+BENCHMARK_DEFINE_F(PaxColumnEncodingBenchmark, Scan)(State &state)
+{
+  const bool zero_copy = state.range(1) != 0;
+
+  int64_t rows = 0;
+  int64_t sum  = 0;
+  for (auto _ : state) {
+    rows += Scan(zero_copy, sum);
+  }
+  DoNotOptimize(sum);
+
+  state.counters["rows"] = Counter(rows, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(PaxColumnEncodingBenchmark, Scan)
+    ->ArgNames({"sealed", "zero_copy"})
+    ->Args({0, 0})
+    ->Args({1, 0})
+    ->Args({0, 1})
+    ->Args({1, 1})
+    ->Unit(kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,185 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+/**
+ * @file pax_zone_map_performance_test.cpp
+ * @brief 对比 PAX 表范围扫描时使用与不使用 zone map 跳过页面的性能
+ * @details 第一列按照插入顺序递增，每次扫描一个随机的范围，按照 `col1 >= begin AND col1 < end` 过滤。
+ * 第一个参数表示是否使用 zone map，第二个参数是范围占全部记录的千分比。
+ * skipped_pages 是每次扫描平均跳过的页面数，rows 是满足条件的记录数，用来确认两种方式结果相同。
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/filesystem.h"
+#include "common/lang/sstream.h"
+#define private public
+#define protected public
+#include "storage/table/table.h"
+#undef private
+#undef protected
+
+#include "common/lang/stdexcept.h"
+#include "common/log/log.h"
+#include "common/math/integer_generator.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/record/record_manager.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+static constexpr int RECORD_NUM = 200 * 1000;
+
+struct TestRecord
+{
+  int32_t value;
+  char    fields[12];
+};
+
+class PaxZoneMapBenchmark : public Fixture
+{
+public:
+  void SetUp(const State &state) override
+  {
+    LoggerFactory::init_default("pax_zone_map.log", LOG_LEVEL_WARN);
+
+    filesystem::remove(filename_);
+    filesystem::remove(filename_ + FreeSpaceMap::FILE_SUFFIX);
+
+    bpm_ = make_unique<BufferPoolManager>();
+    bpm_->init(make_unique<VacuousDoubleWriteBuffer>());
+    if (OB_FAIL(bpm_->create_file(filename_.c_str())) ||
+        OB_FAIL(bpm_->open_file(log_handler_, filename_.c_str(), buffer_pool_))) {
+      throw runtime_error("failed to create buffer pool file");
+    }
+
+    table_.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+    TableMeta &table_meta              = table_.table_meta_;
+    table_meta.fields_.resize(2);
+    table_meta.fields_[0].attr_type_ = AttrType::INTS;
+    table_meta.fields_[0].attr_len_  = 4;
+    table_meta.fields_[0].field_id_  = 0;
+    table_meta.fields_[1].attr_type_ = AttrType::CHARS;
+    table_meta.fields_[1].attr_len_  = 12;
+    table_meta.fields_[1].field_id_  = 1;
+
+    handler_ = make_unique<RecordFileHandler>(StorageFormat::PAX_FORMAT);
+    if (OB_FAIL(handler_->init(*buffer_pool_, log_handler_, &table_meta))) {
+      throw runtime_error("failed to init record file handler");
+    }
+
+    TestRecord record;
+    memset(&record, 0, sizeof(record));
+    for (int32_t i = 0; i < RECORD_NUM; i++) {
+      record.value = i;
+      snprintf(record.fields, sizeof(record.fields), "name_%d", i % 1000);
+      RID rid;
+      if (OB_FAIL(handler_->insert_record(reinterpret_cast<const char *>(&record), sizeof(record), &rid))) {
+        throw runtime_error("failed to insert record");
+      }
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    handler_->close();
+    handler_.reset();
+    bpm_->close_file(filename_.c_str());
+    bpm_.reset();
+    filesystem::remove(filename_);
+    filesystem::remove(filename_ + FreeSpaceMap::FILE_SUFFIX);
+  }
+
+  /**
+   * @brief 扫描 [begin, end) 范围内的记录，返回满足条件的记录数
+   */
+  int64_t Scan(int32_t begin, int32_t end, bool use_zone_map, int64_t &skipped_pages)
+  {
+    ChunkFileScanner scanner;
+    if (OB_FAIL(scanner.open_scan_chunk(&table_, *buffer_pool_, log_handler_, ReadWriteMode::READ_ONLY))) {
+      throw runtime_error("failed to open chunk scanner");
+    }
+
+    if (use_zone_map) {
+      ZoneMapFilter filter;
+      filter.add_condition(0, GREAT_EQUAL, Value(begin));
+      filter.add_condition(0, LESS_THAN, Value(end));
+      scanner.set_zone_map_filter(std::move(filter));
+    }
+
+    Chunk chunk;
+    chunk.add_column(make_unique<Column>(*table_.table_meta_.field(0)), 0);
+    chunk.add_column(make_unique<Column>(*table_.table_meta_.field(1)), 1);
+
+    int64_t rows = 0;
+    RC      rc   = RC::SUCCESS;
+    while (OB_SUCC(rc = scanner.next_chunk(chunk))) {
+      const int32_t *values = reinterpret_cast<const int32_t *>(chunk.column(0).data());
+      for (int i = 0; i < chunk.rows(); i++) {
+        rows += (values[i] >= begin && values[i] < end) ? 1 : 0;
+      }
+      chunk.reset_data();
+    }
+    if (rc != RC::RECORD_EOF) {
+      throw runtime_error("failed to scan chunk");
+    }
+
+    skipped_pages += scanner.skipped_pages();
+    scanner.close_scan();
+    return rows;
+  }
+
+protected:
+  string                        filename_ = "pax_zone_map.bp";
+  unique_ptr<BufferPoolManager> bpm_;
+  DiskBufferPool               *buffer_pool_ = nullptr;
+  VacuousLogHandler             log_handler_;
+  unique_ptr<RecordFileHandler> handler_;
+  Table                         table_;
+};
+
+BENCHMARK_DEFINE_F(PaxZoneMapBenchmark, RangeScan)(State &state)
+{
+  const bool       use_zone_map = state.range(0) != 0;
+  const int32_t    range_size   = static_cast<int32_t>(RECORD_NUM * state.range(1) / 1000);
+  IntegerGenerator begin_generator(0, RECORD_NUM - range_size);
+
+  int64_t scans         = 0;
+  int64_t rows          = 0;
+  int64_t skipped_pages = 0;
+  for (auto _ : state) {
+    int32_t begin = begin_generator.next();
+    rows += Scan(begin, begin + range_size, use_zone_map, skipped_pages);
+    scans++;
+  }
+
+  state.counters["scans"]         = Counter(scans, Counter::kIsRate);
+  state.counters["rows"]          = Counter(static_cast<double>(rows) / scans);
+  state.counters["skipped_pages"] = Counter(static_cast<double>(skipped_pages) / scans);
+  state.counters["total_pages"]   = Counter(buffer_pool_->page_count() - 1);
+}
+
+BENCHMARK_REGISTER_F(PaxZoneMapBenchmark, RangeScan)
+    ->ArgNames({"zone_map", "permille"})
+    ->Args({0, 1})
+    ->Args({1, 1})
+    ->Args({0, 10})
+    ->Args({1, 10})
+    ->Args({0, 100})
+    ->Args({1, 100});
+
+BENCHMARK_MAIN();
@@ -12,7 +12,10 @@ See the Mulan PSL v2 for more details. */
 
 #include <algorithm>
 
+using std::count_if;
 using std::max;
 using std::min;
+using std::remove_if;
 using std::swap;
 using std::transform;
+using std::upper_bound;
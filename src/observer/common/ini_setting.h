@@ -25,3 +25,26 @@ See the Mulan PSL v2 for more details. */
 #define SOCKET_BUFFER_SIZE 8192
 
 #define SESSION_STAGE_NAME "SessionStage"
+
+// buffer pool 相关的配置项
+#define BUFFER_POOL "BUFFER_POOL"
+#define BUFFER_POOL_FRAME_SHARD_NUM "FRAME_SHARD_NUM"
+#define BUFFER_POOL_FRAME_SHARD_NUM_DEFAULT 1
+#define BUFFER_POOL_FRAME_REPLACER "FRAME_REPLACER"
+#define BUFFER_POOL_PREFETCH_DEPTH "PREFETCH_DEPTH"
+#define BUFFER_POOL_PREFETCH_DEPTH_DEFAULT 0
+#define BUFFER_POOL_PAGE_IO_ENGINE "PAGE_IO_ENGINE"
+#define BUFFER_POOL_DIRTY_HIGH_WATERMARK "DIRTY_HIGH_WATERMARK"
+#define BUFFER_POOL_DIRTY_HIGH_WATERMARK_DEFAULT 0
+#define BUFFER_POOL_DIRTY_LOW_WATERMARK "DIRTY_LOW_WATERMARK"
+#define BUFFER_POOL_DIRTY_LOW_WATERMARK_DEFAULT 0
+#define BUFFER_POOL_CHECKPOINT_INTERVAL "CHECKPOINT_INTERVAL"
+#define BUFFER_POOL_CHECKPOINT_INTERVAL_DEFAULT 0
+#define BUFFER_POOL_DOUBLE_WRITE_PAGES "DOUBLE_WRITE_PAGES"
+#define BUFFER_POOL_DOUBLE_WRITE_PAGES_DEFAULT 128
+#define BUFFER_POOL_FRAME_MEMORY "FRAME_MEMORY"
+#define BUFFER_POOL_FRAME_NUMA_POLICY "FRAME_NUMA_POLICY"
+#define BUFFER_POOL_MAX_MEMORY_SIZE "MAX_MEMORY_SIZE"
+#define BUFFER_POOL_MAX_MEMORY_SIZE_DEFAULT 0
+#define BUFFER_POOL_PAGE_SIZE "PAGE_SIZE"
+#define BUFFER_POOL_PAGE_SIZE_DEFAULT 0
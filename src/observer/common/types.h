@@ -42,13 +42,15 @@ enum class ReadWriteMode
 
 /**
  * @brief 存储格式
- * @details 当前仅支持行存格式（ROW_FORMAT）以及 PAX 存储格式(PAX_FORMAT)。
+ * @details 当前支持定长的行存格式（ROW_FORMAT）、PAX 存储格式(PAX_FORMAT)以及变长的行存格式(VARLEN_FORMAT)。
+ * 变长行存格式中 CHARS 字段按照实际长度存放，超长的字段放到溢出页面中。
  */
 enum class StorageFormat
 {
   UNKNOWN_FORMAT = 0,
   ROW_FORMAT,
-  PAX_FORMAT
+  PAX_FORMAT,
+  VARLEN_FORMAT
 };
 
 /**
@@ -83,6 +83,9 @@ public:
   void          set_execution_mode(const ExecutionMode mode) { execution_mode_ = mode; }
   ExecutionMode get_execution_mode() const { return execution_mode_; }
 
+  void set_parallel_scan_threads(int threads) { parallel_scan_threads_ = threads; }
+  int  parallel_scan_threads() const { return parallel_scan_threads_; }
+
   bool used_chunk_mode() { return used_chunk_mode_; }
 
   void set_used_chunk_mode(bool used_chunk_mode) { used_chunk_mode_ = used_chunk_mode; }
@@ -113,4 +116,6 @@ private:
   bool used_chunk_mode_ = false;
 
   ExecutionMode execution_mode_ = ExecutionMode::TUPLE_ITERATOR;
+
+  int parallel_scan_threads_ = 1;  ///< 向量化执行时扫描表使用的线程个数
 };
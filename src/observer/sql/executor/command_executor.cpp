@@ -21,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/executor/help_executor.h"
 #include "sql/executor/load_data_executor.h"
 #include "sql/executor/set_variable_executor.h"
+#include "sql/executor/show_buffer_pool_status_executor.h"
 #include "sql/executor/show_tables_executor.h"
 #include "sql/executor/trx_begin_executor.h"
 #include "sql/executor/trx_end_executor.h"
@@ -57,6 +58,11 @@ RC CommandExecutor::execute(SQLStageEvent *sql_event)
       rc = executor.execute(sql_event);
     } break;
 
+    case StmtType::SHOW_BUFFER_POOL_STATUS: {
+      ShowBufferPoolStatusExecutor executor;
+      rc = executor.execute(sql_event);
+    } break;
+
     case StmtType::BEGIN: {
       TrxBeginExecutor executor;
       rc = executor.execute(sql_event);
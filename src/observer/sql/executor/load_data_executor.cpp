@@ -33,15 +33,16 @@ RC LoadDataExecutor::execute(SQLStageEvent *sql_event)
 }
 
 /**
- * 从文件中导入数据时使用。尝试向表中插入解析后的一行数据。
+ * 从文件中导入数据时使用。把解析后的一行数据转换成表中的一条记录。
  * @param table  要导入的表
  * @param file_values 从文件中读取到的一行数据，使用分隔符拆分后的几个字段值
- * @param record_values Table::insert_record使用的参数，为了防止频繁的申请内存
+ * @param record_values Table::make_record使用的参数，为了防止频繁的申请内存
+ * @param record 返回生成的记录
  * @param errmsg 如果出现错误，通过这个参数返回错误信息
  * @return 成功返回RC::SUCCESS
  */
-RC insert_record_from_file(
-    Table *table, vector<string> &file_values, vector<Value> &record_values, stringstream &errmsg)
+RC make_record_from_file(
+    Table *table, vector<string> &file_values, vector<Value> &record_values, Record &record, stringstream &errmsg)
 {
 
   const int field_num     = record_values.size();
@@ -65,17 +66,52 @@ RC insert_record_from_file(
   }
 
   if (RC::SUCCESS == rc) {
-    Record record;
     rc = table->make_record(field_num, record_values.data(), record);
     if (rc != RC::SUCCESS) {
       errmsg << "insert failed.";
-    } else if (RC::SUCCESS != (rc = table->insert_record(record))) {
-      errmsg << "insert failed.";
     }
   }
   return rc;
 }
 
+/**
+ * 从文件中导入数据时使用。批量插入已经解析好的记录，插入之后会清空 records 和 line_nums。
+ * @details 批量插入失败时，这一批记录都不会插入到表中。这时再逐条插入，找到出错的那一行，
+ * 出错行之前的记录依然会插入成功，与逐行导入时的行为一致。
+ * @param table 要导入的表
+ * @param records 待插入的记录
+ * @param line_nums 每条记录在文件中的行号
+ * @param insertion_count 累加成功插入的记录个数
+ * @param result_string 如果出现错误，输出错误信息
+ */
+RC insert_records_from_file(Table *table, vector<Record> &records, vector<int> &line_nums, int &insertion_count,
+    stringstream &result_string)
+{
+  if (records.empty()) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = table->insert_records(records);
+  if (OB_SUCC(rc)) {
+    insertion_count += static_cast<int>(records.size());
+  } else {
+    LOG_TRACE("failed to insert records in batch, insert one by one. rc=%s", strrc(rc));
+    for (size_t i = 0; i < records.size(); i++) {
+      rc = table->insert_record(records[i]);
+      if (OB_FAIL(rc)) {
+        result_string << "Line:" << line_nums[i] << " insert record failed:insert failed.. error:" << strrc(rc)
+                      << endl;
+        break;
+      }
+      insertion_count++;
+    }
+  }
+
+  records.clear();
+  line_nums.clear();
+  return rc;
+}
+
 void LoadDataExecutor::load_data(Table *table, const char *file_name, SqlResult *sql_result)
 {
   stringstream result_string;
@@ -101,6 +137,12 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, SqlResult
   int                      line_num        = 0;
   int                      insertion_count = 0;
   RC                       rc              = RC::SUCCESS;
+
+  // 解析好的记录先攒起来，凑够一批之后再一起插入
+  vector<Record> records;
+  vector<int>    record_line_nums;
+  records.reserve(LOAD_BATCH_SIZE);
+  record_line_nums.reserve(LOAD_BATCH_SIZE);
   while (!fs.eof() && RC::SUCCESS == rc) {
     getline(fs, line);
     line_num++;
@@ -111,13 +153,25 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, SqlResult
     file_values.clear();
     common::split_string(line, delim, file_values);
     stringstream errmsg;
-    rc = insert_record_from_file(table, file_values, record_values, errmsg);
+    Record       record;
+    rc = make_record_from_file(table, file_values, record_values, record, errmsg);
     if (rc != RC::SUCCESS) {
       result_string << "Line:" << line_num << " insert record failed:" << errmsg.str() << ". error:" << strrc(rc)
                     << endl;
-    } else {
-      insertion_count++;
+      break;
     }
+
+    records.emplace_back(std::move(record));
+    record_line_nums.push_back(line_num);
+    if (static_cast<int>(records.size()) >= LOAD_BATCH_SIZE) {
+      rc = insert_records_from_file(table, records, record_line_nums, insertion_count, result_string);
+    }
+  }
+
+  // 文件中某一行解析失败时，前面已经解析好的记录依然要插入
+  RC insert_rc = insert_records_from_file(table, records, record_line_nums, insertion_count, result_string);
+  if (RC::SUCCESS == rc) {
+    rc = insert_rc;
   }
   fs.close();
 
@@ -26,6 +26,10 @@ class SqlResult;
  */
 class LoadDataExecutor
 {
+public:
+  /// 每次批量插入的记录个数
+  static constexpr int LOAD_BATCH_SIZE = 1000;
+
 public:
   LoadDataExecutor()          = default;
   virtual ~LoadDataExecutor() = default;
@@ -9,6 +9,8 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "sql/executor/set_variable_executor.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/db/db.h"
 
 RC SetVariableExecutor::execute(SQLStageEvent *sql_event)
 {
@@ -34,6 +36,25 @@ RC SetVariableExecutor::execute(SQLStageEvent *sql_event)
       } else {
         rc = RC::INVALID_ARGUMENT;
       }
+    } else if (strcasecmp(var_name, "buffer_pool_size") == 0) {
+      int64_t memory_size = 0;
+      rc = get_memory_size(var_value, memory_size);
+      Db *db = session->get_current_db();
+      if (rc == RC::SUCCESS && db == nullptr) {
+        LOG_WARN("cannot resize buffer pool, no db selected");
+        rc = RC::SCHEMA_DB_NOT_EXIST;
+      }
+      if (rc == RC::SUCCESS) {
+        rc = db->buffer_pool_manager().resize(memory_size);
+      }
+    } else if (strcasecmp(var_name, "parallel_scan_threads") == 0) {
+      // 只对向量化执行模式(chunk_iterator)下的表扫描生效
+      if (var_value.attr_type() == AttrType::INTS && var_value.get_int() >= 1 &&
+          var_value.get_int() <= MAX_PARALLEL_SCAN_THREADS) {
+        session->set_parallel_scan_threads(var_value.get_int());
+      } else {
+        rc = RC::VARIABLE_NOT_VALID;
+      }
     } else {
       rc = RC::VARIABLE_NOT_EXISTS;
     }
@@ -96,3 +117,38 @@ RC SetVariableExecutor::get_execution_mode(const Value &var_value, ExecutionMode
 
     return rc;
 }
+
+RC SetVariableExecutor::get_memory_size(const Value &var_value, int64_t &memory_size) const
+{
+    if (var_value.attr_type() == AttrType::INTS) {
+      memory_size = var_value.get_int();
+      return memory_size > 0 ? RC::SUCCESS : RC::VARIABLE_NOT_VALID;
+    }
+
+    if (var_value.attr_type() != AttrType::CHARS) {
+      return RC::VARIABLE_NOT_VALID;
+    }
+
+    // 字符串可以带单位，比如 "512M"、"2G"
+    string str = var_value.get_string();
+    char  *end = nullptr;
+    memory_size = strtoll(str.c_str(), &end, 10);
+    if (end == str.c_str() || memory_size <= 0) {
+      return RC::VARIABLE_NOT_VALID;
+    }
+
+    int64_t unit = 1;
+    switch (toupper(*end)) {
+      case '\0': break;
+      case 'K': unit = 1024L; end++; break;
+      case 'M': unit = 1024L * 1024; end++; break;
+      case 'G': unit = 1024L * 1024 * 1024; end++; break;
+      default: return RC::VARIABLE_NOT_VALID;
+    }
+    if (*end != '\0') {
+      return RC::VARIABLE_NOT_VALID;
+    }
+
+    memory_size *= unit;
+    return RC::SUCCESS;
+}
@@ -26,6 +26,9 @@ See the Mulan PSL v2 for more details. */
  */
 class SetVariableExecutor
 {
+public:
+  static constexpr int MAX_PARALLEL_SCAN_THREADS = 64;
+
 public:
   SetVariableExecutor()          = default;
   virtual ~SetVariableExecutor() = default;
@@ -36,4 +39,9 @@ private:
   RC var_value_to_boolean(const Value &var_value, bool &bool_value) const;
 
   RC get_execution_mode(const Value &var_value, ExecutionMode &execution_mode) const;
+
+  /**
+   * @brief 解析内存大小，可以是整数(字节)，或者带 K/M/G 单位的字符串
+   */
+  RC get_memory_size(const Value &var_value, int64_t &memory_size) const;
 };
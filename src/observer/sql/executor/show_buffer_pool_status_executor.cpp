@@ -0,0 +1,157 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/executor/show_buffer_pool_status_executor.h"
+
+#include "common/lang/sstream.h"
+#include "common/log/log.h"
+#include "event/session_event.h"
+#include "event/sql_event.h"
+#include "session/session.h"
+#include "sql/operator/string_list_physical_operator.h"
+#include "sql/stmt/stmt.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/db/db.h"
+
+using namespace std;
+
+static string hit_ratio(int64_t hits, int64_t misses)
+{
+  const int64_t total = hits + misses;
+  if (total == 0) {
+    return "0.00";
+  }
+
+  stringstream ss;
+  ss.setf(ios::fixed);
+  ss.precision(2);
+  ss << 100.0 * hits / total;
+  return ss.str();
+}
+
+RC ShowBufferPoolStatusExecutor::execute(SQLStageEvent *sql_event)
+{
+  Stmt         *stmt          = sql_event->stmt();
+  SessionEvent *session_event = sql_event->session_event();
+  ASSERT(stmt->type() == StmtType::SHOW_BUFFER_POOL_STATUS,
+      "show buffer pool status executor can not run this command: %d",
+      static_cast<int>(stmt->type()));
+
+  SqlResult *sql_result = session_event->sql_result();
+  Db        *db         = session_event->session()->get_current_db();
+  if (db == nullptr) {
+    LOG_WARN("cannot show buffer pool status, no db selected");
+    return RC::SCHEMA_DB_NOT_EXIST;
+  }
+
+  BufferPoolManager &bp_manager    = db->buffer_pool_manager();
+  BPFrameManager    &frame_manager = bp_manager.get_frame_manager();
+
+  unordered_map<int32_t, BPFrameManager::Residency> residency;
+  frame_manager.residency(residency);
+
+  TupleSchema tuple_schema;
+  tuple_schema.append_cell(TupleCellSpec("", "Scope", "Scope"));
+  tuple_schema.append_cell(TupleCellSpec("", "Name", "Name"));
+  tuple_schema.append_cell(TupleCellSpec("", "Value", "Value"));
+  sql_result->set_tuple_schema(tuple_schema);
+
+  auto oper = new StringListPhysicalOperator;
+
+  const char *global = "global";
+  int         dirty  = 0;
+  int         pinned = 0;
+  for (const auto &[id, item] : residency) {
+    dirty += item.dirty;
+    pinned += item.pinned;
+  }
+
+  // 不同页面大小的文件在不同的页帧管理器中，buffer pool id 不会重复
+  bp_manager.foreach_frame_manager([&](BPFrameManager &fm) {
+    if (&fm != &frame_manager) {
+      fm.residency(residency);
+    }
+  });
+
+  BPFrameManager::Stats &frame_stats = frame_manager.stats();
+  const int64_t          hits        = frame_stats.hits.load();
+  const int64_t          misses      = frame_stats.misses.load();
+  oper->append({global, "memory_size", to_string(bp_manager.memory_size())});
+  oper->append({global, "max_memory_size", to_string(bp_manager.max_memory_size())});
+  oper->append({global, "page_size", to_string(bp_manager.page_size())});
+  oper->append({global, "frames_total", to_string(frame_manager.total_frame_num())});
+  oper->append({global, "frames_used", to_string(frame_manager.frame_num())});
+  oper->append({global, "frames_dirty", to_string(dirty)});
+  oper->append({global, "frames_pinned", to_string(pinned)});
+  oper->append({global, "frame_shards", to_string(frame_manager.shard_num())});
+  oper->append({global, "hits", to_string(hits)});
+  oper->append({global, "misses", to_string(misses)});
+  oper->append({global, "hit_ratio", hit_ratio(hits, misses)});
+  oper->append({global, "evictions", to_string(frame_stats.evictions.load())});
+  oper->append({global, "pin_waits", to_string(frame_stats.pin_waits.load())});
+
+  BufferPoolPrefetcher::Stats &prefetch_stats = bp_manager.get_prefetcher().stats();
+  oper->append({global, "prefetch_hits", to_string(prefetch_stats.hit.load())});
+  oper->append({global, "prefetch_misses", to_string(prefetch_stats.miss.load())});
+
+  PageCleaner::Stats &cleaner_stats = bp_manager.get_page_cleaner().stats();
+  oper->append({global, "cleaner_flushed", to_string(cleaner_stats.flushed.load())});
+  oper->append({global, "foreground_flushed", to_string(cleaner_stats.foreground_flushed.load())});
+
+  // 其它页面大小的页帧管理器
+  bp_manager.foreach_frame_manager([&](BPFrameManager &fm) {
+    if (&fm == &frame_manager) {
+      return;
+    }
+
+    const string           scope    = "page_size=" + to_string(fm.page_size());
+    BPFrameManager::Stats &fm_stats = fm.stats();
+    const int64_t          fm_hits  = fm_stats.hits.load();
+    const int64_t          fm_miss  = fm_stats.misses.load();
+    oper->append({scope, "frames_total", to_string(fm.total_frame_num())});
+    oper->append({scope, "frames_used", to_string(fm.frame_num())});
+    oper->append({scope, "hits", to_string(fm_hits)});
+    oper->append({scope, "misses", to_string(fm_miss)});
+    oper->append({scope, "hit_ratio", hit_ratio(fm_hits, fm_miss)});
+    oper->append({scope, "evictions", to_string(fm_stats.evictions.load())});
+  });
+
+  bp_manager.foreach_buffer_pool([&](DiskBufferPool &bp) {
+    string file_name = bp.filename();
+    size_t pos       = file_name.find_last_of('/');
+    if (pos != string::npos) {
+      file_name = file_name.substr(pos + 1);
+    }
+
+    const BPFrameManager::Residency &item     = residency[bp.id()];
+    DiskBufferPool::Stats           &bp_stats = bp.stats();
+    const int64_t                    bp_hits  = bp_stats.hits.load();
+    const int64_t                    bp_miss  = bp_stats.misses.load();
+    oper->append({file_name, "page_size", to_string(bp.page_size())});
+    oper->append({file_name, "pages", to_string(bp.page_count())});
+    oper->append({file_name, "allocated_pages", to_string(bp.allocated_pages())});
+    oper->append({file_name, "resident_frames", to_string(item.frames)});
+    oper->append({file_name, "dirty_frames", to_string(item.dirty)});
+    oper->append({file_name, "pinned_frames", to_string(item.pinned)});
+    oper->append({file_name, "hits", to_string(bp_hits)});
+    oper->append({file_name, "misses", to_string(bp_miss)});
+    oper->append({file_name, "hit_ratio", hit_ratio(bp_hits, bp_miss)});
+    oper->append({file_name, "flushes", to_string(bp_stats.flushes.load())});
+    if (bp.compression() != PageCompression::NONE) {
+      oper->append({file_name, "compression", page_compression_to_string(bp.compression())});
+      oper->append({file_name, "compressed_writes", to_string(bp_stats.compressed_writes.load())});
+      oper->append({file_name, "compressed_bytes", to_string(bp_stats.compressed_bytes.load())});
+      oper->append({file_name, "raw_writes", to_string(bp_stats.raw_writes.load())});
+    }
+  });
+
+  sql_result->set_operator(unique_ptr<PhysicalOperator>(oper));
+  return RC::SUCCESS;
+}
@@ -0,0 +1,31 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/sys/rc.h"
+
+class SQLStageEvent;
+
+/**
+ * @brief 显示buffer pool统计信息的执行器
+ * @ingroup Executor
+ * @details 输出三列：Scope、Name、Value。Scope 是 global 时表示整个 buffer pool 的信息，
+ * 否则是某个数据文件的信息，比如命中率、在内存中的页帧个数。
+ * 统计信息都是计数器的累计值，不同计数器之间不保证是同一时刻的值。
+ */
+class ShowBufferPoolStatusExecutor
+{
+public:
+  ShowBufferPoolStatusExecutor()          = default;
+  virtual ~ShowBufferPoolStatusExecutor() = default;
+
+  RC execute(SQLStageEvent *sql_event);
+};
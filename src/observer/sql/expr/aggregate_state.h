@@ -15,4 +15,5 @@ public:
   SumState() : value(0) {}
   T    value;
   void update(const T *values, int size);
+  void merge(const SumState<T> &other) { value += other.value; }
 };
\ No newline at end of file
@@ -35,15 +35,21 @@ bool FieldExpr::equal(const Expression &other) const
   return table_name() == other_field_expr.table_name() && field_name() == other_field_expr.field_name();
 }
 
-// TODO: 在进行表达式计算时，`chunk` 包含了所有列，因此可以通过 `field_id` 获取到对应列。
+// 表扫描只返回查询中用到的列，需要通过 `field_id` 找到对应列在 `chunk` 中的位置。
 // 后续可以优化成在 `FieldExpr` 中存储 `chunk` 中某列的位置信息。
 RC FieldExpr::get_column(Chunk &chunk, Column &column)
 {
   if (pos_ != -1) {
     column.reference(chunk.column(pos_));
-  } else {
-    column.reference(chunk.column(field().meta()->field_id()));
+    return RC::SUCCESS;
+  }
+
+  const int index = chunk.find_column(field().meta()->field_id());
+  if (index < 0) {
+    LOG_WARN("column is not in the chunk. table=%s, field=%s", table_name(), field_name());
+    return RC::INTERNAL;
   }
+  column.reference(chunk.column(index));
   return RC::SUCCESS;
 }
 
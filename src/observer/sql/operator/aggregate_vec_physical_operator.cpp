@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 #include "common/lang/ranges.h"
 #include "sql/operator/aggregate_vec_physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
 #include "sql/expr/aggregate_state.h"
 #include "sql/expr/expression_tuple.h"
 #include "sql/expr/composite_tuple.h"
@@ -36,26 +37,41 @@ AggregateVecPhysicalOperator::AggregateVecPhysicalOperator(vector<Expression *>
 
     if (aggregate_expr->aggregate_type() == AggregateExpr::Type::SUM) {
       if (aggregate_expr->value_type() == AttrType::INTS) {
-        void *aggr_value                     = malloc(sizeof(SumState<int>));
-        ((SumState<int> *)aggr_value)->value = 0;
-        aggr_values_.insert(aggr_value);
         output_chunk_.add_column(make_unique<Column>(AttrType::INTS, sizeof(int)), i);
       } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
-        void *aggr_value                       = malloc(sizeof(SumState<float>));
-        ((SumState<float> *)aggr_value)->value = 0;
-        aggr_values_.insert(aggr_value);
         output_chunk_.add_column(make_unique<Column>(AttrType::FLOATS, sizeof(float)), i);
       }
     } else {
       ASSERT(false, "not supported aggregation type");
     }
   }
+  create_aggregate_values(aggr_values_);
+}
+
+void AggregateVecPhysicalOperator::create_aggregate_values(AggregateValues &aggr_values)
+{
+  for (Expression *expr : aggregate_expressions_) {
+    auto *aggregate_expr = static_cast<AggregateExpr *>(expr);
+    if (aggregate_expr->aggregate_type() == AggregateExpr::Type::SUM) {
+      if (aggregate_expr->value_type() == AttrType::INTS) {
+        void *aggr_value                     = malloc(sizeof(SumState<int>));
+        ((SumState<int> *)aggr_value)->value = 0;
+        aggr_values.insert(aggr_value);
+      } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
+        void *aggr_value                       = malloc(sizeof(SumState<float>));
+        ((SumState<float> *)aggr_value)->value = 0;
+        aggr_values.insert(aggr_value);
+      }
+    }
+  }
 }
 
 RC AggregateVecPhysicalOperator::open(Trx *trx)
 {
   ASSERT(children_.size() == 1, "group by operator only support one child, but got %d", children_.size());
 
+  outputed_ = false;
+
   PhysicalOperator &child = *children_[0];
   RC                rc    = child.open(trx);
   if (OB_FAIL(rc)) {
@@ -63,23 +79,17 @@ RC AggregateVecPhysicalOperator::open(Trx *trx)
     return rc;
   }
 
+  if (child.type() == PhysicalOperatorType::TABLE_SCAN_VEC) {
+    auto &table_scan = static_cast<TableScanVecPhysicalOperator &>(child);
+    if (table_scan.parallelism() > 1) {
+      return parallel_aggregate(table_scan);
+    }
+  }
+
   while (OB_SUCC(rc = child.next(chunk_))) {
-    for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
-      Column column;
-      value_expressions_[aggr_idx]->get_column(chunk_, column);
-      ASSERT(aggregate_expressions_[aggr_idx]->type() == ExprType::AGGREGATION, "expect aggregate expression");
-      auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
-      if (aggregate_expr->aggregate_type() == AggregateExpr::Type::SUM) {
-        if (aggregate_expr->value_type() == AttrType::INTS) {
-          update_aggregate_state<SumState<int>, int>(aggr_values_.at(aggr_idx), column);
-        } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
-          update_aggregate_state<SumState<float>, float>(aggr_values_.at(aggr_idx), column);
-        } else {
-          ASSERT(false, "not supported value type");
-        }
-      } else {
-        ASSERT(false, "not supported aggregation type");
-      }
+    rc = update_aggregate_values(aggr_values_, chunk_);
+    if (OB_FAIL(rc)) {
+      return rc;
     }
   }
 
@@ -89,6 +99,66 @@ RC AggregateVecPhysicalOperator::open(Trx *trx)
 
   return rc;
 }
+
+RC AggregateVecPhysicalOperator::parallel_aggregate(TableScanVecPhysicalOperator &table_scan)
+{
+  vector<unique_ptr<AggregateValues>> partial_values;
+  for (int i = 0; i < table_scan.parallelism(); i++) {
+    partial_values.push_back(make_unique<AggregateValues>());
+    create_aggregate_values(*partial_values.back());
+  }
+
+  RC rc = table_scan.parallel_scan([this, &partial_values](int worker_id, Chunk &chunk) {
+    return update_aggregate_values(*partial_values[worker_id], chunk);
+  });
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to scan table in parallel. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  for (unique_ptr<AggregateValues> &values : partial_values) {
+    merge_aggregate_values(*values);
+  }
+  return rc;
+}
+
+RC AggregateVecPhysicalOperator::update_aggregate_values(AggregateValues &aggr_values, Chunk &chunk)
+{
+  for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
+    Column column;
+    RC     rc = value_expressions_[aggr_idx]->get_column(chunk, column);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get column of aggregation. rc=%s", strrc(rc));
+      return rc;
+    }
+    ASSERT(aggregate_expressions_[aggr_idx]->type() == ExprType::AGGREGATION, "expect aggregate expression");
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
+    if (aggregate_expr->aggregate_type() == AggregateExpr::Type::SUM) {
+      if (aggregate_expr->value_type() == AttrType::INTS) {
+        update_aggregate_state<SumState<int>, int>(aggr_values.at(aggr_idx), column);
+      } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
+        update_aggregate_state<SumState<float>, float>(aggr_values.at(aggr_idx), column);
+      } else {
+        ASSERT(false, "not supported value type");
+      }
+    } else {
+      ASSERT(false, "not supported aggregation type");
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void AggregateVecPhysicalOperator::merge_aggregate_values(AggregateValues &from)
+{
+  for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
+    if (aggregate_expr->value_type() == AttrType::INTS) {
+      merge_aggregate_state<SumState<int>>(aggr_values_.at(aggr_idx), from.at(aggr_idx));
+    } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
+      merge_aggregate_state<SumState<float>>(aggr_values_.at(aggr_idx), from.at(aggr_idx));
+    }
+  }
+}
 template <class STATE, typename T>
 void AggregateVecPhysicalOperator::update_aggregate_state(void *state, const Column &column)
 {
@@ -99,8 +169,30 @@ void AggregateVecPhysicalOperator::update_aggregate_state(void *state, const Col
 
 RC AggregateVecPhysicalOperator::next(Chunk &chunk)
 {
-  // your code here
-  exit(-1);
+  // 没有 group by，聚合结果只有一行
+  if (outputed_) {
+    return RC::RECORD_EOF;
+  }
+
+  output_chunk_.reset_data();
+  for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
+    if (aggregate_expr->aggregate_type() == AggregateExpr::Type::SUM) {
+      if (aggregate_expr->value_type() == AttrType::INTS) {
+        append_to_column<SumState<int>, int>(aggr_values_.at(aggr_idx), output_chunk_.column(aggr_idx));
+      } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
+        append_to_column<SumState<float>, float>(aggr_values_.at(aggr_idx), output_chunk_.column(aggr_idx));
+      } else {
+        ASSERT(false, "not supported value type");
+      }
+    } else {
+      ASSERT(false, "not supported aggregation type");
+    }
+  }
+
+  chunk.reference(output_chunk_);
+  outputed_ = true;
+  return RC::SUCCESS;
 }
 
 RC AggregateVecPhysicalOperator::close()
@@ -12,9 +12,12 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/physical_operator.h"
 
+class TableScanVecPhysicalOperator;
+
 /**
  * @brief 聚合物理算子 (Vectorized)
  * @ingroup PhysicalOperator
+ * @details 子算子是并行度大于1的表扫描算子时，每个扫描线程在自己的部分聚合结果上计算，扫描结束后再合并
  */
 class AggregateVecPhysicalOperator : public PhysicalOperator
 {
@@ -30,9 +33,26 @@ public:
   RC close() override;
 
 private:
+  class AggregateValues;
+
+  void create_aggregate_values(AggregateValues &aggr_values);
+  RC   update_aggregate_values(AggregateValues &aggr_values, Chunk &chunk);
+  void merge_aggregate_values(AggregateValues &from);
+
+  /**
+   * @brief 使用多个线程扫描表，分别计算部分聚合结果，最后合并到 aggr_values_ 中
+   */
+  RC parallel_aggregate(TableScanVecPhysicalOperator &table_scan);
+
   template <class STATE, typename T>
   void update_aggregate_state(void *state, const Column &column);
 
+  template <class STATE>
+  void merge_aggregate_state(void *state, void *other)
+  {
+    reinterpret_cast<STATE *>(state)->merge(*reinterpret_cast<STATE *>(other));
+  }
+
   template <class STATE, typename T>
   void append_to_column(void *state, Column &column)
   {
@@ -44,7 +64,8 @@ private:
   class AggregateValues
   {
   public:
-    AggregateValues() = default;
+    AggregateValues()                        = default;
+    AggregateValues(const AggregateValues &) = delete;
 
     void insert(void *aggr_value) { data_.push_back(aggr_value); }
 
@@ -71,4 +92,5 @@ private:
   Chunk                chunk_;
   Chunk                output_chunk_;
   AggregateValues      aggr_values_;
+  bool                 outputed_ = false;  ///< 聚合结果是否已经输出
 };
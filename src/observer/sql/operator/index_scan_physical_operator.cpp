@@ -13,23 +13,44 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "sql/operator/index_scan_physical_operator.h"
+#include "common/lang/algorithm.h"
 #include "storage/index/index.h"
 #include "storage/trx/trx.h"
 
-IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const Value *left_value,
-    bool left_inclusive, const Value *right_value, bool right_inclusive)
+IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode,
+    vector<Value> left_values, bool left_inclusive, vector<Value> right_values, bool right_inclusive)
     : table_(table),
       index_(index),
       mode_(mode),
+      left_values_(std::move(left_values)),
+      right_values_(std::move(right_values)),
       left_inclusive_(left_inclusive),
       right_inclusive_(right_inclusive)
+{}
+
+bool IndexScanPhysicalOperator::empty_range() const
 {
-  if (left_value) {
-    left_value_ = *left_value;
+  if (left_values_.empty() || right_values_.empty()) {
+    return false;
+  }
+
+  const size_t common_num = min(left_values_.size(), right_values_.size());
+  for (size_t i = 0; i < common_num; i++) {
+    const int result = left_values_[i].compare(right_values_[i]);
+    if (result != 0) {
+      return result > 0;
+    }
+  }
+
+  // 公共的前缀都相等时，较短的一侧表示一个前缀范围，比如 a = 1 and b < 3 的左边界是 (1)，右边界是 (1, 3)，
+  // 这时由较短一侧的边界是否包含在内决定范围是否为空
+  if (left_values_.size() < right_values_.size()) {
+    return !left_inclusive_;
   }
-  if (right_value) {
-    right_value_ = *right_value;
+  if (left_values_.size() > right_values_.size()) {
+    return !right_inclusive_;
   }
+  return !(left_inclusive_ && right_inclusive_);
 }
 
 RC IndexScanPhysicalOperator::open(Trx *trx)
@@ -38,33 +59,37 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
     return RC::INTERNAL;
   }
 
-  IndexScanner *index_scanner = index_->create_scanner(left_value_.data(),
-      left_value_.length(),
-      left_inclusive_,
-      right_value_.data(),
-      right_value_.length(),
-      right_inclusive_);
-  if (nullptr == index_scanner) {
-    LOG_WARN("failed to create index scanner");
-    return RC::INTERNAL;
-  }
-
   record_handler_ = table_->record_handler();
   if (nullptr == record_handler_) {
     LOG_WARN("invalid record handler");
-    index_scanner->destroy();
     return RC::INTERNAL;
   }
-  index_scanner_ = index_scanner;
 
   tuple_.set_schema(table_, table_->table_meta().field_metas());
+  trx_         = trx;
+  row_emitted_ = false;
+
+  // 范围是空的时候不需要扫描索引
+  if (empty_range()) {
+    LOG_TRACE("empty index scan range. index=%s", index_->index_meta().name());
+    return RC::SUCCESS;
+  }
 
-  trx_ = trx;
+  IndexScanner *index_scanner = index_->create_scanner(left_values_, left_inclusive_, right_values_, right_inclusive_);
+  if (nullptr == index_scanner) {
+    LOG_WARN("failed to create index scanner");
+    return RC::INTERNAL;
+  }
+  index_scanner_ = index_scanner;
   return RC::SUCCESS;
 }
 
 RC IndexScanPhysicalOperator::next()
 {
+  if (nullptr == index_scanner_ || (at_most_one_row_ && row_emitted_)) {
+    return RC::RECORD_EOF;
+  }
+
   RID rid;
   RC  rc = RC::SUCCESS;
 
@@ -95,6 +120,7 @@ RC IndexScanPhysicalOperator::next()
       LOG_TRACE("record invisible");
       continue;
     } else {
+      row_emitted_ = OB_SUCC(rc);
       return rc;
     }
   }
@@ -104,8 +130,10 @@ RC IndexScanPhysicalOperator::next()
 
 RC IndexScanPhysicalOperator::close()
 {
-  index_scanner_->destroy();
-  index_scanner_ = nullptr;
+  if (index_scanner_ != nullptr) {
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
   return RC::SUCCESS;
 }
 
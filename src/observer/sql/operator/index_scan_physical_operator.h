@@ -21,12 +21,15 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief 索引扫描物理算子
  * @ingroup PhysicalOperator
+ * @details 扫描索引上 [left_values, right_values] 范围内的数据，边界是否包含在内由 left_inclusive 和 right_inclusive 决定。
+ * 边界值按照索引字段的顺序排列，联合索引可以只给出前面几个字段的值。left_values 或 right_values 为空时，
+ * 表示这一侧没有边界。
  */
 class IndexScanPhysicalOperator : public PhysicalOperator
 {
 public:
-  IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const Value *left_value,
-      bool left_inclusive, const Value *right_value, bool right_inclusive);
+  IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, vector<Value> left_values,
+      bool left_inclusive, vector<Value> right_values, bool right_inclusive);
 
   virtual ~IndexScanPhysicalOperator() = default;
 
@@ -42,7 +45,17 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 设置最多只会返回一行数据，比如唯一索引上的等值查询，返回一行之后不再继续扫描索引
+   */
+  void set_at_most_one_row(bool at_most_one_row) { at_most_one_row_ = at_most_one_row; }
+
 private:
+  /**
+   * @brief 查询条件互相矛盾时扫描范围是空的，比如 a > 5 and a < 3
+   */
+  bool empty_range() const;
+
   // 与TableScanPhysicalOperator代码相同，可以优化
   RC filter(RowTuple &tuple, bool &result);
 
@@ -57,10 +70,12 @@ private:
   Record   current_record_;
   RowTuple tuple_;
 
-  Value left_value_;
-  Value right_value_;
-  bool  left_inclusive_  = false;
-  bool  right_inclusive_ = false;
+  vector<Value> left_values_;
+  vector<Value> right_values_;
+  bool          left_inclusive_  = false;
+  bool          right_inclusive_ = false;
+  bool          at_most_one_row_ = false;
+  bool          row_emitted_     = false;  ///< 是否已经返回过数据
 
   vector<unique_ptr<Expression>> predicates_;
 };
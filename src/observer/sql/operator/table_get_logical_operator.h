@@ -36,6 +36,12 @@ public:
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
   auto predicates() -> vector<unique_ptr<Expression>> & { return predicates_; }
 
+  /**
+   * @brief 设置查询中用到的字段(field_id)，为空时表示需要所有字段
+   */
+  void              set_projection(vector<int> &&field_ids) { projection_ = std::move(field_ids); }
+  const vector<int> &projection() const { return projection_; }
+
 private:
   Table        *table_ = nullptr;
   ReadWriteMode mode_  = ReadWriteMode::READ_WRITE;
@@ -45,4 +51,7 @@ private:
   // 不包含复杂的表达式运算，比如加减乘除、或者conjunction expression
   // 如果有多个表达式，他们的关系都是 AND
   vector<unique_ptr<Expression>> predicates_;
+
+  // 查询中用到的字段。向量化的表扫描只读取这些列
+  vector<int> projection_;
 };
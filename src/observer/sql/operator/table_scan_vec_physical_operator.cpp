@@ -9,74 +9,264 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/table_scan_vec_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/thread.h"
 #include "event/sql_debug.h"
+#include "sql/expr/expression.h"
+#include "storage/record/morsel_dispatcher.h"
 #include "storage/table/table.h"
 
 using namespace std;
 
+/**
+ * @brief 从谓词中找出 `字段 比较 常量` 形式的条件，用来根据页面的 zone map 跳过页面
+ * @details 只处理 AND 连接的条件，常量与字段的类型不同时不处理，这些条件仍然会在 filter 中计算
+ */
+static void collect_zone_map_conditions(Expression &expr, ZoneMapFilter &filter)
+{
+  if (expr.type() == ExprType::CONJUNCTION) {
+    auto &conjunction_expr = static_cast<ConjunctionExpr &>(expr);
+    if (conjunction_expr.conjunction_type() != ConjunctionExpr::Type::AND) {
+      return;
+    }
+    for (unique_ptr<Expression> &child : conjunction_expr.children()) {
+      collect_zone_map_conditions(*child, filter);
+    }
+    return;
+  }
+
+  if (expr.type() != ExprType::COMPARISON) {
+    return;
+  }
+
+  auto                   &comparison_expr = static_cast<ComparisonExpr &>(expr);
+  CompOp                  comp            = comparison_expr.comp();
+  unique_ptr<Expression> &left_expr       = comparison_expr.left();
+  unique_ptr<Expression> &right_expr      = comparison_expr.right();
+
+  FieldExpr *field_expr = nullptr;
+  ValueExpr *value_expr = nullptr;
+  if (left_expr->type() == ExprType::FIELD && right_expr->type() == ExprType::VALUE) {
+    field_expr = static_cast<FieldExpr *>(left_expr.get());
+    value_expr = static_cast<ValueExpr *>(right_expr.get());
+  } else if (left_expr->type() == ExprType::VALUE && right_expr->type() == ExprType::FIELD) {
+    // 常量在左边时，交换两边之后比较符号也要反过来
+    field_expr = static_cast<FieldExpr *>(right_expr.get());
+    value_expr = static_cast<ValueExpr *>(left_expr.get());
+    switch (comp) {
+      case LESS_THAN: comp = GREAT_THAN; break;
+      case LESS_EQUAL: comp = GREAT_EQUAL; break;
+      case GREAT_THAN: comp = LESS_THAN; break;
+      case GREAT_EQUAL: comp = LESS_EQUAL; break;
+      default: break;
+    }
+  } else {
+    return;
+  }
+
+  const FieldMeta *field_meta = field_expr->field().meta();
+  const Value     &value      = value_expr->get_value();
+  if (field_meta->type() != value.attr_type() || !ColumnZoneMap::supported(field_meta->type(), field_meta->len())) {
+    return;
+  }
+  filter.add_condition(field_meta->field_id(), comp, value);
+}
+
 RC TableScanVecPhysicalOperator::open(Trx *trx)
 {
-  RC rc = table_->get_chunk_scanner(chunk_scanner_, trx, mode_);
+  trx_  = trx;
+  RC rc = table_->get_chunk_scanner(scan_context_.scanner, trx, mode_);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get chunk scanner", strrc(rc));
     return rc;
   }
-  // TODO: don't need to fetch all columns from record manager
-  for (int i = 0; i < table_->table_meta().field_num(); ++i) {
-    all_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
-    filterd_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
+
+  // PAX 格式的页面中记录了每列的 zone map，可以跳过不可能满足条件的页面
+  zone_map_filter_ = ZoneMapFilter();
+  for (unique_ptr<Expression> &expr : predicates_) {
+    collect_zone_map_conditions(*expr, zone_map_filter_);
+  }
+  if (!zone_map_filter_.empty()) {
+    scan_context_.scanner.set_zone_map_filter(zone_map_filter_);
   }
+
+  init_columns(scan_context_);
   return rc;
 }
 
-RC TableScanVecPhysicalOperator::next(Chunk &chunk)
+void TableScanVecPhysicalOperator::init_columns(ScanContext &context)
+{
+  // 只读取查询中用到的列，PAX 格式的页面中只会读取这些列的数据
+  // 变长格式的表中，CHARS 字段使用变长的 Column，不需要按照最大长度复制数据
+  const TableMeta &table_meta = table_->table_meta();
+  const bool       varlen     = table_meta.storage_format() == StorageFormat::VARLEN_FORMAT;
+  vector<int>      field_ids  = projection_;
+  if (field_ids.empty()) {
+    for (int i = 0; i < table_meta.field_num(); ++i) {
+      field_ids.push_back(i);
+    }
+  }
+  for (int field_id : field_ids) {
+    const FieldMeta *field = table_meta.field(field_id);
+    if (varlen && field->type() == AttrType::CHARS) {
+      auto all_column      = make_unique<Column>();
+      auto filtered_column = make_unique<Column>();
+      all_column->init_varlen(field->type(), field->len());
+      filtered_column->init_varlen(field->type(), field->len());
+      context.all_columns.add_column(std::move(all_column), field->field_id());
+      context.filtered_columns.add_column(std::move(filtered_column), field->field_id());
+    } else {
+      context.all_columns.add_column(make_unique<Column>(*field), field->field_id());
+      context.filtered_columns.add_column(make_unique<Column>(*field), field->field_id());
+    }
+  }
+}
+
+RC TableScanVecPhysicalOperator::next(Chunk &chunk) { return next_chunk(scan_context_, chunk); }
+
+RC TableScanVecPhysicalOperator::next_chunk(ScanContext &context, Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
 
-  all_columns_.reset_data();
-  filterd_columns_.reset_data();
-  if (OB_SUCC(rc = chunk_scanner_.next_chunk(all_columns_))) {
-    select_.assign(all_columns_.rows(), 1);
-    if (predicates_.empty()) {
-      chunk.reference(all_columns_);
+  Chunk           &all_columns      = context.all_columns;
+  Chunk           &filtered_columns = context.filtered_columns;
+  vector<uint8_t> &select           = context.select;
+  all_columns.reset_data();
+  filtered_columns.reset_data();
+  // PAX 格式的页面中，all_columns 直接引用页面中的列数据，select 标记了页面中被删除的位置。
+  // 返回之前扫描器持有页面的读锁和固定，上一次返回的 chunk 到这里就失效了
+  if (OB_SUCC(rc = context.scanner.next_chunk(all_columns, select))) {
+    const bool all_selected = find(select.begin(), select.end(), 0) == select.end();
+    if (predicates_.empty() && all_selected) {
+      // 零拷贝，页面的读锁和固定一直持有到下一次 next 或者 close
+      chunk.reference(all_columns);
     } else {
-      rc = filter(all_columns_);
-      if (rc != RC::SUCCESS) {
-        LOG_TRACE("filtered failed=%s", strrc(rc));
-        return rc;
+      if (!predicates_.empty()) {
+        rc = filter(all_columns, select);
+        if (rc != RC::SUCCESS) {
+          LOG_TRACE("filtered failed=%s", strrc(rc));
+          return rc;
+        }
       }
       // TODO: if all setted, it doesn't need to set one by one
-      for (int i = 0; i < all_columns_.rows(); i++) {
-        if (select_[i] == 0) {
+      for (int i = 0; i < all_columns.rows(); i++) {
+        if (select[i] == 0) {
           continue;
         }
-        for (int j = 0; j < all_columns_.column_num(); j++) {
-          filterd_columns_.column(j).append_one(
-              (char *)all_columns_.column(filterd_columns_.column_ids(j)).get_value(i).data());
+        for (int j = 0; j < all_columns.column_num(); j++) {
+          filtered_columns.column(j).append_value(all_columns.column(j).get_value(i));
         }
       }
-      chunk.reference(filterd_columns_);
+      // 数据已经复制出来了，不必在上层算子处理 chunk 时还持有页面
+      context.scanner.release_page();
+      chunk.reference(filtered_columns);
     }
   }
   return rc;
 }
 
-RC TableScanVecPhysicalOperator::close() { return chunk_scanner_.close_scan(); }
+void TableScanVecPhysicalOperator::set_parallelism(int parallelism)
+{
+#ifdef CONCURRENCY
+  parallelism_ = max(parallelism, 1);
+#else
+  // 没有 CONCURRENCY 时 buffer pool 等模块中的锁都是空的，不能在多个线程中访问
+  parallelism_ = 1;
+#endif
+}
+
+RC TableScanVecPhysicalOperator::parallel_scan(const function<RC(int worker_id, Chunk &chunk)> &consumer)
+{
+  MorselDispatcher dispatcher;
+  RC               rc = dispatcher.init(*table_->data_buffer_pool());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init morsel dispatcher. table=%s, rc=%s", table_->name(), strrc(rc));
+    return rc;
+  }
+
+  atomic<bool>   stopped(false);
+  vector<RC>     worker_rcs(parallelism_, RC::SUCCESS);
+  vector<thread> workers;
+  for (int worker_id = 1; worker_id < parallelism_; worker_id++) {
+    workers.emplace_back([this, worker_id, &dispatcher, &consumer, &stopped, &worker_rcs]() {
+      ScanContext context;
+      RC          rc = table_->get_chunk_scanner(context.scanner, trx_, mode_);
+      if (OB_SUCC(rc)) {
+        if (!zone_map_filter_.empty()) {
+          context.scanner.set_zone_map_filter(zone_map_filter_);
+        }
+        context.scanner.set_morsel_dispatcher(&dispatcher);
+        init_columns(context);
+        rc = scan_morsels(context, worker_id, consumer, stopped);
+        context.scanner.close_scan();
+      } else {
+        LOG_WARN("failed to get chunk scanner. worker=%d, rc=%s", worker_id, strrc(rc));
+        stopped = true;
+      }
+      worker_rcs[worker_id] = rc;
+    });
+  }
+
+  // 当前线程作为第0个扫描线程
+  scan_context_.scanner.set_morsel_dispatcher(&dispatcher);
+  worker_rcs[0] = scan_morsels(scan_context_, 0, consumer, stopped);
+  for (thread &worker : workers) {
+    worker.join();
+  }
+  scan_context_.scanner.set_morsel_dispatcher(nullptr);
+
+  LOG_TRACE("parallel scan done. table=%s, parallelism=%d, morsels=%d",
+            table_->name(), parallelism_, dispatcher.dispatched_morsels());
+  for (RC worker_rc : worker_rcs) {
+    if (OB_FAIL(worker_rc)) {
+      return worker_rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC TableScanVecPhysicalOperator::scan_morsels(
+    ScanContext &context, int worker_id, const function<RC(int, Chunk &)> &consumer, atomic<bool> &stopped)
+{
+  RC    rc = RC::SUCCESS;
+  Chunk chunk;
+  while (!stopped.load() && OB_SUCC(rc = next_chunk(context, chunk))) {
+    rc = consumer(worker_id, chunk);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+  }
+
+  if (rc == RC::RECORD_EOF) {
+    return RC::SUCCESS;
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("scan worker failed. worker=%d, rc=%s", worker_id, strrc(rc));
+    stopped = true;
+  }
+  return rc;
+}
+
+RC TableScanVecPhysicalOperator::close() { return scan_context_.scanner.close_scan(); }
 
-string TableScanVecPhysicalOperator::param() const { return table_->name(); }
+string TableScanVecPhysicalOperator::param() const
+{
+  if (parallelism_ > 1) {
+    return string(table_->name()) + ", parallelism=" + std::to_string(parallelism_);
+  }
+  return table_->name();
+}
 
 void TableScanVecPhysicalOperator::set_predicates(vector<unique_ptr<Expression>> &&exprs)
 {
   predicates_ = std::move(exprs);
 }
 
-RC TableScanVecPhysicalOperator::filter(Chunk &chunk)
+RC TableScanVecPhysicalOperator::filter(Chunk &chunk, vector<uint8_t> &select)
 {
   RC rc = RC::SUCCESS;
   for (unique_ptr<Expression> &expr : predicates_) {
-    rc = expr->eval(chunk, select_);
+    rc = expr->eval(chunk, select);
     if (rc != RC::SUCCESS) {
       return rc;
     }
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/atomic.h"
+#include "common/lang/functional.h"
 #include "common/sys/rc.h"
 #include "sql/operator/physical_operator.h"
 #include "storage/record/record_manager.h"
@@ -20,6 +22,13 @@ class Table;
 /**
  * @brief 表扫描物理算子(vectorized)
  * @ingroup PhysicalOperator
+ * @details 设置的并行度大于1时，上层算子可以调用 parallel_scan 使用多个线程扫描表。
+ * 数据页面按照 morsel 分给各个线程，每个线程独立地读取页面、计算过滤条件，再把结果交给上层算子处理，
+ * 比如在各个线程中分别计算部分聚合结果，最后再合并到一起。next 接口仍然是单线程扫描。
+ *
+ * 没有过滤条件并且页面中没有删除的记录时，返回的 chunk 直接引用 PAX 页面中的列数据，不做复制。
+ * 这时页面的读锁和固定一直持有到下一次 next 或者 close，上层算子必须在这之前处理完 chunk，
+ * 不能保存其中的数据，也不能在此期间修改同一张表。需要复制数据时，复制之后就会释放页面。
  */
 class TableScanVecPhysicalOperator : public PhysicalOperator
 {
@@ -38,15 +47,52 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 设置需要读取的字段(field_id)，为空时读取所有字段
+   */
+  void set_projection(const vector<int> &field_ids) { projection_ = field_ids; }
+
+  /**
+   * @brief 设置扫描使用的线程个数。不是 CONCURRENCY 模式编译时，总是使用一个线程
+   */
+  void set_parallelism(int parallelism);
+  int  parallelism() const { return parallelism_; }
+
+  /**
+   * @brief 使用 parallelism() 个线程扫描整张表，代替 next 接口
+   * @details 需要在 open 之后调用。当前线程也会作为其中一个扫描线程，所有线程都结束之后才返回。
+   * consumer 会在多个线程中同时调用，每次处理一个已经过滤过的 chunk，worker_id 在 [0, parallelism()) 范围内，
+   * 同一个 worker_id 不会同时调用。consumer 返回错误时，所有线程都会停止扫描。
+   * 与 next 相同，chunk 可能引用页面中的数据，只在这次 consumer 调用期间有效。
+   */
+  RC parallel_scan(const function<RC(int worker_id, Chunk &chunk)> &consumer);
+
 private:
-  RC filter(Chunk &chunk);
+  /**
+   * @brief 一个扫描线程使用的数据
+   * @details next 接口使用算子中的 scan_context_，并行扫描时其它线程各自有一份
+   */
+  struct ScanContext
+  {
+    ChunkFileScanner scanner;
+    Chunk            all_columns;
+    Chunk            filtered_columns;
+    vector<uint8_t>  select;
+  };
+
+  void init_columns(ScanContext &context);
+  RC   next_chunk(ScanContext &context, Chunk &chunk);
+  RC   scan_morsels(ScanContext &context, int worker_id, const function<RC(int, Chunk &)> &consumer,
+      atomic<bool> &stopped);
+  RC   filter(Chunk &chunk, vector<uint8_t> &select);
 
 private:
   Table                         *table_ = nullptr;
   ReadWriteMode                  mode_  = ReadWriteMode::READ_WRITE;
-  ChunkFileScanner               chunk_scanner_;
-  Chunk                          all_columns_;
-  Chunk                          filterd_columns_;
-  vector<uint8_t>                select_;
+  Trx                           *trx_   = nullptr;
+  ScanContext                    scan_context_;
+  ZoneMapFilter                  zone_map_filter_;
   vector<unique_ptr<Expression>> predicates_;
+  vector<int>                    projection_;
+  int                            parallelism_ = 1;
 };
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/optimizer/logical_plan_generator.h"
 
+#include "common/lang/set.h"
 #include "common/log/log.h"
 
 #include "sql/operator/calc_logical_operator.h"
@@ -86,6 +87,54 @@ RC LogicalPlanGenerator::create_plan(CalcStmt *calc_stmt, unique_ptr<LogicalOper
   return RC::SUCCESS;
 }
 
+/**
+ * @brief 收集查询中用到的某张表的字段
+ * @details 包括查询的表达式、分组的表达式和过滤条件中的字段。没有用到任何字段时(比如 count(*))，
+ * 也需要读取一列来确定记录的条数，这里选择第一个用户字段
+ */
+static RC collect_table_fields(SelectStmt *select_stmt, const Table *table, vector<int> &field_ids)
+{
+  set<int> ids;
+
+  function<RC(unique_ptr<Expression> &)> collector = [&](unique_ptr<Expression> &expr) -> RC {
+    if (expr->type() == ExprType::FIELD) {
+      const Field &field = static_cast<FieldExpr *>(expr.get())->field();
+      if (field.table() == table) {
+        ids.insert(field.meta()->field_id());
+      }
+    }
+    return ExpressionIterator::iterate_child_expr(*expr, collector);
+  };
+
+  RC rc = RC::SUCCESS;
+  for (unique_ptr<Expression> &expr : select_stmt->query_expressions()) {
+    if (OB_FAIL(rc = collector(expr))) {
+      return rc;
+    }
+  }
+  for (unique_ptr<Expression> &expr : select_stmt->group_by()) {
+    if (OB_FAIL(rc = collector(expr))) {
+      return rc;
+    }
+  }
+
+  for (const FilterUnit *filter_unit : select_stmt->filter_stmt()->filter_units()) {
+    for (const FilterObj *filter_obj : {&filter_unit->left(), &filter_unit->right()}) {
+      if (filter_obj->is_attr && filter_obj->field.table() == table) {
+        ids.insert(filter_obj->field.meta()->field_id());
+      }
+    }
+  }
+
+  const TableMeta &table_meta = table->table_meta();
+  if (ids.empty() && table_meta.field_num() > table_meta.sys_field_num()) {
+    ids.insert(table_meta.field(table_meta.sys_field_num())->field_id());
+  }
+
+  field_ids.assign(ids.begin(), ids.end());
+  return rc;
+}
+
 RC LogicalPlanGenerator::create_plan(SelectStmt *select_stmt, unique_ptr<LogicalOperator> &logical_operator)
 {
   unique_ptr<LogicalOperator> *last_oper = nullptr;
@@ -96,7 +145,16 @@ RC LogicalPlanGenerator::create_plan(SelectStmt *select_stmt, unique_ptr<Logical
   const vector<Table *> &tables = select_stmt->tables();
   for (Table *table : tables) {
 
-    unique_ptr<LogicalOperator> table_get_oper(new TableGetLogicalOperator(table, ReadWriteMode::READ_ONLY));
+    auto table_get_oper = make_unique<TableGetLogicalOperator>(table, ReadWriteMode::READ_ONLY);
+
+    vector<int> field_ids;
+    RC          rc = collect_table_fields(select_stmt, table, field_ids);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to collect fields of table. table=%s, rc=%s", table->name(), strrc(rc));
+      return rc;
+    }
+    table_get_oper->set_projection(std::move(field_ids));
+
     if (table_oper == nullptr) {
       table_oper = std::move(table_get_oper);
     } else {
@@ -12,7 +12,9 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/12/14.
 //
 
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
+#include "session/session.h"
 #include "sql/expr/expression.h"
 #include "sql/operator/aggregate_vec_physical_operator.h"
 #include "sql/operator/calc_logical_operator.h"
@@ -41,6 +43,8 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/scalar_group_by_physical_operator.h"
 #include "sql/operator/table_scan_vec_physical_operator.h"
 #include "sql/optimizer/physical_plan_generator.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
 
 using namespace std;
 
@@ -119,64 +123,236 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
 
 
 
+namespace {
+
+/**
+ * @brief 一个字段上所有可以使用索引的比较条件合并之后的取值范围
+ * @details 没有左边界或右边界时表示这一侧不限制取值。
+ * 多个条件取交集，只保留最紧的边界，比如 `a > 1 and a >= 3 and a < 10` 合并成 [3, 10)。
+ */
+struct FieldRange
+{
+  bool  has_left        = false;
+  bool  left_inclusive  = false;
+  Value left_value;
+  bool  has_right       = false;
+  bool  right_inclusive = false;
+  Value right_value;
+
+  void intersect_left(const Value &value, bool inclusive)
+  {
+    if (has_left) {
+      const int result = value.compare(left_value);
+      if (result < 0 || (result == 0 && (inclusive || !left_inclusive))) {
+        return;
+      }
+    }
+    has_left       = true;
+    left_value     = value;
+    left_inclusive = inclusive;
+  }
+
+  void intersect_right(const Value &value, bool inclusive)
+  {
+    if (has_right) {
+      const int result = value.compare(right_value);
+      if (result > 0 || (result == 0 && (inclusive || !right_inclusive))) {
+        return;
+      }
+    }
+    has_right       = true;
+    right_value     = value;
+    right_inclusive = inclusive;
+  }
+
+  void intersect(CompOp comp, const Value &value)
+  {
+    switch (comp) {
+      case EQUAL_TO: {
+        intersect_left(value, true);
+        intersect_right(value, true);
+      } break;
+      case GREAT_THAN: intersect_left(value, false); break;
+      case GREAT_EQUAL: intersect_left(value, true); break;
+      case LESS_THAN: intersect_right(value, false); break;
+      case LESS_EQUAL: intersect_right(value, true); break;
+      default: break;
+    }
+  }
+
+  bool is_point() const
+  {
+    return has_left && has_right && left_inclusive && right_inclusive && left_value.compare(right_value) == 0;
+  }
+
+  /**
+   * @brief 范围越小分数越高，用来在多个索引中挑选一个
+   */
+  int score() const
+  {
+    if (is_point()) {
+      return 3;
+    }
+    return (has_left ? 1 : 0) + (has_right ? 1 : 0);
+  }
+};
+
+/**
+ * @brief 从比较表达式中提取出 `字段 比较符 值` 形式的条件
+ * @details 值在左边时把比较符反过来，比如 `5 < a` 转换成 `a > 5`。
+ * 只接受等值和大小比较，并且值的类型与字段类型相同的条件，否则值无法直接作为索引的键值。
+ */
+bool extract_index_condition(
+    const Table *table, ComparisonExpr &comparison_expr, const FieldMeta *&field_meta, CompOp &comp, const Value *&value)
+{
+  unique_ptr<Expression> &left_expr  = comparison_expr.left();
+  unique_ptr<Expression> &right_expr = comparison_expr.right();
+
+  FieldExpr *field_expr = nullptr;
+  ValueExpr *value_expr = nullptr;
+  comp                  = comparison_expr.comp();
+  if (comp != EQUAL_TO && comp != LESS_THAN && comp != LESS_EQUAL && comp != GREAT_THAN && comp != GREAT_EQUAL) {
+    return false;
+  }
+
+  if (left_expr->type() == ExprType::FIELD && right_expr->type() == ExprType::VALUE) {
+    field_expr = static_cast<FieldExpr *>(left_expr.get());
+    value_expr = static_cast<ValueExpr *>(right_expr.get());
+  } else if (left_expr->type() == ExprType::VALUE && right_expr->type() == ExprType::FIELD) {
+    field_expr = static_cast<FieldExpr *>(right_expr.get());
+    value_expr = static_cast<ValueExpr *>(left_expr.get());
+    switch (comp) {
+      case GREAT_THAN: comp = LESS_THAN; break;
+      case GREAT_EQUAL: comp = LESS_EQUAL; break;
+      case LESS_THAN: comp = GREAT_THAN; break;
+      case LESS_EQUAL: comp = GREAT_EQUAL; break;
+      default: break;
+    }
+  } else {
+    return false;
+  }
+
+  const Field &field = field_expr->field();
+  if (field.table() != table || field.attr_type() != value_expr->value_type()) {
+    return false;
+  }
+
+  field_meta = field.meta();
+  value      = &value_expr->get_value();
+  return true;
+}
+
+/**
+ * @brief 使用某个索引时的扫描范围
+ * @details 索引前面的字段都是等值条件时，可以继续使用下一个字段上的条件，比如索引 (a, b, c) 上的条件
+ * `a = 1 and b > 2` 得到的范围是 ((1, 2), (1)]。
+ */
+struct IndexRange
+{
+  Index        *index           = nullptr;
+  vector<Value> left_values;
+  bool          left_inclusive  = true;
+  vector<Value> right_values;
+  bool          right_inclusive = true;
+  bool          at_most_one_row = false;  ///< 唯一索引的所有字段都是等值条件时，最多只有一行数据
+  int           score           = 0;      ///< 每个等值的字段3分，再加上最后一个字段范围的分数
+};
+
+IndexRange match_index(Index *index, const vector<pair<const FieldMeta *, FieldRange>> &field_ranges)
+{
+  const IndexMeta &index_meta = index->index_meta();
+
+  IndexRange index_range;
+  index_range.index = index;
+  int point_num     = 0;
+  for (const string &field_name : index_meta.fields()) {
+    auto iter = find_if(field_ranges.begin(), field_ranges.end(), [&field_name](const auto &field_range) {
+      return field_name == field_range.first->name();
+    });
+    if (iter == field_ranges.end()) {
+      break;
+    }
+
+    const FieldRange &range = iter->second;
+    index_range.score += range.score();
+    if (range.is_point()) {
+      index_range.left_values.push_back(range.left_value);
+      index_range.right_values.push_back(range.right_value);
+      point_num++;
+      continue;
+    }
+
+    if (range.has_left) {
+      index_range.left_values.push_back(range.left_value);
+      index_range.left_inclusive = range.left_inclusive;
+    }
+    if (range.has_right) {
+      index_range.right_values.push_back(range.right_value);
+      index_range.right_inclusive = range.right_inclusive;
+    }
+    break;
+  }
+
+  // 唯一索引上的等值查询比其它的索引更好
+  if (index_meta.unique() && point_num == index_meta.field_num()) {
+    index_range.at_most_one_row = true;
+    index_range.score += 1;
+  }
+  return index_range;
+}
+
+}  // namespace
+
 RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
   // 看看是否有可以用于索引查找的表达式
   Table *table = table_get_oper.table();
 
-  Index     *index      = nullptr;
-  ValueExpr *value_expr = nullptr;
+  // 把同一个字段上的比较条件合并成一个范围，条件都保留在 predicates 中，扫描时依然会过滤
+  vector<pair<const FieldMeta *, FieldRange>> field_ranges;
   for (auto &expr : predicates) {
-    if (expr->type() == ExprType::COMPARISON) {
-      auto comparison_expr = static_cast<ComparisonExpr *>(expr.get());
-      // 简单处理，就找等值查询
-      if (comparison_expr->comp() != EQUAL_TO) {
-        continue;
-      }
-
-      unique_ptr<Expression> &left_expr  = comparison_expr->left();
-      unique_ptr<Expression> &right_expr = comparison_expr->right();
-      // 左右比较的一边最少是一个值
-      if (left_expr->type() != ExprType::VALUE && right_expr->type() != ExprType::VALUE) {
-        continue;
-      }
+    if (expr->type() != ExprType::COMPARISON) {
+      continue;
+    }
 
-      FieldExpr *field_expr = nullptr;
-      if (left_expr->type() == ExprType::FIELD) {
-        ASSERT(right_expr->type() == ExprType::VALUE, "right expr should be a value expr while left is field expr");
-        field_expr = static_cast<FieldExpr *>(left_expr.get());
-        value_expr = static_cast<ValueExpr *>(right_expr.get());
-      } else if (right_expr->type() == ExprType::FIELD) {
-        ASSERT(left_expr->type() == ExprType::VALUE, "left expr should be a value expr while right is a field expr");
-        field_expr = static_cast<FieldExpr *>(right_expr.get());
-        value_expr = static_cast<ValueExpr *>(left_expr.get());
-      }
+    const FieldMeta *field_meta = nullptr;
+    CompOp           comp       = NO_OP;
+    const Value     *value      = nullptr;
+    if (!extract_index_condition(table, static_cast<ComparisonExpr &>(*expr), field_meta, comp, value)) {
+      continue;
+    }
 
-      if (field_expr == nullptr) {
-        continue;
-      }
+    auto iter = find_if(field_ranges.begin(), field_ranges.end(), [field_meta](const auto &field_range) {
+      return field_range.first == field_meta;
+    });
+    if (iter == field_ranges.end()) {
+      iter = field_ranges.emplace(field_ranges.end(), field_meta, FieldRange());
+    }
+    iter->second.intersect(comp, *value);
+  }
 
-      const Field &field = field_expr->field();
-      index              = table->find_index_by_field(field.field_name());
-      if (nullptr != index) {
-        break;
+  // 选择匹配字段最多、范围最小的索引，分数相同时使用先创建的索引
+  IndexRange index_range;
+  if (!field_ranges.empty()) {
+    for (Index *index : table->indexes()) {
+      IndexRange range = match_index(index, field_ranges);
+      if (range.score > index_range.score) {
+        index_range = std::move(range);
       }
     }
   }
 
-  if (index != nullptr) {
-    ASSERT(value_expr != nullptr, "got an index but value expr is null ?");
-
-    const Value               &value           = value_expr->get_value();
+  if (index_range.index != nullptr) {
     IndexScanPhysicalOperator *index_scan_oper = new IndexScanPhysicalOperator(table,
-        index,
+        index_range.index,
         table_get_oper.read_write_mode(),
-        &value,
-        true /*left_inclusive*/,
-        &value,
-        true /*right_inclusive*/);
+        std::move(index_range.left_values),
+        index_range.left_inclusive,
+        std::move(index_range.right_values),
+        index_range.right_inclusive);
 
+    index_scan_oper->set_at_most_one_row(index_range.at_most_one_row);
     index_scan_oper->set_predicates(std::move(predicates));
     oper = unique_ptr<PhysicalOperator>(index_scan_oper);
     LOG_TRACE("use index scan");
@@ -367,6 +543,11 @@ RC PhysicalPlanGenerator::create_vec_plan(TableGetLogicalOperator &table_get_ope
   Table *table = table_get_oper.table();
   TableScanVecPhysicalOperator *table_scan_oper = new TableScanVecPhysicalOperator(table, table_get_oper.read_write_mode());
   table_scan_oper->set_predicates(std::move(predicates));
+  table_scan_oper->set_projection(table_get_oper.projection());
+  Session *session = Session::current_session();
+  if (session != nullptr) {
+    table_scan_oper->set_parallelism(session->parallel_scan_threads());
+  }
   oper = unique_ptr<PhysicalOperator>(table_scan_oper);
   LOG_TRACE("use vectorized table scan");
 
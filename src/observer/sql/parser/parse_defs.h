@@ -157,6 +157,7 @@ struct CreateTableSqlNode
   string                  relation_name;   ///< Relation name
   vector<AttrInfoSqlNode> attr_infos;      ///< attributes
   string                  storage_format;  ///< storage format
+  string                  compression;     ///< 数据文件的页面压缩算法，为空表示不压缩
 };
 
 /**
@@ -176,9 +177,10 @@ struct DropTableSqlNode
  */
 struct CreateIndexSqlNode
 {
-  string index_name;      ///< Index name
-  string relation_name;   ///< Relation name
-  string attribute_name;  ///< Attribute name
+  string         index_name;       ///< Index name
+  string         relation_name;    ///< Relation name
+  vector<string> attribute_names;  ///< Attribute names，多个字段时是联合索引，按照字段出现的顺序排序
+  bool           unique = false;   ///< 是否是唯一索引
 };
 
 /**
@@ -267,6 +269,7 @@ enum SqlCommandFlag
   SCF_DROP_INDEX,
   SCF_SYNC,
   SCF_SHOW_TABLES,
+  SCF_SHOW_BUFFER_POOL_STATUS,  ///< 显示buffer pool的统计信息
   SCF_DESC_TABLE,
   SCF_BEGIN,  ///< 事务开始语句，可以在这里扩展只读事务
   SCF_COMMIT,
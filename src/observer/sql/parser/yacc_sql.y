@@ -71,10 +71,12 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
         TABLE
         TABLES
         INDEX
+        UNIQUE
         CALC
         SELECT
         DESC
         SHOW
+        BUFFER_POOL_STATUS
         SYNC
         INSERT
         DELETE
@@ -105,6 +107,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
         EXPLAIN
         STORAGE
         FORMAT
+        COMPRESSION
         EQ
         LT
         GT
@@ -129,6 +132,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
   vector<string> *                 relation_list;
   char *                                     cstring;
   int                                        number;
+  bool                                       boolean;
   float                                      floats;
 }
 
@@ -152,7 +156,10 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %type <condition_list>      where
 %type <condition_list>      condition_list
 %type <cstring>             storage_format
+%type <cstring>             compression
 %type <relation_list>       rel_list
+%type <relation_list>       index_attr_list
+%type <boolean>             opt_unique
 %type <expression>          expression
 %type <expression_list>     expression_list
 %type <expression_list>     group_by
@@ -164,6 +171,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %type <sql_node>            create_table_stmt
 %type <sql_node>            drop_table_stmt
 %type <sql_node>            show_tables_stmt
+%type <sql_node>            show_buffer_pool_status_stmt
 %type <sql_node>            desc_table_stmt
 %type <sql_node>            create_index_stmt
 %type <sql_node>            drop_index_stmt
@@ -201,6 +209,7 @@ command_wrapper:
   | create_table_stmt
   | drop_table_stmt
   | show_tables_stmt
+  | show_buffer_pool_status_stmt
   | desc_table_stmt
   | create_index_stmt
   | drop_index_stmt
@@ -262,6 +271,12 @@ show_tables_stmt:
     }
     ;
 
+show_buffer_pool_status_stmt:
+    SHOW BUFFER_POOL_STATUS {
+      $$ = new ParsedSqlNode(SCF_SHOW_BUFFER_POOL_STATUS);
+    }
+    ;
+
 desc_table_stmt:
     DESC ID  {
       $$ = new ParsedSqlNode(SCF_DESC_TABLE);
@@ -270,13 +285,37 @@ desc_table_stmt:
     ;
 
 create_index_stmt:    /*create index 语句的语法解析树*/
-    CREATE INDEX ID ON ID LBRACE ID RBRACE
+    CREATE opt_unique INDEX ID ON ID LBRACE index_attr_list RBRACE
     {
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
-      create_index.index_name = $3;
-      create_index.relation_name = $5;
-      create_index.attribute_name = $7;
+      create_index.unique = $2;
+      create_index.index_name = $4;
+      create_index.relation_name = $6;
+      create_index.attribute_names.swap(*$8);
+      delete $8;
+    }
+    ;
+
+opt_unique:
+    /* empty */
+    {
+      $$ = false;
+    }
+    | UNIQUE
+    {
+      $$ = true;
+    }
+    ;
+
+index_attr_list:
+    ID {
+      $$ = new vector<string>();
+      $$->push_back($1);
+    }
+    | ID COMMA index_attr_list {
+      $$ = $3;
+      $$->insert($$->begin(), $1);
     }
     ;
 
@@ -289,7 +328,7 @@ drop_index_stmt:      /*drop index 语句的语法解析树*/
     }
     ;
 create_table_stmt:    /*create table 语句的语法解析树*/
-    CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE storage_format
+    CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE storage_format compression
     {
       $$ = new ParsedSqlNode(SCF_CREATE_TABLE);
       CreateTableSqlNode &create_table = $$->create_table;
@@ -308,6 +347,9 @@ create_table_stmt:    /*create table 语句的语法解析树*/
       if ($8 != nullptr) {
         create_table.storage_format = $8;
       }
+      if ($9 != nullptr) {
+        create_table.compression = $9;
+      }
     }
     ;
 attr_def_list:
@@ -407,6 +449,16 @@ storage_format:
       $$ = $4;
     }
     ;
+compression:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | COMPRESSION EQ ID
+    {
+      $$ = $3;
+    }
+    ;
     
 delete_stmt:    /*  delete 语句的语法解析树*/
     DELETE FROM ID where 
@@ -28,7 +28,16 @@ RC CreateTableStmt::create(Db *db, const CreateTableSqlNode &create_table, Stmt
   if (storage_format == StorageFormat::UNKNOWN_FORMAT) {
     return RC::INVALID_ARGUMENT;
   }
-  stmt = new CreateTableStmt(create_table.relation_name, create_table.attr_infos, storage_format);
+
+  PageCompression compression = PageCompression::NONE;
+  if (!create_table.compression.empty()) {
+    compression = page_compression_from_string(create_table.compression.c_str());
+    if (compression == PageCompression::UNKNOWN) {
+      LOG_WARN("unknown compression: %s", create_table.compression.c_str());
+      return RC::INVALID_ARGUMENT;
+    }
+  }
+  stmt = new CreateTableStmt(create_table.relation_name, create_table.attr_infos, storage_format, compression);
   sql_debug("create table statement: table name %s", create_table.relation_name.c_str());
   return RC::SUCCESS;
 }
@@ -39,6 +48,8 @@ StorageFormat CreateTableStmt::get_storage_format(const char *format_str) {
     format = StorageFormat::ROW_FORMAT;
   } else if (0 == strcasecmp(format_str, "PAX")) {
     format = StorageFormat::PAX_FORMAT;
+  } else if (0 == strcasecmp(format_str, "VARLEN")) {
+    format = StorageFormat::VARLEN_FORMAT;
   } else {
     format = StorageFormat::UNKNOWN_FORMAT;
   }
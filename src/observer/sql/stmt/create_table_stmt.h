@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/string.h"
 #include "common/lang/vector.h"
 #include "sql/stmt/stmt.h"
+#include "storage/buffer/page_compressor.h"
 
 class Db;
 
@@ -28,8 +29,9 @@ class Db;
 class CreateTableStmt : public Stmt
 {
 public:
-  CreateTableStmt(const string &table_name, const vector<AttrInfoSqlNode> &attr_infos, StorageFormat storage_format)
-      : table_name_(table_name), attr_infos_(attr_infos), storage_format_(storage_format)
+  CreateTableStmt(const string &table_name, const vector<AttrInfoSqlNode> &attr_infos, StorageFormat storage_format,
+      PageCompression compression = PageCompression::NONE)
+      : table_name_(table_name), attr_infos_(attr_infos), storage_format_(storage_format), compression_(compression)
   {}
   virtual ~CreateTableStmt() = default;
 
@@ -38,6 +40,7 @@ public:
   const string                  &table_name() const { return table_name_; }
   const vector<AttrInfoSqlNode> &attr_infos() const { return attr_infos_; }
   const StorageFormat            storage_format() const { return storage_format_; }
+  PageCompression                compression() const { return compression_; }
 
   static RC            create(Db *db, const CreateTableSqlNode &create_table, Stmt *&stmt);
   static StorageFormat get_storage_format(const char *format_str);
@@ -46,4 +49,5 @@ private:
   string                  table_name_;
   vector<AttrInfoSqlNode> attr_infos_;
   StorageFormat           storage_format_;
+  PageCompression         compression_;
 };
@@ -0,0 +1,133 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#include "storage/buffer/buffer_pool_prefetcher.h"
+#include "common/log/log.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/vector.h"
+#include "common/thread/thread_util.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+using namespace common;
+
+BufferPoolPrefetcher::~BufferPoolPrefetcher() { stop(); }
+
+RC BufferPoolPrefetcher::init(int depth)
+{
+  if (thread_) {
+    LOG_WARN("prefetcher has been started");
+    return RC::INTERNAL;
+  }
+
+  if (depth <= 0) {
+    LOG_INFO("prefetch is disabled");
+    return RC::SUCCESS;
+  }
+
+  depth_   = depth;
+  running_ = true;
+  thread_  = make_unique<thread>(&BufferPoolPrefetcher::thread_func, this);
+  LOG_INFO("prefetcher started. depth=%d", depth_);
+  return RC::SUCCESS;
+}
+
+void BufferPoolPrefetcher::stop()
+{
+  if (!thread_) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> guard(lock_);
+    running_ = false;
+    queue_.clear();
+  }
+  cond_.notify_all();
+
+  thread_->join();
+  thread_.reset();
+  LOG_INFO("prefetcher stopped. loaded=%ld, hit=%ld, miss=%ld, dropped=%ld",
+           stats_.loaded.load(), stats_.hit.load(), stats_.miss.load(), stats_.dropped.load());
+}
+
+void BufferPoolPrefetcher::submit(DiskBufferPool *buffer_pool, PageNum page_num)
+{
+  {
+    lock_guard<mutex> guard(lock_);
+    if (!running_) {
+      return;
+    }
+
+    if (queue_.size() >= MAX_QUEUE_SIZE) {
+      stats_.dropped++;
+      return;
+    }
+
+    queue_.push_back(Request{buffer_pool, page_num});
+  }
+  cond_.notify_one();
+}
+
+void BufferPoolPrefetcher::cancel(DiskBufferPool *buffer_pool)
+{
+  unique_lock<mutex> lock(lock_);
+  for (auto iter = queue_.begin(); iter != queue_.end();) {
+    if (iter->buffer_pool == buffer_pool) {
+      iter = queue_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  idle_cond_.wait(lock, [this, buffer_pool]() { return current_ != buffer_pool; });
+}
+
+void BufferPoolPrefetcher::thread_func()
+{
+  thread_set_name("Prefetcher");
+  LOG_INFO("prefetcher thread started");
+
+  unique_lock<mutex> lock(lock_);
+  while (running_) {
+    if (queue_.empty()) {
+      cond_.wait(lock);
+      continue;
+    }
+
+    // 同一个 buffer pool 的连续请求合并成一批，一起提交IO
+    DiskBufferPool *buffer_pool = queue_.front().buffer_pool;
+    vector<PageNum> page_nums;
+    while (!queue_.empty() && queue_.front().buffer_pool == buffer_pool &&
+           static_cast<int>(page_nums.size()) < max(depth_, 1)) {
+      page_nums.push_back(queue_.front().page_num);
+      queue_.pop_front();
+    }
+    current_ = buffer_pool;
+    lock.unlock();
+
+    int loaded = 0;
+    RC  rc     = buffer_pool->prefetch_pages(page_nums, loaded);
+    stats_.loaded += loaded;
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to prefetch pages. file=%s, page count=%d, rc=%s",
+                buffer_pool->filename(), static_cast<int>(page_nums.size()), strrc(rc));
+    }
+
+    lock.lock();
+    current_ = nullptr;
+    idle_cond_.notify_all();
+  }
+
+  LOG_INFO("prefetcher thread stopped");
+}
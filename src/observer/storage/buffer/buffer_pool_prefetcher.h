@@ -0,0 +1,103 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/deque.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/thread.h"
+#include "common/sys/rc.h"
+#include "common/types.h"
+#include "storage/buffer/page.h"
+
+class DiskBufferPool;
+
+/**
+ * @brief 页面预读器
+ * @ingroup BufferPool
+ * @details 扫描数据时，每个页面都在工作线程中同步读取，扫描的速度受限于单次IO的延迟。
+ * 预读器在后台线程中提前把即将访问的页面加载到内存中，工作线程访问页面时就可以直接命中。
+ * 预读请求只是一个提示，队列满了的时候会直接丢弃，不影响正确性。
+ * 同一个文件的连续请求会合并成一批，一起提交给 PageIoEngine。
+ */
+class BufferPoolPrefetcher
+{
+public:
+  /// 最多缓存多少个还没有处理的预读请求
+  static constexpr size_t MAX_QUEUE_SIZE = 1024;
+
+  /**
+   * @brief 预读的统计信息
+   */
+  struct Stats
+  {
+    atomic<int64_t> loaded{0};   ///< 预读线程从磁盘加载的页面个数
+    atomic<int64_t> hit{0};      ///< 访问页面时，页面已经由预读线程加载好了
+    atomic<int64_t> miss{0};     ///< 顺序访问页面时，页面不在内存中，只能同步读取
+    atomic<int64_t> dropped{0};  ///< 因为队列满了而丢弃的预读请求个数
+  };
+
+public:
+  BufferPoolPrefetcher() = default;
+  ~BufferPoolPrefetcher();
+
+  /**
+   * @brief 启动后台预读线程
+   * @param depth 预读深度，即顺序扫描时最多提前读取多少个页面。小于等于0时不启动预读
+   */
+  RC   init(int depth);
+  void stop();
+
+  int  depth() const { return depth_; }
+  bool enabled() const { return depth_ > 0; }
+
+  /**
+   * @brief 提交一个预读请求
+   * @details 如果没有启动预读，就什么也不做
+   */
+  void submit(DiskBufferPool *buffer_pool, PageNum page_num);
+
+  /**
+   * @brief 丢弃指定 buffer pool 的所有预读请求，并等待正在处理的请求结束
+   * @details 关闭 buffer pool 之前需要调用，防止预读线程访问已经关闭的文件
+   */
+  void cancel(DiskBufferPool *buffer_pool);
+
+  Stats &stats() { return stats_; }
+
+private:
+  void thread_func();
+
+private:
+  struct Request
+  {
+    DiskBufferPool *buffer_pool = nullptr;
+    PageNum         page_num    = BP_INVALID_PAGE_NUM;
+  };
+
+  int depth_ = 0;
+
+  mutex              lock_;
+  condition_variable cond_;       ///< 有新的预读请求，或者需要退出
+  condition_variable idle_cond_;  ///< 处理完一个预读请求
+  deque<Request>     queue_;
+  DiskBufferPool    *current_ = nullptr;  ///< 正在处理的请求属于哪个 buffer pool
+  bool               running_ = false;
+  unique_ptr<thread> thread_;
+
+  Stats stats_;
+};
@@ -12,11 +12,14 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
 
 #include "common/io/io.h"
 #include "common/lang/mutex.h"
 #include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
+#include "common/lang/thread.h"
 #include "common/log/log.h"
 #include "common/math/crc.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -27,41 +30,278 @@ using namespace common;
 
 static const int MEM_POOL_ITEM_NUM = 20;
 
+/// 分配页帧时，分片中的页帧都被固定而淘汰不出来时最多重试的次数
+static const int ALLOCATE_FRAME_RETRY_NUM = 100;
+
+/// 释放页面时等待其它线程释放页帧最多重试的次数。乐观读的线程很快就会释放，等这么久还没有释放说明有固定泄露了
+static const int DISPOSE_PAGE_RETRY_NUM = 10000;
+
+/**
+ * @brief 释放文件中的一段空间，不改变文件的大小
+ * @details 释放之后再读取这段空间，读到的都是0。操作系统或文件系统不支持打洞时什么都不做，只是不节省磁盘空间
+ */
+static void punch_hole(int fd, int64_t offset, int64_t length)
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+  if (length > 0 && fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, length) != 0) {
+    LOG_DEBUG("failed to punch hole. fd=%d, offset=%ld, length=%ld, error=%s", fd, offset, length, strerror(errno));
+  }
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 string BPFileHeader::to_string() const
 {
   stringstream ss;
-  ss << "pageCount:" << page_count << ", allocatedCount:" << allocated_pages;
+  ss << "pageSize:" << page_size << ", compression:" << page_compression_to_string(PageCompression(compression))
+     << ", pageCount:" << page_count << ", allocatedCount:" << allocated_pages;
   return ss.str();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-BPFrameManager::BPFrameManager(const char *name) : allocator_(name) {}
+BPFrameManager::BPFrameManager(const char *name, int page_size /* = BP_PAGE_SIZE */) : tag_(name), arena_(page_size) {}
 
-RC BPFrameManager::init(int pool_num)
+RC BPFrameManager::init(int pool_num, int shard_num /* = 1 */, const char *replacer /* = nullptr */,
+    const char *memory_mode /* = nullptr */, const char *numa_policy /* = nullptr */, int max_pool_num /* = 0 */)
 {
-  int ret = allocator_.init(false, pool_num);
-  if (ret == 0) {
+  if (!shards_.empty()) {
+    LOG_WARN("frame manager has been initialized. tag=%s", tag_.c_str());
     return RC::SUCCESS;
   }
-  return RC::NOMEM;
+
+  if (pool_num <= 0) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 每个分片至少要有一个内存池
+  if (shard_num <= 0) {
+    shard_num = 1;
+  } else if (shard_num > pool_num) {
+    LOG_WARN("frame shard number is larger than pool number, use pool number instead. shard num=%d, pool num=%d",
+             shard_num, pool_num);
+    shard_num = pool_num;
+  }
+
+  RC rc = arena_.init(static_cast<size_t>(pool_num) * DEFAULT_ITEM_NUM_PER_POOL, memory_mode, numa_policy,
+      static_cast<size_t>(max(pool_num, max_pool_num)) * DEFAULT_ITEM_NUM_PER_POOL);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init frame arena. tag=%s, pool num=%d, rc=%s", tag_.c_str(), pool_num, strrc(rc));
+    return rc;
+  }
+
+  shards_.reserve(shard_num);
+  for (int i = 0; i < shard_num; i++) {
+    unique_ptr<FrameReplacer> frame_replacer = FrameReplacer::create(replacer);
+    if (!frame_replacer) {
+      shards_.clear();
+      arena_.cleanup();
+      return RC::INVALID_ARGUMENT;
+    }
+
+    shards_.push_back(make_unique<FrameShard>(std::move(frame_replacer)));
+  }
+
+  // 内存池轮流分给各个分片，这样增加或者移除内存池时，各个分片的页帧个数最多相差一个内存池
+  Frame *frames = arena_.frames();
+  for (int i = 0; i < pool_num; i++) {
+    shard_of_pool(i).allocator_.add_chunk(frames + i * DEFAULT_ITEM_NUM_PER_POOL, DEFAULT_ITEM_NUM_PER_POOL);
+  }
+  pool_num_.store(pool_num);
+
+  LOG_INFO("frame manager init done. tag=%s, page size=%d, pool num=%d, max pool num=%d, shard num=%d, replacer=%s, "
+           "page type=%s",
+           tag_.c_str(), page_size(), pool_num, this->max_pool_num(), shard_num,
+           replacer == nullptr ? "default" : replacer, arena_.page_type_name());
+  return RC::SUCCESS;
+}
+
+RC BPFrameManager::resize(int pool_num, function<RC(Frame *frame)> flusher)
+{
+  lock_guard<mutex> resize_guard(resize_lock_);
+
+  if (pool_num < static_cast<int>(shards_.size()) || pool_num > max_pool_num()) {
+    LOG_WARN("invalid pool num. tag=%s, pool num=%d, shard num=%d, max pool num=%d",
+             tag_.c_str(), pool_num, shard_num(), max_pool_num());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int old_pool_num = pool_num_.load();
+  if (pool_num > old_pool_num) {
+    RC rc = arena_.resize(static_cast<size_t>(pool_num) * DEFAULT_ITEM_NUM_PER_POOL);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    Frame *frames = arena_.frames();
+    for (int i = old_pool_num; i < pool_num; i++) {
+      FrameShard       &shard = shard_of_pool(i);
+      lock_guard<mutex> lock_guard(shard.lock_);
+      shard.allocator_.add_chunk(frames + i * DEFAULT_ITEM_NUM_PER_POOL, DEFAULT_ITEM_NUM_PER_POOL);
+    }
+    pool_num_.store(pool_num);
+  }
+
+  for (int i = old_pool_num - 1; i >= pool_num; i--) {
+    RC rc = drain_last_pool(shard_of_pool(i), flusher);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to drain frame pool. tag=%s, pool index=%d, rc=%s", tag_.c_str(), i, strrc(rc));
+      return rc;
+    }
+
+    pool_num_.store(i);
+    (void)arena_.resize(static_cast<size_t>(i) * DEFAULT_ITEM_NUM_PER_POOL);
+  }
+
+  LOG_INFO("frame manager resized. tag=%s, pool num=%d->%d", tag_.c_str(), old_pool_num, pool_num);
+  return RC::SUCCESS;
+}
+
+RC BPFrameManager::drain_last_pool(FrameShard &shard, const function<RC(Frame *frame)> &flusher)
+{
+  static constexpr int MAX_RETRY_TIMES   = 100;
+  static constexpr int RETRY_INTERVAL_MS = 10;
+
+  for (int retry = 0; retry < MAX_RETRY_TIMES; retry++) {
+    if (retry > 0) {
+      this_thread::sleep_for(chrono::milliseconds(RETRY_INTERVAL_MS));
+    }
+
+    vector<Frame *> frames;
+    {
+      lock_guard<mutex> lock_guard(shard.lock_);
+      auto [chunk_frames, chunk_frame_num] = shard.allocator_.chunk(shard.allocator_.chunk_num() - 1);
+      for (auto &[frame_id, frame] : shard.frames_) {
+        if (frame >= chunk_frames && frame < chunk_frames + chunk_frame_num && frame->dirty()) {
+          frame->pin();
+          frames.push_back(frame);
+        }
+      }
+    }
+
+    // 刷新脏页时需要加 buffer pool 的锁，不能持有分片的锁
+    for (Frame *frame : frames) {
+      RC rc = flusher(frame);
+      frame->unpin();
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to flush frame while draining. frame=%s, rc=%s", frame->to_string().c_str(), strrc(rc));
+      }
+    }
+
+    lock_guard<mutex> lock_guard(shard.lock_);
+    auto [chunk_frames, chunk_frame_num] = shard.allocator_.chunk(shard.allocator_.chunk_num() - 1);
+
+    frames.clear();
+    bool can_drain = true;
+    for (auto &[frame_id, frame] : shard.frames_) {
+      if (frame >= chunk_frames && frame < chunk_frames + chunk_frame_num) {
+        if (frame->pin_count() > 0 || frame->dirty()) {
+          can_drain = false;
+          break;
+        }
+        frames.push_back(frame);
+      }
+    }
+
+    if (!can_drain) {
+      continue;
+    }
+
+    for (Frame *frame : frames) {
+      frame->pin();
+      shard.free_internal(frame->frame_id(), frame);
+    }
+    stats_.evictions += frames.size();
+    return shard.allocator_.remove_last_chunk();
+  }
+  return RC::LOCKED_CONCURRENCY_CONFLICT;
 }
 
 RC BPFrameManager::cleanup()
 {
-  if (frames_.count() > 0) {
-    return RC::INTERNAL;
+  for (unique_ptr<FrameShard> &shard : shards_) {
+    if (!shard->frames_.empty()) {
+      return RC::INTERNAL;
+    }
   }
 
-  frames_.destroy();
+  for (unique_ptr<FrameShard> &shard : shards_) {
+    shard->frames_.clear();
+  }
   return RC::SUCCESS;
 }
 
-int BPFrameManager::purge_frames(int count, function<RC(Frame *frame)> purger)
+BPFrameManager::FrameShard &BPFrameManager::shard_of(const FrameId &frame_id)
+{
+  // FrameId的哈希值中，页面编号在低位，buffer pool id在高位，这里把高位也混合进来
+  size_t hash = frame_id.hash();
+  hash ^= hash >> 32;
+  return *shards_[hash % shards_.size()];
+}
+
+size_t BPFrameManager::frame_num() const
+{
+  size_t num = 0;
+  for (const unique_ptr<FrameShard> &shard : shards_) {
+    num += shard->frames_.size();
+  }
+  return num;
+}
+
+void BPFrameManager::dirty_frames(vector<pair<LSN, FrameId>> &frames)
+{
+  for (unique_ptr<FrameShard> &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard->lock_);
+    for (const auto &[frame_id, frame] : shard->frames_) {
+      if (frame->dirty()) {
+        frames.emplace_back(frame->lsn(), frame_id);
+      }
+    }
+  }
+}
+
+void BPFrameManager::all_frames(vector<FrameId> &frames)
 {
-  lock_guard<mutex> lock_guard(lock_);
+  for (unique_ptr<FrameShard> &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard->lock_);
+    for (const auto &[frame_id, frame] : shard->frames_) {
+      frames.push_back(frame_id);
+    }
+  }
+}
+
+void BPFrameManager::residency(unordered_map<int32_t, Residency> &result)
+{
+  for (unique_ptr<FrameShard> &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard->lock_);
+    for (const auto &[frame_id, frame] : shard->frames_) {
+      Residency &residency = result[frame_id.buffer_pool_id()];
+      residency.frames++;
+      if (frame->dirty()) {
+        residency.dirty++;
+      }
+      if (frame->pin_count() > 0) {
+        residency.pinned++;
+      }
+    }
+  }
+}
+
+size_t BPFrameManager::total_frame_num() const
+{
+  size_t num = 0;
+  for (const unique_ptr<FrameShard> &shard : shards_) {
+    num += shard->allocator_.get_size();
+  }
+  return num;
+}
+
+int BPFrameManager::purge_frames(const FrameId &frame_id, int count, function<RC(Frame *frame)> purger)
+{
+  FrameShard &shard = shard_of(frame_id);
+
+  lock_guard<mutex> lock_guard(shard.lock_);
 
   vector<Frame *> frames_can_purge;
   if (count <= 0) {
@@ -69,7 +309,7 @@ int BPFrameManager::purge_frames(int count, function<RC(Frame *frame)> purger)
   }
   frames_can_purge.reserve(count);
 
-  auto purge_finder = [&frames_can_purge, count](const FrameId &frame_id, Frame *const frame) {
+  auto purge_finder = [&frames_can_purge, count](Frame *frame) {
     if (frame->can_purge()) {
       frame->pin();
       frames_can_purge.push_back(frame);
@@ -80,16 +320,19 @@ int BPFrameManager::purge_frames(int count, function<RC(Frame *frame)> purger)
     return true;  // true continue to look up
   };
 
-  frames_.foreach_reverse(purge_finder);
+  shard.replacer_->foreach_victim(purge_finder);
   LOG_INFO("purge frames find %ld pages total", frames_can_purge.size());
+  if (frames_can_purge.empty()) {
+    stats_.pin_waits++;
+  }
 
-  /// 当前还在frameManager的锁内，而 purger 是一个非常耗时的操作
-  /// 他需要把脏页数据刷新到磁盘上去，所以这里会极大地降低并发度
+  /// 当前还在分片的锁内，而 purger 是一个非常耗时的操作
+  /// 他需要把脏页数据刷新到磁盘上去，所以这里会降低当前分片的并发度
   int freed_count = 0;
   for (Frame *frame : frames_can_purge) {
     RC rc = purger(frame);
     if (RC::SUCCESS == rc) {
-      free_internal(frame->frame_id(), frame);
+      shard.free_internal(frame->frame_id(), frame);
       freed_count++;
     } else {
       frame->unpin();
@@ -97,48 +340,72 @@ int BPFrameManager::purge_frames(int count, function<RC(Frame *frame)> purger)
                frame->frame_id().to_string().c_str(), strrc(rc));
     }
   }
+  stats_.evictions += freed_count;
   LOG_INFO("purge frame done. number=%d", freed_count);
   return freed_count;
 }
 
-Frame *BPFrameManager::get(int buffer_pool_id, PageNum page_num)
+Frame *BPFrameManager::get(int buffer_pool_id, PageNum page_num, BufferAccessHint hint /* = NORMAL */)
 {
-  FrameId                     frame_id(buffer_pool_id, page_num);
+  FrameId     frame_id(buffer_pool_id, page_num);
+  FrameShard &shard = shard_of(frame_id);
 
-  lock_guard<mutex> lock_guard(lock_);
-  return get_internal(frame_id);
+  unique_lock<mutex> lock(shard.lock_);
+  Frame *frame = shard.get_internal(frame_id, hint, lock);
+  if (frame != nullptr) {
+    stats_.hits++;
+  }
+  return frame;
 }
 
-Frame *BPFrameManager::get_internal(const FrameId &frame_id)
+Frame *BPFrameManager::FrameShard::get_internal(
+    const FrameId &frame_id, BufferAccessHint hint, unique_lock<mutex> &lock)
 {
-  Frame *frame = nullptr;
-  (void)frames_.get(frame_id, frame);
-  if (frame != nullptr) {
-    frame->pin();
-    LOG_DEBUG("got a frame. frame=%s", frame->to_string().c_str());
+  auto iter = frames_.find(frame_id);
+  if (iter == frames_.end()) {
+    return nullptr;
+  }
+
+  // 固定页帧必须在锁内，参考 try_free
+  Frame *frame = iter->second;
+  frame->pin();
+  if (replacer_->lock_free_access()) {
+    lock.unlock();
   }
+  replacer_->access(frame, hint);
+  LOG_DEBUG("got a frame. frame=%s", frame->to_string().c_str());
   return frame;
 }
 
-Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num)
+Frame *BPFrameManager::alloc(
+    int buffer_pool_id, PageNum page_num, BufferAccessHint hint /* = NORMAL */, bool for_prefetch /* = false */)
 {
-  FrameId frame_id(buffer_pool_id, page_num);
+  FrameId     frame_id(buffer_pool_id, page_num);
+  FrameShard &shard = shard_of(frame_id);
 
-  lock_guard<mutex> lock_guard(lock_);
+  unique_lock<mutex> lock(shard.lock_);
 
-  Frame                      *frame = get_internal(frame_id);
+  Frame *frame = shard.get_internal(frame_id, hint, lock);
   if (frame != nullptr) {
+    stats_.hits++;
     return frame;
   }
 
-  frame = allocator_.alloc();
+  frame = shard.allocator_.alloc();
   if (frame != nullptr) {
+    stats_.misses++;
     ASSERT(frame->pin_count() == 0, "got an invalid frame that pin count is not 0. frame=%s", 
            frame->to_string().c_str());
     frame->set_buffer_pool_id(buffer_pool_id);
     frame->set_page_num(page_num);
     frame->pin();
-    frames_.put(frame_id, frame);
+    frame->set_loading(for_prefetch);
+    if (for_prefetch) {
+      frame->write_latch();
+      frame->set_prefetched(true);
+    }
+    shard.frames_.emplace(frame_id, frame);
+    shard.replacer_->insert(frame, hint);
     LOG_DEBUG("allocate a new frame. frame=%s", frame->to_string().c_str());
   }
   return frame;
@@ -146,40 +413,59 @@ Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num)
 
 RC BPFrameManager::free(int buffer_pool_id, PageNum page_num, Frame *frame)
 {
-  FrameId frame_id(buffer_pool_id, page_num);
+  FrameId     frame_id(buffer_pool_id, page_num);
+  FrameShard &shard = shard_of(frame_id);
+
+  lock_guard<mutex> lock_guard(shard.lock_);
+  return shard.free_internal(frame_id, frame);
+}
+
+RC BPFrameManager::try_free(int buffer_pool_id, PageNum page_num, Frame *frame)
+{
+  FrameId     frame_id(buffer_pool_id, page_num);
+  FrameShard &shard = shard_of(frame_id);
 
-  lock_guard<mutex> lock_guard(lock_);
-  return free_internal(frame_id, frame);
+  // 固定页帧(get)也要加分片的锁，所以检查之后不会有新的线程固定这个页帧
+  lock_guard<mutex> lock_guard(shard.lock_);
+  if (frame->pin_count() != 1) {
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  return shard.free_internal(frame_id, frame);
 }
 
-RC BPFrameManager::free_internal(const FrameId &frame_id, Frame *frame)
+RC BPFrameManager::FrameShard::free_internal(const FrameId &frame_id, Frame *frame)
 {
-  Frame                *frame_source = nullptr;
-  [[maybe_unused]] bool found        = frames_.get(frame_id, frame_source);
+  auto                  iter         = frames_.find(frame_id);
+  [[maybe_unused]] bool found        = iter != frames_.end();
+  Frame                *frame_source = found ? iter->second : nullptr;
   ASSERT(found && frame == frame_source && frame->pin_count() == 1,
       "failed to free frame. found=%d, frameId=%s, frame_source=%p, frame=%p, pinCount=%d, lbt=%s",
       found, frame_id.to_string().c_str(), frame_source, frame, frame->pin_count(), lbt());
+  if (!found) {
+    return RC::INTERNAL;
+  }
 
   frame->set_page_num(-1);
+  frame->set_prefetched(false);
   frame->unpin();
-  frames_.remove(frame_id);
+  frames_.erase(iter);
+  replacer_->remove(frame);
   allocator_.free(frame);
   return RC::SUCCESS;
 }
 
 list<Frame *> BPFrameManager::find_list(int buffer_pool_id)
 {
-  lock_guard<mutex> lock_guard(lock_);
-
   list<Frame *> frames;
-  auto               fetcher = [&frames, buffer_pool_id](const FrameId &frame_id, Frame *const frame) -> bool {
-    if (buffer_pool_id == frame_id.buffer_pool_id()) {
-      frame->pin();
-      frames.push_back(frame);
+  for (unique_ptr<FrameShard> &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard->lock_);
+    for (auto &[frame_id, frame] : shard->frames_) {
+      if (buffer_pool_id == frame_id.buffer_pool_id()) {
+        frame->pin();
+        frames.push_back(frame);
+      }
     }
-    return true;
-  };
-  frames_.foreach (fetcher);
+  }
   return frames;
 }
 
@@ -188,12 +474,14 @@ BufferPoolIterator::BufferPoolIterator() {}
 BufferPoolIterator::~BufferPoolIterator() {}
 RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
 {
+  buffer_pool_ = &bp;
   bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
   if (start_page <= 0) {
     current_page_num_ = -1;
   } else {
     current_page_num_ = start_page - 1;
   }
+  prefetch_page_num_ = current_page_num_;
   return RC::SUCCESS;
 }
 
@@ -210,14 +498,35 @@ PageNum BufferPoolIterator::next()
 
 RC BufferPoolIterator::reset()
 {
-  current_page_num_ = 0;
+  current_page_num_  = 0;
+  prefetch_page_num_ = 0;
   return RC::SUCCESS;
 }
 
+void BufferPoolIterator::prefetch()
+{
+  if (nullptr == buffer_pool_) {
+    return;
+  }
+
+  const int depth = buffer_pool_->prefetcher().depth();
+  PageNum   page_num = current_page_num_;
+  for (int i = 0; i < depth; i++) {
+    page_num = bitmap_.next_setted_bit(page_num + 1);
+    if (page_num == -1) {
+      break;
+    }
+
+    if (page_num > prefetch_page_num_) {
+      buffer_pool_->prefetch(page_num);
+      prefetch_page_num_ = page_num;
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
-DiskBufferPool::DiskBufferPool(
-    BufferPoolManager &bp_manager, BPFrameManager &frame_manager, DoubleWriteBuffer &dblwr_manager, LogHandler &log_handler)
-    : bp_manager_(bp_manager), frame_manager_(frame_manager), dblwr_manager_(dblwr_manager), log_handler_(*this, log_handler)
+DiskBufferPool::DiskBufferPool(BufferPoolManager &bp_manager, DoubleWriteBuffer &dblwr_manager, LogHandler &log_handler)
+    : bp_manager_(bp_manager), dblwr_manager_(dblwr_manager), log_handler_(*this, log_handler)
 {}
 
 DiskBufferPool::~DiskBufferPool()
@@ -238,8 +547,9 @@ RC DiskBufferPool::open_file(const char *file_name)
   file_name_ = file_name;
   file_desc_ = fd;
 
-  Page header_page;
-  int ret = readn(file_desc_, &header_page, sizeof(header_page));
+  // 页面大小记录在文件头中，先只读取文件头，知道页面大小之后才能分配页帧
+  alignas(Page) char header_buf[sizeof(Page) + sizeof(BPFileHeader)];
+  int ret = readn(file_desc_, header_buf, sizeof(header_buf));
   if (ret != 0) {
     LOG_ERROR("Failed to read first page of %s, due to %s.", file_name, strerror(errno));
     close(fd);
@@ -247,10 +557,30 @@ RC DiskBufferPool::open_file(const char *file_name)
     return RC::IOERR_READ;
   }
 
-  BPFileHeader *tmp_file_header = reinterpret_cast<BPFileHeader *>(header_page.data);
+  BPFileHeader *tmp_file_header = reinterpret_cast<BPFileHeader *>(reinterpret_cast<Page *>(header_buf)->data);
   buffer_pool_id_ = tmp_file_header->buffer_pool_id;
+  page_size_      = tmp_file_header->page_size;
+
+  const PageCompression compression = static_cast<PageCompression>(tmp_file_header->compression);
+  if (compression != PageCompression::NONE) {
+    compressor_ = PageCompressor::get(compression);
+    if (compressor_ == nullptr) {
+      LOG_ERROR("Unknown page compression of %s. compression=%d", file_name, tmp_file_header->compression);
+      close(fd);
+      file_desc_ = -1;
+      return RC::INTERNAL;
+    }
+  }
+
+  RC rc = bp_manager_.get_frame_manager(page_size_, frame_manager_);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to get frame manager of %s. page size=%d, rc=%s", file_name, page_size_, strrc(rc));
+    close(fd);
+    file_desc_ = -1;
+    return rc;
+  }
 
-  RC rc = allocate_frame(BP_HEADER_PAGE, &hdr_frame_);
+  rc = allocate_frame(BP_HEADER_PAGE, &hdr_frame_);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("failed to allocate frame for header. file name %s", file_name_.c_str());
     close(fd);
@@ -283,6 +613,11 @@ RC DiskBufferPool::close_file()
     return rc;
   }
 
+  // 预读线程和刷脏线程可能还在访问当前文件。先标记为正在关闭，等待之后它们就不会再访问了
+  bp_manager_.mark_closing(*this);
+  prefetcher().cancel(this);
+  bp_manager_.get_page_cleaner().cancel(this);
+
   hdr_frame_->unpin();
 
   // TODO: 理论上是在回放时回滚未提交事务，但目前没有undo log，因此不下刷数据page，只通过redo log回放
@@ -311,24 +646,60 @@ RC DiskBufferPool::close_file()
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
+RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame, BufferAccessHint hint /* = NORMAL */)
 {
   RC rc  = RC::SUCCESS;
   *frame = nullptr;
 
-  Frame *used_match_frame = frame_manager_.get(id(), page_num);
+  Frame *used_match_frame = frame_manager_->get(id(), page_num, hint);
   if (used_match_frame != nullptr) {
-    used_match_frame->access();
-    *frame = used_match_frame;
-    return RC::SUCCESS;
+    if (OB_SUCC(wait_for_loading(used_match_frame))) {
+      used_match_frame->access();
+      if (used_match_frame->clear_prefetched()) {
+        prefetcher().stats().hit++;
+      }
+      stats_.hits++;
+      *frame = used_match_frame;
+      return RC::SUCCESS;
+    }
+    // 预读失败的页帧，加锁之后再处理
+    used_match_frame->unpin();
   }
 
   scoped_lock lock_guard(lock_);  // 直接加了一把大锁，其实可以根据访问的页面来细化提高并行度
 
+  // 在等锁的过程中，其它线程(比如预读线程)可能已经把页面加载到内存中了
+  used_match_frame = frame_manager_->get(id(), page_num, hint);
+  if (used_match_frame != nullptr) {
+    rc = wait_for_loading(used_match_frame);
+    if (OB_SUCC(rc)) {
+      used_match_frame->access();
+      if (used_match_frame->clear_prefetched()) {
+        prefetcher().stats().hit++;
+      }
+      stats_.hits++;
+      *frame = used_match_frame;
+      return RC::SUCCESS;
+    }
+
+    // 预读失败的页帧没有其它线程使用时释放掉，重新加载页面，否则返回错误
+    if (OB_FAIL(frame_manager_->try_free(id(), page_num, used_match_frame))) {
+      used_match_frame->unpin();
+      LOG_WARN("page failed to load by prefetcher is still in use. file=%s, page num=%d",
+               file_name_.c_str(), page_num);
+      return rc;
+    }
+  }
+
+  if (hint == BufferAccessHint::SEQUENTIAL && prefetcher().enabled()) {
+    prefetcher().stats().miss++;
+  }
+  stats_.misses++;
+
   // Allocate one page and load the data into this page
   Frame *allocated_frame = nullptr;
 
-  rc = allocate_frame(page_num, &allocated_frame);
+  rc = allocate_frame(page_num, &allocated_frame, hint);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
     return rc;
@@ -348,6 +719,99 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
   return RC::SUCCESS;
 }
 
+void DiskBufferPool::prefetch(PageNum page_num)
+{
+  BufferPoolPrefetcher &bp_prefetcher = prefetcher();
+  if (bp_prefetcher.enabled()) {
+    bp_prefetcher.submit(this, page_num);
+  }
+}
+
+RC DiskBufferPool::prefetch_pages(span<const PageNum> page_nums, int &loaded)
+{
+  loaded = 0;
+
+  // 在锁内分配并固定页帧，页帧带着 loading 标记和写锁，其它线程访问这些页面时会等待加载完成。
+  // 批量读取页面时不持有 buffer pool 的锁，不会阻塞其它页面的访问
+  vector<Frame *>       frames;
+  vector<PageIoRequest> requests;
+  lock_.lock();
+  for (PageNum page_num : page_nums) {
+    if (page_num <= BP_HEADER_PAGE || page_num >= file_header_->page_count ||
+        (file_header_->bitmap[page_num / 8] & (1 << (page_num % 8))) == 0) {
+      continue;
+    }
+
+    Frame *frame = frame_manager_->get(id(), page_num, BufferAccessHint::SEQUENTIAL);
+    if (frame != nullptr) {
+      frame->unpin();
+      continue;
+    }
+
+    RC rc = allocate_frame(page_num, &frame, BufferAccessHint::SEQUENTIAL, true /*for_prefetch*/);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate frame for prefetch. file=%s, page num=%d, rc=%s",
+               file_name_.c_str(), page_num, strrc(rc));
+      break;
+    }
+
+    frame->set_buffer_pool_id(id());
+    frame->access();
+
+    // double write buffer 中的页面比磁盘上的新
+    if (OB_SUCC(dblwr_manager_.read_page(this, page_num, frame->page()))) {
+      frame->set_loading(false);
+      frame->write_unlatch();
+      frame->unpin();
+      loaded++;
+      continue;
+    }
+
+    frames.push_back(frame);
+    requests.push_back(PageIoRequest::make_read(file_desc_, (int64_t)page_num * page_size_, &frame->page(), page_size_));
+  }
+  lock_.unlock();
+
+  RC rc = bp_manager_.get_io_engine().submit(requests);
+
+  vector<Frame *> failed_frames;
+  for (size_t i = 0; i < frames.size(); i++) {
+    Frame  *frame    = frames[i];
+    PageNum page_num = frame->page_num();
+    RC      load_rc  = requests[i].rc;
+    if (OB_SUCC(load_rc)) {
+      load_rc = decompress_page(page_num, frame->page());
+    }
+    if (OB_FAIL(load_rc)) {
+      // 保留 loading 标记再释放写锁，等待这个页面的线程会发现加载失败
+      LOG_WARN("failed to load page for prefetch. file=%s, page num=%d, rc=%s",
+               file_name_.c_str(), page_num, strrc(load_rc));
+      frame->write_unlatch();
+      failed_frames.push_back(frame);
+      continue;
+    }
+
+    frame->set_loading(false);
+    frame->write_unlatch();
+    frame->unpin();
+    loaded++;
+  }
+
+  // 与 get_this_page 一样，在锁内释放加载失败的页帧
+  if (!failed_frames.empty()) {
+    scoped_lock lock_guard(lock_);
+    for (Frame *frame : failed_frames) {
+      if (OB_FAIL(frame_manager_->try_free(id(), frame->page_num(), frame))) {
+        // 其它线程还在使用，由它们在 get_this_page 中处理
+        frame->unpin();
+      }
+    }
+  }
+  return rc;
+}
+
+BufferPoolPrefetcher &DiskBufferPool::prefetcher() { return bp_manager_.get_prefetcher(); }
+
 RC DiskBufferPool::allocate_page(Frame **frame)
 {
   RC rc = RC::SUCCESS;
@@ -382,9 +846,9 @@ RC DiskBufferPool::allocate_page(Frame **frame)
     }
   }
 
-  if (file_header_->page_count >= BPFileHeader::MAX_PAGE_NUM) {
+  if (file_header_->page_count >= file_header_->max_page_num()) {
     LOG_WARN("file buffer pool is full. page count %d, max page count %d",
-        file_header_->page_count, BPFileHeader::MAX_PAGE_NUM);
+        file_header_->page_count, file_header_->max_page_num());
     lock_.unlock();
     return RC::BUFFERPOOL_NOBUF;
   }
@@ -421,9 +885,11 @@ RC DiskBufferPool::allocate_page(Frame **frame)
   allocated_frame->clear_page();
   allocated_frame->set_page_num(file_header_->page_count - 1);
 
-  // Use flush operation to extension file
-  if ((rc = flush_page_internal(*allocated_frame)) != RC::SUCCESS) {
-    LOG_WARN("Failed to alloc page %s , due to failed to extend one page.", file_name_.c_str());
+  // 直接扩展文件，不经过double write buffer。页面写入double write buffer后不会立即落盘，
+  // 恢复时回放这个页面的日志，需要能从文件中读到它
+  int ret = posix_fallocate(file_desc_, static_cast<off_t>(page_num) * page_size_, page_size_);
+  if (ret != 0) {
+    LOG_WARN("Failed to alloc page %s , due to failed to extend one page. error=%s", file_name_.c_str(), strerror(ret));
     // skip return false, delay flush the extended page
     // return tmp;
   }
@@ -442,10 +908,23 @@ RC DiskBufferPool::dispose_page(PageNum page_num)
   }
   
   scoped_lock lock_guard(lock_);
-  Frame           *used_frame = frame_manager_.get(id(), page_num);
+  Frame           *used_frame = frame_manager_->get(id(), page_num);
   if (used_frame != nullptr) {
-    ASSERT("the page try to dispose is in use. frame:%s", used_frame->to_string().c_str());
-    frame_manager_.free(id(), page_num, used_frame);
+    // 乐观读的线程可能还固定着这个页面，它们检查版本号失败后就会释放。
+    // 等待时不持有 buffer pool 的锁，因为它们获取下一个页面时可能需要这个锁。
+    // 调用者自己还固定着页面或者固定泄露时永远等不到，重试一定次数后返回错误，页面保持已分配状态
+    RC rc = RC::SUCCESS;
+    for (int retry = 0; OB_FAIL(rc = frame_manager_->try_free(id(), page_num, used_frame)); retry++) {
+      if (retry >= DISPOSE_PAGE_RETRY_NUM) {
+        LOG_WARN("failed to dispose page, the frame is still pinned by others. file=%s, frame=%s, rc=%s",
+                 file_name_.c_str(), used_frame->to_string().c_str(), strrc(rc));
+        used_frame->unpin();
+        return rc;
+      }
+      lock_.unlock();
+      this_thread::yield();
+      lock_.lock();
+    }
   } else {
     LOG_DEBUG("page not found in memory while disposing it. pageNum=%d", page_num);
   }
@@ -471,6 +950,17 @@ RC DiskBufferPool::unpin_page(Frame *frame)
   return RC::SUCCESS;
 }
 
+RC DiskBufferPool::wait_for_loading(Frame *frame)
+{
+  if (!frame->loading()) {
+    return RC::SUCCESS;
+  }
+
+  frame->read_latch();
+  frame->read_unlatch();
+  return frame->loading() ? RC::IOERR_READ : RC::SUCCESS;
+}
+
 RC DiskBufferPool::purge_frame(PageNum page_num, Frame *buf)
 {
   if (buf->pin_count() != 1) {
@@ -488,7 +978,7 @@ RC DiskBufferPool::purge_frame(PageNum page_num, Frame *buf)
   }
 
   LOG_DEBUG("Successfully purge frame =%p, page %d frame_id=%s", buf, buf->page_num(), buf->frame_id().to_string().c_str());
-  frame_manager_.free(id(), page_num, buf);
+  frame_manager_->free(id(), page_num, buf);
   return RC::SUCCESS;
 }
 
@@ -496,7 +986,7 @@ RC DiskBufferPool::purge_page(PageNum page_num)
 {
   scoped_lock lock_guard(lock_);
 
-  Frame           *used_frame = frame_manager_.get(id(), page_num);
+  Frame           *used_frame = frame_manager_->get(id(), page_num);
   if (used_frame != nullptr) {
     return purge_frame(page_num, used_frame);
   }
@@ -506,7 +996,7 @@ RC DiskBufferPool::purge_page(PageNum page_num)
 
 RC DiskBufferPool::purge_all_pages()
 {
-  list<Frame *> used = frame_manager_.find_list(id());
+  list<Frame *> used = frame_manager_->find_list(id());
 
   scoped_lock lock_guard(lock_);
   for (list<Frame *>::iterator it = used.begin(); it != used.end(); ++it) {
@@ -519,7 +1009,7 @@ RC DiskBufferPool::purge_all_pages()
 
 RC DiskBufferPool::check_all_pages_unpinned()
 {
-  list<Frame *> frames = frame_manager_.find_list(id());
+  list<Frame *> frames = frame_manager_->find_list(id());
 
   scoped_lock lock_guard(lock_);
   for (Frame *frame : frames) {
@@ -542,6 +1032,15 @@ RC DiskBufferPool::flush_page(Frame &frame)
   return flush_page_internal(frame);
 }
 
+RC DiskBufferPool::flush_dirty_page(Frame &frame)
+{
+  scoped_lock lock_guard(lock_);
+  if (!frame.dirty()) {
+    return RC::NOT_EXIST;
+  }
+  return flush_page_internal(frame);
+}
+
 RC DiskBufferPool::flush_page_internal(Frame &frame)
 {
   // The better way is use mmap the block into memory,
@@ -553,7 +1052,7 @@ RC DiskBufferPool::flush_page_internal(Frame &frame)
     // ignore error handle
   }
 
-  frame.set_check_sum(crc32(frame.page().data, BP_PAGE_DATA_SIZE));
+  frame.set_check_sum(crc32(frame.page().data, frame.data_size()));
 
   rc = dblwr_manager_.add_page(this, frame.page_num(), frame.page());
   if (OB_FAIL(rc)) {
@@ -561,6 +1060,7 @@ RC DiskBufferPool::flush_page_internal(Frame &frame)
   }
 
   frame.clear_dirty();
+  stats_.flushes++;
   LOG_DEBUG("Flush block. file desc=%d, frame=%s", file_desc_, frame.to_string().c_str());
 
   return RC::SUCCESS;
@@ -568,7 +1068,7 @@ RC DiskBufferPool::flush_page_internal(Frame &frame)
 
 RC DiskBufferPool::flush_all_pages()
 {
-  list<Frame *> used = frame_manager_.find_list(id());
+  list<Frame *> used = frame_manager_->find_list(id());
   for (Frame *frame : used) {
     RC rc = flush_page(*frame);
     frame->unpin();
@@ -598,22 +1098,56 @@ RC DiskBufferPool::recover_page(PageNum page_num)
 
 RC DiskBufferPool::write_page(PageNum page_num, Page &page)
 {
-  scoped_lock lock_guard(wr_lock_);
-  int64_t     offset = ((int64_t)page_num) * sizeof(Page);
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to write page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
-  }
-
-  if (writen(file_desc_, &page, sizeof(Page)) != 0) {
-    LOG_ERROR("Failed to write page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_WRITE;
+  vector<char>  buffer;
+  PageIoRequest request = make_write_request(page_num, page, buffer);
+  RC            rc      = bp_manager_.get_io_engine().submit(span<PageIoRequest>(&request, 1));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to write page %s:%d. rc=%s", file_name_.c_str(), page_num, strrc(rc));
+    return rc;
   }
 
   LOG_TRACE("write_page: buffer_pool_id:%d, page_num:%d, lsn=%d, check_sum=%d", id(), page_num, page.lsn, page.check_sum);
   return RC::SUCCESS;
 }
 
+PageIoRequest DiskBufferPool::make_write_request(PageNum page_num, Page &page, vector<char> &buffer)
+{
+  const int64_t offset = ((int64_t)page_num) * page_size_;
+  if (compressor_ == nullptr || page_num == BP_HEADER_PAGE) {
+    return PageIoRequest::make_write(file_desc_, offset, &page, page_size_);
+  }
+
+  // 压缩之后至少要节省一个对齐单位才有意义，否则原样写入
+  const int header_size = static_cast<int>(sizeof(CompressedPageHeader));
+  const int align       = CompressedPageHeader::COMPRESSED_PAGE_ALIGN;
+  const int capacity    = page_size_ - align - header_size;
+
+  int compressed_size = -1;
+  if (capacity > 0) {
+    buffer.resize(page_size_);
+    compressed_size =
+        compressor_->compress(reinterpret_cast<const char *>(&page), page_size_, buffer.data() + header_size, capacity);
+  }
+  if (compressed_size < 0) {
+    stats_.raw_writes++;
+    return PageIoRequest::make_write(file_desc_, offset, &page, page_size_);
+  }
+
+  auto *header            = reinterpret_cast<CompressedPageHeader *>(buffer.data());
+  header->magic           = CompressedPageHeader::MAGIC;
+  header->compression     = file_header_->compression;
+  header->compressed_size = compressed_size;
+
+  const int data_size  = header_size + compressed_size;
+  const int write_size = (data_size + align - 1) / align * align;
+  memset(buffer.data() + data_size, 0, write_size - data_size);
+  punch_hole(file_desc_, offset + write_size, page_size_ - write_size);
+
+  stats_.compressed_writes++;
+  stats_.compressed_bytes += write_size;
+  return PageIoRequest::make_write(file_desc_, offset, buffer.data(), write_size);
+}
+
 RC DiskBufferPool::redo_allocate_page(LSN lsn, PageNum page_num)
 {
   if (hdr_frame_->lsn() >= lsn) {
@@ -641,9 +1175,9 @@ RC DiskBufferPool::redo_allocate_page(LSN lsn, PageNum page_num)
   }
 
   // page_num == file_header_->page_count
-  if (file_header_->page_count >= BPFileHeader::MAX_PAGE_NUM) {
+  if (file_header_->page_count >= file_header_->max_page_num()) {
     LOG_WARN("file buffer pool is full. page count %d, max page count %d",
-        file_header_->page_count, BPFileHeader::MAX_PAGE_NUM);
+        file_header_->page_count, file_header_->max_page_num());
     return RC::INTERNAL;
   }
 
@@ -685,13 +1219,19 @@ RC DiskBufferPool::redo_deallocate_page(LSN lsn, PageNum page_num)
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
+RC DiskBufferPool::allocate_frame(
+    PageNum page_num, Frame **buffer, BufferAccessHint hint /* = NORMAL */, bool for_prefetch /* = false */)
 {
   auto purger = [this](Frame *frame) {
     if (!frame->dirty()) {
       return RC::SUCCESS;
     }
 
+    // 前台线程不得不同步刷新脏页，说明后台刷脏跟不上了
+    PageCleaner &page_cleaner = bp_manager_.get_page_cleaner();
+    page_cleaner.stats().foreground_flushed++;
+    page_cleaner.wakeup();
+
     RC rc = RC::SUCCESS;
     if (frame->buffer_pool_id() == id()) {
       rc = this->flush_page_internal(*frame);
@@ -705,8 +1245,10 @@ RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
     return rc;
   };
 
-  while (true) {
-    Frame *frame = frame_manager_.alloc(id(), page_num);
+  // 页帧只能从页面所在的分片中分配。分片中的页帧都被固定时等其它线程释放，
+  // 重试一定次数之后仍然没有就返回错误，不能一直等下去
+  for (int retry = 0; retry < ALLOCATE_FRAME_RETRY_NUM; retry++) {
+    Frame *frame = frame_manager_->alloc(id(), page_num, hint, for_prefetch);
     if (frame != nullptr) {
       *buffer = frame;
       LOG_DEBUG("allocate frame %p, page num %d, frame=%s", frame, page_num, frame->to_string().c_str());
@@ -714,8 +1256,13 @@ RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
     }
 
     LOG_TRACE("frames are all allocated, so we should purge some frames to get one free frame");
-    (void)frame_manager_.purge_frames(1 /*count*/, purger);
+    if (frame_manager_->purge_frames(FrameId(id(), page_num), 1 /*count*/, purger) == 0) {
+      this_thread::yield();
+    }
   }
+
+  LOG_WARN("failed to allocate frame, all frames in the shard are pinned. file=%s, page num=%d",
+           file_name_.c_str(), page_num);
   return RC::BUFFERPOOL_NOBUF;
 }
 
@@ -740,19 +1287,17 @@ RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
     return rc;
   }
 
-  scoped_lock lock_guard(wr_lock_);
-  int64_t          offset = ((int64_t)page_num) * BP_PAGE_SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to lseek:%s.", file_name_.c_str(), page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
+  int64_t offset = ((int64_t)page_num) * page_size_;
+  rc             = bp_manager_.get_io_engine().read(file_desc_, offset, &page, page_size_);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, rc=%s",
+              file_name_.c_str(), file_desc_, page_num, strrc(rc));
+    return rc;
   }
 
-  int ret = readn(file_desc_, &page, BP_PAGE_SIZE);
-  if (ret != 0) {
-    LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
-              file_name_.c_str(), file_desc_, page_num, strerror(errno), ret, file_header_->allocated_pages);
-    return RC::IOERR_READ;
+  rc = decompress_page(page_num, page);
+  if (OB_FAIL(rc)) {
+    return rc;
   }
 
   frame->set_page_num(page_num);
@@ -762,38 +1307,128 @@ RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
   return RC::SUCCESS;
 }
 
+RC DiskBufferPool::decompress_page(PageNum page_num, Page &page)
+{
+  if (compressor_ == nullptr || page.lsn != CompressedPageHeader::MAGIC) {
+    return RC::SUCCESS;
+  }
+
+  CompressedPageHeader header;
+  memcpy(&header, &page, sizeof(header));
+  const int max_size = page_size_ - static_cast<int>(sizeof(header));
+  if (header.compressed_size <= 0 || header.compressed_size > max_size ||
+      PageCompressor::get(static_cast<PageCompression>(header.compression)) != compressor_) {
+    LOG_ERROR("Invalid compressed page %s:%d. compression=%d, compressed size=%d",
+              file_name_.c_str(), page_num, header.compression, header.compressed_size);
+    return RC::IOERR_READ;
+  }
+
+  // 解压的结果会覆盖页面中的压缩数据，先把压缩数据复制出来
+  static thread_local vector<char> compressed;
+  const char *compressed_data = reinterpret_cast<const char *>(&page) + sizeof(header);
+  compressed.assign(compressed_data, compressed_data + header.compressed_size);
+
+  const int size =
+      compressor_->decompress(compressed.data(), header.compressed_size, reinterpret_cast<char *>(&page), page_size_);
+  if (size != page_size_) {
+    LOG_ERROR("Failed to decompress page %s:%d. compressed size=%d, decompressed size=%d",
+              file_name_.c_str(), page_num, header.compressed_size, size);
+    return RC::IOERR_READ;
+  }
+  return RC::SUCCESS;
+}
+
 int DiskBufferPool::file_desc() const { return file_desc_; }
 
 ////////////////////////////////////////////////////////////////////////////////
-BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */)
+BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */, int frame_shard_num /* = 1 */,
+    const char *frame_replacer /* = nullptr */, const char *page_io_engine /* = nullptr */,
+    const char *frame_memory /* = nullptr */, const char *frame_numa /* = nullptr */, int64_t max_memory_size /* = 0 */,
+    int page_size /* = 0 */)
+    : page_size_(bp_valid_page_size(page_size) ? page_size : BP_PAGE_SIZE),
+      frame_manager_("BufPool", page_size_),
+      frame_shard_num_(frame_shard_num),
+      frame_replacer_(frame_replacer == nullptr ? "" : frame_replacer),
+      frame_memory_(frame_memory == nullptr ? "" : frame_memory),
+      frame_numa_(frame_numa == nullptr ? "" : frame_numa)
 {
+  if (page_size > 0 && page_size != page_size_) {
+    LOG_WARN("invalid page size %d, use %d instead", page_size, page_size_);
+  }
+
+  io_engine_ = PageIoEngine::create(page_io_engine);
+  if (!io_engine_) {
+    LOG_WARN("failed to create page io engine %s, use sync io engine", page_io_engine);
+    io_engine_ = make_unique<SyncPageIoEngine>();
+  }
+
   if (memory_size <= 0) {
     memory_size = MEM_POOL_ITEM_NUM * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE;
   }
-  const int pool_num = max(memory_size / BP_PAGE_SIZE / DEFAULT_ITEM_NUM_PER_POOL, 1);
-  frame_manager_.init(pool_num);
-  LOG_INFO("buffer pool manager init with memory size %d, page num: %d, pool num: %d",
-           memory_size, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num);
+  if (max_memory_size <= 0) {
+    max_memory_size = static_cast<int64_t>(memory_size) * DEFAULT_MAX_MEMORY_RATIO;
+  }
+  const int pool_num     = max(memory_size / page_size_ / DEFAULT_ITEM_NUM_PER_POOL, 1);
+  const int max_pool_num = static_cast<int>(max_memory_size / page_size_ / DEFAULT_ITEM_NUM_PER_POOL);
+  RC rc = frame_manager_.init(pool_num, frame_shard_num, frame_replacer, frame_memory, frame_numa, max_pool_num);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init frame manager, use default frame memory. rc=%s", strrc(rc));
+    frame_manager_.init(pool_num, frame_shard_num, frame_replacer, nullptr, nullptr, max_pool_num);
+  }
+  LOG_INFO("buffer pool manager init with memory size %d, page size: %d, page num: %d, pool num: %d, "
+           "max pool num: %d, frame shard num: %d, io engine: %s",
+           memory_size, page_size_, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num, frame_manager_.max_pool_num(),
+           frame_manager_.shard_num(), io_engine_->name());
 }
 
 BufferPoolManager::~BufferPoolManager()
 {
+  page_cleaner_.stop();
+
   unordered_map<string, DiskBufferPool *> tmp_bps;
   tmp_bps.swap(buffer_pools_);
 
   for (auto &iter : tmp_bps) {
     delete iter.second;
   }
+
+  prefetcher_.stop();
 }
 
-RC BufferPoolManager::init(unique_ptr<DoubleWriteBuffer> dblwr_buffer)
+RC BufferPoolManager::init(unique_ptr<DoubleWriteBuffer> dblwr_buffer, int prefetch_depth /* = 0 */,
+    int dirty_high_watermark /* = 0 */, int dirty_low_watermark /* = 0 */)
 {
   dblwr_buffer_ = std::move(dblwr_buffer);
+
+  RC rc = prefetcher_.init(prefetch_depth);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init prefetcher. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = page_cleaner_.init(dirty_high_watermark, dirty_low_watermark);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init page cleaner. rc=%s", strrc(rc));
+    return rc;
+  }
   return RC::SUCCESS;
 }
 
-RC BufferPoolManager::create_file(const char *file_name)
+RC BufferPoolManager::create_file(
+    const char *file_name, int page_size /* = 0 */, PageCompression compression /* = PageCompression::NONE */)
 {
+  if (page_size <= 0) {
+    page_size = page_size_;
+  } else if (!bp_valid_page_size(page_size)) {
+    LOG_WARN("invalid page size. file=%s, page size=%d", file_name, page_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (compression != PageCompression::NONE && PageCompressor::get(compression) == nullptr) {
+    LOG_WARN("invalid page compression. file=%s, compression=%d", file_name, static_cast<int>(compression));
+    return RC::INVALID_ARGUMENT;
+  }
+
   int fd = open(file_name, O_RDWR | O_CREAT | O_EXCL, S_IREAD | S_IWRITE);
   if (fd < 0) {
     LOG_ERROR("Failed to create %s, due to %s.", file_name, strerror(errno));
@@ -811,12 +1446,14 @@ RC BufferPoolManager::create_file(const char *file_name)
     return RC::IOERR_ACCESS;
   }
 
-  Page page;
-  memset(&page, 0, BP_PAGE_SIZE);
+  vector<char> page_buf(page_size, 0);
+  Page        &page = *reinterpret_cast<Page *>(page_buf.data());
 
   BPFileHeader *file_header    = (BPFileHeader *)page.data;
   file_header->allocated_pages = 1;
   file_header->page_count      = 1;
+  file_header->page_size       = page_size;
+  file_header->compression     = static_cast<int32_t>(compression);
   file_header->buffer_pool_id  = next_buffer_pool_id_.fetch_add(1);
 
   char *bitmap = file_header->bitmap;
@@ -827,14 +1464,15 @@ RC BufferPoolManager::create_file(const char *file_name)
     return RC::IOERR_SEEK;
   }
 
-  if (writen(fd, (char *)&page, BP_PAGE_SIZE) != 0) {
+  if (writen(fd, page_buf.data(), page_size) != 0) {
     LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strerror(errno));
     close(fd);
     return RC::IOERR_WRITE;
   }
 
   close(fd);
-  LOG_INFO("Successfully create %s.", file_name);
+  LOG_INFO("Successfully create %s. page size=%d, compression=%s",
+           file_name, page_size, page_compression_to_string(compression));
   return RC::SUCCESS;
 }
 
@@ -848,7 +1486,7 @@ RC BufferPoolManager::open_file(LogHandler &log_handler, const char *_file_name,
     return RC::BUFFERPOOL_OPEN;
   }
 
-  DiskBufferPool *bp = new DiskBufferPool(*this, frame_manager_, *dblwr_buffer_, log_handler);
+  DiskBufferPool *bp = new DiskBufferPool(*this, *dblwr_buffer_, log_handler);
   RC              rc = bp->open_file(_file_name);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to open file name");
@@ -890,6 +1528,12 @@ RC BufferPoolManager::close_file(const char *_file_name)
   return RC::SUCCESS;
 }
 
+void BufferPoolManager::mark_closing(DiskBufferPool &bp)
+{
+  scoped_lock lock_guard(lock_);
+  bp.closing_.store(true, memory_order_release);
+}
+
 RC BufferPoolManager::flush_page(Frame &frame)
 {
   int buffer_pool_id = frame.buffer_pool_id();
@@ -905,6 +1549,110 @@ RC BufferPoolManager::flush_page(Frame &frame)
   return bp->flush_page(frame);
 }
 
+RC BufferPoolManager::resize(int64_t memory_size)
+{
+  const int64_t pool_size = static_cast<int64_t>(page_size_) * DEFAULT_ITEM_NUM_PER_POOL;
+  const int64_t pool_num  = memory_size / pool_size;
+  if (pool_num <= 0 || pool_num > frame_manager_.max_pool_num()) {
+    LOG_WARN("invalid buffer pool memory size. memory size=%ld, max memory size=%ld", memory_size, max_memory_size());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  auto flusher = [this](Frame *frame) { return frame->dirty() ? flush_page(*frame) : RC::SUCCESS; };
+  RC   rc      = frame_manager_.resize(static_cast<int>(pool_num), flusher);
+  LOG_INFO("resize buffer pool. memory size=%ld, current memory size=%ld, rc=%s",
+           memory_size, this->memory_size(), strrc(rc));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  scoped_lock lock_guard(frame_managers_lock_);
+  for (auto &[page_size, frame_manager] : sized_frame_managers_) {
+    int sized_num = sized_pool_num(memory_size, page_size);
+    sized_num     = min(max(sized_num, frame_manager->shard_num()), frame_manager->max_pool_num());
+    if (sized_num == frame_manager->pool_num()) {
+      continue;
+    }
+
+    rc = frame_manager->resize(sized_num, flusher);
+    LOG_INFO("resize frame manager for page size %d. pool num=%d, rc=%s",
+             page_size, frame_manager->pool_num(), strrc(rc));
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+int BufferPoolManager::sized_pool_num(int64_t memory_size, int page_size)
+{
+  const int64_t pool_size = static_cast<int64_t>(page_size) * DEFAULT_ITEM_NUM_PER_POOL;
+  return static_cast<int>(max(memory_size / SIZED_FRAME_MEMORY_DIVISOR / pool_size, (int64_t)1));
+}
+
+int64_t BufferPoolManager::memory_size() const
+{
+  return static_cast<int64_t>(frame_manager_.pool_num()) * DEFAULT_ITEM_NUM_PER_POOL * page_size_;
+}
+
+int64_t BufferPoolManager::max_memory_size() const
+{
+  return static_cast<int64_t>(frame_manager_.max_pool_num()) * DEFAULT_ITEM_NUM_PER_POOL * page_size_;
+}
+
+RC BufferPoolManager::get_frame_manager(int page_size, BPFrameManager *&frame_manager)
+{
+  frame_manager = nullptr;
+  if (!bp_valid_page_size(page_size)) {
+    LOG_WARN("invalid page size %d", page_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (page_size == page_size_) {
+    frame_manager = &frame_manager_;
+    return RC::SUCCESS;
+  }
+
+  scoped_lock lock_guard(frame_managers_lock_);
+  auto        iter = sized_frame_managers_.find(page_size);
+  if (iter != sized_frame_managers_.end()) {
+    frame_manager = iter->second.get();
+    return RC::SUCCESS;
+  }
+
+  // 最大内存与默认页帧管理器保持相同的比例，这样调整默认页帧管理器的内存时可以一起调整
+  const int    pool_num     = sized_pool_num(memory_size(), page_size);
+  const int    max_pool_num = sized_pool_num(max_memory_size(), page_size);
+  const string tag          = "BufPool" + to_string(page_size / 1024) + "K";
+
+  auto sized_frame_manager = make_unique<BPFrameManager>(tag.c_str(), page_size);
+  RC   rc                  = sized_frame_manager->init(pool_num, frame_shard_num_, frame_replacer_.c_str(),
+      frame_memory_.c_str(), frame_numa_.c_str(), max_pool_num);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init frame manager, use default frame memory. page size=%d, rc=%s", page_size, strrc(rc));
+    rc = sized_frame_manager->init(pool_num, frame_shard_num_, frame_replacer_.c_str(), nullptr, nullptr, max_pool_num);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("failed to init frame manager. page size=%d, rc=%s", page_size, strrc(rc));
+      return rc;
+    }
+  }
+
+  LOG_INFO("create frame manager for page size %d. pool num=%d", page_size, pool_num);
+  frame_manager = sized_frame_manager.get();
+  sized_frame_managers_.emplace(page_size, std::move(sized_frame_manager));
+  return RC::SUCCESS;
+}
+
+void BufferPoolManager::foreach_frame_manager(const function<void(BPFrameManager &)> &func)
+{
+  func(frame_manager_);
+
+  scoped_lock lock_guard(frame_managers_lock_);
+  for (auto &[page_size, frame_manager] : sized_frame_managers_) {
+    func(*frame_manager);
+  }
+}
+
 RC BufferPoolManager::get_buffer_pool(int32_t id, DiskBufferPool *&bp)
 {
   bp = nullptr;
@@ -921,3 +1669,11 @@ RC BufferPoolManager::get_buffer_pool(int32_t id, DiskBufferPool *&bp)
   return RC::SUCCESS;
 }
 
+void BufferPoolManager::foreach_buffer_pool(const function<void(DiskBufferPool &)> &func)
+{
+  scoped_lock lock_guard(lock_);
+  for (auto &[id, bp] : id_to_buffer_pools_) {
+    func(*bp);
+  }
+}
+
@@ -25,16 +25,24 @@ See the Mulan PSL v2 for more details. */
 #include <time.h>
 #include <optional>
 
+#include "common/lang/atomic.h"
 #include "common/lang/bitmap.h"
-#include "common/lang/lru_cache.h"
+#include "common/lang/map.h"
 #include "common/lang/mutex.h"
 #include "common/lang/memory.h"
 #include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
 #include "common/mm/mem_pool.h"
 #include "common/sys/rc.h"
 #include "common/types.h"
+#include "storage/buffer/buffer_pool_prefetcher.h"
 #include "storage/buffer/frame.h"
+#include "storage/buffer/frame_arena.h"
+#include "storage/buffer/frame_replacer.h"
+#include "storage/buffer/page_cleaner.h"
 #include "storage/buffer/page.h"
+#include "storage/buffer/page_compressor.h"
+#include "storage/buffer/page_io_engine.h"
 #include "storage/buffer/buffer_pool_log.h"
 
 class BufferPoolManager;
@@ -66,12 +74,15 @@ struct BPFileHeader
   int32_t buffer_pool_id;   //! buffer pool id
   int32_t page_count;       //! 当前文件一共有多少个页面
   int32_t allocated_pages;  //! 已经分配了多少个页面
+  int32_t page_size;        //! 文件中每个页面的大小，包括当前页面
+  int32_t compression;      //! 页面压缩算法，参考 PageCompression。当前页面不压缩
   char    bitmap[0];        //! 页面分配位图, 第0个页面(就是当前页面)，总是1
 
   /**
    * 能够分配的最大的页面个数，即bitmap的字节数 乘以8
    */
-  static const int MAX_PAGE_NUM = (BP_PAGE_DATA_SIZE - sizeof(page_count) - sizeof(allocated_pages)) * 8;
+  static int max_page_num(int page_size) { return (bp_page_data_size(page_size) - sizeof(BPFileHeader)) * 8; }
+  int        max_page_num() const { return max_page_num(page_size); }
 
   string to_string() const;
 };
@@ -83,23 +94,86 @@ struct BPFileHeader
  * 当内存中的页帧不够用时，需要从内存中淘汰一些页帧，以便为新的页帧腾出空间。
  * 这个管理器负责为所有的BufferPool提供页帧管理服务，也就是所有的BufferPool磁盘文件
  * 在访问时都使用这个管理器映射到内存。
+ *
+ * 为了降低多线程访问时的锁冲突，页帧管理器可以划分为多个分片(shard)。每个页帧根据 FrameId
+ * 的哈希值落在某个分片上，每个分片有自己的锁、淘汰策略和页帧分配器，不同分片之间的访问互不影响。
+ * 分片个数为1时，与没有分片的行为完全一致。
+ *
+ * 一个页帧管理器中的页面大小都相同，不同页面大小的文件使用不同的页帧管理器，参考 BufferPoolManager。
+ *
+ * 所有分片的页帧都来自同一块连续的内存(FrameArena)，可以配置使用大页和NUMA策略。
+ * 这块内存按照内存池(每个 DEFAULT_ITEM_NUM_PER_POOL 个页帧)轮流分给各个分片，
+ * 运行时可以通过 resize 增加或者减少内存池的个数。
  */
 class BPFrameManager
 {
 public:
-  BPFrameManager(const char *tag);
+  /**
+   * @brief 页帧管理器的统计信息
+   * @details 只做计数，不加锁，读取时各个计数之间不保证是同一时刻的值
+   */
+  struct Stats
+  {
+    atomic<int64_t> hits{0};       ///< 页面已经在内存中
+    atomic<int64_t> misses{0};     ///< 页面不在内存中，分配了新的页帧
+    atomic<int64_t> evictions{0};  ///< 为了分配新的页帧，淘汰的页帧个数
+    atomic<int64_t> pin_waits{0};  ///< 没有空闲页帧，并且所有页帧都被固定，分配页帧的线程只能等待重试
+  };
+
+  /**
+   * @brief 某个文件在内存中的页帧情况
+   */
+  struct Residency
+  {
+    int frames = 0;  ///< 在内存中的页帧个数
+    int dirty  = 0;  ///< 脏页帧个数
+    int pinned = 0;  ///< 被固定的页帧个数
+  };
+
+public:
+  /**
+   * @param tag 名字，用于日志
+   * @param page_size 页帧的页面大小
+   */
+  BPFrameManager(const char *tag, int page_size = BP_PAGE_SIZE);
 
-  RC init(int pool_num);
+  /**
+   * @brief 初始化页帧管理器
+   *
+   * @param pool_num  页帧内存池的个数，每个内存池包含 DEFAULT_ITEM_NUM_PER_POOL 个页帧
+   * @param shard_num 分片个数。内存池会平均分配给各个分片，所以分片个数不会超过内存池个数
+   * @param replacer  页帧淘汰策略的名字，参考 FrameReplacer::create
+   * @param memory_mode 页帧内存使用的页面类型，参考 FrameArena
+   * @param numa_policy 页帧内存的NUMA策略，参考 FrameArena
+   * @param max_pool_num 运行时最多可以扩展到多少个内存池，小于 pool_num 时不能扩展
+   */
+  RC init(int pool_num, int shard_num = 1, const char *replacer = nullptr, const char *memory_mode = nullptr,
+      const char *numa_policy = nullptr, int max_pool_num = 0);
   RC cleanup();
 
+  /**
+   * @brief 在线调整内存池的个数
+   * @details 扩展时在 FrameArena 中构造新的页帧，并添加到对应分片的分配器中。
+   * 缩小时从最后一个内存池开始逐个移除：先在分片的锁外刷新其中的脏页，再在分片的锁内淘汰它的所有页帧，
+   * 最后释放页帧占用的内存。内存池中有被固定的页帧时等待一会儿再重试，
+   * 一直无法淘汰时返回 RC::LOCKED_CONCURRENCY_CONFLICT，已经移除的内存池不会再恢复。
+   * @param pool_num 新的内存池个数，不能小于分片个数，也不能超过 max_pool_num
+   * @param flusher 刷新脏页的函数，调用时页帧已经被固定，但是没有持有任何分片的锁
+   */
+  RC resize(int pool_num, function<RC(Frame *frame)> flusher);
+
+  int pool_num() const { return pool_num_.load(); }
+  int max_pool_num() const { return static_cast<int>(arena_.max_frame_num() / DEFAULT_ITEM_NUM_PER_POOL); }
+
   /**
    * @brief 获取指定的页面
    *
    * @param buffer_pool_id buffer Pool标识
    * @param page_num  页面号
+   * @param hint 访问提示，参考 BufferAccessHint
    * @return Frame* 页帧指针
    */
-  Frame *get(int buffer_pool_id, PageNum page_num);
+  Frame *get(int buffer_pool_id, PageNum page_num, BufferAccessHint hint = BufferAccessHint::NORMAL);
 
   /**
    * @brief 列出所有指定文件的页面
@@ -111,12 +185,16 @@ public:
 
   /**
    * @brief 分配一个新的页面
-   *
+   * @details 页帧从指定页面所在的分片中分配。即使其它分片还有空闲的页帧，当前分片没有空闲页帧时也会返回空
    * @param buffer_pool_id buffer Pool标识
    * @param page_num 页面编号
+   * @param hint 访问提示，参考 BufferAccessHint
+   * @param for_prefetch 是否是预读线程分配的页帧。预读的页帧在对其它线程可见之前，会先加上写锁并设置预读标记，
+   *        页面数据加载完成之前，其它线程即使拿到了这个页帧，也要等待写锁释放才能访问页面数据
    * @return Frame* 页帧指针
    */
-  Frame *alloc(int buffer_pool_id, PageNum page_num);
+  Frame *alloc(int buffer_pool_id, PageNum page_num, BufferAccessHint hint = BufferAccessHint::NORMAL,
+      bool for_prefetch = false);
 
   /**
    * 尽管frame中已经包含了buffer_pool_id和page_num，但是依然要求
@@ -124,25 +202,55 @@ public:
    */
   RC free(int buffer_pool_id, PageNum page_num, Frame *frame);
 
+  /**
+   * @brief 与 free 相同，但是页帧还被其它线程固定时不释放
+   * @details 调用方自己固定了一次页帧。乐观读(参考 Frame::optimistic_read_begin)的线程只固定页面不加锁，
+   * 即使调用方持有页面的写锁，其它线程也可能固定着这个页帧
+   * @return 页帧还被其它线程固定时返回 RC::LOCKED_CONCURRENCY_CONFLICT
+   */
+  RC try_free(int buffer_pool_id, PageNum page_num, Frame *frame);
+
   /**
    * 如果不能从空闲链表中分配新的页面，就使用这个接口，
    * 尝试从pin count=0的页面中淘汰一些
+   * @param frame_id 需要分配页帧的页面。只会淘汰这个页面所在分片中的页帧
    * @param count 想要purge多少个页面
    * @param purger 需要在释放frame之前，对页面做些什么操作。当前是刷新脏数据到磁盘
    * @return 返回本次清理了多少个页面
    */
-  int purge_frames(int count, function<RC(Frame *frame)> purger);
+  int purge_frames(const FrameId &frame_id, int count, function<RC(Frame *frame)> purger);
+
+  size_t frame_num() const;
+
+  /**
+   * @brief 列出所有的脏页帧
+   * @details 只返回页帧的标识和页面的LSN，不会固定(pin)页帧，使用时需要重新获取页帧
+   */
+  void dirty_frames(vector<pair<LSN, FrameId>> &frames);
+
+  /**
+   * @brief 列出所有的页帧
+   * @details 与 dirty_frames 一样，不会固定(pin)页帧
+   */
+  void all_frames(vector<FrameId> &frames);
 
-  size_t frame_num() const { return frames_.count(); }
+  /**
+   * @brief 按照 buffer pool id 统计内存中的页帧
+   * @details 依次对每个分片加锁统计，不会固定(pin)页帧
+   */
+  void residency(unordered_map<int32_t, Residency> &result);
 
   /**
    * 测试使用。返回已经从内存申请的个数
    */
-  size_t total_frame_num() const { return allocator_.get_size(); }
+  size_t total_frame_num() const;
 
-private:
-  Frame *get_internal(const FrameId &frame_id);
-  RC     free_internal(const FrameId &frame_id, Frame *frame);
+  int shard_num() const { return static_cast<int>(shards_.size()); }
+  int page_size() const { return arena_.page_size(); }
+
+  const FrameArena &arena() const { return arena_; }
+
+  Stats &stats() { return stats_; }
 
 private:
   class BPFrameIdHasher
@@ -151,12 +259,49 @@ private:
     size_t operator()(const FrameId &frame_id) const { return frame_id.hash(); }
   };
 
-  using FrameLruCache  = common::LruCache<FrameId, Frame *, BPFrameIdHasher>;
-  using FrameAllocator = common::MemPoolSimple<Frame>;
+  using FrameMap = unordered_map<FrameId, Frame *, BPFrameIdHasher>;
+
+  /**
+   * @brief 页帧管理器的一个分片
+   * @details 分片之间没有任何共享的数据，每个分片的数据都由自己的锁保护。
+   * 页帧的查找使用哈希表，淘汰顺序由淘汰策略(FrameReplacer)决定。
+   */
+  class FrameShard
+  {
+  public:
+    FrameShard(unique_ptr<FrameReplacer> replacer) : replacer_(std::move(replacer)) {}
+
+    /**
+     * @brief 查找并固定页帧，找到时记录一次访问
+     * @details 淘汰策略支持无锁访问时，找到页帧后会先释放 lock 再记录访问，没有找到时不会释放
+     */
+    Frame *get_internal(const FrameId &frame_id, BufferAccessHint hint, unique_lock<mutex> &lock);
+    RC     free_internal(const FrameId &frame_id, Frame *frame);
+
+  public:
+    mutex                     lock_;
+    FrameMap                  frames_;
+    unique_ptr<FrameReplacer> replacer_;
+    FramePool                 allocator_;
+  };
+
+  FrameShard &shard_of(const FrameId &frame_id);
+
+  /// 内存池 pool_index 所在的分片
+  FrameShard &shard_of_pool(int pool_index) { return *shards_[pool_index % shards_.size()]; }
 
-  mutex          lock_;
-  FrameLruCache  frames_;
-  FrameAllocator allocator_;
+  /**
+   * @brief 淘汰分片中最后一个内存池的所有页帧，并从分配器中移除这个内存池
+   */
+  RC drain_last_pool(FrameShard &shard, const function<RC(Frame *frame)> &flusher);
+
+private:
+  string                         tag_;
+  FrameArena                     arena_;  ///< 需要在分片之后析构
+  vector<unique_ptr<FrameShard>> shards_;
+  atomic<int>                    pool_num_{0};
+  mutex                          resize_lock_;  ///< 同一时间只有一个线程调整内存池的个数
+  Stats                          stats_;
 };
 
 /**
@@ -174,9 +319,18 @@ public:
   PageNum next();
   RC      reset();
 
+  /**
+   * @brief 预读当前位置之后的页面
+   * @details 根据页面分配位图跳过没有分配的页面，最多预读 BufferPoolPrefetcher::depth 个页面。
+   * 已经请求过预读的页面不会重复请求。顺序扫描时，每次调用 next 之后调用一次即可。
+   */
+  void prefetch();
+
 private:
-  common::Bitmap bitmap_;
-  PageNum        current_page_num_ = -1;
+  DiskBufferPool *buffer_pool_ = nullptr;
+  common::Bitmap  bitmap_;
+  PageNum         current_page_num_  = -1;
+  PageNum         prefetch_page_num_ = -1;  ///< 已经请求预读的最大页面编号
 };
 
 /**
@@ -188,12 +342,27 @@ private:
 class DiskBufferPool final
 {
 public:
-  DiskBufferPool(BufferPoolManager &bp_manager, BPFrameManager &frame_manager, DoubleWriteBuffer &dblwr_manager,
-      LogHandler &log_handler);
+  /**
+   * @brief 单个文件的访问统计
+   */
+  struct Stats
+  {
+    atomic<int64_t> hits{0};     ///< 获取页面时页面已经在内存中
+    atomic<int64_t> misses{0};   ///< 获取页面时需要从磁盘(或double write buffer)加载
+    atomic<int64_t> flushes{0};  ///< 刷新到double write buffer的页面个数
+
+    atomic<int64_t> compressed_writes{0};  ///< 压缩后写入文件的页面个数
+    atomic<int64_t> compressed_bytes{0};   ///< 压缩的页面实际写入的字节数，包括对齐填充的部分
+    atomic<int64_t> raw_writes{0};         ///< 压缩文件中因为压缩效果不好而原样写入的页面个数
+  };
+
+public:
+  DiskBufferPool(BufferPoolManager &bp_manager, DoubleWriteBuffer &dblwr_manager, LogHandler &log_handler);
   ~DiskBufferPool();
 
   /**
    * 根据文件名打开一个分页文件
+   * @details 按照文件头中记录的页面大小，从 BufferPoolManager 获取对应的页帧管理器
    */
   RC open_file(const char *file_name);
 
@@ -204,8 +373,26 @@ public:
 
   /**
    * 根据文件ID和页号获取指定页面到缓冲区，返回页面句柄指针。
+   * @param hint 访问提示。全表扫描等顺序访问的场景应该使用 BufferAccessHint::SEQUENTIAL，
+   *             避免把其它会话的热点页面挤出内存
+   */
+  RC get_this_page(PageNum page_num, Frame **frame, BufferAccessHint hint = BufferAccessHint::NORMAL);
+
+  /**
+   * @brief 请求后台线程预读指定的页面
+   * @details 只是提交一个请求，不会等待页面加载完成。没有开启预读时什么也不做
+   */
+  void prefetch(PageNum page_num);
+
+  /**
+   * @brief 将指定的一批页面加载到内存中，但是不固定(pin)这些页面
+   * @details 由预读线程调用。已经在内存中或者无效的页面会被跳过，其余页面的读请求一起提交给 PageIoEngine。
+   * 只在分配页帧时持有 buffer pool 的锁，等待读请求完成时不持有
+   * @param loaded 实际从磁盘加载的页面个数
    */
-  RC get_this_page(PageNum page_num, Frame **frame);
+  RC prefetch_pages(span<const PageNum> page_nums, int &loaded);
+
+  BufferPoolPrefetcher &prefetcher();
 
   /**
    * @brief 在指定文件中分配一个新的页面，并将其放入缓冲区，返回页面句柄指针。
@@ -216,6 +403,8 @@ public:
 
   /**
    * @brief 释放某个页面，将此页面设置为未分配状态
+   * @details 页面还被其它线程固定时会等待它们释放，等待一定次数后仍未释放就返回
+   * LOCKED_CONCURRENCY_CONFLICT，页面保持已分配状态。调用前调用者自己必须已经释放了这个页面
    *
    * @param page_num 待释放的页面
    */
@@ -250,6 +439,13 @@ public:
    */
   RC flush_page(Frame &frame);
 
+  /**
+   * @brief 只有页面是脏页时才刷新到double write buffer
+   * @details 在 buffer pool 的锁内检查页面是否是脏页。文件头页面是在这个锁内修改的，不会漏掉正在进行的修改
+   * @return 页面不是脏页时返回 RC::NOT_EXIST
+   */
+  RC flush_dirty_page(Frame &frame);
+
   /**
    * 刷新所有页面到double write buffer，即使pin count不是0
    */
@@ -265,6 +461,14 @@ public:
    */
   RC write_page(PageNum page_num, Page &page);
 
+  /**
+   * @brief 生成将页面写到当前文件的IO请求
+   * @details 用于把多个页面的写请求一起提交给 PageIoEngine，效果与 write_page 相同。
+   * 压缩文件的页面会先压缩到 buffer 中，IO请求指向 buffer，请求完成之前 buffer 需要一直有效。
+   * 页面中压缩之后不再使用的部分，在这里就打洞释放了，与后面的写请求不重叠
+   */
+  PageIoRequest make_write_request(PageNum page_num, Page &page, vector<char> &buffer);
+
   RC redo_allocate_page(LSN lsn, PageNum page_num);
   RC redo_deallocate_page(LSN lsn, PageNum page_num);
 
@@ -273,8 +477,39 @@ public:
 
   const char *filename() const { return file_name_.c_str(); }
 
+  /**
+   * @brief 是否正在关闭
+   * @details 关闭时先在 BufferPoolManager 的锁内设置，刷脏线程等后台线程看到这个标记后就不再访问这个 buffer pool
+   */
+  bool closing() const { return closing_.load(memory_order_acquire); }
+
+  BufferPoolManager &bp_manager() { return bp_manager_; }
+
+  /// 文件中页面的大小，打开文件之后才有效
+  int page_size() const { return page_size_; }
+  /// 页面中可以存放数据的大小
+  int page_data_size() const { return bp_page_data_size(page_size_); }
+
+  /// 页面压缩算法，打开文件之后才有效
+  PageCompression compression() const
+  {
+    return file_header_ == nullptr ? PageCompression::NONE : static_cast<PageCompression>(file_header_->compression);
+  }
+
+  BPFrameManager &frame_manager() { return *frame_manager_; }
+
+  /**
+   * @brief 文件中的页面个数和已经分配的页面个数
+   * @details 不加锁读取，只能作为参考，比如展示统计信息、确定空闲空间表的查找范围
+   */
+  int32_t page_count() const { return file_header_ == nullptr ? 0 : file_header_->page_count; }
+  int32_t allocated_pages() const { return file_header_ == nullptr ? 0 : file_header_->allocated_pages; }
+
+  Stats &stats() { return stats_; }
+
 protected:
-  RC allocate_frame(PageNum page_num, Frame **buf);
+  RC allocate_frame(PageNum page_num, Frame **buf, BufferAccessHint hint = BufferAccessHint::NORMAL,
+      bool for_prefetch = false);
 
   /**
    * 刷新指定页面到磁盘(flush)，并且释放关联的Frame
@@ -282,23 +517,38 @@ protected:
   RC purge_frame(PageNum page_num, Frame *used_frame);
   RC check_page_num(PageNum page_num);
 
+  /**
+   * @brief 等待预读线程加载页面完成
+   * @details 预读线程加载页面时持有写锁，这里加一次读锁等待加载结束
+   * @return 加载失败时返回 IOERR_READ，页面中的数据不能使用
+   */
+  RC wait_for_loading(Frame *frame);
+
   /**
    * 加载指定页面的数据到内存中
    */
   RC load_page(PageNum page_num, Frame *frame);
 
+  /**
+   * @brief 从磁盘读取页面之后，如果页面是压缩过的，就原地解压
+   * @details 没有压缩的文件，或者压缩文件中原样写入的页面，什么都不做
+   */
+  RC decompress_page(PageNum page_num, Page &page);
+
   /**
    * 如果页面是脏的，就将数据刷新到磁盘
    */
   RC flush_page_internal(Frame &frame);
 
 private:
-  BufferPoolManager   &bp_manager_;     /// BufferPool 管理器
-  BPFrameManager      &frame_manager_;  /// Frame 管理器
-  DoubleWriteBuffer   &dblwr_manager_;  /// Double Write Buffer 管理器
-  BufferPoolLogHandler log_handler_;    /// BufferPool 日志处理器
-
-  int file_desc_ = -1;  /// 文件描述符
+  BufferPoolManager   &bp_manager_;               /// BufferPool 管理器
+  BPFrameManager      *frame_manager_ = nullptr;  /// Frame 管理器，与文件的页面大小对应
+  DoubleWriteBuffer   &dblwr_manager_;            /// Double Write Buffer 管理器
+  BufferPoolLogHandler log_handler_;              /// BufferPool 日志处理器
+
+  int                   file_desc_  = -1;       /// 文件描述符
+  int                   page_size_  = 0;        /// 页面大小，记录在文件头中
+  const PageCompressor *compressor_ = nullptr;  /// 页面压缩算法，不压缩时为空
   /// 由于在最开始打开文件时，没有正确的buffer pool id不能加载header frame，所以单独从文件中读取此标识
   int32_t       buffer_pool_id_ = -1;
   Frame        *hdr_frame_      = nullptr;  /// 文件头页面
@@ -307,11 +557,15 @@ private:
 
   string file_name_;  /// 文件名
 
+  atomic<bool> closing_{false};  /// 正在关闭，参考 closing()
+
   common::Mutex lock_;
-  common::Mutex wr_lock_;
+
+  Stats stats_;
 
 private:
   friend class BufferPoolIterator;
+  friend class BufferPoolManager;
 };
 
 /**
@@ -321,19 +575,93 @@ private:
 class BufferPoolManager final
 {
 public:
-  BufferPoolManager(int memory_size = 0);
+  /// 没有指定最大内存时，最大内存是初始内存的多少倍
+  static constexpr int DEFAULT_MAX_MEMORY_RATIO = 4;
+  /// 非默认页面大小的页帧管理器使用的内存是默认页帧管理器的几分之一
+  static constexpr int SIZED_FRAME_MEMORY_DIVISOR = 4;
+
+public:
+  /**
+   * @param memory_size     用于缓存页面的内存大小，小于等于0时使用默认值
+   * @param frame_shard_num 页帧管理器的分片个数，参考 BPFrameManager
+   * @param frame_replacer  页帧淘汰策略，参考 FrameReplacer::create
+   * @param page_io_engine  页面IO引擎，参考 PageIoEngine::create
+   * @param frame_memory    页帧内存使用的页面类型，参考 FrameArena
+   * @param frame_numa      页帧内存的NUMA策略，参考 FrameArena
+   * @param max_memory_size 运行时最多可以扩展到多大的内存，小于等于0时是 memory_size 的 DEFAULT_MAX_MEMORY_RATIO 倍
+   * @param page_size       默认的页面大小，创建文件时没有指定页面大小就使用它，小于等于0时使用 BP_PAGE_SIZE
+   * @details 页面大小是文件的属性，不同页面大小的文件使用不同的页帧管理器：
+   * memory_size 是默认页面大小的页帧管理器使用的内存；打开其它页面大小的文件时，按需创建对应的页帧管理器，
+   * 内存是 memory_size 的 1/SIZED_FRAME_MEMORY_DIVISOR，至少一个内存池，参考 resize。
+   */
+  BufferPoolManager(int memory_size = 0, int frame_shard_num = 1, const char *frame_replacer = nullptr,
+      const char *page_io_engine = nullptr, const char *frame_memory = nullptr, const char *frame_numa = nullptr,
+      int64_t max_memory_size = 0, int page_size = 0);
   ~BufferPoolManager();
 
-  RC init(unique_ptr<DoubleWriteBuffer> dblwr_buffer);
+  /**
+   * @param dblwr_buffer         double write buffer
+   * @param prefetch_depth       顺序扫描时的预读深度，小于等于0时不预读，参考 BufferPoolPrefetcher
+   * @param dirty_high_watermark 脏页帧百分比的高水位，小于等于0时不启动后台刷脏，参考 PageCleaner
+   * @param dirty_low_watermark  脏页帧百分比的低水位
+   */
+  RC init(unique_ptr<DoubleWriteBuffer> dblwr_buffer, int prefetch_depth = 0, int dirty_high_watermark = 0,
+      int dirty_low_watermark = 0);
 
-  RC create_file(const char *file_name);
+  /**
+   * @brief 创建一个分页文件
+   * @param page_size   文件的页面大小，小于等于0时使用默认的页面大小，参考 bp_valid_page_size
+   * @param compression 页面的压缩算法，参考 CompressedPageHeader
+   */
+  RC create_file(const char *file_name, int page_size = 0, PageCompression compression = PageCompression::NONE);
   RC open_file(LogHandler &log_handler, const char *file_name, DiskBufferPool *&bp);
   RC close_file(const char *file_name);
 
+  /**
+   * @brief 将 buffer pool 标记为正在关闭
+   * @details DiskBufferPool::close_file 在等待后台线程之前调用。这时 buffer pool 还在管理器中，
+   * get_buffer_pool 仍然可以找到它，后台线程需要检查 DiskBufferPool::closing
+   */
+  void mark_closing(DiskBufferPool &bp);
+
   RC flush_page(Frame &frame);
 
-  BPFrameManager    &get_frame_manager() { return frame_manager_; }
-  DoubleWriteBuffer *get_dblwr_buffer() { return dblwr_buffer_.get(); }
+  /**
+   * @brief 在线调整缓存页面的内存大小
+   * @details 按照内存池的大小向下取整。缩小时会刷新并淘汰被移除的页帧，参考 BPFrameManager::resize。
+   * 其它页面大小的页帧管理器按比例调整为 memory_size 的 1/SIZED_FRAME_MEMORY_DIVISOR，
+   * 不超过它们各自的最大内存，任意一个调整失败都返回错误
+   * @param memory_size 新的内存大小，不能超过构造时指定的最大内存
+   */
+  RC resize(int64_t memory_size);
+
+  /// 当前用于缓存页面的内存大小，只包括默认页面大小的页帧管理器
+  int64_t memory_size() const;
+  int64_t max_memory_size() const;
+
+  /// 默认的页面大小
+  int page_size() const { return page_size_; }
+
+  /**
+   * @brief 默认页面大小的页帧管理器
+   */
+  BPFrameManager &get_frame_manager() { return frame_manager_; }
+
+  /**
+   * @brief 获取指定页面大小的页帧管理器，不存在时创建
+   * @return 页面大小无效时返回 RC::INVALID_ARGUMENT
+   */
+  RC get_frame_manager(int page_size, BPFrameManager *&frame_manager);
+
+  /**
+   * @brief 遍历所有的页帧管理器，第一个是默认页面大小的页帧管理器
+   */
+  void foreach_frame_manager(const function<void(BPFrameManager &)> &func);
+
+  DoubleWriteBuffer    *get_dblwr_buffer() { return dblwr_buffer_.get(); }
+  BufferPoolPrefetcher &get_prefetcher() { return prefetcher_; }
+  PageIoEngine         &get_io_engine() { return *io_engine_; }
+  PageCleaner          &get_page_cleaner() { return page_cleaner_; }
 
   /**
    * @brief 根据ID获取对应的BufferPool对象
@@ -343,10 +671,32 @@ public:
    */
   RC get_buffer_pool(int32_t id, DiskBufferPool *&bp);
 
+  /**
+   * @brief 遍历所有打开的BufferPool
+   * @details 遍历时持有管理器的锁，回调中不能打开或者关闭文件
+   */
+  void foreach_buffer_pool(const function<void(DiskBufferPool &)> &func);
+
 private:
-  BPFrameManager frame_manager_{"BufPool"};
+  /// 默认页帧管理器使用 memory_size 内存时，其它页面大小的页帧管理器的内存池个数
+  static int sized_pool_num(int64_t memory_size, int page_size);
 
+private:
+  int            page_size_ = BP_PAGE_SIZE;  ///< 需要在 frame_manager_ 之前初始化
+  BPFrameManager frame_manager_;
+
+  /// 其它页面大小的页帧管理器，创建之后不会删除。使用与默认页帧管理器相同的配置
+  common::Mutex                        frame_managers_lock_;
+  map<int, unique_ptr<BPFrameManager>> sized_frame_managers_;
+  int                                  frame_shard_num_ = 1;
+  string                               frame_replacer_;
+  string                               frame_memory_;
+  string                               frame_numa_;
+
+  unique_ptr<PageIoEngine>      io_engine_;
   unique_ptr<DoubleWriteBuffer> dblwr_buffer_;
+  BufferPoolPrefetcher          prefetcher_;
+  PageCleaner                   page_cleaner_{*this};
 
   common::Mutex                            lock_;
   unordered_map<string, DiskBufferPool *>  buffer_pools_;
@@ -16,43 +16,46 @@ See the Mulan PSL v2 for more details. */
 #include "storage/buffer/double_write_buffer.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "common/io/io.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
 #include "common/log/log.h"
 #include "common/math/crc.h"
 
 using namespace common;
 
-struct DoubleWritePage
+/**
+ * @brief double write buffer 中一个页面的描述信息，页面数据紧跟在后面
+ * @details 页面大小都是8的倍数，按照8字节对齐后，后面的页面也是对齐的
+ */
+struct alignas(8) DoubleWritePage
 {
-public:
-  DoubleWritePage() = default;
-  DoubleWritePage(int32_t buffer_pool_id, PageNum page_num, int32_t page_index, Page &page);
-
 public:
   DoubleWritePageKey key;
   int32_t            page_index = -1; /// 页面在double write buffer文件中的页索引
+  int32_t            page_size  = 0;  /// 页面的大小，不包括当前描述信息
   bool               valid = true; /// 表示页面是否有效，在页面被删除时，需要同时标记磁盘上的值。
-  Page               page;
-
-  static const int32_t SIZE;
-};
 
-DoubleWritePage::DoubleWritePage(int32_t buffer_pool_id, PageNum page_num, int32_t page_index, Page &_page)
-  : key{buffer_pool_id, page_num}, page_index(page_index), page(_page)
-{}
+  Page &page() { return *reinterpret_cast<Page *>(reinterpret_cast<char *>(this) + sizeof(DoubleWritePage)); }
 
-const int32_t DoubleWritePage::SIZE = sizeof(DoubleWritePage);
+  /// 描述信息与页面数据一共占用的空间
+  int64_t total_size() const { return static_cast<int64_t>(sizeof(DoubleWritePage)) + page_size; }
+};
 
 const int32_t DoubleWriteBufferHeader::SIZE = sizeof(DoubleWriteBufferHeader);
 
-DiskDoubleWriteBuffer::DiskDoubleWriteBuffer(BufferPoolManager &bp_manager, int max_pages /*=16*/) 
-  : max_pages_(max_pages), bp_manager_(bp_manager)
+DiskDoubleWriteBuffer::DiskDoubleWriteBuffer(BufferPoolManager &bp_manager, int max_pages /*=DEFAULT_MAX_PAGES*/)
+  : max_pages_(max(max_pages, 1)), bp_manager_(bp_manager)
 {
+  buffer_.resize(static_cast<size_t>(max_pages_) * (sizeof(DoubleWritePage) + BP_PAGE_SIZE));
 }
 
 DiskDoubleWriteBuffer::~DiskDoubleWriteBuffer()
 {
   flush_page();
   close(file_desc_);
+  LOG_INFO("double write buffer closed. batches=%ld, pages=%ld, bytes=%ld, fsyncs=%ld, flush time=%ldus",
+           stats_.batches.load(), stats_.pages.load(), stats_.bytes.load(), stats_.fsyncs.load(),
+           stats_.flush_us.load());
 }
 
 RC DiskDoubleWriteBuffer::open_file(const char *filename)
@@ -74,21 +77,100 @@ RC DiskDoubleWriteBuffer::open_file(const char *filename)
 
 RC DiskDoubleWriteBuffer::flush_page()
 {
-  sync();
+  scoped_lock lock_guard(lock_);
+  return flush_pages();
+}
+
+RC DiskDoubleWriteBuffer::flush_pages(DiskBufferPool *closing_bp /*= nullptr*/)
+{
+  if (dblwr_pages_.empty()) {
+    return RC::SUCCESS;
+  }
 
+  const auto    start_time = chrono::steady_clock::now();
+  const int32_t page_cnt   = static_cast<int32_t>(dblwr_pages_.size());
+  PageIoEngine &io_engine  = bp_manager_.get_io_engine();
+
+  // 页面在内存中是连续的，与文件头一起写入共享文件，只需要一次 fsync
+  header_.page_cnt = page_cnt;
+  const int64_t pages_size = buffer_size_;
+
+  PageIoRequest dblwr_requests[] = {
+      PageIoRequest::make_write(file_desc_, 0, &header_, DoubleWriteBufferHeader::SIZE),
+      PageIoRequest::make_write(file_desc_, DoubleWriteBufferHeader::SIZE, buffer_.data(), pages_size),
+  };
+  RC rc = io_engine.submit(dblwr_requests);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to write pages into double write buffer file. page count=%d, rc=%s", page_cnt, strrc(rc));
+    return rc;
+  }
+
+  if (fdatasync(file_desc_) != 0) {
+    LOG_ERROR("Failed to sync double write buffer file. error=%s", strerror(errno));
+    return RC::IOERR_SYNC;
+  }
+  stats_.fsyncs++;
+
+  // 按照文件和页面编号排序后写入各自的文件，尽量让写入是顺序的
+  vector<DoubleWritePage *> sorted_pages;
+  sorted_pages.reserve(page_cnt);
   for (const auto &pair : dblwr_pages_) {
-    RC rc = write_page(pair.second);
-    if (rc != RC::SUCCESS) {
+    sorted_pages.push_back(page_at(pair.second));
+  }
+  sort(sorted_pages.begin(), sorted_pages.end(), [](const DoubleWritePage *a, const DoubleWritePage *b) {
+    if (a->key.buffer_pool_id != b->key.buffer_pool_id) {
+      return a->key.buffer_pool_id < b->key.buffer_pool_id;
+    }
+    return a->key.page_num < b->key.page_num;
+  });
+
+  // 压缩文件的页面压缩到 write_buffers 中再写入，写入的长度可能比页面小
+  vector<PageIoRequest> requests(sorted_pages.size());
+  vector<vector<char>>  write_buffers(sorted_pages.size());
+  vector<int>           file_descs;
+  int64_t               write_bytes = 0;
+  for (size_t i = 0; i < sorted_pages.size(); i++) {
+    rc = make_write_request(sorted_pages[i], closing_bp, requests[i], write_buffers[i]);
+    if (OB_FAIL(rc)) {
       return rc;
     }
-    pair.second->valid = false;
-    write_page_internal(pair.second);
-    delete pair.second;
+    if (file_descs.empty() || file_descs.back() != requests[i].fd) {
+      file_descs.push_back(requests[i].fd);
+    }
+    write_bytes += requests[i].size;
+  }
+
+  rc = io_engine.submit(requests);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to write pages in double write buffer. page count=%d, rc=%s", page_cnt, strrc(rc));
+    return rc;
   }
 
+  for (int fd : file_descs) {
+    if (fdatasync(fd) != 0) {
+      LOG_ERROR("Failed to sync buffer pool file. fd=%d, error=%s", fd, strerror(errno));
+      return RC::IOERR_SYNC;
+    }
+    stats_.fsyncs++;
+  }
+
+  // 页面都已经写入了各自的文件，共享文件中的页面不再需要了
   dblwr_pages_.clear();
+  buffer_size_     = 0;
   header_.page_cnt = 0;
+  rc               = io_engine.write(file_desc_, 0, &header_, DoubleWriteBufferHeader::SIZE);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to invalidate pages in double write buffer. rc=%s", strrc(rc));
+  }
 
+  const auto flush_us =
+      chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start_time).count();
+  stats_.batches++;
+  stats_.pages += page_cnt;
+  stats_.bytes += pages_size + write_bytes;
+  stats_.flush_us += flush_us;
+  LOG_TRACE("double write buffer flushed %d pages to %d files in %ldus", page_cnt,
+            static_cast<int>(file_descs.size()), flush_us);
   return RC::SUCCESS;
 }
 
@@ -96,42 +178,28 @@ RC DiskDoubleWriteBuffer::add_page(DiskBufferPool *bp, PageNum page_num, Page &p
 {
   scoped_lock lock_guard(lock_);
   DoubleWritePageKey key{bp->id(), page_num};
-  auto iter = dblwr_pages_.find(key);
+  const int32_t page_size = bp->page_size();
+  auto          iter      = dblwr_pages_.find(key);
   if (iter != dblwr_pages_.end()) {
-    iter->second->page = page;
+    memcpy(&page_at(iter->second)->page(), &page, page_size);
     LOG_TRACE("[cache hit]add page into double write buffer. buffer_pool_id:%d,page_num:%d,lsn=%d, dwb size=%d",
               bp->id(), page_num, page.lsn, static_cast<int>(dblwr_pages_.size()));
-    return write_page_internal(iter->second);
+    return RC::SUCCESS;
   }
 
-  int64_t          page_cnt   = dblwr_pages_.size();
-  DoubleWritePage *dblwr_page = new DoubleWritePage(bp->id(), page_num, page_cnt, page);
-  dblwr_pages_.insert(pair<DoubleWritePageKey, DoubleWritePage *>(key, dblwr_page));
+  const int64_t    offset     = append_page(page_size);
+  DoubleWritePage *dblwr_page = page_at(offset);
+  dblwr_page->key             = key;
+  dblwr_page->page_index      = static_cast<int32_t>(dblwr_pages_.size());
+  dblwr_page->valid           = true;
+  memcpy(&dblwr_page->page(), &page, page_size);
+  dblwr_pages_.insert(pair<DoubleWritePageKey, int64_t>(key, offset));
   LOG_TRACE("insert page into double write buffer. buffer_pool_id:%d,page_num:%d,lsn=%d, dwb size:%d",
             bp->id(), page_num, page.lsn, static_cast<int>(dblwr_pages_.size()));
 
-  RC rc = write_page_internal(dblwr_page);
-  if (OB_FAIL(rc)) {
-    LOG_WARN("failed to write page into double write buffer. rc=%s buffer_pool_id:%d,page_num:%d,lsn=%d.",
-        strrc(rc), bp->id(), page_num, page.lsn);
-    return rc;
-  }
-
-  if (page_cnt + 1 > header_.page_cnt) {
-    header_.page_cnt = page_cnt + 1;
-    if (lseek(file_desc_, 0, SEEK_SET) == -1) {
-      LOG_ERROR("Failed to add page header due to failed to seek %s.", strerror(errno));
-      return RC::IOERR_SEEK;
-    }
-
-    if (writen(file_desc_, &header_, sizeof(header_)) != 0) {
-      LOG_ERROR("Failed to add page header due to %s.", strerror(errno));
-      return RC::IOERR_WRITE;
-    }
-  }
-
+  // 关闭 buffer pool 时刷新的页面也会加进来，这时已经不能从 BufferPoolManager 中找到它了
   if (static_cast<int>(dblwr_pages_.size()) >= max_pages_) {
-    RC rc = flush_page();
+    RC rc = flush_pages(bp);
     if (rc != RC::SUCCESS) {
       LOG_ERROR("Failed to flush pages in double write buffer");
       return rc;
@@ -141,39 +209,38 @@ RC DiskDoubleWriteBuffer::add_page(DiskBufferPool *bp, PageNum page_num, Page &p
   return RC::SUCCESS;
 }
 
-RC DiskDoubleWriteBuffer::write_page_internal(DoubleWritePage *page)
+DoubleWritePage *DiskDoubleWriteBuffer::page_at(int64_t offset)
 {
-  int32_t page_index = page->page_index;
-  int64_t offset = page_index * DoubleWritePage::SIZE + DoubleWriteBufferHeader::SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to add page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
-  }
+  return reinterpret_cast<DoubleWritePage *>(buffer_.data() + offset);
+}
 
-  if (writen(file_desc_, page, DoubleWritePage::SIZE) != 0) {
-    LOG_ERROR("Failed to add page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_WRITE;
+int64_t DiskDoubleWriteBuffer::append_page(int32_t page_size)
+{
+  const int64_t offset     = buffer_size_;
+  const int64_t total_size = static_cast<int64_t>(sizeof(DoubleWritePage)) + page_size;
+  if (static_cast<int64_t>(buffer_.size()) < offset + total_size) {
+    buffer_.resize(max(buffer_.size() * 2, static_cast<size_t>(offset + total_size)));
   }
 
-  return RC::SUCCESS;
+  buffer_size_ += total_size;
+  page_at(offset)->page_size = page_size;
+  return offset;
 }
 
-RC DiskDoubleWriteBuffer::write_page(DoubleWritePage *dblwr_page)
+RC DiskDoubleWriteBuffer::make_write_request(
+    DoubleWritePage *dblwr_page, DiskBufferPool *closing_bp, PageIoRequest &request, vector<char> &buffer)
 {
-  DiskBufferPool *disk_buffer = nullptr;
-  // skip invalid page
-  if (!dblwr_page->valid) {
-    LOG_TRACE("double write buffer write page invalid. buffer_pool_id:%d,page_num:%d,lsn=%d",
-              dblwr_page->key.buffer_pool_id, dblwr_page->key.page_num, dblwr_page->page.lsn);
-    return RC::SUCCESS;
+  DiskBufferPool *disk_buffer = closing_bp;
+  if (disk_buffer == nullptr || disk_buffer->id() != dblwr_page->key.buffer_pool_id) {
+    RC rc = bp_manager_.get_buffer_pool(dblwr_page->key.buffer_pool_id, disk_buffer);
+    ASSERT(OB_SUCC(rc) && disk_buffer != nullptr, "failed to get disk buffer pool of %d", dblwr_page->key.buffer_pool_id);
   }
-  RC rc = bp_manager_.get_buffer_pool(dblwr_page->key.buffer_pool_id, disk_buffer);
-  ASSERT(OB_SUCC(rc) && disk_buffer != nullptr, "failed to get disk buffer pool of %d", dblwr_page->key.buffer_pool_id);
 
   LOG_TRACE("double write buffer write page. buffer_pool_id:%d,page_num:%d,lsn=%d",
-            dblwr_page->key.buffer_pool_id, dblwr_page->key.page_num, dblwr_page->page.lsn);
+            dblwr_page->key.buffer_pool_id, dblwr_page->key.page_num, dblwr_page->page().lsn);
 
-  return disk_buffer->write_page(dblwr_page->key.page_num, dblwr_page->page);
+  request = disk_buffer->make_write_request(dblwr_page->key.page_num, dblwr_page->page(), buffer);
+  return RC::SUCCESS;
 }
 
 RC DiskDoubleWriteBuffer::read_page(DiskBufferPool *bp, PageNum page_num, Page &page)
@@ -182,7 +249,8 @@ RC DiskDoubleWriteBuffer::read_page(DiskBufferPool *bp, PageNum page_num, Page &
   DoubleWritePageKey key{bp->id(), page_num};
   auto iter = dblwr_pages_.find(key);
   if (iter != dblwr_pages_.end()) {
-    page = iter->second->page;
+    DoubleWritePage *dblwr_page = page_at(iter->second);
+    memcpy(&page, &dblwr_page->page(), dblwr_page->page_size);
     LOG_TRACE("double write buffer read page success. bp id=%d, page_num:%d, lsn:%d", bp->id(), page_num, page.lsn);
     return RC::SUCCESS;
   }
@@ -192,44 +260,11 @@ RC DiskDoubleWriteBuffer::read_page(DiskBufferPool *bp, PageNum page_num, Page &
 
 RC DiskDoubleWriteBuffer::clear_pages(DiskBufferPool *buffer_pool)
 {
-  vector<DoubleWritePage *> spec_pages;
-  
-  auto remove_pred = [&spec_pages, buffer_pool](const pair<DoubleWritePageKey, DoubleWritePage *> &pair) {
-    DoubleWritePage *dbl_page = pair.second;
-    if (buffer_pool->id() == dbl_page->key.buffer_pool_id) {
-      spec_pages.push_back(dbl_page);
-      return true;
-    }
-    return false;
-  };
-
-  lock_.lock();
-  erase_if(dblwr_pages_, remove_pred);
-  lock_.unlock();
-
-  LOG_INFO("clear pages in double write buffer. file name=%s, page count=%d",
-           buffer_pool->filename(), spec_pages.size());
-
-  // 页面从小到大排序，防止出现小页面还没有写入，而页面编号更大的seek失败的情况
-  sort(spec_pages.begin(), spec_pages.end(), [](DoubleWritePage *a, DoubleWritePage *b) {
-    return a->key.page_num < b->key.page_num;
-  });
-
-  RC rc = RC::SUCCESS;
-  for (DoubleWritePage *dbl_page : spec_pages) {
-    rc = buffer_pool->write_page(dbl_page->key.page_num, dbl_page->page);
-    if (OB_FAIL(rc)) {
-      LOG_WARN("Failed to write page %s:%d to disk buffer pool. rc=%s",
-               buffer_pool->filename(), dbl_page->key.page_num, strrc(rc));
-      break;
-    }
-    dbl_page->valid = false;
-    write_page_internal(dbl_page);
-  }
-
-  for_each(spec_pages.begin(), spec_pages.end(), [](DoubleWritePage *dbl_page) { delete dbl_page; });
-
-  return RC::SUCCESS;
+  // 页面在共享文件中是连续存放的，不能只删除一部分，所以把所有页面都刷新掉
+  scoped_lock lock_guard(lock_);
+  RC          rc = flush_pages(buffer_pool);
+  LOG_INFO("clear pages in double write buffer. file name=%s, rc=%s", buffer_pool->filename(), strrc(rc));
+  return rc;
 }
 
 RC DiskDoubleWriteBuffer::load_pages()
@@ -256,31 +291,51 @@ RC DiskDoubleWriteBuffer::load_pages()
     return RC::IOERR_READ;
   }
 
+  // 页面是一个接一个存放的，需要先读取描述信息才知道页面的大小
+  int64_t file_offset = DoubleWriteBufferHeader::SIZE;
   for (int page_num = 0; page_num < header_.page_cnt; page_num++) {
-    int64_t offset = ((int64_t)page_num) * DoubleWritePage::SIZE + DoubleWriteBufferHeader::SIZE;
-
-    if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-      LOG_ERROR("Failed to load page %d, offset=%ld, due to failed to lseek:%s.", page_num, offset, strerror(errno));
+    if (lseek(file_desc_, file_offset, SEEK_SET) == -1) {
+      LOG_ERROR("Failed to load page %d, offset=%ld, due to failed to lseek:%s.", page_num, file_offset, strerror(errno));
       return RC::IOERR_SEEK;
     }
 
-    auto dblwr_page = make_unique<DoubleWritePage>();
-    Page &page     = dblwr_page->page;
-    page.check_sum = (CheckSum)-1;
+    DoubleWritePage page_header;
+    ret = readn(file_desc_, &page_header, sizeof(page_header));
+    if (ret != 0) {
+      LOG_ERROR("Failed to load page, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
+                file_desc_, page_num, strerror(errno), ret, page_num);
+      return RC::IOERR_READ;
+    }
+
+    // 描述信息本身写坏了，后面的页面位置都不可信
+    if (!bp_valid_page_size(page_header.page_size)) {
+      LOG_WARN("got a page with an invalid page size, ignore the rest pages. page num=%d, page size=%d",
+               page_num, page_header.page_size);
+      break;
+    }
+
+    const int64_t    offset     = append_page(page_header.page_size);
+    DoubleWritePage *dblwr_page = page_at(offset);
+    *dblwr_page                 = page_header;
+    Page &page                  = dblwr_page->page();
+    page.check_sum              = (CheckSum)-1;
 
-    ret = readn(file_desc_, dblwr_page.get(), DoubleWritePage::SIZE);
+    ret = readn(file_desc_, &page, page_header.page_size);
     if (ret != 0) {
       LOG_ERROR("Failed to load page, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
                 file_desc_, page_num, strerror(errno), ret, page_num);
       return RC::IOERR_READ;
     }
+    file_offset += dblwr_page->total_size();
 
-    const CheckSum check_sum = crc32(page.data, BP_PAGE_DATA_SIZE);
-    if (check_sum == page.check_sum) {
-      DoubleWritePageKey key = dblwr_page->key;
-      dblwr_pages_.insert(pair<DoubleWritePageKey, DoubleWritePage *>(key, dblwr_page.release()));
+    const CheckSum check_sum = crc32(page.data, bp_page_data_size(page_header.page_size));
+    if (check_sum == page.check_sum && dblwr_page->valid) {
+      // 有效的页面在内存中依然连续存放
+      dblwr_page->page_index = static_cast<int32_t>(dblwr_pages_.size());
+      dblwr_pages_.insert(pair<DoubleWritePageKey, int64_t>(dblwr_page->key, offset));
     } else {
       LOG_TRACE("got a page with an invalid checksum. on disk:%d, in memory:%d", page.check_sum, check_sum);
+      buffer_size_ = offset;
     }
   }
 
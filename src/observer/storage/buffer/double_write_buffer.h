@@ -14,11 +14,15 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/atomic.h"
+#include "common/lang/memory.h"
 #include "common/lang/mutex.h"
 #include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
 #include "common/types.h"
 #include "common/sys/rc.h"
 #include "storage/buffer/page.h"
+#include "storage/buffer/page_io_engine.h"
 
 class DiskBufferPool;
 struct DoubleWritePage;
@@ -80,18 +84,41 @@ struct DoubleWritePageKeyHash
  * 当我们从磁盘中读取页面时，会校验页面的checksum，如果校验失败，则说明页面写入不完整，这时候可以从
  * DoubleWriteBuffer中读取数据。
  *
+ * 页面加入缓冲区时只保存在内存中，攒够一批后再一起刷新。不同文件的页面大小可能不同，
+ * 每个页面前面有一个 DoubleWritePage 记录页面属于哪个文件以及页面的大小：
+ * 1. 这批页面在内存中是连续存放的，与文件头一起写入共享文件的连续区域，然后只做一次 fsync；
+ * 2. 按照 (buffer_pool_id, page_num) 排序后批量写入各自的文件，尽量让写入是顺序的，再 fsync 这些文件；
+ * 3. 将文件头中的页面个数清零，表示这批页面都已经写入了。
+ * 还没有写入共享文件的页面，对应的日志已经落盘(刷新页面前会等待日志)，异常重启后可以通过日志恢复。
+ *
  * @note 每次都要保证，不管在内存中还是在文件中，这里的数据都是最新的，都比Buffer pool中的数据要新
  */
 class DiskDoubleWriteBuffer : public DoubleWriteBuffer
 {
 public:
+  /**
+   * @brief 刷新的统计信息
+   */
+  struct Stats
+  {
+    atomic<int64_t> batches{0};   ///< 刷新了多少批页面
+    atomic<int64_t> pages{0};     ///< 刷新的页面个数
+    atomic<int64_t> bytes{0};     ///< 写入的字节数，包括共享文件与页面所在的文件
+    atomic<int64_t> fsyncs{0};    ///< fsync 的次数
+    atomic<int64_t> flush_us{0};  ///< 刷新花费的时间(微秒)
+  };
+
+public:
+  /// 默认一批刷新的页面个数
+  static constexpr int DEFAULT_MAX_PAGES = 128;
+
   /**
    * @brief 构造函数
    *
    * @param bp_manager 关联的buffer pool manager
-   * @param max_pages  内存中保存的最大页面数
+   * @param max_pages  内存中保存的最大页面数，也是一批刷新的页面个数
    */
-  DiskDoubleWriteBuffer(BufferPoolManager &bp_manager, int max_pages = 16);
+  DiskDoubleWriteBuffer(BufferPoolManager &bp_manager, int max_pages = DEFAULT_MAX_PAGES);
   virtual ~DiskDoubleWriteBuffer();
 
   /**
@@ -101,12 +128,11 @@ public:
 
   /**
    * 将buffer中的页全部写入磁盘，并且清空buffer
-   * TODO 目前的解决方案是等buffer装满后再刷盘，可能会导致程序卡住一段时间
    */
   RC flush_page();
 
   /**
-   * 将页面加入buffer，并且写入磁盘中的共享表空间
+   * 将页面加入buffer，buffer满了以后一起写入磁盘
    */
   RC add_page(DiskBufferPool *bp, PageNum page_num, Page &page) override;
 
@@ -114,6 +140,7 @@ public:
 
   /**
    * @brief 清空所有与指定buffer pool关联的页面
+   * @details 关闭 buffer pool 时调用，会刷新 buffer 中所有的页面
    */
   RC clear_pages(DiskBufferPool *bp) override;
 
@@ -122,18 +149,31 @@ public:
    */
   RC recover();
 
+  Stats &stats() { return stats_; }
+
 private:
   /**
-   * 将buffer中的页面写入对应的磁盘
+   * @brief 刷新 buffer 中所有的页面，调用时需要持有锁
+   * @param closing_bp 正在关闭的 buffer pool，已经不能从 BufferPoolManager 中找到它了
    */
-  RC write_page(DoubleWritePage *page);
+  RC flush_pages(DiskBufferPool *closing_bp = nullptr);
 
   /**
-   * 将页面写到当前double write buffer文件中
-   * @details 每次页面更新都应该写入到磁盘中。保证double write buffer
-   * 内存和文件中的数据都是最新的。
+   * 生成将页面写入对应磁盘文件的IO请求
+   * @param buffer 页面需要压缩时存放压缩后的数据，参考 DiskBufferPool::make_write_request
    */
-  RC write_page_internal(DoubleWritePage *page);
+  RC make_write_request(
+      DoubleWritePage *page, DiskBufferPool *closing_bp, PageIoRequest &request, vector<char> &buffer);
+
+  /**
+   * 内存中指定偏移位置的页面，偏移加上文件头的大小就是页面在double write buffer文件中的偏移量
+   */
+  DoubleWritePage *page_at(int64_t offset);
+
+  /**
+   * @brief 在内存中追加一个页面，返回它的偏移位置
+   */
+  int64_t append_page(int32_t page_size);
 
   /**
    * @brief 将磁盘文件中的内容加载到内存中。在启动时调用
@@ -147,7 +187,14 @@ private:
   BufferPoolManager      &bp_manager_;
   DoubleWriteBufferHeader header_;
 
-  unordered_map<DoubleWritePageKey, DoubleWritePage *, DoubleWritePageKeyHash> dblwr_pages_;
+  /// 页面在内存中连续存放，与在共享文件中的布局相同，刷新时可以一次写入
+  vector<char> buffer_;
+  int64_t      buffer_size_ = 0;  ///< buffer_ 中已经使用的大小
+
+  /// 页面在 buffer_ 中的偏移位置。buffer_ 扩展时页面的地址会变，所以不保存指针
+  unordered_map<DoubleWritePageKey, int64_t, DoubleWritePageKeyHash> dblwr_pages_;
+
+  Stats stats_;
 };
 
 class VacuousDoubleWriteBuffer : public DoubleWriteBuffer
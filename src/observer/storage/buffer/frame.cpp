@@ -76,6 +76,12 @@ void Frame::write_latch(intptr_t xid)
 
   lock_.lock();
 
+  if (write_depth_++ == 0) {
+    // 先把版本号改成奇数，再修改页面。fence 保证修改页面的操作不会重排到修改版本号之前
+    version_.fetch_add(1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+  }
+
 #ifdef DEBUG
   write_locker_ = xid;
   ++write_recursive_count_;
@@ -110,6 +116,10 @@ void Frame::write_unlatch(intptr_t xid)
   }
   debug_lock_.unlock();
 
+  if (--write_depth_ == 0) {
+    version_.fetch_add(1, memory_order_release);
+  }
+
   lock_.unlock();
 }
 
@@ -208,6 +218,19 @@ void Frame::read_unlatch(intptr_t xid)
   lock_.unlock_shared();
 }
 
+bool Frame::optimistic_read_begin(uint64_t &version) const
+{
+  version = version_.load(memory_order_acquire);
+  return (version & 1) == 0;
+}
+
+bool Frame::optimistic_read_validate(uint64_t version) const
+{
+  // 读取页面的操作不能重排到读取版本号之后
+  atomic_thread_fence(memory_order_acquire);
+  return version_.load(memory_order_relaxed) == version;
+}
+
 void Frame::pin()
 {
   scoped_lock debug_lock(debug_lock_);
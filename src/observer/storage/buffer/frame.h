@@ -71,14 +71,24 @@ public:
   }
 
   /**
-   * @brief reinit 和 reset 在 MemPoolSimple 中使用
-   * @details 在 MemPoolSimple 分配和释放一个Frame对象时，不会调用构造函数和析构函数，
+   * @brief reinit 和 reset 在 FramePool 中使用
+   * @details 在 FramePool 分配和释放一个Frame对象时，不会调用构造函数和析构函数，
    * 而是调用reinit和reset。
    */
   void reinit() {}
   void reset() {}
 
-  void clear_page() { memset(&page_, 0, sizeof(page_)); }
+  /**
+   * @brief 设置页帧使用的页面内存
+   * @details 页面内存由 FrameArena 分配，页帧构造之后设置一次，不会再改变
+   */
+  void set_page(Page *page, int page_size)
+  {
+    page_      = page;
+    page_size_ = page_size;
+  }
+
+  void clear_page() { memset(page_, 0, page_size_); }
 
   int  buffer_pool_id() const { return frame_id_.buffer_pool_id(); }
   void set_buffer_pool_id(int id) { frame_id_.set_buffer_pool_id(id); }
@@ -88,7 +98,12 @@ public:
    * @details 磁盘文件划分为一个个页面，每次从磁盘加载到内存中，也是一个页面，就是 Page。
    * frame 是为了管理这些页面而维护的一个数据结构。
    */
-  Page &page() { return page_; }
+  Page &page() { return *page_; }
+
+  /// 页面的大小，同一个页帧管理器中的页帧大小相同
+  int page_size() const { return page_size_; }
+  /// 页面中数据部分的大小
+  int data_size() const { return bp_page_data_size(page_size_); }
 
   /**
    * @brief 每个页面都有一个编号
@@ -103,15 +118,15 @@ public:
    * @details 如果当前页面从磁盘中加载出来时，它的日志序列号比当前WAL(Write-Ahead-Logging)中的一些
    * 序列号要小，那就可以从日志中读取这些更大序列号的日志，做重做操作，将页面恢复到最新状态，也就是redo。
    */
-  LSN  lsn() const { return page_.lsn; }
-  void set_lsn(LSN lsn) { page_.lsn = lsn; }
+  LSN  lsn() const { return page_->lsn; }
+  void set_lsn(LSN lsn) { page_->lsn = lsn; }
 
   /**
    * @brief 页面校验和
    * @details 用于校验页面完整性。如果页面写入一半时出现异常，可以通过校验和检测出来。
    */
-  CheckSum check_sum() const { return page_.check_sum; }
-  void     set_check_sum(CheckSum check_sum) { page_.check_sum = check_sum; }
+  CheckSum check_sum() const { return page_->check_sum; }
+  void     set_check_sum(CheckSum check_sum) { page_->check_sum = check_sum; }
 
   /**
    * @brief 刷新当前内存页面的访问时间
@@ -121,21 +136,44 @@ public:
    */
   void access();
 
+  /**
+   * @brief 页面淘汰算法使用的访问标记
+   * @details 比如CLOCK算法，访问页面时只需要设置这个标记，不需要像LRU一样调整链表。
+   * 参考 ClockFrameReplacer
+   */
+  void set_referenced(bool referenced) { referenced_.store(referenced, memory_order_relaxed); }
+  bool referenced() const { return referenced_.load(memory_order_relaxed); }
+
+  /**
+   * @brief 页面是否由预读线程加载并且还没有被访问过，用来统计预读的命中率
+   * @details clear_prefetched 返回清理之前的值
+   */
+  void set_prefetched(bool prefetched) { prefetched_.store(prefetched, memory_order_relaxed); }
+  bool clear_prefetched() { return prefetched_.exchange(false, memory_order_relaxed); }
+
+  /**
+   * @brief 预读线程是否还没有成功加载页面
+   * @details 预读线程分配页帧时设置，加着写锁读取页面，成功之后清除标记再释放写锁。
+   * 加载失败时保留这个标记，其它线程拿到锁之后检查标记，就知道页面中的数据不可用
+   */
+  void set_loading(bool loading) { loading_.store(loading, memory_order_release); }
+  bool loading() const { return loading_.load(memory_order_acquire); }
+
   /**
    * @brief 标记指定页面为“脏”页。
    * @details 如果修改了页面的内容，则应调用此函数，
    * 以便该页面被淘汰出缓冲区时系统将新的页面数据写入磁盘文件
    */
-  void mark_dirty() { dirty_ = true; }
+  void mark_dirty() { dirty_.store(true, memory_order_relaxed); }
 
   /**
    * @brief 重置“脏”标记
    * @details 如果页面已经被写入磁盘文件，则应调用此函数。
    */
-  void clear_dirty() { dirty_ = false; }
-  bool dirty() const { return dirty_; }
+  void clear_dirty() { dirty_.store(false, memory_order_relaxed); }
+  bool dirty() const { return dirty_.load(memory_order_relaxed); }
 
-  char *data() { return page_.data; }
+  char *data() { return page_->data; }
 
   bool can_purge() { return pin_count_.load() == 0; }
 
@@ -166,16 +204,41 @@ public:
   void read_unlatch();
   void read_unlatch(intptr_t xid);
 
+  /**
+   * @brief 开始一次乐观读
+   * @details 乐观读不加页面的读锁，只需要固定(pin)页帧，读取页面内容之后再调用 optimistic_read_validate
+   * 检查读取期间页面有没有被修改过，读到的内容只有在检查通过之后才能使用。
+   * 页帧有一个版本号，加写锁和释放写锁时各加1，所以版本号是奇数时表示有线程正在修改页面(seqlock)。
+   * 读取期间页面可能正在被修改，读到的数据可能是不一致的，使用时不能因为数据异常而访问页面以外的内存。
+   * @param[out] version 当前的版本号，用于之后的检查
+   * @return 有线程持有写锁时返回false，这时应该改用读锁
+   */
+  bool optimistic_read_begin(uint64_t &version) const;
+
+  /**
+   * @brief 检查乐观读期间页面有没有被修改过
+   * @param version optimistic_read_begin 返回的版本号
+   */
+  bool optimistic_read_validate(uint64_t version) const;
+
   string to_string() const;
 
 private:
   friend class BufferPool;
 
-  bool          dirty_ = false;
+  atomic<bool>  dirty_{false};  ///< 后台刷脏线程会在不加锁的情况下检查
   atomic<int>   pin_count_{0};
   unsigned long acc_time_ = 0;
+  atomic<bool>  referenced_{false};
+  atomic<bool>  prefetched_{false};
+  atomic<bool>  loading_{false};
   FrameId       frame_id_;
-  Page          page_;
+  Page         *page_      = nullptr;
+  int           page_size_ = 0;
+
+  /// 乐观读使用的版本号，只在最外层的加写锁和释放写锁时修改。页帧重新分配时不会重置
+  atomic<uint64_t> version_{0};
+  int              write_depth_ = 0;  ///< 写锁的重入次数，由写锁保护
 
   /// 在非并发编译时，加锁解锁动作将什么都不做
   common::RecursiveSharedMutex lock_;
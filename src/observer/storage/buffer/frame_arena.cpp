@@ -0,0 +1,371 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <sanitizer/asan_interface.h>
+
+#if defined(__linux__) && __has_include(<linux/mempolicy.h>)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#define MINIOB_HAVE_MBIND 1
+#endif
+
+#include "storage/buffer/frame_arena.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/fstream.h"
+#include "common/lang/new.h"
+#include "common/log/log.h"
+
+/// MAP_HUGETLB 使用系统默认的大页，通常是2M。默认大页是1G时 mmap 会失败，退化成透明大页
+static constexpr size_t HUGE_PAGE_SIZE = 2UL * 1024 * 1024;
+
+static size_t align_up(size_t size, size_t align) { return (size + align - 1) / align * align; }
+
+FrameArena::~FrameArena() { cleanup(); }
+
+RC FrameArena::init(size_t frame_num, const char *memory_mode /* = nullptr */, const char *numa_policy /* = nullptr */,
+    size_t max_frame_num /* = 0 */)
+{
+  if (memory_ != nullptr) {
+    LOG_WARN("frame arena has been initialized");
+    return RC::INTERNAL;
+  }
+
+  if (frame_num == 0 || !bp_valid_page_size(page_size_)) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  bool huge_page = false;
+  if (nullptr == memory_mode || common::is_blank(memory_mode) || 0 == strcasecmp(memory_mode, "normal")) {
+    huge_page = false;
+  } else if (0 == strcasecmp(memory_mode, "huge_page")) {
+    huge_page = true;
+  } else {
+    LOG_WARN("unknown frame memory mode: %s", memory_mode);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 策略格式为 policy[:nodes]
+  string      policy;
+  vector<int> nodes;
+  if (numa_policy != nullptr && !common::is_blank(numa_policy)) {
+    string str(numa_policy);
+    size_t pos = str.find(':');
+    policy     = str.substr(0, pos);
+    common::strip(policy);
+    common::str_to_lower(policy);
+    if (pos != string::npos && OB_FAIL(parse_nodes(str.c_str() + pos + 1, nodes))) {
+      LOG_WARN("invalid numa nodes: %s", numa_policy);
+      return RC::INVALID_ARGUMENT;
+    }
+
+    if (policy == "none") {
+      policy.clear();
+    } else if ((policy != "interleave" && policy != "bind") || (policy == "bind" && nodes.empty())) {
+      LOG_WARN("invalid numa policy: %s", numa_policy);
+      return RC::INVALID_ARGUMENT;
+    }
+  }
+
+  // 按照最大页帧个数预留地址空间
+  max_frame_num = max(frame_num, max_frame_num);
+
+  // 页帧对象和页面内存各自按照内存页面对齐，释放一部分页帧的物理内存时不会影响另一块区域
+  const size_t sys_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t align         = huge_page ? HUGE_PAGE_SIZE : sys_page_size;
+  const size_t frames_size   = align_up(max_frame_num * sizeof(Frame), align);
+  const size_t pages_size    = align_up(max_frame_num * page_size_, align);
+
+  page_type_     = PageType::NORMAL;
+  sys_page_size_ = sys_page_size;
+  size_          = frames_size + pages_size;
+  if (huge_page) {
+#ifdef MAP_HUGETLB
+    memory_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory_ == MAP_FAILED) {
+      LOG_INFO("failed to mmap with MAP_HUGETLB, try transparent huge page. size=%ld, error=%s", size_, strerror(errno));
+      memory_ = nullptr;
+    } else {
+      page_type_     = PageType::HUGETLB;
+      sys_page_size_ = HUGE_PAGE_SIZE;
+    }
+#endif
+  }
+
+  if (memory_ == nullptr) {
+    // 预留的内存在访问之前不会分配物理页面，不需要计入 overcommit
+    memory_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory_ == MAP_FAILED) {
+      LOG_ERROR("failed to mmap frame arena. size=%ld, error=%s", size_, strerror(errno));
+      memory_ = nullptr;
+      size_   = 0;
+      return RC::NOMEM;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (huge_page) {
+      if (0 == madvise(memory_, size_, MADV_HUGEPAGE)) {
+        page_type_ = PageType::TRANSPARENT;
+      } else {
+        LOG_WARN("failed to enable transparent huge page, use normal pages. error=%s", strerror(errno));
+      }
+    }
+#endif
+  }
+
+  // 构造页帧之前设置NUMA策略，这时内存还没有分配物理页面
+  if (!policy.empty()) {
+    apply_numa_policy(policy, nodes);
+  }
+
+  frames_        = static_cast<Frame *>(memory_);
+  pages_         = static_cast<char *>(memory_) + frames_size;
+  frame_num_     = 0;
+  max_frame_num_ = max_frame_num;
+  RC rc          = resize(frame_num);
+  if (OB_FAIL(rc)) {
+    cleanup();
+    return rc;
+  }
+
+  LOG_INFO("frame arena init done. frame num=%ld, max frame num=%ld, page size=%d, memory size=%ld, page type=%s, "
+           "numa policy=%s, numa applied=%d",
+           frame_num_, max_frame_num_, page_size_, size_, page_type_name(), policy.empty() ? "none" : numa_policy,
+           numa_applied_);
+  return RC::SUCCESS;
+}
+
+RC FrameArena::resize(size_t frame_num)
+{
+  if (frame_num > max_frame_num_) {
+    LOG_WARN("frame num exceeds the max frame num of arena. frame num=%ld, max frame num=%ld", frame_num, max_frame_num_);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  for (size_t i = frame_num_; i < frame_num; i++) {
+    Frame *frame = new (&frames_[i]) Frame();
+    frame->set_page(reinterpret_cast<Page *>(pages_ + i * page_size_), page_size_);
+  }
+
+  if (frame_num < frame_num_) {
+    // 空闲的页帧在 ASAN 中标记为不可访问，析构之前恢复
+    ASAN_UNPOISON_MEMORY_REGION(&frames_[frame_num], (frame_num_ - frame_num) * sizeof(Frame));
+    for (size_t i = frame_num; i < frame_num_; i++) {
+      frames_[i].~Frame();
+    }
+
+    release_memory(reinterpret_cast<char *>(frames_), frame_num * sizeof(Frame), frame_num_ * sizeof(Frame));
+    release_memory(pages_, frame_num * page_size_, frame_num_ * page_size_);
+  }
+
+  frame_num_ = frame_num;
+  return RC::SUCCESS;
+}
+
+void FrameArena::cleanup()
+{
+  if (memory_ == nullptr) {
+    return;
+  }
+
+  // 空闲的页帧在 ASAN 中标记为不可访问，析构之前恢复
+  ASAN_UNPOISON_MEMORY_REGION(memory_, size_);
+  for (size_t i = 0; i < frame_num_; i++) {
+    frames_[i].~Frame();
+  }
+
+  munmap(memory_, size_);
+  memory_        = nullptr;
+  size_          = 0;
+  frames_        = nullptr;
+  pages_         = nullptr;
+  frame_num_     = 0;
+  max_frame_num_ = 0;
+  sys_page_size_ = 0;
+  page_type_     = PageType::NORMAL;
+  numa_applied_  = false;
+}
+
+void FrameArena::release_memory(char *base, size_t begin_offset, size_t end_offset)
+{
+  // 只能释放完整的内存页面，与剩余页帧共用的内存页面保留
+  char *begin = base + align_up(begin_offset, sys_page_size_);
+  char *end   = base + align_up(end_offset, sys_page_size_);
+  if (begin < end && 0 != madvise(begin, end - begin, MADV_DONTNEED)) {
+    LOG_WARN("failed to release frame memory. size=%ld, error=%s", end - begin, strerror(errno));
+  }
+}
+
+const char *FrameArena::page_type_name() const
+{
+  switch (page_type_) {
+    case PageType::NORMAL: return "normal";
+    case PageType::HUGETLB: return "hugetlb";
+    case PageType::TRANSPARENT: return "transparent";
+  }
+  return "unknown";
+}
+
+RC FrameArena::parse_nodes(const char *str, vector<int> &nodes)
+{
+  nodes.clear();
+
+  vector<string> parts;
+  common::split_string(str, ",", parts);
+  for (string &part : parts) {
+    common::strip(part);
+    if (part.empty()) {
+      continue;
+    }
+
+    int  begin = 0;
+    int  end   = 0;
+    char extra = 0;
+    if (sscanf(part.c_str(), "%d-%d%c", &begin, &end, &extra) == 2) {
+      // 节点范围
+    } else if (sscanf(part.c_str(), "%d%c", &begin, &extra) == 1) {
+      end = begin;
+    } else {
+      return RC::INVALID_ARGUMENT;
+    }
+
+    if (begin < 0 || end < begin) {
+      return RC::INVALID_ARGUMENT;
+    }
+    for (int node = begin; node <= end; node++) {
+      nodes.push_back(node);
+    }
+  }
+  return RC::SUCCESS;
+}
+
+#ifdef MINIOB_HAVE_MBIND
+
+void FrameArena::apply_numa_policy(const string &policy, const vector<int> &nodes)
+{
+  vector<int> policy_nodes = nodes;
+  if (policy_nodes.empty()) {
+    ifstream ifs("/sys/devices/system/node/online");
+    string   online;
+    if (!getline(ifs, online) || OB_FAIL(parse_nodes(online.c_str(), policy_nodes)) || policy_nodes.empty()) {
+      LOG_WARN("failed to get online numa nodes, ignore numa policy %s", policy.c_str());
+      return;
+    }
+  }
+
+  constexpr int         bits_per_mask = sizeof(unsigned long) * 8;
+  const int             max_node      = *max_element(policy_nodes.begin(), policy_nodes.end());
+  vector<unsigned long> node_mask(max_node / bits_per_mask + 1, 0);
+  for (int node : policy_nodes) {
+    node_mask[node / bits_per_mask] |= 1UL << (node % bits_per_mask);
+  }
+
+  const int  mode = (policy == "bind") ? MPOL_BIND : MPOL_INTERLEAVE;
+  const long ret  = syscall(__NR_mbind, memory_, size_, mode, node_mask.data(), node_mask.size() * bits_per_mask + 1, 0);
+  if (ret != 0) {
+    LOG_WARN("failed to set numa policy, ignore it. policy=%s, max node=%d, error=%s",
+             policy.c_str(), max_node, strerror(errno));
+    return;
+  }
+
+  numa_applied_ = true;
+}
+
+#else  // MINIOB_HAVE_MBIND
+
+void FrameArena::apply_numa_policy(const string &policy, const vector<int> &nodes)
+{
+  LOG_WARN("numa policy is not supported on this platform, ignore it. policy=%s", policy.c_str());
+}
+
+#endif  // MINIOB_HAVE_MBIND
+
+////////////////////////////////////////////////////////////////////////////////
+void FramePool::init(Frame *frames, size_t frame_num)
+{
+  chunks_.clear();
+  free_frames_.clear();
+  frame_num_ = 0;
+  add_chunk(frames, frame_num);
+}
+
+void FramePool::add_chunk(Frame *frames, size_t frame_num)
+{
+  ASSERT(chunks_.empty() || chunks_.back().first + chunks_.back().second <= frames,
+         "frame chunk should be added in address order");
+
+  chunks_.emplace_back(frames, frame_num);
+  frame_num_ += frame_num;
+
+  // 新的页帧放在空闲链表的底部，从后往前放，这样先分配的是地址小的页帧
+  vector<Frame *> free_frames;
+  free_frames.reserve(free_frames_.size() + frame_num);
+  for (size_t i = frame_num; i > 0; i--) {
+    Frame *frame = frames + i - 1;
+    free_frames.push_back(frame);
+    ASAN_POISON_MEMORY_REGION(frame, sizeof(Frame));
+  }
+  free_frames.insert(free_frames.end(), free_frames_.begin(), free_frames_.end());
+  free_frames_.swap(free_frames);
+}
+
+RC FramePool::remove_last_chunk()
+{
+  if (chunks_.empty()) {
+    return RC::NOT_EXIST;
+  }
+
+  auto [frames, frame_num] = chunks_.back();
+  auto in_chunk            = [frames, frame_num](Frame *frame) { return frame >= frames && frame < frames + frame_num; };
+  if (static_cast<size_t>(count_if(free_frames_.begin(), free_frames_.end(), in_chunk)) != frame_num) {
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  free_frames_.erase(remove_if(free_frames_.begin(), free_frames_.end(), in_chunk), free_frames_.end());
+  chunks_.pop_back();
+  frame_num_ -= frame_num;
+  return RC::SUCCESS;
+}
+
+Frame *FramePool::alloc()
+{
+  if (free_frames_.empty()) {
+    return nullptr;
+  }
+
+  Frame *frame = free_frames_.back();
+  free_frames_.pop_back();
+  ASAN_UNPOISON_MEMORY_REGION(frame, sizeof(Frame));
+  frame->reinit();
+  return frame;
+}
+
+void FramePool::free(Frame *frame)
+{
+  // 块按照地址排序，找到起始地址不大于页帧的最后一个块
+  auto iter = upper_bound(chunks_.begin(), chunks_.end(), frame,
+      [](Frame *frame, const pair<Frame *, size_t> &chunk) { return frame < chunk.first; });
+  if (iter == chunks_.begin() || frame >= (iter - 1)->first + (iter - 1)->second) {
+    LOG_WARN("frame %p does not belong to this pool. chunk num=%ld, frame num=%ld", frame, chunks_.size(), frame_num_);
+    return;
+  }
+
+  frame->reset();
+  ASAN_POISON_MEMORY_REGION(frame, sizeof(Frame));
+  free_frames_.push_back(frame);
+}
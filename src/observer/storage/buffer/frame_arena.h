@@ -0,0 +1,171 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/lang/utility.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "storage/buffer/frame.h"
+
+/**
+ * @brief 页帧使用的一整块内存
+ * @ingroup BufferPool
+ * @details 所有的页帧都放在一次 mmap 申请的连续内存中，由 BPFrameManager 切分给各个分片。
+ * 内存池很大时，使用普通的4K页面会占用大量的TLB，可以配置使用大页：
+ * - normal    普通页面(默认)
+ * - huge_page 先尝试 MAP_HUGETLB，需要系统预留大页(vm.nr_hugepages)；
+ *             失败时使用透明大页(madvise(MADV_HUGEPAGE))；都不支持时退化成普通页面
+ *
+ * 在多个NUMA节点的机器上，还可以指定内存在节点上的分布策略：
+ * - none                 不做处理(默认)，由操作系统决定，通常是分配在第一次访问内存的线程所在的节点上
+ * - interleave[:nodes]   内存交错分布在指定的节点上，不指定节点时使用所有在线的节点
+ * - bind:nodes           内存只从指定的节点上分配
+ * 节点列表的格式与 /sys/devices/system/node/online 相同，比如 "0,2-3"。
+ * 设置NUMA策略失败时只打印日志，不影响使用。
+ *
+ * 页帧对象和页面内存分开存放：前面是所有的页帧对象，后面是按照页面大小对齐的页面内存，
+ * 第i个页帧使用第i个页面。一个 FrameArena 中的页面大小都相同，不同大小的页面使用不同的 FrameArena。
+ *
+ * 为了支持在线调整页帧个数，初始化时会按照最大页帧个数预留地址空间，但只构造需要的页帧。
+ * 普通页面在第一次访问时才会分配物理内存；缩小时释放的页帧通过 madvise(MADV_DONTNEED) 归还给操作系统。
+ * MAP_HUGETLB 会按照最大页帧个数预留大页。
+ */
+class FrameArena
+{
+public:
+  /// 实际使用的页面类型
+  enum class PageType
+  {
+    NORMAL,       ///< 普通页面
+    HUGETLB,      ///< MAP_HUGETLB 申请的大页
+    TRANSPARENT,  ///< 透明大页
+  };
+
+public:
+  /**
+   * @param page_size 每个页帧的页面大小，参考 bp_valid_page_size
+   */
+  explicit FrameArena(int page_size = BP_PAGE_SIZE) : page_size_(page_size) {}
+  ~FrameArena();
+
+  /**
+   * @brief 申请内存并构造页帧
+   * @param frame_num   页帧个数
+   * @param memory_mode 内存类型，normal 或 huge_page，为空时使用 normal
+   * @param numa_policy NUMA策略，为空时使用 none
+   * @param max_frame_num 最多可以扩展到多少个页帧，小于 frame_num 时不能扩展
+   * @return 配置错误时返回 RC::INVALID_ARGUMENT，申请不到内存时返回 RC::NOMEM
+   */
+  RC init(size_t frame_num, const char *memory_mode = nullptr, const char *numa_policy = nullptr,
+      size_t max_frame_num = 0);
+
+  /**
+   * @brief 调整页帧的个数
+   * @details 扩展时在已有页帧的后面构造新的页帧；缩小时析构最后面的页帧并释放它们占用的物理内存，
+   * 调用方需要保证这些页帧已经不再使用
+   * @return 超过最大页帧个数时返回 RC::INVALID_ARGUMENT
+   */
+  RC resize(size_t frame_num);
+
+  /**
+   * @brief 析构所有的页帧并释放内存
+   */
+  void cleanup();
+
+  Frame *frames() const { return frames_; }
+  size_t frame_num() const { return frame_num_; }
+  size_t max_frame_num() const { return max_frame_num_; }
+  int    page_size() const { return page_size_; }
+
+  /// 预留的内存大小，按照页面大小对齐
+  size_t memory_size() const { return size_; }
+
+  PageType    page_type() const { return page_type_; }
+  const char *page_type_name() const;
+
+  /// 是否成功设置了NUMA策略
+  bool numa_applied() const { return numa_applied_; }
+
+  /**
+   * @brief 解析节点列表，比如 "0,2-3"
+   */
+  static RC parse_nodes(const char *str, vector<int> &nodes);
+
+private:
+  /**
+   * @brief 按照配置的策略设置内存的NUMA分布，需要在访问内存之前调用
+   */
+  void apply_numa_policy(const string &policy, const vector<int> &nodes);
+
+  /**
+   * @brief 释放 [base + begin_offset, base + end_offset) 占用的物理内存
+   */
+  void release_memory(char *base, size_t begin_offset, size_t end_offset);
+
+private:
+  void    *memory_        = nullptr;
+  size_t   size_          = 0;
+  Frame   *frames_        = nullptr;
+  char    *pages_         = nullptr;  ///< 页面内存的起始地址
+  size_t   frame_num_     = 0;
+  size_t   max_frame_num_ = 0;
+  int      page_size_     = BP_PAGE_SIZE;
+  size_t   sys_page_size_ = 0;  ///< 实际使用的内存页面大小，释放物理内存时按照它对齐
+  PageType page_type_     = PageType::NORMAL;
+  bool     numa_applied_  = false;
+};
+
+/**
+ * @brief 页帧分配器，管理 FrameArena 中的一段页帧
+ * @ingroup BufferPool
+ * @details 每个页帧管理器的分片有一个分配器，由分片的锁保护，自己不加锁。
+ * 与 MemPoolSimple 一样，分配和释放时分别调用页帧的 reinit 和 reset，空闲的页帧在 ASAN 中标记为不可访问。
+ * 分配器管理的页帧由多个内存块(chunk)组成，块按照地址从小到大添加，只能从最后面移除。
+ */
+class FramePool
+{
+public:
+  FramePool() = default;
+
+  void init(Frame *frames, size_t frame_num);
+
+  /**
+   * @brief 添加一块页帧，地址需要比已有的页帧都大
+   */
+  void add_chunk(Frame *frames, size_t frame_num);
+
+  /**
+   * @brief 移除最后一块页帧
+   * @details 这块内存中的页帧需要都已经释放了
+   * @return 有页帧正在使用时返回 RC::LOCKED_CONCURRENCY_CONFLICT
+   */
+  RC remove_last_chunk();
+
+  Frame *alloc();
+  void   free(Frame *frame);
+
+  /// 管理的页帧个数
+  size_t get_size() const { return frame_num_; }
+  size_t get_used_num() const { return frame_num_ - free_frames_.size(); }
+
+  int                         chunk_num() const { return static_cast<int>(chunks_.size()); }
+  const pair<Frame *, size_t> &chunk(int index) const { return chunks_[index]; }
+
+private:
+  vector<pair<Frame *, size_t>> chunks_;  ///< 每块页帧的起始地址和个数
+  size_t                        frame_num_ = 0;
+  vector<Frame *>               free_frames_;
+};
@@ -0,0 +1,237 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#include "storage/buffer/frame_replacer.h"
+#include "common/lang/string.h"
+#include "common/log/log.h"
+#include "storage/buffer/frame.h"
+
+unique_ptr<FrameReplacer> FrameReplacer::create(const char *name)
+{
+  if (nullptr == name || common::is_blank(name) || 0 == strcasecmp(name, "lru")) {
+    return make_unique<LruFrameReplacer>();
+  } else if (0 == strcasecmp(name, "clock")) {
+    return make_unique<ClockFrameReplacer>();
+  } else if (0 == strcasecmp(name, "2q")) {
+    return make_unique<TwoQueueFrameReplacer>();
+  }
+
+  LOG_ERROR("unknown frame replacer: %s", name);
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void LruFrameReplacer::insert(Frame *frame, BufferAccessHint hint)
+{
+  if (hint == BufferAccessHint::SEQUENTIAL) {
+    positions_[frame] = frames_.insert(frames_.end(), frame);
+  } else {
+    frames_.push_front(frame);
+    positions_[frame] = frames_.begin();
+  }
+}
+
+void LruFrameReplacer::access(Frame *frame, BufferAccessHint hint)
+{
+  if (hint == BufferAccessHint::SEQUENTIAL) {
+    return;
+  }
+
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    return;
+  }
+  frames_.splice(frames_.begin(), frames_, iter->second);
+}
+
+void LruFrameReplacer::remove(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    return;
+  }
+
+  frames_.erase(iter->second);
+  positions_.erase(iter);
+}
+
+void LruFrameReplacer::foreach_victim(const function<bool(Frame *)> &func)
+{
+  for (auto iter = frames_.rbegin(); iter != frames_.rend(); ++iter) {
+    if (!func(*iter)) {
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ClockFrameReplacer::insert(Frame *frame, BufferAccessHint hint)
+{
+  frame->set_referenced(false);
+
+  if (hint == BufferAccessHint::SEQUENTIAL) {
+    cold_.push_front(frame);
+    cold_positions_[frame] = cold_.begin();
+  } else {
+    insert_into_ring(frame);
+  }
+}
+
+void ClockFrameReplacer::insert_into_ring(Frame *frame)
+{
+  size_t position = 0;
+  if (!free_slots_.empty()) {
+    position = free_slots_.back();
+    free_slots_.pop_back();
+    ring_[position] = frame;
+  } else {
+    position = ring_.size();
+    ring_.push_back(frame);
+  }
+  positions_[frame] = position;
+}
+
+void ClockFrameReplacer::access(Frame *frame, BufferAccessHint hint)
+{
+  // 不持有分片的锁，只能设置访问标记。FIFO 队列中的页帧在 foreach_victim 中再移动到环上
+  if (hint != BufferAccessHint::SEQUENTIAL) {
+    frame->set_referenced(true);
+  }
+}
+
+void ClockFrameReplacer::remove(Frame *frame)
+{
+  auto cold_iter = cold_positions_.find(frame);
+  if (cold_iter != cold_positions_.end()) {
+    cold_.erase(cold_iter->second);
+    cold_positions_.erase(cold_iter);
+    return;
+  }
+
+  auto iter = positions_.find(frame);
+  if (iter == positions_.end()) {
+    return;
+  }
+
+  ring_[iter->second] = nullptr;
+  free_slots_.push_back(iter->second);
+  positions_.erase(iter);
+}
+
+void ClockFrameReplacer::foreach_victim(const function<bool(Frame *)> &func)
+{
+  for (auto iter = cold_.end(); iter != cold_.begin();) {
+    --iter;
+    Frame *frame = *iter;
+    if (frame->referenced()) {
+      // 顺序访问之后又被普通访问过，移动到环上，访问标记留给时钟指针清理
+      iter = cold_.erase(iter);
+      cold_positions_.erase(frame);
+      insert_into_ring(frame);
+      continue;
+    }
+
+    if (!func(frame)) {
+      return;
+    }
+  }
+
+  // 最多转两圈：第一圈清理访问标记，第二圈所有页帧都没有访问标记了
+  const size_t ring_size = ring_.size();
+  for (size_t step = 0; step < ring_size * 2; step++) {
+    if (hand_ >= ring_size) {
+      hand_ = 0;
+    }
+
+    Frame *frame = ring_[hand_];
+    hand_++;
+    if (nullptr == frame) {
+      continue;
+    }
+
+    if (frame->referenced()) {
+      frame->set_referenced(false);
+      continue;
+    }
+
+    if (!func(frame)) {
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TwoQueueFrameReplacer::insert(Frame *frame, BufferAccessHint hint)
+{
+  Entry &entry = entries_[frame];
+  entry.hot    = false;
+  if (hint == BufferAccessHint::SEQUENTIAL) {
+    entry.iter = a1_.insert(a1_.end(), frame);
+  } else {
+    a1_.push_front(frame);
+    entry.iter = a1_.begin();
+  }
+}
+
+void TwoQueueFrameReplacer::access(Frame *frame, BufferAccessHint hint)
+{
+  if (hint == BufferAccessHint::SEQUENTIAL) {
+    return;
+  }
+
+  auto iter = entries_.find(frame);
+  if (iter == entries_.end()) {
+    return;
+  }
+
+  // 不管在哪个队列中，再次访问都会移动到 Am 的头部
+  Entry &entry = iter->second;
+  am_.splice(am_.begin(), entry.hot ? am_ : a1_, entry.iter);
+  entry.hot  = true;
+  entry.iter = am_.begin();
+}
+
+void TwoQueueFrameReplacer::remove(Frame *frame)
+{
+  auto iter = entries_.find(frame);
+  if (iter == entries_.end()) {
+    return;
+  }
+
+  Entry &entry = iter->second;
+  (entry.hot ? am_ : a1_).erase(entry.iter);
+  entries_.erase(iter);
+}
+
+void TwoQueueFrameReplacer::foreach_victim(const function<bool(Frame *)> &func)
+{
+  auto visit = [&func](list<Frame *> &frames) {
+    for (auto iter = frames.rbegin(); iter != frames.rend(); ++iter) {
+      if (!func(*iter)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const bool a1_first = a1_.size() * 4 > entries_.size();
+  if (a1_first) {
+    (void)(visit(a1_) && visit(am_));
+  } else {
+    (void)(visit(am_) && visit(a1_));
+  }
+}
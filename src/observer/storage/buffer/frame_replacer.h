@@ -0,0 +1,176 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#pragma once
+
+#include "common/lang/functional.h"
+#include "common/lang/list.h"
+#include "common/lang/memory.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+
+class Frame;
+
+/**
+ * @brief 访问页面时的提示信息
+ * @ingroup BufferPool
+ * @details 淘汰策略根据提示信息决定页面在淘汰顺序中的位置。
+ * 全表扫描等顺序访问的页面通常只会访问一次，如果与点查询的页面同等对待，一次大表扫描就会把
+ * 其它会话的热点页面全部挤出内存。顺序访问的页面会放到淘汰顺序的冷端，并且再次访问也不会被提升，
+ * 这样扫描时新分配的页帧总是优先淘汰刚扫描过的页面，作用与 PostgreSQL 的 buffer ring 类似。
+ */
+enum class BufferAccessHint
+{
+  NORMAL,      ///< 普通访问，比如点查询和索引访问
+  SEQUENTIAL,  ///< 顺序访问，比如全表扫描
+};
+
+/**
+ * @brief 页帧淘汰策略
+ * @ingroup BufferPool
+ * @details 当内存中没有空闲页帧时，需要淘汰一些页帧。淘汰哪些页帧由淘汰策略决定。
+ * 淘汰策略只负责记录页帧的访问情况，并给出淘汰的先后顺序，不负责页帧的分配与释放。
+ * 淘汰策略不是线程安全的，由使用者(BPFrameManager的分片)加锁保护。lock_free_access 返回 true 的策略，
+ * access 不需要加锁。
+ */
+class FrameReplacer
+{
+public:
+  FrameReplacer()          = default;
+  virtual ~FrameReplacer() = default;
+
+  /**
+   * @brief 新分配了一个页帧
+   */
+  virtual void insert(Frame *frame, BufferAccessHint hint) = 0;
+
+  /**
+   * @brief 访问了一个已经在内存中的页帧
+   */
+  virtual void access(Frame *frame, BufferAccessHint hint) = 0;
+
+  /**
+   * @brief access 是否只修改页帧自身的原子状态，不需要分片的锁
+   * @details 返回 true 时，命中的页帧在释放分片的锁之后再调用 access。页帧已经被固定，这期间不会被淘汰
+   */
+  virtual bool lock_free_access() const { return false; }
+
+  /**
+   * @brief 页帧被释放
+   */
+  virtual void remove(Frame *frame) = 0;
+
+  /**
+   * @brief 按照淘汰的优先级遍历页帧，最应该被淘汰的页帧最先访问
+   * @details 遍历的过程中可能会修改淘汰策略的内部状态，比如CLOCK算法会清理访问标记
+   * @param func 返回 false 时停止遍历
+   */
+  virtual void foreach_victim(const function<bool(Frame *)> &func) = 0;
+
+  virtual size_t size() const = 0;
+
+  /**
+   * @brief 根据名称创建淘汰策略
+   * @details 当前支持 lru、clock 和 2q。名字为空时，使用lru
+   * @return 不认识的名字返回空
+   */
+  static unique_ptr<FrameReplacer> create(const char *name);
+};
+
+/**
+ * @brief LRU 淘汰策略
+ * @ingroup BufferPool
+ * @details 每次访问页帧都会将页帧移动到链表头部，淘汰时从链表尾部开始。
+ * 顺序访问的页帧放到链表尾部，再次顺序访问时也不移动
+ */
+class LruFrameReplacer : public FrameReplacer
+{
+public:
+  void insert(Frame *frame, BufferAccessHint hint) override;
+  void access(Frame *frame, BufferAccessHint hint) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(const function<bool(Frame *)> &func) override;
+
+  size_t size() const override { return positions_.size(); }
+
+private:
+  list<Frame *>                                   frames_;  ///< 头部是最近访问的
+  unordered_map<Frame *, list<Frame *>::iterator> positions_;
+};
+
+/**
+ * @brief CLOCK 淘汰策略
+ * @ingroup BufferPool
+ * @details 所有的页帧放在一个环上。访问页帧时仅设置页帧的访问标记(Frame::referenced)，不修改任何共享的数据结构，
+ * 所以访问不需要加分片的锁。
+ * 淘汰时，时钟指针沿着环移动，遇到有访问标记的页帧就清除标记并跳过，遇到没有访问标记的页帧就作为淘汰对象。
+ * 新加入的页帧没有访问标记，只被访问过一次的页面(比如全表扫描)会比反复访问的页面先淘汰。
+ * 顺序访问的页帧不放到环上，而是放到一个单独的 FIFO 队列中，淘汰时优先淘汰这个队列中的页帧，
+ * 否则时钟指针在回收扫描页面时会顺带清理掉热点页面的访问标记。顺序访问的页帧被普通访问后会带上访问标记，
+ * 淘汰时在队列中遇到它再移动到环上。
+ */
+class ClockFrameReplacer : public FrameReplacer
+{
+public:
+  void insert(Frame *frame, BufferAccessHint hint) override;
+  void access(Frame *frame, BufferAccessHint hint) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(const function<bool(Frame *)> &func) override;
+  bool lock_free_access() const override { return true; }
+
+  size_t size() const override { return positions_.size() + cold_positions_.size(); }
+
+private:
+  void insert_into_ring(Frame *frame);
+
+private:
+  vector<Frame *>                ring_;        ///< 时钟环，释放的位置为空
+  vector<size_t>                 free_slots_;  ///< 时钟环中空闲的位置
+  unordered_map<Frame *, size_t> positions_;   ///< 页帧在环上的位置
+  size_t                         hand_ = 0;    ///< 时钟指针
+
+  list<Frame *>                                   cold_;            ///< 顺序访问的页帧，头部是最新加入的
+  unordered_map<Frame *, list<Frame *>::iterator> cold_positions_;
+};
+
+/**
+ * @brief 简化的 2Q 淘汰策略
+ * @ingroup BufferPool
+ * @details 新加入的页帧放到 FIFO 队列 A1 中，再次访问时提升到 LRU 链表 Am 中。
+ * 淘汰时，如果 A1 中的页帧超过总数的 1/4，就先淘汰 A1 中的页帧，否则先淘汰 Am 中的页帧。
+ * 大范围扫描的页面通常只访问一次，只会在 A1 中流转，不会将 Am 中的热点页面(比如B+树的内部节点)挤出去。
+ * 参考 "2Q: A Low Overhead High Performance Buffer Management Replacement Algorithm"。这里没有实现 A1out 队列。
+ * 顺序访问的页帧放到 A1 的淘汰端，再次顺序访问时也不会提升到 Am 中。
+ */
+class TwoQueueFrameReplacer : public FrameReplacer
+{
+public:
+  void insert(Frame *frame, BufferAccessHint hint) override;
+  void access(Frame *frame, BufferAccessHint hint) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(const function<bool(Frame *)> &func) override;
+
+  size_t size() const override { return entries_.size(); }
+
+private:
+  struct Entry
+  {
+    bool                    hot = false;  ///< 是否在 Am 中
+    list<Frame *>::iterator iter;
+  };
+
+  list<Frame *>                 a1_;  ///< FIFO 队列，头部是最新加入的
+  list<Frame *>                 am_;  ///< LRU 链表，头部是最近访问的
+  unordered_map<Frame *, Entry> entries_;
+};
@@ -23,16 +23,35 @@ static constexpr PageNum BP_INVALID_PAGE_NUM = -1;
 
 static constexpr PageNum BP_HEADER_PAGE = 0;
 
-static constexpr const int BP_PAGE_SIZE      = (1 << 13);
-static constexpr const int BP_PAGE_DATA_SIZE = (BP_PAGE_SIZE - sizeof(PageNum) - sizeof(LSN) - sizeof(CheckSum));
+/// 页面大小是文件的属性，记录在文件头中，创建文件时没有指定就使用默认值
+static constexpr const int BP_PAGE_SIZE        = (1 << 13);  ///< 默认的页面大小
+static constexpr const int BP_MIN_PAGE_SIZE    = (1 << 12);
+static constexpr const int BP_MAX_PAGE_SIZE    = (1 << 16);
+static constexpr const int BP_PAGE_HEADER_SIZE = (sizeof(PageNum) + sizeof(LSN) + sizeof(CheckSum));
+static constexpr const int BP_PAGE_DATA_SIZE   = (BP_PAGE_SIZE - BP_PAGE_HEADER_SIZE);  ///< 默认页面大小的数据部分
+
+/**
+ * @brief 指定大小的页面中可以存放数据的大小
+ */
+inline constexpr int bp_page_data_size(int page_size) { return page_size - BP_PAGE_HEADER_SIZE; }
+
+/**
+ * @brief 页面大小需要是 BP_MIN_PAGE_SIZE 到 BP_MAX_PAGE_SIZE 之间的2的幂
+ */
+inline constexpr bool bp_valid_page_size(int page_size)
+{
+  return page_size >= BP_MIN_PAGE_SIZE && page_size <= BP_MAX_PAGE_SIZE && (page_size & (page_size - 1)) == 0;
+}
 
 /**
  * @brief 表示一个页面，可能放在内存或磁盘上
  * @ingroup BufferPool
+ * @details 页面的大小由所在的文件决定，这里只描述页面的头部，数据部分有 bp_page_data_size(page_size) 个字节。
+ * 所以不能直接定义 Page 类型的变量，需要按照页面大小申请内存。
  */
 struct Page
 {
   LSN      lsn;
   CheckSum check_sum;
-  char     data[BP_PAGE_DATA_SIZE];
+  char     data[0];
 };
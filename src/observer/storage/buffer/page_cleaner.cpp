@@ -0,0 +1,270 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#include "storage/buffer/page_cleaner.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
+#include "common/log/log.h"
+#include "common/thread/thread_util.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+using namespace common;
+
+PageCleaner::PageCleaner(BufferPoolManager &bp_manager) : bp_manager_(bp_manager) {}
+
+PageCleaner::~PageCleaner() { stop(); }
+
+RC PageCleaner::init(int high_watermark, int low_watermark)
+{
+  if (thread_) {
+    LOG_WARN("page cleaner has been started");
+    return RC::INTERNAL;
+  }
+
+  if (high_watermark <= 0) {
+    LOG_INFO("page cleaner is disabled");
+    return RC::SUCCESS;
+  }
+
+  if (high_watermark > 100 || low_watermark < 0 || low_watermark > high_watermark) {
+    LOG_WARN("invalid dirty page watermark. high=%d, low=%d", high_watermark, low_watermark);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  high_watermark_ = high_watermark;
+  low_watermark_  = low_watermark;
+  running_        = true;
+  thread_         = make_unique<thread>(&PageCleaner::thread_func, this);
+  LOG_INFO("page cleaner started. high watermark=%d%%, low watermark=%d%%", high_watermark_, low_watermark_);
+  return RC::SUCCESS;
+}
+
+void PageCleaner::stop()
+{
+  if (!thread_) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> guard(lock_);
+    running_ = false;
+    stopped_ = true;
+  }
+  cond_.notify_all();
+
+  thread_->join();
+  thread_.reset();
+  LOG_INFO("page cleaner stopped. rounds=%ld, flushed=%ld, skipped=%ld, foreground flushed=%ld",
+           stats_.rounds.load(), stats_.flushed.load(), stats_.skipped.load(), stats_.foreground_flushed.load());
+}
+
+void PageCleaner::wakeup()
+{
+  if (!enabled()) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> guard(lock_);
+    wakeup_ = true;
+  }
+  cond_.notify_one();
+}
+
+void PageCleaner::cancel(DiskBufferPool *buffer_pool)
+{
+  unique_lock<mutex> lock(lock_);
+  const int32_t      id = buffer_pool->id();
+  idle_cond_.wait(lock, [this, id]() { return current_id_ != id; });
+}
+
+void PageCleaner::thread_func()
+{
+  thread_set_name("PageCleaner");
+  LOG_INFO("page cleaner thread started");
+
+  unique_lock<mutex> lock(lock_);
+  while (running_) {
+    cond_.wait_for(lock, chrono::milliseconds(INTERVAL_MS), [this]() { return !running_ || wakeup_; });
+    if (!running_) {
+      break;
+    }
+    wakeup_ = false;
+
+    lock.unlock();
+    clean();
+    lock.lock();
+  }
+
+  LOG_INFO("page cleaner thread stopped");
+}
+
+int PageCleaner::clean()
+{
+  if (!enabled()) {
+    return 0;
+  }
+
+  // 每种页面大小的页帧管理器单独计算脏页比例
+  vector<BPFrameManager *> frame_managers;
+  bp_manager_.foreach_frame_manager([&frame_managers](BPFrameManager &frame_manager) {
+    frame_managers.push_back(&frame_manager);
+  });
+
+  int flushed = 0;
+  for (BPFrameManager *frame_manager : frame_managers) {
+    flushed += clean(*frame_manager);
+  }
+  return flushed;
+}
+
+int PageCleaner::clean(BPFrameManager &frame_manager)
+{
+  const size_t total_num = frame_manager.total_frame_num();
+  if (total_num == 0) {
+    return 0;
+  }
+
+  vector<pair<LSN, FrameId>> dirty_frames;
+  frame_manager.dirty_frames(dirty_frames);
+  if (dirty_frames.size() * 100 <= total_num * high_watermark_) {
+    return 0;
+  }
+
+  stats_.rounds++;
+  const size_t target = dirty_frames.size() - total_num * low_watermark_ / 100;
+  // 按照LSN排序，LSN相同时，同一个文件的页面按照页面编号排在一起
+  sort(dirty_frames.begin(), dirty_frames.end(), [](const auto &a, const auto &b) {
+    if (a.first != b.first) {
+      return a.first < b.first;
+    }
+    if (a.second.buffer_pool_id() != b.second.buffer_pool_id()) {
+      return a.second.buffer_pool_id() < b.second.buffer_pool_id();
+    }
+    return a.second.page_num() < b.second.page_num();
+  });
+
+  vector<FrameId> frame_ids;
+  frame_ids.reserve(dirty_frames.size());
+  for (const auto &[lsn, frame_id] : dirty_frames) {
+    frame_ids.push_back(frame_id);
+  }
+
+  int flushed = 0;
+  (void)flush_frames(frame_ids, target, false /*wait*/, flushed);
+  LOG_DEBUG("page cleaner flushed %d pages. dirty=%ld, total=%ld", flushed, dirty_frames.size(), total_num);
+  return flushed;
+}
+
+RC PageCleaner::flush_all(int &flushed)
+{
+  flushed = 0;
+
+  // 正在修改的页面可能还没有标记为脏页，所以要检查所有的页帧，而不仅仅是脏页帧
+  vector<FrameId> frame_ids;
+  bp_manager_.foreach_frame_manager([&frame_ids](BPFrameManager &frame_manager) {
+    vector<FrameId> frames;
+    frame_manager.all_frames(frames);
+    frame_ids.insert(frame_ids.end(), frames.begin(), frames.end());
+  });
+  sort(frame_ids.begin(), frame_ids.end(), [](const FrameId &a, const FrameId &b) {
+    if (a.buffer_pool_id() != b.buffer_pool_id()) {
+      return a.buffer_pool_id() < b.buffer_pool_id();
+    }
+    return a.page_num() < b.page_num();
+  });
+
+  RC rc = flush_frames(frame_ids, frame_ids.size(), true /*wait*/, flushed);
+  LOG_INFO("flush all dirty pages done. frames=%ld, flushed=%d, rc=%s", frame_ids.size(), flushed, strrc(rc));
+  return rc;
+}
+
+RC PageCleaner::flush_frames(span<const FrameId> frames, size_t limit, bool wait, int &flushed)
+{
+  lock_guard<mutex> flush_guard(flush_lock_);
+
+  RC              rc          = RC::SUCCESS;
+  DiskBufferPool *buffer_pool = nullptr;
+  for (const FrameId &frame_id : frames) {
+    if (static_cast<size_t>(flushed) >= limit) {
+      break;
+    }
+
+    if (buffer_pool == nullptr || buffer_pool->id() != frame_id.buffer_pool_id()) {
+      // 先声明要访问的 buffer pool 再查找，这样关闭 buffer pool 的线程要么等我们访问结束，要么我们找不到它
+      {
+        lock_guard<mutex> guard(lock_);
+        if (stopped_) {
+          // 正在退出，没有刷新完所有的页面
+          rc = RC::INTERNAL;
+          break;
+        }
+        current_id_ = frame_id.buffer_pool_id();
+      }
+      idle_cond_.notify_all();
+
+      if (OB_FAIL(bp_manager_.get_buffer_pool(frame_id.buffer_pool_id(), buffer_pool)) || buffer_pool->closing()) {
+        // buffer pool 已经关闭或者正在关闭，关闭时会刷新所有的页面
+        buffer_pool = nullptr;
+        continue;
+      }
+    }
+
+    RC ret = clean_page(*buffer_pool, frame_id.page_num(), wait);
+    if (OB_SUCC(ret)) {
+      flushed++;
+    } else if (ret == RC::LOCKED_CONCURRENCY_CONFLICT) {
+      stats_.skipped++;
+    } else if (ret != RC::NOT_EXIST && OB_SUCC(rc)) {
+      rc = ret;
+    }
+  }
+
+  {
+    lock_guard<mutex> guard(lock_);
+    current_id_ = -1;
+  }
+  idle_cond_.notify_all();
+
+  stats_.flushed += flushed;
+  return rc;
+}
+
+RC PageCleaner::clean_page(DiskBufferPool &buffer_pool, PageNum page_num, bool wait)
+{
+  // 使用顺序访问的提示，不影响页面在淘汰策略中的位置
+  Frame *frame = buffer_pool.frame_manager().get(buffer_pool.id(), page_num, BufferAccessHint::SEQUENTIAL);
+  if (frame == nullptr) {
+    return RC::NOT_EXIST;
+  }
+
+  RC rc = RC::NOT_EXIST;
+  if (wait) {
+    // 没有持有 buffer pool 的锁，可以等待页面的锁。拿到锁时，修改页面的线程已经把页面标记为脏页了
+    frame->read_latch();
+    rc = buffer_pool.flush_dirty_page(*frame);
+    frame->read_unlatch();
+  } else if (frame->dirty()) {
+    // 持有页面写锁的线程可能在等待 buffer pool 的锁，这里不能阻塞等待页面的锁
+    if (frame->try_read_latch()) {
+      rc = buffer_pool.flush_dirty_page(*frame);
+      frame->read_unlatch();
+    } else {
+      rc = RC::LOCKED_CONCURRENCY_CONFLICT;
+    }
+  }
+
+  buffer_pool.unpin_page(frame);
+  return rc;
+}
@@ -0,0 +1,140 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/span.h"
+#include "common/lang/thread.h"
+#include "common/sys/rc.h"
+#include "common/types.h"
+#include "storage/buffer/frame.h"
+
+class BPFrameManager;
+class BufferPoolManager;
+class DiskBufferPool;
+
+/**
+ * @brief 后台刷脏线程
+ * @ingroup BufferPool
+ * @details 如果没有后台刷脏，脏页只有在被淘汰或者 flush_all_pages 时才会写入磁盘，
+ * 前台线程访问的页面不在内存中时，可能要先同步刷新一个脏页才能腾出页帧。
+ * 刷脏线程定期检查脏页帧占所有页帧的比例，超过高水位时，按照页面LSN从小到大的顺序刷新脏页，
+ * 直到比例降到低水位以下。LSN小的页面对应的日志更可能已经落盘，等待日志(LogHandler::wait_lsn)的时间更短。
+ * 刷脏线程只刷新能够立即加上读锁的页面，不会阻塞正在修改页面的线程。
+ */
+class PageCleaner
+{
+public:
+  /// 两次检查之间的时间间隔
+  static constexpr int INTERVAL_MS = 100;
+
+  /**
+   * @brief 刷脏的统计信息
+   */
+  struct Stats
+  {
+    atomic<int64_t> rounds{0};              ///< 超过高水位，执行了刷脏的次数
+    atomic<int64_t> flushed{0};             ///< 刷脏线程刷新的页面个数
+    atomic<int64_t> skipped{0};             ///< 页面正在被其它线程使用，跳过的次数
+    atomic<int64_t> foreground_flushed{0};  ///< 前台线程淘汰页面时，同步刷新的脏页个数
+  };
+
+public:
+  PageCleaner(BufferPoolManager &bp_manager);
+  ~PageCleaner();
+
+  /**
+   * @brief 启动刷脏线程
+   * @param high_watermark 脏页帧的百分比超过这个值时开始刷脏。小于等于0时不启动刷脏线程
+   * @param low_watermark  刷脏直到脏页帧的百分比低于这个值。不能超过 high_watermark
+   */
+  RC   init(int high_watermark, int low_watermark);
+  void stop();
+
+  bool enabled() const { return high_watermark_ > 0; }
+
+  /**
+   * @brief 唤醒刷脏线程，立即做一次检查
+   * @details 前台线程淘汰页面时遇到了脏页，说明刷脏跟不上，需要尽快刷新
+   */
+  void wakeup();
+
+  /**
+   * @brief 等待刷脏线程不再访问指定的 buffer pool
+   * @details 关闭 buffer pool 之前需要调用。这时 buffer pool 还在 BufferPoolManager 中，但是已经标记为
+   * 正在关闭(BufferPoolManager::mark_closing)，返回之后刷脏线程即使找到它也会跳过
+   */
+  void cancel(DiskBufferPool *buffer_pool);
+
+  /**
+   * @brief 检查一次脏页比例，超过高水位时刷脏
+   * @details 由刷脏线程定期调用，测试时也可以直接调用
+   * @return 刷新的页面个数
+   */
+  int clean();
+
+  /**
+   * @brief 刷新所有的脏页，做检查点时使用
+   * @details 与 clean 不同，这里会等待正在修改页面的线程释放页面的锁，
+   * 因此调用之前已经写入日志的修改，返回时都已经写入了 double write buffer。
+   * 每次只锁住一个页面，不会阻塞事务的执行。刷脏线程没有启动时也可以调用
+   * @param[out] flushed 刷新的页面个数
+   */
+  RC flush_all(int &flushed);
+
+  Stats &stats() { return stats_; }
+
+private:
+  /**
+   * @brief 检查一个页帧管理器的脏页比例，超过高水位时刷脏
+   */
+  int clean(BPFrameManager &frame_manager);
+
+  void thread_func();
+
+  /**
+   * @brief 按照顺序刷新指定的页面
+   * @param limit 最多刷新多少个页面
+   * @param wait  页面正在被使用时是否等待
+   */
+  RC flush_frames(span<const FrameId> frames, size_t limit, bool wait, int &flushed);
+
+  /**
+   * @brief 刷新指定页面
+   * @return 不等待并且页面正在被使用时返回 RC::LOCKED_CONCURRENCY_CONFLICT
+   */
+  RC clean_page(DiskBufferPool &buffer_pool, PageNum page_num, bool wait);
+
+private:
+  BufferPoolManager &bp_manager_;
+
+  int high_watermark_ = 0;
+  int low_watermark_  = 0;
+
+  mutex              flush_lock_;  ///< clean 与 flush_all 共用 current_id_，不能同时执行
+  mutex              lock_;
+  condition_variable cond_;       ///< 唤醒刷脏线程，或者需要退出
+  condition_variable idle_cond_;  ///< 刷脏线程不再访问 current_id_ 对应的 buffer pool
+  int32_t            current_id_ = -1;  ///< 正在刷新的 buffer pool id
+  bool               running_    = false;
+  bool               stopped_    = false;  ///< 调用了 stop，正在执行的刷脏也要尽快结束
+  bool               wakeup_     = false;
+  unique_ptr<thread> thread_;
+
+  Stats stats_;
+};
@@ -0,0 +1,241 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include <string.h>
+#include <strings.h>
+
+#include "storage/buffer/page_compressor.h"
+
+const char *page_compression_to_string(PageCompression compression)
+{
+  switch (compression) {
+    case PageCompression::NONE: return "none";
+    case PageCompression::LZ4: return "lz4";
+    default: return "unknown";
+  }
+}
+
+PageCompression page_compression_from_string(const char *s)
+{
+  if (0 == strcasecmp(s, "none")) {
+    return PageCompression::NONE;
+  }
+  if (0 == strcasecmp(s, "lz4")) {
+    return PageCompression::LZ4;
+  }
+  return PageCompression::UNKNOWN;
+}
+
+const PageCompressor *PageCompressor::get(PageCompression compression)
+{
+  static const Lz4PageCompressor lz4_compressor;
+
+  switch (compression) {
+    case PageCompression::LZ4: return &lz4_compressor;
+    default: return nullptr;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LZ4 block 格式：由若干个序列(sequence)组成，每个序列是
+//   token(1字节，高4位是字面量长度，低4位是匹配长度-4)
+//   [字面量长度的扩展字节] 字面量 offset(2字节小端) [匹配长度的扩展字节]
+// 长度字段为15时，后面跟着扩展字节，每个字节累加，直到遇到一个不是255的字节。
+// 最后一个序列只有字面量，最后 LAST_LITERALS 个字节必须是字面量。
+
+namespace {
+
+constexpr int HASH_LOG      = 12;
+constexpr int MIN_MATCH     = 4;
+constexpr int MF_LIMIT      = 12;  ///< 距离结尾不足这么多字节时，不再查找匹配
+constexpr int LAST_LITERALS = 5;
+constexpr int MAX_OFFSET    = 65535;
+constexpr int RUN_MASK      = 15;
+
+inline uint32_t read32(const uint8_t *p)
+{
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint32_t hash32(uint32_t value) { return (value * 2654435761U) >> (32 - HASH_LOG); }
+
+/// 写入扩展长度字节
+inline void write_length(uint8_t *&op, int length)
+{
+  while (length >= 255) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = static_cast<uint8_t>(length);
+}
+
+/// 读取扩展长度字节，数据不完整时返回 false
+inline bool read_length(const uint8_t *&ip, const uint8_t *end, int &length)
+{
+  uint8_t byte = 0;
+  do {
+    if (ip >= end) {
+      return false;
+    }
+    byte = *ip++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/**
+ * @brief 写入一个序列
+ * @param match_length 匹配长度，为0时表示最后一个只有字面量的序列
+ * @return 输出空间不足时返回 false
+ */
+bool write_sequence(uint8_t *&op, const uint8_t *op_end, const uint8_t *literals, int literal_length, int offset,
+    int match_length)
+{
+  // 最坏情况下需要的空间：token + 扩展长度 + 字面量 + offset + 扩展长度
+  const int64_t max_size = 1 + literal_length / 255 + 1 + literal_length + 2 + match_length / 255 + 1;
+  if (op_end - op < max_size) {
+    return false;
+  }
+
+  uint8_t *token = op++;
+  if (literal_length >= RUN_MASK) {
+    *token = RUN_MASK << 4;
+    write_length(op, literal_length - RUN_MASK);
+  } else {
+    *token = static_cast<uint8_t>(literal_length << 4);
+  }
+
+  memcpy(op, literals, literal_length);
+  op += literal_length;
+
+  if (match_length == 0) {
+    return true;
+  }
+
+  *op++ = static_cast<uint8_t>(offset & 0xFF);
+  *op++ = static_cast<uint8_t>(offset >> 8);
+
+  const int length = match_length - MIN_MATCH;
+  if (length >= RUN_MASK) {
+    *token |= RUN_MASK;
+    write_length(op, length - RUN_MASK);
+  } else {
+    *token |= static_cast<uint8_t>(length);
+  }
+  return true;
+}
+
+}  // namespace
+
+int Lz4PageCompressor::compress(const char *src, int src_size, char *dst, int dst_capacity) const
+{
+  const uint8_t *in     = reinterpret_cast<const uint8_t *>(src);
+  uint8_t       *op     = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *op_end = op + dst_capacity;
+
+  int32_t table[1 << HASH_LOG];
+  for (int32_t &position : table) {
+    position = -1;
+  }
+
+  int       anchor      = 0;
+  int       ip          = 0;
+  const int match_limit = src_size - MF_LIMIT;
+  const int match_end   = src_size - LAST_LITERALS;
+  while (ip < match_limit) {
+    const uint32_t sequence = read32(in + ip);
+    const uint32_t h        = hash32(sequence);
+    const int      ref      = table[h];
+    table[h]                = ip;
+
+    if (ref < 0 || ip - ref > MAX_OFFSET || read32(in + ref) != sequence) {
+      ip++;
+      continue;
+    }
+
+    int match_length = MIN_MATCH;
+    while (ip + match_length < match_end && in[ref + match_length] == in[ip + match_length]) {
+      match_length++;
+    }
+
+    if (!write_sequence(op, op_end, in + anchor, ip - anchor, ip - ref, match_length)) {
+      return -1;
+    }
+
+    ip += match_length;
+    anchor = ip;
+  }
+
+  if (!write_sequence(op, op_end, in + anchor, src_size - anchor, 0, 0)) {
+    return -1;
+  }
+  return static_cast<int>(op - reinterpret_cast<uint8_t *>(dst));
+}
+
+int Lz4PageCompressor::decompress(const char *src, int src_size, char *dst, int dst_capacity) const
+{
+  const uint8_t *ip     = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *ip_end = ip + src_size;
+  uint8_t       *op     = reinterpret_cast<uint8_t *>(dst);
+  uint8_t       *op_end = op + dst_capacity;
+
+  while (ip < ip_end) {
+    const uint8_t token = *ip++;
+
+    int literal_length = token >> 4;
+    if (literal_length == RUN_MASK && !read_length(ip, ip_end, literal_length)) {
+      return -1;
+    }
+    if (ip_end - ip < literal_length || op_end - op < literal_length) {
+      return -1;
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+
+    // 最后一个序列只有字面量
+    if (ip == ip_end) {
+      break;
+    }
+
+    if (ip_end - ip < 2) {
+      return -1;
+    }
+    const int offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > op - reinterpret_cast<uint8_t *>(dst)) {
+      return -1;
+    }
+
+    int match_length = token & RUN_MASK;
+    if (match_length == RUN_MASK && !read_length(ip, ip_end, match_length)) {
+      return -1;
+    }
+    match_length += MIN_MATCH;
+    if (op_end - op < match_length) {
+      return -1;
+    }
+
+    // 匹配的数据可能与输出重叠，只能逐字节复制
+    const uint8_t *match = op - offset;
+    for (int i = 0; i < match_length; i++) {
+      op[i] = match[i];
+    }
+    op += match_length;
+  }
+
+  return static_cast<int>(op - reinterpret_cast<uint8_t *>(dst));
+}
@@ -0,0 +1,95 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief 页面压缩算法
+ * @ingroup BufferPool
+ * @details 压缩算法是文件的属性，记录在 BPFileHeader 中
+ */
+enum class PageCompression : int32_t
+{
+  UNKNOWN = -1,
+  NONE    = 0,  ///< 不压缩
+  LZ4     = 1,  ///< LZ4 block 格式
+};
+
+const char     *page_compression_to_string(PageCompression compression);
+PageCompression page_compression_from_string(const char *s);
+
+/**
+ * @brief 压缩后的页面在文件中的格式
+ * @ingroup BufferPool
+ * @details 压缩文件中的页面仍然按照 PageNum * page_size 的偏移量存放，这样不需要额外的映射表。
+ * 压缩后的页面以这个结构开头，后面紧跟压缩后的数据，写入的长度按照 COMPRESSED_PAGE_ALIGN 向上对齐，
+ * 页面剩余的部分在文件中打洞(punch hole)，不占用磁盘空间，因此文件需要是稀疏文件。
+ * 压缩之后节省不了至少一个 COMPRESSED_PAGE_ALIGN 时，页面原样写入。
+ *
+ * 普通页面的开头是 LSN，不会是负数，magic 的最高位是1，以此区分页面有没有压缩。
+ */
+struct CompressedPageHeader
+{
+  static constexpr int64_t MAGIC                 = static_cast<int64_t>(0xFFFF'5A43'4750'4245ULL);
+  static constexpr int     COMPRESSED_PAGE_ALIGN = 4096;  ///< 文件系统块的大小，打洞的最小单位
+
+  int64_t magic;
+  int32_t compression;      ///< PageCompression
+  int32_t compressed_size;  ///< 后面紧跟的压缩数据的长度
+};
+
+/**
+ * @brief 页面压缩算法的实现
+ * @ingroup BufferPool
+ * @details 压缩与解压都是无状态的，同一个对象可以在多个线程中同时使用
+ */
+class PageCompressor
+{
+public:
+  virtual ~PageCompressor() = default;
+
+  /**
+   * @brief 压缩一段数据
+   * @return 压缩后的长度。dst 的空间不够时返回 -1，这时调用者应该直接保存原始数据
+   */
+  virtual int compress(const char *src, int src_size, char *dst, int dst_capacity) const = 0;
+
+  /**
+   * @brief 解压一段数据
+   * @return 解压后的长度。数据损坏或者 dst 的空间不够时返回 -1
+   */
+  virtual int decompress(const char *src, int src_size, char *dst, int dst_capacity) const = 0;
+
+  /**
+   * @brief 获取压缩算法的实现
+   * @return 不需要压缩或者不认识的算法返回空
+   */
+  static const PageCompressor *get(PageCompression compression);
+};
+
+/**
+ * @brief LZ4 block 格式的压缩实现
+ * @ingroup BufferPool
+ * @details 输出与 LZ4 的 block 格式兼容，没有帧头和校验信息。
+ * 只实现了最简单的单哈希表贪心匹配，压缩率和速度都不如官方实现，但是代码很短，不需要引入第三方依赖。
+ * 页面中通常有大量的空闲空间和重复的记录头，这种简单的实现已经可以获得不错的压缩率。
+ */
+class Lz4PageCompressor : public PageCompressor
+{
+public:
+  int compress(const char *src, int src_size, char *dst, int dst_capacity) const override;
+  int decompress(const char *src, int src_size, char *dst, int dst_capacity) const override;
+};
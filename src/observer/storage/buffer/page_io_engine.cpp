@@ -0,0 +1,325 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define MINIOB_HAVE_IO_URING 1
+#endif
+
+#include "storage/buffer/page_io_engine.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/log/log.h"
+
+RC PageIoEngine::read(int fd, int64_t offset, void *buf, int64_t size)
+{
+  PageIoRequest request = PageIoRequest::make_read(fd, offset, buf, size);
+  return submit(span<PageIoRequest>(&request, 1));
+}
+
+RC PageIoEngine::write(int fd, int64_t offset, const void *buf, int64_t size)
+{
+  PageIoRequest request = PageIoRequest::make_write(fd, offset, buf, size);
+  return submit(span<PageIoRequest>(&request, 1));
+}
+
+RC PageIoEngine::sync_io(PageIoRequest &request, int64_t done /* = 0 */)
+{
+  char *buf = static_cast<char *>(request.buf);
+  while (done < request.size) {
+    ssize_t ret = 0;
+    if (request.write) {
+      ret = ::pwrite(request.fd, buf + done, request.size - done, request.offset + done);
+    } else {
+      ret = ::pread(request.fd, buf + done, request.size - done, request.offset + done);
+    }
+    stats_.syscalls++;
+
+    if (ret > 0) {
+      done += ret;
+      continue;
+    }
+
+    if (ret < 0 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+
+    // 读取时 ret == 0 表示到了文件尾
+    LOG_ERROR("failed to %s. fd=%d, offset=%ld, size=%ld, done=%ld, ret=%ld, error=%s",
+              request.write ? "pwrite" : "pread", request.fd, request.offset, request.size, done, ret,
+              ret < 0 ? strerror(errno) : "end of file");
+    request.rc = request.write ? RC::IOERR_WRITE : RC::IOERR_READ;
+    return request.rc;
+  }
+
+  request.rc = RC::SUCCESS;
+  return RC::SUCCESS;
+}
+
+unique_ptr<PageIoEngine> PageIoEngine::create(const char *name)
+{
+  if (nullptr == name || common::is_blank(name) || 0 == strcasecmp(name, "sync")) {
+    return make_unique<SyncPageIoEngine>();
+  }
+
+  if (0 == strcasecmp(name, "io_uring")) {
+    auto engine = make_unique<UringPageIoEngine>();
+    RC   rc     = engine->init();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("io_uring is not available, fallback to sync io engine. rc=%s", strrc(rc));
+      return make_unique<SyncPageIoEngine>();
+    }
+    return engine;
+  }
+
+  LOG_ERROR("unknown page io engine: %s", name);
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RC SyncPageIoEngine::submit(span<PageIoRequest> requests)
+{
+  RC rc = RC::SUCCESS;
+  for (PageIoRequest &request : requests) {
+    stats_.requests++;
+    RC ret = sync_io(request);
+    if (OB_FAIL(ret) && OB_SUCC(rc)) {
+      rc = ret;
+    }
+  }
+  return rc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+#ifdef MINIOB_HAVE_IO_URING
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *params)
+{
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+UringPageIoEngine::~UringPageIoEngine()
+{
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+RC UringPageIoEngine::init(unsigned entries /* = 64 */)
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  ring_fd_ = io_uring_setup(entries, &params);
+  if (ring_fd_ < 0) {
+    LOG_WARN("failed to setup io_uring. entries=%u, error=%s", entries, strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  entries_      = params.sq_entries;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  sqes_size_    = params.sq_entries * sizeof(struct io_uring_sqe);
+
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+  sqes_    = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    LOG_WARN("failed to mmap io_uring. error=%s", strerror(errno));
+    // 析构函数中只释放映射成功的部分
+    sq_ring_ = (sq_ring_ == MAP_FAILED) ? nullptr : sq_ring_;
+    cq_ring_ = (cq_ring_ == MAP_FAILED) ? nullptr : cq_ring_;
+    sqes_    = (sqes_ == MAP_FAILED) ? nullptr : sqes_;
+    return RC::NOMEM;
+  }
+
+  char *sq_ring = static_cast<char *>(sq_ring_);
+  sq_tail_      = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.tail);
+  sq_mask_      = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+  sq_array_     = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+
+  char *cq_ring = static_cast<char *>(cq_ring_);
+  cq_head_      = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.head);
+  cq_tail_      = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.tail);
+  cq_mask_      = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+  cqes_         = cq_ring + params.cq_off.cqes;
+
+  LOG_INFO("io_uring page io engine inited. entries=%u", entries_);
+  return RC::SUCCESS;
+}
+
+RC UringPageIoEngine::submit(span<PageIoRequest> requests)
+{
+  if (requests.size() == 1) {
+    stats_.requests++;
+    return sync_io(requests[0]);
+  }
+
+  lock_guard<mutex> guard(lock_);
+
+  RC rc = RC::SUCCESS;
+  for (size_t start = 0; start < requests.size(); start += entries_) {
+    const size_t count = min(static_cast<size_t>(entries_), requests.size() - start);
+    RC           ret   = submit_batch(requests.subspan(start, count));
+    if (OB_FAIL(ret) && OB_SUCC(rc)) {
+      rc = ret;
+    }
+  }
+  return rc;
+}
+
+RC UringPageIoEngine::submit_batch(span<PageIoRequest> requests)
+{
+  stats_.requests += requests.size();
+  if (broken_) {
+    RC rc = RC::SUCCESS;
+    for (PageIoRequest &request : requests) {
+      RC ret = sync_io(request);
+      if (OB_FAIL(ret) && OB_SUCC(rc)) {
+        rc = ret;
+      }
+    }
+    return rc;
+  }
+
+  auto *sqes = static_cast<struct io_uring_sqe *>(sqes_);
+  auto *cqes = static_cast<struct io_uring_cqe *>(cqes_);
+
+  unsigned tail = *sq_tail_;
+  for (size_t i = 0; i < requests.size(); i++) {
+    PageIoRequest &request = requests[i];
+    request.rc             = RC::SUCCESS;
+
+    const unsigned       index = tail & *sq_mask_;
+    struct io_uring_sqe &sqe   = sqes[index];
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode    = request.write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe.fd        = request.fd;
+    sqe.addr      = reinterpret_cast<uint64_t>(request.buf);
+    sqe.len       = static_cast<uint32_t>(request.size);
+    sqe.off       = static_cast<uint64_t>(request.offset);
+    sqe.user_data = i;
+
+    sq_array_[index] = index;
+    tail++;
+  }
+  __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+  unsigned     to_submit = static_cast<unsigned>(requests.size());
+  unsigned     completed = 0;
+  vector<bool> done(requests.size(), false);
+  RC           rc        = RC::SUCCESS;
+  while (completed < requests.size()) {
+    int ret = io_uring_enter(ring_fd_, to_submit, 1, IORING_ENTER_GETEVENTS);
+    stats_.syscalls++;
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+
+      if (to_submit > 0) {
+        // 内核按顺序消费提交队列，还没有提交的是最后 to_submit 个请求。把它们从提交队列中撤回，同步执行。
+        // 已经提交的请求必须等它们完成，否则内核可能还在访问请求的内存
+        LOG_WARN("failed to enter io_uring, fallback to sync io. error=%s, pending=%u", strerror(errno), to_submit);
+        __atomic_store_n(sq_tail_, tail - to_submit, __ATOMIC_RELEASE);
+        for (size_t i = requests.size() - to_submit; i < requests.size(); i++) {
+          RC ret = sync_io(requests[i]);
+          if (OB_FAIL(ret) && OB_SUCC(rc)) {
+            rc = ret;
+          }
+          done[i] = true;
+        }
+        completed += to_submit;
+        to_submit = 0;
+        continue;
+      }
+
+      // 等待完成事件也失败了，没有办法再收到剩下请求的结果
+      LOG_ERROR("failed to wait for io_uring completions. error=%s, pending=%u",
+                strerror(errno), static_cast<unsigned>(requests.size()) - completed);
+      broken_ = true;
+      for (size_t i = 0; i < requests.size(); i++) {
+        if (!done[i]) {
+          requests[i].rc = requests[i].write ? RC::IOERR_WRITE : RC::IOERR_READ;
+          if (OB_SUCC(rc)) {
+            rc = requests[i].rc;
+          }
+        }
+      }
+      return rc;
+    }
+    to_submit -= min(static_cast<unsigned>(ret), to_submit);
+
+    unsigned head = *cq_head_;
+    while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      const struct io_uring_cqe &cqe     = cqes[head & *cq_mask_];
+      PageIoRequest             &request = requests[cqe.user_data];
+      if (cqe.res < 0) {
+        LOG_ERROR("failed to %s by io_uring. fd=%d, offset=%ld, size=%ld, error=%s",
+                  request.write ? "write" : "read", request.fd, request.offset, request.size, strerror(-cqe.res));
+        request.rc = request.write ? RC::IOERR_WRITE : RC::IOERR_READ;
+      } else if (cqe.res < request.size) {
+        // 没有一次读写完成，剩下的部分同步完成
+        sync_io(request, cqe.res);
+      }
+
+      if (OB_FAIL(request.rc) && OB_SUCC(rc)) {
+        rc = request.rc;
+      }
+      done[cqe.user_data] = true;
+      head++;
+      completed++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+  return rc;
+}
+
+#else  // MINIOB_HAVE_IO_URING
+
+UringPageIoEngine::~UringPageIoEngine() = default;
+
+RC UringPageIoEngine::init(unsigned entries /* = 64 */)
+{
+  LOG_WARN("io_uring is not supported on this platform");
+  return RC::UNSUPPORTED;
+}
+
+RC UringPageIoEngine::submit(span<PageIoRequest> requests) { return RC::UNSUPPORTED; }
+
+RC UringPageIoEngine::submit_batch(span<PageIoRequest> requests) { return RC::UNSUPPORTED; }
+
+#endif  // MINIOB_HAVE_IO_URING
@@ -0,0 +1,168 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/span.h"
+#include "common/sys/rc.h"
+
+/**
+ * @brief 一次页面IO请求
+ * @ingroup BufferPool
+ */
+struct PageIoRequest
+{
+  int     fd     = -1;
+  int64_t offset = 0;
+  void   *buf    = nullptr;
+  int64_t size   = 0;
+  bool    write  = false;
+  RC      rc     = RC::SUCCESS;  ///< 请求的执行结果，由 PageIoEngine 填写
+
+  static PageIoRequest make_read(int fd, int64_t offset, void *buf, int64_t size)
+  {
+    return PageIoRequest{fd, offset, buf, size, false};
+  }
+  static PageIoRequest make_write(int fd, int64_t offset, const void *buf, int64_t size)
+  {
+    return PageIoRequest{fd, offset, const_cast<void *>(buf), size, true};
+  }
+};
+
+/**
+ * @brief 页面IO引擎
+ * @ingroup BufferPool
+ * @details buffer pool 与 double write buffer 的页面读写都通过这个接口完成。
+ * 所有的读写都是按照偏移量进行的(pread/pwrite 语义)，不会修改文件描述符的读写位置，
+ * 因此多个线程可以同时读写同一个文件。
+ * 刷新大量脏页、预读多个页面时，可以通过 submit 一次提交一批请求，由具体的实现决定如何执行。
+ */
+class PageIoEngine
+{
+public:
+  /**
+   * @brief IO统计信息
+   */
+  struct Stats
+  {
+    atomic<int64_t> requests{0};  ///< 执行的IO请求个数
+    atomic<int64_t> syscalls{0};  ///< 为了执行这些请求，调用了多少次系统调用
+  };
+
+public:
+  PageIoEngine()          = default;
+  virtual ~PageIoEngine() = default;
+
+  virtual const char *name() const = 0;
+
+  RC read(int fd, int64_t offset, void *buf, int64_t size);
+  RC write(int fd, int64_t offset, const void *buf, int64_t size);
+
+  /**
+   * @brief 批量执行IO请求，所有请求都完成后才返回
+   * @details 每个请求的执行结果记录在请求的 rc 中，不同请求之间没有先后顺序的保证。
+   * @return 所有请求都成功时返回 RC::SUCCESS，否则返回第一个失败请求的错误码
+   */
+  virtual RC submit(span<PageIoRequest> requests) = 0;
+
+  Stats &stats() { return stats_; }
+
+  /**
+   * @brief 根据名称创建IO引擎
+   * @details 当前支持 sync 和 io_uring。名字为空时使用 sync。
+   * 如果当前系统不支持 io_uring，会退化成 sync
+   * @return 不认识的名字返回空
+   */
+  static unique_ptr<PageIoEngine> create(const char *name);
+
+protected:
+  /**
+   * @brief 使用 pread/pwrite 同步执行一个请求
+   * @param done 请求中已经完成的字节数
+   */
+  RC sync_io(PageIoRequest &request, int64_t done = 0);
+
+protected:
+  Stats stats_;
+};
+
+/**
+ * @brief 同步IO引擎，每个请求执行一次(或多次) pread/pwrite
+ * @ingroup BufferPool
+ */
+class SyncPageIoEngine : public PageIoEngine
+{
+public:
+  const char *name() const override { return "sync"; }
+
+  RC submit(span<PageIoRequest> requests) override;
+};
+
+/**
+ * @brief 基于 io_uring 的IO引擎
+ * @ingroup BufferPool
+ * @details 一批请求一次性放入提交队列，使用一次 io_uring_enter 提交并等待全部完成，
+ * 一个线程就可以让很多IO同时在磁盘上执行，也减少了系统调用的次数。
+ * 只有一个请求时，io_uring 没有优势，直接使用 pread/pwrite，这样也不会与其它线程竞争队列的锁。
+ * 没有使用 liburing，直接使用系统调用，不需要额外的依赖。
+ */
+class UringPageIoEngine : public PageIoEngine
+{
+public:
+  UringPageIoEngine() = default;
+  ~UringPageIoEngine() override;
+
+  /**
+   * @brief 创建 io_uring 队列
+   * @param entries 队列的长度，也是一次最多同时提交的请求个数
+   */
+  RC init(unsigned entries = 64);
+
+  const char *name() const override { return "io_uring"; }
+
+  RC submit(span<PageIoRequest> requests) override;
+
+private:
+  /**
+   * @brief 提交一批请求并等待它们全部完成
+   * @details 只重试 EINTR/EAGAIN/EBUSY。其它错误时，还没有提交的请求改为同步执行；
+   * 等待完成事件失败时，没有完成的请求返回错误，之后不再使用 io_uring
+   */
+  RC submit_batch(span<PageIoRequest> requests);
+
+private:
+  int      ring_fd_ = -1;
+  unsigned entries_ = 0;
+
+  void  *sq_ring_      = nullptr;
+  size_t sq_ring_size_ = 0;
+  void  *cq_ring_      = nullptr;
+  size_t cq_ring_size_ = 0;
+  void  *sqes_         = nullptr;
+  size_t sqes_size_    = 0;
+
+  unsigned *sq_tail_  = nullptr;
+  unsigned *sq_mask_  = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_  = nullptr;
+  unsigned *cq_tail_  = nullptr;
+  unsigned *cq_mask_  = nullptr;
+  void     *cqes_     = nullptr;
+
+  mutex lock_;            ///< 提交队列与完成队列不是线程安全的
+  bool  broken_ = false;  ///< 队列中可能还有没有收到的完成事件，之后的请求都同步执行
+};
@@ -48,6 +48,13 @@ public:
 
   void add_column(unique_ptr<Column> col, int col_id);
 
+  /**
+   * @brief 根据列 ID 查找列在 Chunk 中的下标
+   * @details 表扫描只读取用到的列时，列 ID 与列在 Chunk 中的下标不一定相同
+   * @return 没有找到时返回 -1
+   */
+  int find_column(int col_id) const;
+
   RC reference(Chunk &chunk);
 
   /**
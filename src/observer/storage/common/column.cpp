@@ -8,6 +8,8 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#include "common/lang/algorithm.h"
+#include "common/lang/new.h"
 #include "common/log/log.h"
 #include "storage/common/column.h"
 
@@ -73,12 +75,31 @@ void Column::init(const Value &value)
   column_type_ = Type::CONSTANT_COLUMN;
 }
 
+void Column::init_varlen(AttrType attr_type, int attr_len, size_t capacity)
+{
+  reset();
+  // 先按照每个值平均8个字节分配，不够时再扩容
+  data_capacity_ = static_cast<int>(capacity) * 8;
+  data_          = new char[data_capacity_];
+  offsets_       = new int[capacity + 1];
+  offsets_[0]    = 0;
+  count_         = 0;
+  capacity_      = capacity;
+  own_           = true;
+  attr_type_     = attr_type;
+  attr_len_      = attr_len;
+  column_type_   = Type::NORMAL_COLUMN;
+}
+
 void Column::reset()
 {
-  if (data_ != nullptr && own_) {
+  if (own_) {
     delete[] data_;
+    delete[] offsets_;
   }
-  data_      = nullptr;
+  data_          = nullptr;
+  offsets_       = nullptr;
+  data_capacity_ = 0;
   count_     = 0;
   capacity_  = 0;
   own_       = false;
@@ -98,6 +119,21 @@ RC Column::append(char *data, int count)
     LOG_WARN("append data to full column");
     return RC::INTERNAL;
   }
+  if (offsets_ != nullptr) {
+    for (int i = 0; i < count; i++) {
+      const char *value = data + static_cast<size_t>(i) * attr_len_;
+      int         len   = attr_len_;
+      if (attr_type_ == AttrType::CHARS) {
+        len = strnlen(value, attr_len_);
+      }
+      RC rc = append_varlen(value, len);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    return RC::SUCCESS;
+  }
+
   // Using a larger integer type to avoid overflow
   size_t total_bytes = static_cast<size_t>(count) * static_cast<size_t>(attr_len_);
 
@@ -106,11 +142,82 @@ RC Column::append(char *data, int count)
   return RC::SUCCESS;
 }
 
+RC Column::reserve_data(int size)
+{
+  if (size <= data_capacity_) {
+    return RC::SUCCESS;
+  }
+
+  int new_capacity = max(data_capacity_ * 2, size);
+  char *new_data   = new (nothrow) char[new_capacity];
+  if (new_data == nullptr) {
+    LOG_WARN("failed to allocate memory for column. size=%d", new_capacity);
+    return RC::NOMEM;
+  }
+  memcpy(new_data, data_, offsets_[count_]);
+  delete[] data_;
+  data_          = new_data;
+  data_capacity_ = new_capacity;
+  return RC::SUCCESS;
+}
+
+RC Column::append_varlen(const char *data, int len)
+{
+  if (!own_) {
+    LOG_WARN("append data to non-owned column");
+    return RC::INTERNAL;
+  }
+  if (offsets_ == nullptr) {
+    LOG_WARN("append variable-length data to fixed-length column");
+    return RC::INTERNAL;
+  }
+  if (count_ >= capacity_) {
+    LOG_WARN("append data to full column");
+    return RC::INTERNAL;
+  }
+
+  len   = min(len, attr_len_);
+  RC rc = reserve_data(offsets_[count_] + len);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  memcpy(data_ + offsets_[count_], data, len);
+  offsets_[count_ + 1] = offsets_[count_] + len;
+  count_++;
+  return RC::SUCCESS;
+}
+
+RC Column::append_value(const Value &value)
+{
+  if (offsets_ != nullptr) {
+    return append_varlen(value.data(), value.length());
+  }
+  if (!own_) {
+    LOG_WARN("append data to non-owned column");
+    return RC::INTERNAL;
+  }
+  if (count_ >= capacity_) {
+    LOG_WARN("append data to full column");
+    return RC::INTERNAL;
+  }
+
+  // CHARS 类型的值可能比 attr_len 短
+  char *dest = data_ + static_cast<size_t>(count_) * attr_len_;
+  int   len  = min(value.length(), attr_len_);
+  memcpy(dest, value.data(), len);
+  memset(dest + len, 0, attr_len_ - len);
+  count_++;
+  return RC::SUCCESS;
+}
+
 Value Column::get_value(int index) const
 {
   if (index >= count_ || index < 0) {
     return Value();
   }
+  if (offsets_ != nullptr) {
+    return Value(attr_type_, &data_[offsets_[index]], offsets_[index + 1] - offsets_[index]);
+  }
   return Value(attr_type_, &data_[index * attr_len_], attr_len_);
 }
 
@@ -122,6 +229,7 @@ void Column::reference(const Column &column)
   reset();
 
   this->data_     = column.data();
+  this->offsets_  = const_cast<int *>(column.offsets());
   this->capacity_ = column.capacity();
   this->count_    = column.count();
   this->own_      = false;
@@ -129,4 +237,18 @@ void Column::reference(const Column &column)
   this->column_type_ = column.column_type();
   this->attr_type_   = column.attr_type();
   this->attr_len_    = column.attr_len();
-}
\ No newline at end of file
+}
+
+void Column::reference(char *data, int count)
+{
+  ASSERT(offsets_ == nullptr, "varlen column cannot reference fixed-length data");
+  if (own_) {
+    delete[] data_;
+  }
+
+  data_          = data;
+  data_capacity_ = 0;
+  count_         = count;
+  capacity_      = count;
+  own_           = false;
+}
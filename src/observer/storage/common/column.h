@@ -16,8 +16,9 @@ See the Mulan PSL v2 for more details. */
 
 /**
  * @brief A column contains multiple values in contiguous memory with a specified type.
+ * @details 默认每个值占用 attr_len 个字节。变长的 Column(init_varlen) 中，值紧挨着存放，
+ * 第 i 个值的范围是 [offsets[i], offsets[i+1])，CHARS 类型的值去掉了末尾的0。
  */
-// TODO: `Column` currently only support fixed-length type.
 class Column
 {
 public:
@@ -38,6 +39,12 @@ public:
   void init(AttrType attr_type, int attr_len, size_t size = DEFAULT_CAPACITY);
   void init(const Value &value);
 
+  /**
+   * @brief 初始化一个变长的 Column
+   * @param attr_len 每个值的最大长度
+   */
+  void init_varlen(AttrType attr_type, int attr_len, size_t capacity = DEFAULT_CAPACITY);
+
   virtual ~Column() { reset(); }
 
   void reset();
@@ -51,6 +58,17 @@ public:
    */
   RC append(char *data, int count);
 
+  /**
+   * @brief 向变长的 Column 追加一个值
+   * @param len 值的实际长度，不超过 attr_len
+   */
+  RC append_varlen(const char *data, int len);
+
+  /**
+   * @brief 追加一个值，定长的 Column 中不足 attr_len 的部分填0
+   */
+  RC append_value(const Value &value);
+
   /**
    * @brief 获取 index 位置的列值
    */
@@ -59,10 +77,15 @@ public:
   /**
    * @brief 获取列数据的实际大小（字节）
    */
-  int data_len() const { return count_ * attr_len_; }
+  int data_len() const { return offsets_ != nullptr ? offsets_[count_] : count_ * attr_len_; }
 
   char *data() const { return data_; }
 
+  /**
+   * @brief 变长 Column 中每个值的偏移，共 count + 1 项。定长的 Column 返回 nullptr
+   */
+  const int *offsets() const { return offsets_; }
+
   /**
    * @brief 重置列数据，但不修改元信息
    */
@@ -73,6 +96,13 @@ public:
    */
   void reference(const Column &column);
 
+  /**
+   * @brief 引用外部的一段定长数据，比如页面中的一列，不修改列的元信息
+   * @details 原来拥有的内存会被释放，之后不能再向 Column 追加数据。引用的数据需要调用者保证有效
+   * @param count 数据中列值的个数
+   */
+  void reference(char *data, int count);
+
   void set_column_type(Type column_type) { column_type_ = column_type; }
   void set_count(int count) { count_ = count; }
 
@@ -81,11 +111,21 @@ public:
   AttrType attr_type() const { return attr_type_; }
   int      attr_len() const { return attr_len_; }
   Type     column_type() const { return column_type_; }
+  bool     is_varlen() const { return offsets_ != nullptr; }
 
 private:
   static constexpr size_t DEFAULT_CAPACITY = 8192;
 
+  /**
+   * @brief 变长 Column 的数据空间不够时扩容
+   */
+  RC reserve_data(int size);
+
   char *data_ = nullptr;
+  /// 变长 Column 中每个值的偏移，定长 Column 为 nullptr
+  int *offsets_ = nullptr;
+  /// 变长 Column 中 data_ 的大小（字节）
+  int data_capacity_ = 0;
   /// 当前列值数量
   int count_ = 0;
   /// 当前容量，count_ <= capacity_
@@ -94,7 +134,7 @@ private:
   bool own_ = true;
   /// 列属性类型
   AttrType attr_type_ = AttrType::UNDEFINED;
-  /// 列属性类型长度（目前只支持定长）
+  /// 列属性类型长度，变长 Column 中是值的最大长度
   int attr_len_ = -1;
   /// 列类型
   Type column_type_ = Type::NORMAL_COLUMN;
@@ -17,10 +17,14 @@ See the Mulan PSL v2 for more details. */
 #include <fcntl.h>
 #include <sys/stat.h>
 
+#include "common/conf/ini.h"
+#include "common/ini_setting.h"
+#include "common/lang/chrono.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
 #include "common/os/path.h"
 #include "common/global_context.h"
+#include "common/thread/thread_util.h"
 #include "storage/common/meta_util.h"
 #include "storage/table/table.h"
 #include "storage/table/table_meta.h"
@@ -32,6 +36,16 @@ using namespace common;
 
 Db::~Db()
 {
+  if (checkpoint_thread_) {
+    {
+      lock_guard<mutex> guard(checkpoint_thread_lock_);
+      checkpoint_running_ = false;
+    }
+    checkpoint_cond_.notify_all();
+    checkpoint_thread_->join();
+    checkpoint_thread_.reset();
+  }
+
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
@@ -67,8 +81,83 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
 
   trx_kit_.reset(trx_kit);
 
-  buffer_pool_manager_ = make_unique<BufferPoolManager>();
-  auto dblwr_buffer    = make_unique<DiskDoubleWriteBuffer>(*buffer_pool_manager_);
+  const map<string, string> &buffer_pool_section = get_properties()->get(BUFFER_POOL);
+
+  int  frame_shard_num = BUFFER_POOL_FRAME_SHARD_NUM_DEFAULT;
+  auto it              = buffer_pool_section.find(BUFFER_POOL_FRAME_SHARD_NUM);
+  if (it != buffer_pool_section.end()) {
+    str_to_val(it->second, frame_shard_num);
+  }
+
+  string frame_replacer;
+  it = buffer_pool_section.find(BUFFER_POOL_FRAME_REPLACER);
+  if (it != buffer_pool_section.end()) {
+    frame_replacer = it->second;
+  }
+
+  int prefetch_depth = BUFFER_POOL_PREFETCH_DEPTH_DEFAULT;
+  it                 = buffer_pool_section.find(BUFFER_POOL_PREFETCH_DEPTH);
+  if (it != buffer_pool_section.end()) {
+    str_to_val(it->second, prefetch_depth);
+  }
+
+  int dirty_high_watermark = BUFFER_POOL_DIRTY_HIGH_WATERMARK_DEFAULT;
+  it                       = buffer_pool_section.find(BUFFER_POOL_DIRTY_HIGH_WATERMARK);
+  if (it != buffer_pool_section.end()) {
+    str_to_val(it->second, dirty_high_watermark);
+  }
+
+  int dirty_low_watermark = BUFFER_POOL_DIRTY_LOW_WATERMARK_DEFAULT;
+  it                      = buffer_pool_section.find(BUFFER_POOL_DIRTY_LOW_WATERMARK);
+  if (it != buffer_pool_section.end()) {
+    str_to_val(it->second, dirty_low_watermark);
+  }
+
+  string page_io_engine;
+  it = buffer_pool_section.find(BUFFER_POOL_PAGE_IO_ENGINE);
+  if (it != buffer_pool_section.end()) {
+    page_io_engine = it->second;
+  }
+
+  int double_write_pages = BUFFER_POOL_DOUBLE_WRITE_PAGES_DEFAULT;
+  it                     = buffer_pool_section.find(BUFFER_POOL_DOUBLE_WRITE_PAGES);
+  if (it != buffer_pool_section.end()) {
+    str_to_val(it->second, double_write_pages);
+  }
+
+  string frame_memory;
+  it = buffer_pool_section.find(BUFFER_POOL_FRAME_MEMORY);
+  if (it != buffer_pool_section.end()) {
+    frame_memory = it->second;
+  }
+
+  string frame_numa_policy;
+  it = buffer_pool_section.find(BUFFER_POOL_FRAME_NUMA_POLICY);
+  if (it != buffer_pool_section.end()) {
+    frame_numa_policy = it->second;
+  }
+
+  int64_t max_memory_size = BUFFER_POOL_MAX_MEMORY_SIZE_DEFAULT;
+  it                      = buffer_pool_section.find(BUFFER_POOL_MAX_MEMORY_SIZE);
+  if (it != buffer_pool_section.end()) {
+    str_to_val(it->second, max_memory_size);
+  }
+
+  int page_size = BUFFER_POOL_PAGE_SIZE_DEFAULT;
+  it            = buffer_pool_section.find(BUFFER_POOL_PAGE_SIZE);
+  if (it != buffer_pool_section.end()) {
+    str_to_val(it->second, page_size);
+  }
+
+  checkpoint_interval_ = BUFFER_POOL_CHECKPOINT_INTERVAL_DEFAULT;
+  it                   = buffer_pool_section.find(BUFFER_POOL_CHECKPOINT_INTERVAL);
+  if (it != buffer_pool_section.end()) {
+    str_to_val(it->second, checkpoint_interval_);
+  }
+
+  buffer_pool_manager_ = make_unique<BufferPoolManager>(0 /*memory_size*/, frame_shard_num, frame_replacer.c_str(),
+      page_io_engine.c_str(), frame_memory.c_str(), frame_numa_policy.c_str(), max_memory_size, page_size);
+  auto dblwr_buffer    = make_unique<DiskDoubleWriteBuffer>(*buffer_pool_manager_, double_write_pages);
 
   const char      *double_write_buffer_filename  = "dblwr.db";
   filesystem::path double_write_buffer_file_path = filesystem::path(dbpath) / double_write_buffer_filename;
@@ -79,7 +168,7 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
     return rc;
   }
 
-  rc = buffer_pool_manager_->init(std::move(dblwr_buffer));
+  rc = buffer_pool_manager_->init(std::move(dblwr_buffer), prefetch_depth, dirty_high_watermark, dirty_low_watermark);
   if (OB_FAIL(rc)) {
     LOG_ERROR("Failed to init buffer pool manager. dbpath=%s, rc=%s", dbpath, strrc(rc));
     return rc;
@@ -131,10 +220,16 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
     return rc;
   }
 
+  if (checkpoint_interval_ > 0) {
+    checkpoint_running_ = true;
+    checkpoint_thread_  = make_unique<thread>(&Db::checkpoint_thread_func, this);
+  }
+
   return rc;
 }
 
-RC Db::create_table(const char *table_name, span<const AttrInfoSqlNode> attributes, const StorageFormat storage_format)
+RC Db::create_table(const char *table_name, span<const AttrInfoSqlNode> attributes, const StorageFormat storage_format,
+    PageCompression compression)
 {
   RC rc = RC::SUCCESS;
   // check table_name
@@ -147,7 +242,8 @@ RC Db::create_table(const char *table_name, span<const AttrInfoSqlNode> attribut
   string  table_file_path = table_meta_file(path_.c_str(), table_name);
   Table  *table           = new Table();
   int32_t table_id        = next_table_id_++;
-  rc = table->create(this, table_id, table_file_path.c_str(), table_name, path_.c_str(), attributes, storage_format);
+  rc = table->create(
+      this, table_id, table_file_path.c_str(), table_name, path_.c_str(), attributes, storage_format, compression);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create table %s.", table_name);
     delete table;
@@ -228,26 +324,30 @@ void Db::all_tables(vector<string> &table_names) const
 
 RC Db::sync()
 {
-  RC rc = RC::SUCCESS;
-  // 调用所有表的sync函数刷新数据到磁盘
-  for (const auto &table_pair : opened_tables_) {
-    Table *table = table_pair.second;
-    rc           = table->sync();
-    if (rc != RC::SUCCESS) {
-      LOG_ERROR("Failed to flush table. table=%s.%s, rc=%d:%s", name_.c_str(), table->name(), rc, strrc(rc));
-      return rc;
-    }
-    LOG_INFO("Successfully sync table db:%s, table:%s.", name_.c_str(), table->name());
+  lock_guard<mutex> guard(checkpoint_lock_);
+
+  /*
+  模糊检查点，不要求没有正在进行的事务。
+  先记录当前的LSN，这之前写入日志的修改，在刷新所有的脏页后都已经落盘了。
+  还没有结束的事务，恢复时需要它们完整的日志才能回滚，所以检查点不能超过它们日志的起始位置。
+  */
+  LSN checkpoint_lsn = log_handler_->current_lsn();
+  checkpoint_lsn     = trx_kit_->min_active_lsn(checkpoint_lsn);
+
+  int flushed = 0;
+  RC  rc      = buffer_pool_manager_->get_page_cleaner().flush_all(flushed);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to flush dirty pages. db=%s, rc=%d:%s", name_.c_str(), rc, strrc(rc));
+    return rc;
   }
 
   auto dblwr_buffer = static_cast<DiskDoubleWriteBuffer *>(buffer_pool_manager_->get_dblwr_buffer());
   rc                = dblwr_buffer->flush_page();
-  LOG_INFO("double write buffer flush pages ret=%s", strrc(rc));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to flush double write buffer. db=%s, rc=%d:%s", name_.c_str(), rc, strrc(rc));
+    return rc;
+  }
 
-  /*
-  在sync期间，不允许有未完成的事务，也不允许开启新的事物。
-  这个约束不是从程序层面处理的，而是认为的约束。
-  */
   LSN current_lsn = log_handler_->current_lsn();
   rc              = log_handler_->wait_lsn(current_lsn);
   if (OB_FAIL(rc)) {
@@ -255,16 +355,39 @@ RC Db::sync()
     return rc;
   }
 
-  check_point_lsn_ = current_lsn;
+  check_point_lsn_ = checkpoint_lsn;
   rc               = flush_meta();
   if (OB_FAIL(rc)) {
     LOG_ERROR("Failed to flush meta. db=%s, rc=%d:%s", name_.c_str(), rc, strrc(rc));
     return rc;
   }
-  LOG_INFO("Successfully sync db. db=%s", name_.c_str());
+  LOG_INFO("Successfully sync db. db=%s, checkpoint lsn=%ld, flushed pages=%d", name_.c_str(), check_point_lsn_, flushed);
   return rc;
 }
 
+void Db::checkpoint_thread_func()
+{
+  thread_set_name("Checkpoint");
+  LOG_INFO("checkpoint thread started. db=%s, interval=%ds", name_.c_str(), checkpoint_interval_);
+
+  unique_lock<mutex> lock(checkpoint_thread_lock_);
+  while (checkpoint_running_) {
+    checkpoint_cond_.wait_for(lock, chrono::seconds(checkpoint_interval_), [this]() { return !checkpoint_running_; });
+    if (!checkpoint_running_) {
+      break;
+    }
+
+    lock.unlock();
+    RC rc = sync();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to do checkpoint. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    }
+    lock.lock();
+  }
+
+  LOG_INFO("checkpoint thread stopped. db=%s", name_.c_str());
+}
+
 RC Db::recover()
 {
   LOG_TRACE("db recover begin. check_point_lsn=%d", check_point_lsn_);
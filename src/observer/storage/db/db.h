@@ -20,6 +20,9 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/unordered_map.h"
 #include "common/lang/memory.h"
 #include "common/lang/span.h"
+#include "common/lang/mutex.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/thread.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/clog/disk_log_handler.h"
@@ -62,9 +65,11 @@ public:
    * @param table_name 表名
    * @param attributes 表的属性
    * @param storage_format 表的存储格式
+   * @param compression 表数据文件的页面压缩算法
    */
   RC create_table(const char *table_name, span<const AttrInfoSqlNode> attributes,
-      const StorageFormat storage_format = StorageFormat::ROW_FORMAT);
+      const StorageFormat storage_format = StorageFormat::ROW_FORMAT,
+      PageCompression compression = PageCompression::NONE);
 
   /**
    * @brief 根据表名查找表
@@ -82,8 +87,10 @@ public:
   void all_tables(vector<string> &table_names) const;
 
   /**
-   * @brief 将所有内存中的数据，刷新到磁盘中。
-   * @details 注意，这里也没有并发控制，需要由上层来保证当前没有正在进行的事务。
+   * @brief 做一次检查点，将所有内存中的数据，刷新到磁盘中。
+   * @details 这是一个模糊检查点，不要求没有正在进行的事务，也不会阻止开启新的事务。
+   * 先记录当前的LSN，再刷新所有的脏页，刷新时只会短暂地锁住单个页面。
+   * 检查点LSN取这个LSN与活跃事务日志起始位置中较小的一个，恢复时从这里开始重放日志。
    */
   RC sync();
 
@@ -110,6 +117,9 @@ private:
   /// @brief 初始化数据库的double buffer pool
   RC init_dblwr_buffer();
 
+  /// @brief 后台检查点线程，定期调用 sync
+  void checkpoint_thread_func();
+
 private:
   string                         name_;                 ///< 数据库名称
   string                         path_;                 ///< 数据库文件存放的目录
@@ -122,4 +132,11 @@ private:
   int32_t next_table_id_ = 0;
 
   LSN check_point_lsn_ = 0;  ///< 当前数据库的检查点LSN。会记录到磁盘中。
+
+  mutex              checkpoint_lock_;           ///< 同一时间只能做一个检查点
+  int                checkpoint_interval_ = 0;   ///< 后台检查点的时间间隔(秒)，0表示不启动后台检查点
+  mutex              checkpoint_thread_lock_;    ///< 保护 checkpoint_running_
+  condition_variable checkpoint_cond_;
+  bool               checkpoint_running_ = false;
+  unique_ptr<thread> checkpoint_thread_;
 };
@@ -29,17 +29,21 @@ using namespace common;
  */
 #define FIRST_INDEX_PAGE 1
 
-int calc_internal_page_capacity(int attr_length)
+/**
+ * @brief 计算内部节点最多可以存放多少个键值
+ * @param page_data_size 页面中可以存放数据的大小，与索引文件的页面大小有关
+ */
+int calc_internal_page_capacity(int attr_length, int page_data_size)
 {
   int item_size = attr_length + sizeof(RID) + sizeof(PageNum);
-  int capacity  = ((int)BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE) / item_size;
+  int capacity  = (page_data_size - InternalIndexNode::HEADER_SIZE) / item_size;
   return capacity;
 }
 
-int calc_leaf_page_capacity(int attr_length)
+int calc_leaf_page_capacity(int attr_length, int page_data_size)
 {
   int item_size = attr_length + sizeof(RID) + sizeof(RID);
-  int capacity  = ((int)BP_PAGE_DATA_SIZE - LeafIndexNode::HEADER_SIZE) / item_size;
+  int capacity  = (page_data_size - LeafIndexNode::HEADER_SIZE) / item_size;
   return capacity;
 }
 
@@ -799,6 +803,24 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
                             int attr_length, 
                             int internal_max_size /* = -1*/,
                             int leaf_max_size /* = -1 */)
+{
+  return this->create(log_handler,
+      bpm,
+      file_name,
+      span<const AttrType>(&attr_type, 1),
+      span<const int>(&attr_length, 1),
+      internal_max_size,
+      leaf_max_size);
+}
+
+RC BplusTreeHandler::create(LogHandler &log_handler,
+                            BufferPoolManager &bpm,
+                            const char *file_name,
+                            span<const AttrType> attr_types,
+                            span<const int> attr_lengths,
+                            int internal_max_size /* = -1*/,
+                            int leaf_max_size /* = -1 */,
+                            bool unique /* = false */)
 {
   RC rc = bpm.create_file(file_name);
   if (OB_FAIL(rc)) {
@@ -816,7 +838,7 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
   }
   LOG_INFO("Successfully open index file %s.", file_name);
 
-  rc = this->create(log_handler, *bp, attr_type, attr_length, internal_max_size, leaf_max_size);
+  rc = this->create(log_handler, *bp, attr_types, attr_lengths, internal_max_size, leaf_max_size, unique);
   if (OB_FAIL(rc)) {
     bpm.close_file(file_name);
     return rc;
@@ -833,11 +855,38 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
             int internal_max_size /* = -1 */,
             int leaf_max_size /* = -1 */)
 {
+  return this->create(log_handler,
+      buffer_pool,
+      span<const AttrType>(&attr_type, 1),
+      span<const int>(&attr_length, 1),
+      internal_max_size,
+      leaf_max_size);
+}
+
+RC BplusTreeHandler::create(LogHandler &log_handler,
+            DiskBufferPool &buffer_pool,
+            span<const AttrType> attr_types,
+            span<const int> attr_lengths,
+            int internal_max_size /* = -1 */,
+            int leaf_max_size /* = -1 */,
+            bool unique /* = false */)
+{
+  const int attr_num = static_cast<int>(attr_types.size());
+  if (attr_num == 0 || attr_num > IndexFileHeader::MAX_ATTR_NUM || attr_lengths.size() != attr_types.size()) {
+    LOG_WARN("invalid attributes of index. attr num=%d, length num=%d", attr_num, static_cast<int>(attr_lengths.size()));
+    return RC::INVALID_ARGUMENT;
+  }
+
+  int attr_length = 0;
+  for (int length : attr_lengths) {
+    attr_length += length;
+  }
+
   if (internal_max_size < 0) {
-    internal_max_size = calc_internal_page_capacity(attr_length);
+    internal_max_size = calc_internal_page_capacity(attr_length, buffer_pool.page_data_size());
   }
   if (leaf_max_size < 0) {
-    leaf_max_size = calc_leaf_page_capacity(attr_length);
+    leaf_max_size = calc_leaf_page_capacity(attr_length, buffer_pool.page_data_size());
   }
 
   log_handler_      = &log_handler;
@@ -865,10 +914,17 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
   IndexFileHeader *file_header   = (IndexFileHeader *)pdata;
   file_header->attr_length       = attr_length;
   file_header->key_length        = attr_length + sizeof(RID);
-  file_header->attr_type         = attr_type;
+  file_header->attr_type         = attr_types[0];
   file_header->internal_max_size = internal_max_size;
   file_header->leaf_max_size     = leaf_max_size;
   file_header->root_page         = BP_INVALID_PAGE_NUM;
+  // 单个字段的索引与旧版本的格式保持一致
+  file_header->attr_num = attr_num > 1 ? attr_num : 0;
+  file_header->unique   = unique;
+  for (int i = 0; i < file_header->attr_num; i++) {
+    file_header->attr_types[i]   = attr_types[i];
+    file_header->attr_lengths[i] = attr_lengths[i];
+  }
 
   // 取消记录日志的原因请参考下面的sync调用的地方。
   // mtr.logger().init_header_page(header_frame, *file_header);
@@ -885,8 +941,7 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
     return RC::NOMEM;
   }
 
-  key_comparator_.init(file_header->attr_type, file_header->attr_length);
-  key_printer_.init(file_header->attr_type, file_header->attr_length);
+  init_key_comparator();
 
   /*
   虽然我们针对B+树记录了WAL，但是我们记录的都是逻辑日志，并没有记录某个页面如何修改的物理日志。
@@ -957,8 +1012,7 @@ RC BplusTreeHandler::open(LogHandler &log_handler, DiskBufferPool &buffer_pool)
   // close old page_handle
   buffer_pool.unpin_page(frame);
 
-  key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
-  key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  init_key_comparator();
   LOG_INFO("Successfully open index");
   return RC::SUCCESS;
 }
@@ -1203,6 +1257,13 @@ RC BplusTreeHandler::find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTree
 {
   LatchMemo &latch_memo = mtr.latch_memo();
 
+  if (op == BplusTreeOperationType::READ) {
+    RC rc = optimistic_find_leaf(mtr, child_page_getter, frame);
+    if (rc != RC::LOCKED_CONCURRENCY_CONFLICT) {
+      return rc;
+    }
+  }
+
   // root locked
   if (op != BplusTreeOperationType::READ) {
     latch_memo.xlatch(&root_lock_);
@@ -1236,6 +1297,101 @@ RC BplusTreeHandler::find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTree
   return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::optimistic_find_leaf(BplusTreeMiniTransaction &mtr,
+    const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame)
+{
+  LatchMemo &latch_memo = mtr.latch_memo();
+
+  // 查找过程中固定的页面不放在 latch memo 中，因为要在拿到子节点之后单独释放父节点
+  Frame   *current  = nullptr;
+  uint64_t version  = 0;
+  auto     conflict = [&]() {
+    if (current != nullptr) {
+      disk_buffer_pool_->unpin_page(current);
+    }
+    latch_memo.release_to(latch_memo.memo_point());
+    optimistic_stats_.conflict++;
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  };
+
+  // 根节点的页面编号由 root_lock_ 保护。拿到根节点的版本号之后就可以释放，根节点分裂或删除时都会修改版本号
+  latch_memo.slatch(&root_lock_);
+  if (is_empty()) {
+    return RC::EMPTY;
+  }
+
+  if (OB_FAIL(disk_buffer_pool_->get_this_page(file_header_.root_page, &current))) {
+    return conflict();
+  }
+  if (!current->optimistic_read_begin(version)) {
+    return conflict();
+  }
+  latch_memo.release_to(latch_memo.memo_point());
+
+  // 内部节点的内容复制出来之后再查找，查找时使用的是一致的数据
+  static thread_local Frame        snapshot;
+  static thread_local vector<char> snapshot_page;
+  if (snapshot_page.size() < static_cast<size_t>(disk_buffer_pool_->page_size())) {
+    snapshot_page.resize(disk_buffer_pool_->page_size());
+  }
+  snapshot.set_page(reinterpret_cast<Page *>(snapshot_page.data()), disk_buffer_pool_->page_size());
+
+  while (true) {
+    // 读到的数据可能是不一致的，先检查节点大小，避免访问页面以外的内存
+    IndexNode *node    = (IndexNode *)current->data();
+    const bool is_leaf = node->is_leaf;
+    const int  key_num = node->key_num;
+    if (!current->optimistic_read_validate(version)) {
+      return conflict();
+    }
+    if (is_leaf) {
+      break;
+    }
+    if (key_num <= 0 || key_num > file_header_.internal_max_size) {
+      return conflict();
+    }
+
+    const int node_size = InternalIndexNode::HEADER_SIZE + key_num * (file_header_.key_length + sizeof(PageNum));
+    memcpy(snapshot.data(), current->data(), node_size);
+    if (!current->optimistic_read_validate(version)) {
+      return conflict();
+    }
+
+    InternalIndexNodeHandler internal_node(mtr, file_header_, &snapshot);
+    const PageNum            child_page_num = child_page_getter(internal_node);
+
+    Frame *child = nullptr;
+    if (OB_FAIL(disk_buffer_pool_->get_this_page(child_page_num, &child))) {
+      return conflict();
+    }
+
+    uint64_t child_version = 0;
+    bool     valid         = child->optimistic_read_begin(child_version) && current->optimistic_read_validate(version);
+    disk_buffer_pool_->unpin_page(current);
+    current = child;
+    version = child_version;
+    if (!valid) {
+      return conflict();
+    }
+  }
+
+  // 叶子节点与 crabing protocol 一样加读锁返回。加锁之后版本号没有变化，说明找到的就是正确的叶子节点
+  RC rc = latch_memo.get_page(current->page_num(), frame);
+  if (OB_FAIL(rc)) {
+    return conflict();
+  }
+  disk_buffer_pool_->unpin_page(current);
+  current = nullptr;
+
+  latch_memo.slatch(frame);
+  if (!frame->optimistic_read_validate(version)) {
+    return conflict();
+  }
+
+  optimistic_stats_.success++;
+  return RC::SUCCESS;
+}
+
 RC BplusTreeHandler::crabing_protocal_fetch_page(
     BplusTreeMiniTransaction &mtr, BplusTreeOperationType op, PageNum page_num, bool is_root_node, Frame *&frame)
 {
@@ -1436,8 +1592,7 @@ RC BplusTreeHandler::recover_init_header_page(BplusTreeMiniTransaction &mtr, Fra
   header_dirty_ = false;
   frame->mark_dirty();
 
-  key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
-  key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  init_key_comparator();
 
   return RC::SUCCESS;
 }
@@ -1495,6 +1650,25 @@ MemPoolItem::item_unique_ptr BplusTreeHandler::make_key(const char *user_key, co
   return key;
 }
 
+void BplusTreeHandler::init_key_comparator()
+{
+  if (file_header_.attr_num > 0) {
+    span<const AttrType> attr_types(file_header_.attr_types, file_header_.attr_num);
+    span<const int>      attr_lengths(file_header_.attr_lengths, file_header_.attr_num);
+    key_comparator_.init(attr_types, attr_lengths);
+    key_printer_.init(attr_types, attr_lengths);
+  } else {
+    key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
+    key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  }
+}
+
+const RID &BplusTreeHandler::key_rid(const RID &rid) const
+{
+  static const RID unique_key_rid{0, 1};
+  return file_header_.unique ? unique_key_rid : rid;
+}
+
 RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
 {
   if (user_key == nullptr || rid == nullptr) {
@@ -1502,7 +1676,7 @@ RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
     return RC::INVALID_ARGUMENT;
   }
 
-  MemPoolItem::item_unique_ptr pkey = make_key(user_key, *rid);
+  MemPoolItem::item_unique_ptr pkey = make_key(user_key, key_rid(*rid));
   if (pkey == nullptr) {
     LOG_WARN("Failed to alloc memory for key.");
     return RC::NOMEM;
@@ -1761,10 +1935,20 @@ RC BplusTreeHandler::redistribute(BplusTreeMiniTransaction &mtr, Frame *neighbor
   return RC::SUCCESS;
 }
 
-RC BplusTreeHandler::delete_entry_internal(BplusTreeMiniTransaction &mtr, Frame *leaf_frame, const char *key)
+RC BplusTreeHandler::delete_entry_internal(BplusTreeMiniTransaction &mtr, Frame *leaf_frame, const char *key, const RID *rid)
 {
   LeafIndexNodeHandler leaf_index_node(mtr, file_header_, leaf_frame);
 
+  // 唯一索引的键值中没有数据的RID，需要确认找到的是要删除的数据
+  if (file_header_.unique) {
+    bool      found = false;
+    const int index = leaf_index_node.lookup(key_comparator_, key, &found);
+    if (!found || memcmp(leaf_index_node.value_at(index), rid, sizeof(*rid)) != 0) {
+      LOG_TRACE("no data need to remove");
+      return RC::RECORD_NOT_EXIST;
+    }
+  }
+
   const int remove_count = leaf_index_node.remove(key, key_comparator_);
   if (remove_count == 0) {
     LOG_TRACE("no data need to remove");
@@ -1792,7 +1976,7 @@ RC BplusTreeHandler::delete_entry(const char *user_key, const RID *rid)
   char *key = static_cast<char *>(pkey.get());
 
   memcpy(key, user_key, file_header_.attr_length);
-  memcpy(key + file_header_.attr_length, rid, sizeof(*rid));
+  memcpy(key + file_header_.attr_length, &key_rid(*rid), sizeof(*rid));
 
   BplusTreeOperationType op = BplusTreeOperationType::DELETE;
 
@@ -1813,7 +1997,7 @@ RC BplusTreeHandler::delete_entry(const char *user_key, const RID *rid)
     return rc;
   }
 
-  rc = delete_entry_internal(mtr, leaf_frame, key);
+  rc = delete_entry_internal(mtr, leaf_frame, key, rid);
   return rc;
 }
 
@@ -1866,7 +2050,7 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
   } else {
 
     char *fixed_left_key = const_cast<char *>(left_user_key);
-    if (tree_handler_.file_header_.attr_type == AttrType::CHARS) {
+    if (tree_handler_.file_header_.attr_type == AttrType::CHARS && tree_handler_.file_header_.attr_num == 0) {
       bool should_inclusive_after_fix = false;
       rc = fix_user_key(left_user_key, left_len, true /*greater*/, &fixed_left_key, &should_inclusive_after_fix);
       if (OB_FAIL(rc)) {
@@ -1933,7 +2117,7 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
     char *fixed_right_key          = const_cast<char *>(right_user_key);
     bool  should_include_after_fix = false;
-    if (tree_handler_.file_header_.attr_type == AttrType::CHARS) {
+    if (tree_handler_.file_header_.attr_type == AttrType::CHARS && tree_handler_.file_header_.attr_num == 0) {
       rc = fix_user_key(right_user_key, right_len, false /*want_greater*/, &fixed_right_key, &should_include_after_fix);
       if (OB_FAIL(rc)) {
         LOG_WARN("failed to fix right user key. rc=%s", strrc(rc));
@@ -1958,6 +2142,8 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
   if (touch_end()) {
     current_frame_ = nullptr;
+  } else {
+    prefetch_next_leaf();
   }
 
   return RC::SUCCESS;
@@ -2033,9 +2219,19 @@ RC BplusTreeScanner::next_entry(RID &rid)
 
   latch_memo.release_to(memo_point);
   iter_index_ = -1;  // `next` will add 1
+  prefetch_next_leaf();
   return next_entry(rid);
 }
 
+void BplusTreeScanner::prefetch_next_leaf()
+{
+  LeafIndexNodeHandler node(mtr_, tree_handler_.file_header_, current_frame_);
+  PageNum              next_page_num = node.next_page();
+  if (next_page_num != BP_INVALID_PAGE_NUM) {
+    tree_handler_.buffer_pool().prefetch(next_page_num);
+  }
+}
+
 RC BplusTreeScanner::close()
 {
   inited_ = false;
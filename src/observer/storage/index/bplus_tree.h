@@ -19,10 +19,13 @@ See the Mulan PSL v2 for more details. */
 
 #include <string.h>
 
+#include "common/lang/atomic.h"
 #include "common/lang/comparator.h"
 #include "common/lang/memory.h"
 #include "common/lang/sstream.h"
 #include "common/lang/functional.h"
+#include "common/lang/span.h"
+#include "common/lang/vector.h"
 #include "common/log/log.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -51,15 +54,22 @@ enum class BplusTreeOperationType
 
 /**
  * @brief 属性比较(BplusTree)
+ * @details 联合索引的属性是多个字段按照顺序拼接起来的，比较时逐个字段比较
  * @ingroup BPlusTree
  */
 class AttrComparator
 {
 public:
-  void init(AttrType type, int length)
+  void init(AttrType type, int length) { init(span<const AttrType>(&type, 1), span<const int>(&length, 1)); }
+
+  void init(span<const AttrType> types, span<const int> lengths)
   {
-    attr_type_   = type;
-    attr_length_ = length;
+    attr_types_.assign(types.begin(), types.end());
+    attr_lengths_.assign(lengths.begin(), lengths.end());
+    attr_length_ = 0;
+    for (int length : attr_lengths_) {
+      attr_length_ += length;
+    }
   }
 
   int attr_length() const { return attr_length_; }
@@ -67,18 +77,27 @@ public:
   int operator()(const char *v1, const char *v2) const
   {
     // TODO: optimized the comparison
-    Value left;
-    left.set_type(attr_type_);
-    left.set_data(v1, attr_length_);
-    Value right;
-    right.set_type(attr_type_);
-    right.set_data(v2, attr_length_);
-    return DataType::type_instance(attr_type_)->compare(left, right);
+    int offset = 0;
+    for (size_t i = 0; i < attr_types_.size(); i++) {
+      Value left;
+      left.set_type(attr_types_[i]);
+      left.set_data(v1 + offset, attr_lengths_[i]);
+      Value right;
+      right.set_type(attr_types_[i]);
+      right.set_data(v2 + offset, attr_lengths_[i]);
+      int result = DataType::type_instance(attr_types_[i])->compare(left, right);
+      if (result != 0) {
+        return result;
+      }
+      offset += attr_lengths_[i];
+    }
+    return 0;
   }
 
 private:
-  AttrType attr_type_;
-  int      attr_length_;
+  vector<AttrType> attr_types_;
+  vector<int>      attr_lengths_;
+  int              attr_length_ = 0;
 };
 
 /**
@@ -90,6 +109,7 @@ class KeyComparator
 {
 public:
   void init(AttrType type, int length) { attr_comparator_.init(type, length); }
+  void init(span<const AttrType> types, span<const int> lengths) { attr_comparator_.init(types, lengths); }
 
   const AttrComparator &attr_comparator() const { return attr_comparator_; }
 
@@ -116,23 +136,45 @@ private:
 class AttrPrinter
 {
 public:
-  void init(AttrType type, int length)
+  void init(AttrType type, int length) { init(span<const AttrType>(&type, 1), span<const int>(&length, 1)); }
+
+  void init(span<const AttrType> types, span<const int> lengths)
   {
-    attr_type_   = type;
-    attr_length_ = length;
+    attr_types_.assign(types.begin(), types.end());
+    attr_lengths_.assign(lengths.begin(), lengths.end());
+    attr_length_ = 0;
+    for (int length : attr_lengths_) {
+      attr_length_ += length;
+    }
   }
 
   int attr_length() const { return attr_length_; }
 
   string operator()(const char *v) const
   {
-    Value value(attr_type_, const_cast<char *>(v), attr_length_);
-    return value.to_string();
+    if (attr_types_.size() == 1) {
+      Value value(attr_types_[0], const_cast<char *>(v), attr_lengths_[0]);
+      return value.to_string();
+    }
+
+    string result = "(";
+    int    offset = 0;
+    for (size_t i = 0; i < attr_types_.size(); i++) {
+      if (i > 0) {
+        result += ",";
+      }
+      Value value(attr_types_[i], const_cast<char *>(v + offset), attr_lengths_[i]);
+      result += value.to_string();
+      offset += attr_lengths_[i];
+    }
+    result += ")";
+    return result;
   }
 
 private:
-  AttrType attr_type_;
-  int      attr_length_;
+  vector<AttrType> attr_types_;
+  vector<int>      attr_lengths_;
+  int              attr_length_ = 0;
 };
 
 /**
@@ -143,6 +185,7 @@ class KeyPrinter
 {
 public:
   void init(AttrType type, int length) { attr_printer_.init(type, length); }
+  void init(span<const AttrType> types, span<const int> lengths) { attr_printer_.init(types, lengths); }
 
   const AttrPrinter &attr_printer() const { return attr_printer_; }
 
@@ -164,21 +207,28 @@ private:
  * @brief the meta information of bplus tree
  * @ingroup BPlusTree
  * @details this is the first page of bplus tree.
- * only one field can be supported, can you extend it to multi-fields?
+ * 联合索引的每个字段类型和长度记录在 attr_types 和 attr_lengths 中，键值是这些字段按顺序拼接起来的。
+ * attr_num 为 0 时只有一个字段，使用 attr_type 和 attr_length，这样旧版本的索引文件也可以直接打开。
  */
 struct IndexFileHeader
 {
+  static constexpr int MAX_ATTR_NUM = 8;  ///< 联合索引最多包含的字段个数
+
   IndexFileHeader()
   {
     memset(this, 0, sizeof(IndexFileHeader));
     root_page = BP_INVALID_PAGE_NUM;
   }
-  PageNum  root_page;          ///< 根节点在磁盘中的页号
-  int32_t  internal_max_size;  ///< 内部节点最大的键值对数
-  int32_t  leaf_max_size;      ///< 叶子节点最大的键值对数
-  int32_t  attr_length;        ///< 键值的长度
-  int32_t  key_length;         ///< attr length + sizeof(RID)
-  AttrType attr_type;          ///< 键值的类型
+  PageNum  root_page;                   ///< 根节点在磁盘中的页号
+  int32_t  internal_max_size;           ///< 内部节点最大的键值对数
+  int32_t  leaf_max_size;               ///< 叶子节点最大的键值对数
+  int32_t  attr_length;                 ///< 键值的长度
+  int32_t  key_length;                  ///< attr length + sizeof(RID)
+  AttrType attr_type;                   ///< 键值的类型。联合索引时是第一个字段的类型
+  int32_t  attr_num;                    ///< 联合索引的字段个数，单个字段时是0
+  AttrType attr_types[MAX_ATTR_NUM];    ///< 联合索引每个字段的类型
+  int32_t  attr_lengths[MAX_ATTR_NUM];  ///< 联合索引每个字段的长度
+  bool     unique;                      ///< 是否是唯一索引
 
   const string to_string() const
   {
@@ -186,7 +236,15 @@ struct IndexFileHeader
 
     ss << "attr_length:" << attr_length << ","
        << "key_length:" << key_length << ","
-       << "attr_type:" << attr_type_to_string(attr_type) << ","
+       << "attr_type:" << attr_type_to_string(attr_type) << ",";
+    if (attr_num > 0) {
+      ss << "attrs:[";
+      for (int i = 0; i < attr_num; i++) {
+        ss << (i > 0 ? "," : "") << attr_type_to_string(attr_types[i]) << "(" << attr_lengths[i] << ")";
+      }
+      ss << "],";
+    }
+    ss << "unique:" << unique << ","
        << "root_page:" << root_page << ","
        << "internal_max_size:" << internal_max_size << ","
        << "leaf_max_size:" << leaf_max_size << ";";
@@ -464,6 +522,18 @@ public:
   RC create(LogHandler &log_handler, DiskBufferPool &buffer_pool, AttrType attr_type, int attr_length,
       int internal_max_size = -1, int leaf_max_size = -1);
 
+  /**
+   * @brief 创建一个联合索引的B+树
+   * @details 键值是多个字段按照顺序拼接起来的，字段个数不能超过 IndexFileHeader::MAX_ATTR_NUM
+   * @param attr_types 每个字段的类型
+   * @param attr_lengths 每个字段的长度
+   * @param unique 是否是唯一索引，唯一索引中插入键值相同的数据会返回 RECORD_DUPLICATE_KEY
+   */
+  RC create(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name, span<const AttrType> attr_types,
+      span<const int> attr_lengths, int internal_max_size = -1, int leaf_max_size = -1, bool unique = false);
+  RC create(LogHandler &log_handler, DiskBufferPool &buffer_pool, span<const AttrType> attr_types,
+      span<const int> attr_lengths, int internal_max_size = -1, int leaf_max_size = -1, bool unique = false);
+
   /**
    * @brief 打开一个B+树
    * @param log_handler 记录日志
@@ -512,6 +582,17 @@ public:
   bool validate_tree();
 
 public:
+  /**
+   * @brief 乐观读查找叶子节点的统计信息
+   */
+  struct OptimisticStats
+  {
+    atomic<int64_t> success{0};   ///< 不加内部节点的锁找到了叶子节点
+    atomic<int64_t> conflict{0};  ///< 遇到并发修改，改用 crabing protocol 的次数
+  };
+
+  OptimisticStats &optimistic_stats() { return optimistic_stats_; }
+
   const IndexFileHeader &file_header() const { return file_header_; }
   DiskBufferPool        &buffer_pool() const { return *disk_buffer_pool_; }
   LogHandler            &log_handler() const { return *log_handler_; }
@@ -568,6 +649,18 @@ protected:
   RC find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTreeOperationType op,
       const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame);
 
+  /**
+   * @brief 使用乐观读查找叶子节点，只用于读操作
+   * @details 内部节点不加读锁，只固定页面，把节点内容复制出来之后检查页帧的版本号(参考 Frame::optimistic_read_begin)，
+   * 版本号没有变化时再从复制的内容中查找子节点。
+   * 拿到子节点的版本号之后再检查一次父节点的版本号，确保子节点是从一致的父节点中找到的。
+   * 找到的叶子节点加上读锁，再检查一次版本号，与 crabing protocol 返回的结果一样。
+   * @return 遇到并发修改时返回 RC::LOCKED_CONCURRENCY_CONFLICT，调用方需要使用 crabing protocol 重新查找。
+   * 这时已经释放了查找过程中拿到的所有锁和页面
+   */
+  RC optimistic_find_leaf(BplusTreeMiniTransaction &mtr,
+      const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame);
+
   /**
    * @brief 使用crabing protocol 获取页面
    */
@@ -577,7 +670,7 @@ protected:
   /**
    * @brief 从叶子节点中删除指定的键值对
    */
-  RC delete_entry_internal(BplusTreeMiniTransaction &mtr, Frame *leaf_frame, const char *key);
+  RC delete_entry_internal(BplusTreeMiniTransaction &mtr, Frame *leaf_frame, const char *key, const RID *rid);
 
   /**
    * @brief 拆分节点
@@ -635,6 +728,19 @@ protected:
 private:
   common::MemPoolItem::item_unique_ptr make_key(const char *user_key, const RID &rid);
 
+  /**
+   * @brief 插入和删除数据时，键值中使用的RID
+   * @details 普通索引的键值中使用数据的RID，这样键值不会重复。唯一索引的键值中使用一个固定的RID，
+   * 键值相同的数据在B+树中的位置也相同，插入时在叶子节点上就能发现重复的数据，与插入是同一个原子操作。
+   * 固定的RID介于 RID::min 和 RID::max 之间，扫描时边界的处理与普通索引相同。
+   */
+  const RID &key_rid(const RID &rid) const;
+
+  /**
+   * @brief 根据元数据页面中记录的字段信息初始化键值比较器和打印器
+   */
+  void init_key_comparator();
+
 protected:
   LogHandler     *log_handler_      = nullptr;  /// 日志处理器
   DiskBufferPool *disk_buffer_pool_ = nullptr;  /// 磁盘缓冲池
@@ -645,6 +751,8 @@ protected:
   // 这个锁可以使用递归读写锁，但是这里偷懒先不改
   common::SharedMutex root_lock_;
 
+  OptimisticStats optimistic_stats_;
+
   KeyComparator key_comparator_;
   KeyPrinter    key_printer_;
 
@@ -697,7 +805,8 @@ public:
 
 private:
   /**
-   * 如果key的类型是CHARS, 扩展或缩减user_key的大小刚好是schema中定义的大小
+   * 如果是单个字段的索引并且key的类型是CHARS, 扩展或缩减user_key的大小刚好是schema中定义的大小
+   * 联合索引的键值由调用者构造，长度总是与 attr_length 一致
    */
   RC fix_user_key(const char *user_key, int key_len, bool want_greater, char **fixed_key, bool *should_inclusive);
 
@@ -708,6 +817,11 @@ private:
    */
   bool touch_end();
 
+  /**
+   * @brief 请求预读当前叶子节点的下一个叶子节点
+   */
+  void prefetch_next_leaf();
+
 private:
   bool                     inited_ = false;
   BplusTreeHandler        &tree_handler_;
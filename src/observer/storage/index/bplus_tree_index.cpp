@@ -13,13 +13,16 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/index/bplus_tree_index.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/limits.h"
 #include "common/log/log.h"
 #include "storage/table/table.h"
 #include "storage/db/db.h"
 
 BplusTreeIndex::~BplusTreeIndex() noexcept { close(); }
 
-RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::create(
+    Table *table, const char *file_name, const IndexMeta &index_meta, const vector<const FieldMeta *> &field_metas)
 {
   if (inited_) {
     LOG_WARN("Failed to create index due to the index has been created before. file_name:%s, index:%s, field:%s",
@@ -27,16 +30,32 @@ RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
+
+  vector<AttrType> attr_types;
+  vector<int>      attr_lengths;
+  for (const FieldMeta &field_meta : field_metas_) {
+    attr_types.push_back(field_meta.type());
+    attr_lengths.push_back(field_meta.len());
+  }
 
   BufferPoolManager &bpm = table->db()->buffer_pool_manager();
-  RC rc = index_handler_.create(table->db()->log_handler(), bpm, file_name, field_meta.type(), field_meta.len());
+  RC rc = index_handler_.create(table->db()->log_handler(),
+      bpm,
+      file_name,
+      attr_types,
+      attr_lengths,
+      -1 /*internal_max_size*/,
+      -1 /*leaf_max_size*/,
+      index_meta.unique());
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to create index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name, index_meta.name(), index_meta.field(), strrc(rc));
     return rc;
   }
 
+  init_attr_comparator();
+
   inited_ = true;
   table_  = table;
   LOG_INFO("Successfully create index, file_name:%s, index:%s, field:%s",
@@ -44,7 +63,8 @@ RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &
   return RC::SUCCESS;
 }
 
-RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::open(
+    Table *table, const char *file_name, const IndexMeta &index_meta, const vector<const FieldMeta *> &field_metas)
 {
   if (inited_) {
     LOG_WARN("Failed to open index due to the index has been initedd before. file_name:%s, index:%s, field:%s",
@@ -52,7 +72,7 @@ RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &in
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
 
   BufferPoolManager &bpm = table->db()->buffer_pool_manager();
   RC rc = index_handler_.open(table->db()->log_handler(), bpm, file_name);
@@ -62,6 +82,21 @@ RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &in
     return rc;
   }
 
+  init_attr_comparator();
+  if (attr_comparator_.attr_length() != index_handler_.file_header().attr_length) {
+    LOG_WARN("index file does not match the fields. file_name:%s, index:%s, attr length in file:%d, fields length:%d",
+        file_name, index_meta.name(), index_handler_.file_header().attr_length, attr_comparator_.attr_length());
+    index_handler_.close();
+    return RC::INTERNAL;
+  }
+
+  if (index_handler_.file_header().unique != index_meta.unique()) {
+    LOG_WARN("unique flag of index file does not match the meta. file_name:%s, index:%s, unique in file:%d",
+        file_name, index_meta.name(), index_handler_.file_header().unique);
+    index_handler_.close();
+    return RC::INTERNAL;
+  }
+
   inited_ = true;
   table_  = table;
   LOG_INFO("Successfully open index, file_name:%s, index:%s, field:%s",
@@ -69,6 +104,17 @@ RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &in
   return RC::SUCCESS;
 }
 
+void BplusTreeIndex::init_attr_comparator()
+{
+  vector<AttrType> attr_types;
+  vector<int>      attr_lengths;
+  for (const FieldMeta &field_meta : field_metas_) {
+    attr_types.push_back(field_meta.type());
+    attr_lengths.push_back(field_meta.len());
+  }
+  attr_comparator_.init(attr_types, attr_lengths);
+}
+
 RC BplusTreeIndex::close()
 {
   if (inited_) {
@@ -80,14 +126,62 @@ RC BplusTreeIndex::close()
   return RC::SUCCESS;
 }
 
+const char *BplusTreeIndex::make_user_key(const char *record, char *buffer) const
+{
+  if (field_metas_.size() == 1) {
+    return record + field_metas_[0].offset();
+  }
+
+  int offset = 0;
+  for (const FieldMeta &field_meta : field_metas_) {
+    memcpy(buffer + offset, record + field_meta.offset(), field_meta.len());
+    offset += field_meta.len();
+  }
+  return buffer;
+}
+
 RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
 {
-  return index_handler_.insert_entry(record + field_meta_.offset(), rid);
+  vector<char> buffer(attr_comparator_.attr_length());
+  return index_handler_.insert_entry(make_user_key(record, buffer.data()), rid);
+}
+
+RC BplusTreeIndex::insert_entries(span<const char *const> records, span<const RID> rids)
+{
+  const int            attr_length = attr_comparator_.attr_length();
+  vector<char>         buffer(records.size() * attr_length);
+  vector<const char *> user_keys(records.size());
+  for (size_t i = 0; i < records.size(); i++) {
+    user_keys[i] = make_user_key(records[i], buffer.data() + i * attr_length);
+  }
+
+  vector<int> order(records.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = static_cast<int>(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int left, int right) {
+    return attr_comparator_(user_keys[left], user_keys[right]) < 0;
+  });
+
+  for (int i : order) {
+    RC rc = index_handler_.insert_entry(user_keys[i], &rids[i]);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
 }
 
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 {
-  return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+  vector<char> buffer(attr_comparator_.attr_length());
+  return index_handler_.delete_entry(make_user_key(record, buffer.data()), rid);
+}
+
+RC BplusTreeIndex::get_entries(const char *record, list<RID> &rids)
+{
+  vector<char> buffer(attr_comparator_.attr_length());
+  return index_handler_.get_entry(make_user_key(record, buffer.data()), attr_comparator_.attr_length(), rids);
 }
 
 IndexScanner *BplusTreeIndex::create_scanner(
@@ -103,6 +197,115 @@ IndexScanner *BplusTreeIndex::create_scanner(
   return index_scanner;
 }
 
+/**
+ * @brief 使用类型的最小值或最大值填充一个字段
+ */
+static void fill_bound_value(const FieldMeta &field_meta, bool min_value, char *data)
+{
+  switch (field_meta.type()) {
+    case AttrType::INTS: {
+      int32_t value = min_value ? numeric_limits<int32_t>::min() : numeric_limits<int32_t>::max();
+      memcpy(data, &value, sizeof(value));
+    } break;
+    case AttrType::FLOATS: {
+      float value = min_value ? -numeric_limits<float>::infinity() : numeric_limits<float>::infinity();
+      memcpy(data, &value, sizeof(value));
+    } break;
+    default: {
+      // 字符串按照字节比较，全0是最小值，全0xFF是最大值
+      memset(data, min_value ? 0 : 0xFF, field_meta.len());
+    } break;
+  }
+}
+
+RC BplusTreeIndex::make_bound_key(span<const Value> values, bool is_left, bool &inclusive, vector<char> &key) const
+{
+  key.resize(attr_comparator_.attr_length());
+
+  size_t value_num = values.size();
+  int    offset    = 0;
+  for (size_t i = 0; i < value_num; i++) {
+    const FieldMeta &field_meta = field_metas_[i];
+    const Value     &value      = values[i];
+    if (value.attr_type() != field_meta.type()) {
+      LOG_WARN("value type does not match the index field. field=%s, field type=%s, value type=%s",
+          field_meta.name(), attr_type_to_string(field_meta.type()), attr_type_to_string(value.attr_type()));
+      return RC::INVALID_ARGUMENT;
+    }
+
+    char     *data   = key.data() + offset;
+    const int length = min(value.length(), field_meta.len());
+    memcpy(data, value.data(), length);
+    memset(data + length, 0, field_meta.len() - length);
+    offset += field_meta.len();
+
+    // 字符串超出了字段长度，索引中不会存在与它相等的值。截断之后，> 'ABCD1' 等价于 > 'ABCD'，
+    // < 'ABCD1' 等价于 <= 'ABCD'，后面的字段就不再需要了。
+    // 不能像 BplusTreeScanner::fix_user_key 那样把左边界改成 >= 'ABCE'，最后一个字节是 0xFF 时加一会溢出
+    if (field_meta.type() == AttrType::CHARS && value.length() > field_meta.len()) {
+      inclusive = !is_left;
+      value_num = i + 1;
+      break;
+    }
+  }
+
+  // 左边界包含边界值或者右边界不包含边界值时，后面的字段补齐为最小值，否则补齐为最大值
+  const bool min_value = (is_left == inclusive);
+  for (size_t i = value_num; i < field_metas_.size(); i++) {
+    fill_bound_value(field_metas_[i], min_value, key.data() + offset);
+    offset += field_metas_[i].len();
+  }
+  return RC::SUCCESS;
+}
+
+IndexScanner *BplusTreeIndex::create_scanner(
+    span<const Value> left_values, bool left_inclusive, span<const Value> right_values, bool right_inclusive)
+{
+  if (field_metas_.size() == 1) {
+    return Index::create_scanner(left_values, left_inclusive, right_values, right_inclusive);
+  }
+
+  if (left_values.size() > field_metas_.size() || right_values.size() > field_metas_.size()) {
+    LOG_WARN("too many values for index. index=%s, field num=%d, left value num=%d, right value num=%d",
+        index_meta_.name(), static_cast<int>(field_metas_.size()), static_cast<int>(left_values.size()),
+        static_cast<int>(right_values.size()));
+    return nullptr;
+  }
+
+  vector<char> left_key;
+  vector<char> right_key;
+  if (!left_values.empty() && OB_FAIL(make_bound_key(left_values, true /*is_left*/, left_inclusive, left_key))) {
+    return nullptr;
+  }
+  if (!right_values.empty() && OB_FAIL(make_bound_key(right_values, false /*is_left*/, right_inclusive, right_key))) {
+    return nullptr;
+  }
+
+  BplusTreeIndexScanner *index_scanner = new BplusTreeIndexScanner(index_handler_);
+
+  // 补齐之后的范围可能是空的，比如 a = 1 and b < INT_MIN，B+树扫描器认为这是非法的范围，
+  // 这里直接返回一个没有打开的扫描器，不会返回任何数据
+  if (!left_key.empty() && !right_key.empty()) {
+    const int result = attr_comparator_(left_key.data(), right_key.data());
+    if (result > 0 || (result == 0 && (!left_inclusive || !right_inclusive))) {
+      return index_scanner;
+    }
+  }
+
+  RC rc = index_scanner->open(left_key.empty() ? nullptr : left_key.data(),
+      static_cast<int>(left_key.size()),
+      left_inclusive,
+      right_key.empty() ? nullptr : right_key.data(),
+      static_cast<int>(right_key.size()),
+      right_inclusive);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open index scanner. rc=%d:%s", rc, strrc(rc));
+    delete index_scanner;
+    return nullptr;
+  }
+  return index_scanner;
+}
+
 RC BplusTreeIndex::sync() { return index_handler_.sync(); }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -27,12 +27,20 @@ public:
   BplusTreeIndex() = default;
   virtual ~BplusTreeIndex() noexcept;
 
-  RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) override;
-  RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) override;
+  RC create(Table *table, const char *file_name, const IndexMeta &index_meta,
+      const vector<const FieldMeta *> &field_metas) override;
+  RC open(Table *table, const char *file_name, const IndexMeta &index_meta,
+      const vector<const FieldMeta *> &field_metas) override;
   RC close();
 
   RC insert_entry(const char *record, const RID *rid) override;
+
+  /**
+   * @brief 按照键值排序之后再逐条插入，相邻的插入大多落在同一个叶子节点上，访问的页面都在 buffer pool 中
+   */
+  RC insert_entries(span<const char *const> records, span<const RID> rids) override;
   RC delete_entry(const char *record, const RID *rid) override;
+  RC get_entries(const char *record, list<RID> &rids) override;
 
   /**
    * 扫描指定范围的数据
@@ -40,12 +48,39 @@ public:
   IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
       int right_len, bool right_inclusive) override;
 
+  /**
+   * @brief 使用字段值作为边界扫描数据
+   * @details 联合索引只给出前面几个字段的值时，后面的字段使用类型的最小值或最大值补齐，
+   * 补齐之后的键值与索引中存储的键值长度一致
+   */
+  IndexScanner *create_scanner(span<const Value> left_values, bool left_inclusive, span<const Value> right_values,
+      bool right_inclusive) override;
+
   RC sync() override;
 
+private:
+  /**
+   * @brief 获取记录中索引的键值
+   * @details 单个字段时直接指向记录中的字段，联合索引需要把各个字段按顺序拼接到 buffer 中
+   */
+  const char *make_user_key(const char *record, char *buffer) const;
+
+  /**
+   * @brief 使用字段值构造联合索引扫描的边界
+   * @param values 前面若干个字段的值
+   * @param is_left 是否是左边界
+   * @param[in,out] inclusive 是否包含边界。字符串超出字段长度被截断时，会改成包含边界
+   * @param[out] key 构造出来的键值
+   */
+  RC make_bound_key(span<const Value> values, bool is_left, bool &inclusive, vector<char> &key) const;
+
+  void init_attr_comparator();
+
 private:
   bool             inited_ = false;
   Table           *table_  = nullptr;
   BplusTreeHandler index_handler_;
+  AttrComparator   attr_comparator_;  ///< 比较索引的键值，不包含RID
 };
 
 /**
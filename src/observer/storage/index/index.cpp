@@ -13,10 +13,41 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/index/index.h"
+#include "common/log/log.h"
 
-RC Index::init(const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC Index::init(const IndexMeta &index_meta, const vector<const FieldMeta *> &field_metas)
 {
   index_meta_ = index_meta;
-  field_meta_ = field_meta;
+  field_metas_.clear();
+  for (const FieldMeta *field_meta : field_metas) {
+    field_metas_.push_back(*field_meta);
+  }
   return RC::SUCCESS;
 }
+
+RC Index::insert_entries(span<const char *const> records, span<const RID> rids)
+{
+  RC rc = RC::SUCCESS;
+  for (size_t i = 0; i < records.size() && OB_SUCC(rc); i++) {
+    rc = insert_entry(records[i], &rids[i]);
+  }
+  return rc;
+}
+
+IndexScanner *Index::create_scanner(
+    span<const Value> left_values, bool left_inclusive, span<const Value> right_values, bool right_inclusive)
+{
+  if (field_metas_.size() != 1 || left_values.size() > 1 || right_values.size() > 1) {
+    LOG_WARN("only support index with one field. index=%s", index_meta_.name());
+    return nullptr;
+  }
+
+  const Value *left_value  = left_values.empty() ? nullptr : &left_values[0];
+  const Value *right_value = right_values.empty() ? nullptr : &right_values[0];
+  return create_scanner(left_value != nullptr ? left_value->data() : nullptr,
+      left_value != nullptr ? left_value->length() : 0,
+      left_inclusive,
+      right_value != nullptr ? right_value->data() : nullptr,
+      right_value != nullptr ? right_value->length() : 0,
+      right_inclusive);
+}
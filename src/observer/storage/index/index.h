@@ -15,8 +15,10 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <stddef.h>
-#include <vector>
 
+#include "common/lang/list.h"
+#include "common/lang/span.h"
+#include "common/lang/vector.h"
 #include "common/sys/rc.h"
 #include "storage/field/field_meta.h"
 #include "storage/index/index_meta.h"
@@ -40,11 +42,17 @@ public:
   Index()          = default;
   virtual ~Index() = default;
 
-  virtual RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+  /**
+   * @brief 创建索引
+   * @param field_metas 索引包含的字段，顺序与 index_meta 中的字段一致
+   */
+  virtual RC create(
+      Table *table, const char *file_name, const IndexMeta &index_meta, const vector<const FieldMeta *> &field_metas)
   {
     return RC::UNSUPPORTED;
   }
-  virtual RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+  virtual RC open(
+      Table *table, const char *file_name, const IndexMeta &index_meta, const vector<const FieldMeta *> &field_metas)
   {
     return RC::UNSUPPORTED;
   }
@@ -61,6 +69,14 @@ public:
    */
   virtual RC insert_entry(const char *record, const RID *rid) = 0;
 
+  /**
+   * @brief 插入多条数据
+   * @details 默认逐条调用 insert_entry。失败时已经插入的数据不会删除，由调用者处理
+   * @param records 插入的记录
+   * @param rids 每条记录的位置，与 records 一一对应
+   */
+  virtual RC insert_entries(span<const char *const> records, span<const RID> rids);
+
   /**
    * @brief 删除一条数据
    *
@@ -69,6 +85,14 @@ public:
    */
   virtual RC delete_entry(const char *record, const RID *rid) = 0;
 
+  /**
+   * @brief 查找与记录键值相同的数据
+   *
+   * @param record 记录，只会使用索引包含的字段
+   * @param[out] rids 键值相同的数据的位置
+   */
+  virtual RC get_entries(const char *record, list<RID> &rids) { return RC::UNSUPPORTED; }
+
   /**
    * @brief 创建一个索引数据的扫描器
    *
@@ -82,6 +106,18 @@ public:
   virtual IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
       int right_len, bool right_inclusive) = 0;
 
+  /**
+   * @brief 使用字段值作为边界创建一个索引数据的扫描器
+   * @details 边界值按照索引字段的顺序排列，可以只包含前面的几个字段，表示扫描这些字段值组成的前缀范围。
+   * 值为空表示这一侧没有边界。默认实现只支持单个字段的索引
+   * @param left_values 左边界每个字段的值
+   * @param left_inclusive 是否包含左边界
+   * @param right_values 右边界每个字段的值
+   * @param right_inclusive 是否包含右边界
+   */
+  virtual IndexScanner *create_scanner(
+      span<const Value> left_values, bool left_inclusive, span<const Value> right_values, bool right_inclusive);
+
   /**
    * @brief 同步索引数据到磁盘
    *
@@ -89,11 +125,11 @@ public:
   virtual RC sync() = 0;
 
 protected:
-  RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC init(const IndexMeta &index_meta, const vector<const FieldMeta *> &field_metas);
 
 protected:
-  IndexMeta index_meta_;  ///< 索引的元数据
-  FieldMeta field_meta_;  ///< 当前实现仅考虑一个字段的索引
+  IndexMeta         index_meta_;   ///< 索引的元数据
+  vector<FieldMeta> field_metas_;  ///< 索引包含的字段，多个字段时是联合索引
 };
 
 /**
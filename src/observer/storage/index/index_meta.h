@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/sys/rc.h"
 #include "common/lang/string.h"
+#include "common/lang/vector.h"
 
 class TableMeta;
 class FieldMeta;
@@ -27,7 +28,8 @@ class Value;
 /**
  * @brief 描述一个索引
  * @ingroup Index
- * @details 一个索引包含了表的哪些字段，索引的名称等。
+ * @details 一个索引包含了表的哪些字段，索引的名称等。一个索引可以包含多个字段，即联合索引，
+ * 键值按照字段的顺序逐个比较。
  * 如果以后实现了多种类型的索引，还需要记录索引的类型，对应类型的一些元数据等
  */
 class IndexMeta
@@ -36,11 +38,27 @@ public:
   IndexMeta() = default;
 
   RC init(const char *name, const FieldMeta &field);
+  RC init(const char *name, const vector<const FieldMeta *> &fields, bool unique = false);
 
 public:
   const char *name() const;
+
+  /**
+   * @brief 索引的第一个字段
+   */
   const char *field() const;
 
+  /**
+   * @brief 索引包含的所有字段
+   */
+  const vector<string> &fields() const { return fields_; }
+  int                   field_num() const { return static_cast<int>(fields_.size()); }
+
+  /**
+   * @brief 是否是唯一索引。唯一索引中不允许出现键值相同的两条数据
+   */
+  bool unique() const { return unique_; }
+
   void desc(ostream &os) const;
 
 public:
@@ -48,6 +66,7 @@ public:
   static RC from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index);
 
 protected:
-  string name_;   // index's name
-  string field_;  // field's name
+  string         name_;            // index's name
+  vector<string> fields_;          // fields' name
+  bool           unique_ = false;  // whether the index is unique
 };
@@ -140,7 +140,11 @@ void LatchMemo::release()
   release_to(point);
 
   for (PageNum page_num : disposed_pages_) {
-    buffer_pool_->dispose_page(page_num);
+    RC rc = buffer_pool_->dispose_page(page_num);
+    if (OB_FAIL(rc)) {
+      // 释放失败只是浪费一个页面的空间，页面已经从B+树中摘除，不影响正确性
+      LOG_WARN("failed to dispose page. page_num=%d, rc=%s", page_num, strrc(rc));
+    }
   }
   disposed_pages_.clear();
 }
@@ -0,0 +1,288 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include "storage/record/column_encoding.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/string.h"
+
+static int32_t read_int32(const char *data)
+{
+  int32_t value = 0;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static void append_int32(vector<char> &out, int32_t value)
+{
+  const char *data = reinterpret_cast<const char *>(&value);
+  out.insert(out.end(), data, data + sizeof(value));
+}
+
+/**
+ * @brief 表示 [0, max_value] 范围内的值需要的位数
+ */
+static int bit_width(uint32_t max_value)
+{
+  int width = 0;
+  while (max_value != 0) {
+    width++;
+    max_value >>= 1;
+  }
+  return width;
+}
+
+static int packed_size(int count, int width) { return static_cast<int>((static_cast<int64_t>(count) * width + 7) / 8); }
+
+/**
+ * @brief 把 value 的低 width 位写入到 data 中第 index 个位置。data 需要提前清零
+ * @details 逐个字节处理，不要求对齐，也不会访问到数据的范围之外
+ */
+static void pack_bits(char *data, int width, int index, uint32_t value)
+{
+  int64_t bit  = static_cast<int64_t>(index) * width;
+  int     left = width;
+  while (left > 0) {
+    const int shift = static_cast<int>(bit % 8);
+    const int n     = min(8 - shift, left);
+    data[bit / 8] |= static_cast<char>((value & ((1U << n) - 1)) << shift);
+    value >>= n;
+    bit += n;
+    left -= n;
+  }
+}
+
+static uint32_t unpack_bits(const char *data, int width, int index)
+{
+  uint32_t value = 0;
+  int64_t  bit   = static_cast<int64_t>(index) * width;
+  int      done  = 0;
+  while (done < width) {
+    const int shift = static_cast<int>(bit % 8);
+    const int n     = min(8 - shift, width - done);
+    const uint32_t byte = static_cast<uint8_t>(data[bit / 8]);
+    value |= ((byte >> shift) & ((1U << n) - 1)) << done;
+    bit += n;
+    done += n;
+  }
+  return value;
+}
+
+ColumnEncoding ColumnEncoder::encode(AttrType type, int attr_len, const char *values, int count, vector<char> &out)
+{
+  out.clear();
+  if (attr_len <= 0 || count <= 0) {
+    return ColumnEncoding::PLAIN;
+  }
+
+  ColumnEncoding best_encoding = ColumnEncoding::PLAIN;
+  size_t         best_size     = static_cast<size_t>(attr_len) * count;
+  vector<char>   buffer;
+  auto           try_encoding  = [&](ColumnEncoding encoding) {
+    if (buffer.size() < best_size) {
+      best_encoding = encoding;
+      best_size     = buffer.size();
+      out.swap(buffer);
+    }
+    buffer.clear();
+  };
+
+  encode_rle(attr_len, values, count, buffer);
+  try_encoding(ColumnEncoding::RLE);
+
+  if (type == AttrType::CHARS) {
+    encode_dictionary(attr_len, values, count, buffer);
+    try_encoding(ColumnEncoding::DICTIONARY);
+  }
+
+  if (type == AttrType::INTS && attr_len == sizeof(int32_t)) {
+    encode_for_bitpack(values, count, buffer);
+    try_encoding(ColumnEncoding::FOR_BITPACK);
+  }
+
+  if (best_encoding == ColumnEncoding::PLAIN) {
+    out.clear();
+  }
+  return best_encoding;
+}
+
+void ColumnEncoder::encode_dictionary(int attr_len, const char *values, int count, vector<char> &out)
+{
+  auto less = [attr_len](const char *left, const char *right) { return memcmp(left, right, attr_len) < 0; };
+
+  vector<const char *> dict(count);
+  for (int i = 0; i < count; i++) {
+    dict[i] = values + static_cast<size_t>(i) * attr_len;
+  }
+  std::sort(dict.begin(), dict.end(), less);
+  dict.erase(std::unique(dict.begin(),
+                 dict.end(),
+                 [attr_len](const char *left, const char *right) { return memcmp(left, right, attr_len) == 0; }),
+      dict.end());
+
+  const int dict_count = static_cast<int>(dict.size());
+  const int width      = bit_width(static_cast<uint32_t>(dict_count - 1));
+  append_int32(out, dict_count);
+  append_int32(out, width);
+  for (const char *entry : dict) {
+    out.insert(out.end(), entry, entry + attr_len);
+  }
+
+  const size_t codes_offset = out.size();
+  out.resize(codes_offset + packed_size(count, width), 0);
+  for (int i = 0; i < count; i++) {
+    const char *value = values + static_cast<size_t>(i) * attr_len;
+    const auto  iter  = std::lower_bound(dict.begin(), dict.end(), value, less);
+    pack_bits(out.data() + codes_offset, width, i, static_cast<uint32_t>(iter - dict.begin()));
+  }
+}
+
+void ColumnEncoder::encode_rle(int attr_len, const char *values, int count, vector<char> &out)
+{
+  vector<int32_t> run_ends;
+  for (int i = 1; i <= count; i++) {
+    if (i == count || 0 != memcmp(values + static_cast<size_t>(i - 1) * attr_len,
+                                  values + static_cast<size_t>(i) * attr_len, attr_len)) {
+      run_ends.push_back(i);
+    }
+  }
+
+  append_int32(out, static_cast<int32_t>(run_ends.size()));
+  for (int32_t end : run_ends) {
+    append_int32(out, end);
+  }
+  for (int32_t end : run_ends) {
+    const char *value = values + static_cast<size_t>(end - 1) * attr_len;
+    out.insert(out.end(), value, value + attr_len);
+  }
+}
+
+void ColumnEncoder::encode_for_bitpack(const char *values, int count, vector<char> &out)
+{
+  int32_t min_value = read_int32(values);
+  int32_t max_value = min_value;
+  for (int i = 1; i < count; i++) {
+    const int32_t value = read_int32(values + i * sizeof(int32_t));
+    min_value           = min(min_value, value);
+    max_value           = max(max_value, value);
+  }
+
+  // 差值可能超过 int32_t 的范围，按照无符号数计算
+  const int width = bit_width(static_cast<uint32_t>(max_value) - static_cast<uint32_t>(min_value));
+  append_int32(out, min_value);
+  append_int32(out, width);
+
+  const size_t data_offset = out.size();
+  out.resize(data_offset + packed_size(count, width), 0);
+  for (int i = 0; i < count; i++) {
+    const int32_t value = read_int32(values + i * sizeof(int32_t));
+    pack_bits(out.data() + data_offset, width, i, static_cast<uint32_t>(value) - static_cast<uint32_t>(min_value));
+  }
+}
+
+void ColumnEncoder::decode(ColumnEncoding encoding, int attr_len, const char *data, int count, char *values)
+{
+  switch (encoding) {
+    case ColumnEncoding::DICTIONARY: {
+      const int   dict_count = read_int32(data);
+      const int   width      = read_int32(data + sizeof(int32_t));
+      const char *dict       = data + 2 * sizeof(int32_t);
+      const char *codes      = dict + static_cast<size_t>(dict_count) * attr_len;
+      for (int i = 0; i < count; i++) {
+        const uint32_t code = unpack_bits(codes, width, i);
+        memcpy(values + static_cast<size_t>(i) * attr_len, dict + static_cast<size_t>(code) * attr_len, attr_len);
+      }
+    } break;
+
+    case ColumnEncoding::RLE: {
+      const int   run_count = read_int32(data);
+      const char *run_ends  = data + sizeof(int32_t);
+      const char *runs      = run_ends + static_cast<size_t>(run_count) * sizeof(int32_t);
+      int         begin     = 0;
+      for (int run = 0; run < run_count; run++) {
+        const int   end   = min(read_int32(run_ends + run * sizeof(int32_t)), count);
+        const char *value = runs + static_cast<size_t>(run) * attr_len;
+        for (int i = begin; i < end; i++) {
+          memcpy(values + static_cast<size_t>(i) * attr_len, value, attr_len);
+        }
+        begin = end;
+      }
+    } break;
+
+    case ColumnEncoding::FOR_BITPACK: {
+      const uint32_t min_value = static_cast<uint32_t>(read_int32(data));
+      const int      width     = read_int32(data + sizeof(int32_t));
+      const char    *packed    = data + 2 * sizeof(int32_t);
+      for (int i = 0; i < count; i++) {
+        const int32_t value = static_cast<int32_t>(min_value + unpack_bits(packed, width, i));
+        memcpy(values + i * sizeof(int32_t), &value, sizeof(value));
+      }
+    } break;
+
+    default: {
+      memcpy(values, data, static_cast<size_t>(count) * attr_len);
+    } break;
+  }
+}
+
+void ColumnEncoder::decode_one(ColumnEncoding encoding, int attr_len, const char *data, int index, char *value)
+{
+  switch (encoding) {
+    case ColumnEncoding::DICTIONARY: {
+      const int      dict_count = read_int32(data);
+      const int      width      = read_int32(data + sizeof(int32_t));
+      const char    *dict       = data + 2 * sizeof(int32_t);
+      const uint32_t code       = unpack_bits(dict + static_cast<size_t>(dict_count) * attr_len, width, index);
+      memcpy(value, dict + static_cast<size_t>(code) * attr_len, attr_len);
+    } break;
+
+    case ColumnEncoding::RLE: {
+      // run 的结束位置是递增的，二分查找第一个结束位置大于 index 的 run
+      const int   run_count = read_int32(data);
+      const char *run_ends  = data + sizeof(int32_t);
+      int         low = 0, high = run_count - 1;
+      while (low < high) {
+        const int mid = (low + high) / 2;
+        if (read_int32(run_ends + mid * sizeof(int32_t)) > index) {
+          high = mid;
+        } else {
+          low = mid + 1;
+        }
+      }
+      const char *runs = run_ends + static_cast<size_t>(run_count) * sizeof(int32_t);
+      memcpy(value, runs + static_cast<size_t>(low) * attr_len, attr_len);
+    } break;
+
+    case ColumnEncoding::FOR_BITPACK: {
+      const uint32_t min_value = static_cast<uint32_t>(read_int32(data));
+      const int      width     = read_int32(data + sizeof(int32_t));
+      const int32_t  result    = static_cast<int32_t>(min_value + unpack_bits(data + 2 * sizeof(int32_t), width, index));
+      memcpy(value, &result, sizeof(result));
+    } break;
+
+    default: {
+      memcpy(value, data + static_cast<size_t>(index) * attr_len, attr_len);
+    } break;
+  }
+}
+
+const char *ColumnEncoder::to_string(ColumnEncoding encoding)
+{
+  switch (encoding) {
+    case ColumnEncoding::PLAIN: return "PLAIN";
+    case ColumnEncoding::DICTIONARY: return "DICTIONARY";
+    case ColumnEncoding::RLE: return "RLE";
+    case ColumnEncoding::FOR_BITPACK: return "FOR_BITPACK";
+    default: return "UNKNOWN";
+  }
+}
@@ -0,0 +1,84 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/lang/vector.h"
+#include "common/type/attr_type.h"
+
+/**
+ * @brief PAX 页面中一列数据的编码方式
+ * @ingroup RecordManager
+ */
+enum class ColumnEncoding : int32_t
+{
+  PLAIN,        ///< 不编码，每个值按照列的长度依次存放
+  DICTIONARY,   ///< 字典编码，适合基数比较低的字符串
+  RLE,          ///< 行程编码(run-length encoding)，适合有序或者有大量重复的值
+  FOR_BITPACK,  ///< frame of reference + bit packing，适合取值范围比较小的整数
+};
+
+/**
+ * @brief PAX 页面中每列一个，记录这一列的编码方式和编码之后的大小
+ * @ingroup RecordManager
+ */
+struct ColumnEncodingHeader
+{
+  int32_t encoding;  ///< ColumnEncoding
+  int32_t size;      ///< 编码之后的字节数，PLAIN 时是0
+
+  ColumnEncoding type() const { return static_cast<ColumnEncoding>(encoding); }
+};
+
+/**
+ * @brief 定长列的轻量级编码
+ * @ingroup RecordManager
+ * @details 编码之后的格式，所有的整数都是 int32_t，不要求对齐：
+ * - DICTIONARY：| dict_count | bit_width | 排好序的字典项 | 每个值在字典中的下标，按 bit_width 紧凑存放 |
+ * - RLE：| run_count | 每个 run 的结束位置 | 每个 run 的值 |
+ * - FOR_BITPACK：| min_value | bit_width | 每个值减去 min_value，按 bit_width 紧凑存放 |
+ * 解码时既可以整列解码，也可以只解码一个值，用于按照 RID 读取记录。
+ */
+class ColumnEncoder
+{
+public:
+  /**
+   * @brief 尝试这个类型可以使用的所有编码方式，选择编码之后最小的一种
+   * @param values 依次存放的 count 个值，每个值 attr_len 字节
+   * @param out 编码之后的数据
+   * @return 编码方式。编码之后不比原始数据小时返回 PLAIN，out 为空
+   */
+  static ColumnEncoding encode(AttrType type, int attr_len, const char *values, int count, vector<char> &out);
+
+  /**
+   * @brief 解码整列的数据
+   * @param values 解码之后的数据，至少有 count * attr_len 字节
+   */
+  static void decode(ColumnEncoding encoding, int attr_len, const char *data, int count, char *values);
+
+  /**
+   * @brief 只解码第 index 个值
+   * @param value 解码之后的值，至少有 attr_len 字节
+   */
+  static void decode_one(ColumnEncoding encoding, int attr_len, const char *data, int index, char *value);
+
+  static const char *to_string(ColumnEncoding encoding);
+
+private:
+  static void encode_dictionary(int attr_len, const char *values, int count, vector<char> &out);
+  static void encode_rle(int attr_len, const char *values, int count, vector<char> &out);
+  static void encode_for_bitpack(const char *values, int count, vector<char> &out);
+};
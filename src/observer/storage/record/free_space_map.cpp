@@ -0,0 +1,325 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include "storage/record/free_space_map.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/functional.h"
+#include "common/lang/thread.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+using namespace common;
+
+FreeSpaceMap::~FreeSpaceMap() { close(); }
+
+uint8_t FreeSpaceMap::fill_class(int free_slots, int capacity)
+{
+  if (free_slots <= 0 || capacity <= 0) {
+    return FULL;
+  }
+  return static_cast<uint8_t>(FULL + 1 + free_slots * (MAX_FILL_CLASS - FULL - 1) / capacity);
+}
+
+uint8_t FreeSpaceMap::required_fill_class(int free_size, int capacity)
+{
+  if (free_size <= 0) {
+    return FULL + 1;
+  }
+  if (free_size > capacity) {
+    return MAX_FILL_CLASS + 1;
+  }
+  // fill_class 是向下取整的，这里向上取整，保证这个空闲程度的页面一定有足够的空间
+  const int steps = MAX_FILL_CLASS - FULL - 1;
+  return static_cast<uint8_t>(FULL + 1 + (free_size * steps + capacity - 1) / capacity);
+}
+
+RC FreeSpaceMap::open(DiskBufferPool &data_buffer_pool)
+{
+  if (fsm_buffer_pool_ != nullptr) {
+    LOG_WARN("free space map has been opened. file=%s", file_name_.c_str());
+    return RC::RECORD_OPENNED;
+  }
+
+  BufferPoolManager &bpm       = data_buffer_pool.bp_manager();
+  string             file_name = string(data_buffer_pool.filename()) + FILE_SUFFIX;
+
+  RC rc = RC::SUCCESS;
+  if (!filesystem::exists(file_name)) {
+    // 以前创建的表没有空闲空间表，这里创建一个空的，所有的页面都是 UNKNOWN
+    rc = bpm.create_file(file_name.c_str());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create free space map. file=%s, rc=%s", file_name.c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  rc = bpm.open_file(log_handler_, file_name.c_str(), fsm_buffer_pool_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open free space map. file=%s, rc=%s", file_name.c_str(), strrc(rc));
+    fsm_buffer_pool_ = nullptr;
+    return rc;
+  }
+
+  bp_manager_       = &bpm;
+  data_buffer_pool_ = &data_buffer_pool;
+  file_name_        = file_name;
+  entries_per_page_ = fsm_buffer_pool_->page_data_size() - static_cast<int>(sizeof(FreeSpacePageHeader));
+  search_start_.store(1, memory_order_relaxed);
+  for (atomic<PageNum> &insert_page : insert_pages_) {
+    insert_page.store(BP_INVALID_PAGE_NUM, memory_order_relaxed);
+  }
+
+  LOG_INFO("open free space map done. file=%s, pages=%d, entries per page=%d",
+           file_name_.c_str(), fsm_buffer_pool_->page_count(), entries_per_page_);
+  return RC::SUCCESS;
+}
+
+void FreeSpaceMap::close()
+{
+  if (fsm_buffer_pool_ != nullptr) {
+    bp_manager_->close_file(file_name_.c_str());
+    fsm_buffer_pool_  = nullptr;
+    data_buffer_pool_ = nullptr;
+    bp_manager_       = nullptr;
+  }
+}
+
+int FreeSpaceMap::thread_slot() const
+{
+  return static_cast<int>(hash<thread::id>()(this_thread::get_id()) % INSERT_SLOT_NUM);
+}
+
+bool FreeSpaceMap::claimed_by_others(PageNum page_num, int slot) const
+{
+  for (int i = 0; i < INSERT_SLOT_NUM; i++) {
+    if (i != slot && insert_pages_[i].load(memory_order_relaxed) == page_num) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FreeSpaceMap::claim(PageNum page_num) { insert_pages_[thread_slot()].store(page_num, memory_order_relaxed); }
+
+RC FreeSpaceMap::find_free_page(PageNum &page_num, uint8_t min_fill_class /* = FULL + 1 */)
+{
+  const int slot        = thread_slot();
+  PageNum   insert_page = insert_pages_[slot].load(memory_order_relaxed);
+  if (insert_page != BP_INVALID_PAGE_NUM) {
+    uint8_t fill_class = UNKNOWN;
+    RC      rc         = get(insert_page, fill_class);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (fill_class == UNKNOWN || fill_class >= min_fill_class) {
+      page_num = insert_page;
+      return RC::SUCCESS;
+    }
+  }
+
+  // 从上次找到空闲页面的位置开始向后查找，找到最后再从头开始
+  const PageNum page_count = data_buffer_pool_->page_count();
+  PageNum       start      = search_start_.load(memory_order_relaxed);
+  if (start <= 0 || start >= page_count) {
+    start = 1;
+  }
+
+  RC rc = search(start, page_count, slot, min_fill_class, page_num);
+  if (rc == RC::RECORD_EOF) {
+    rc = search(1, start, slot, min_fill_class, page_num);
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  insert_pages_[slot].store(page_num, memory_order_relaxed);
+  search_start_.store(page_num, memory_order_relaxed);
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::search(PageNum begin, PageNum end, int slot, uint8_t min_fill_class, PageNum &page_num)
+{
+  PageNum current = begin;
+  while (current < end) {
+    const PageNum fsm_page  = fsm_page_num(current);
+    const PageNum range_end = min<PageNum>(end, fsm_page * entries_per_page_);
+
+    // 没有记录过的数据页面都当作可能有空闲位置
+    if (fsm_page >= fsm_buffer_pool_->page_count()) {
+      for (; current < range_end; current++) {
+        if (!claimed_by_others(current, slot)) {
+          page_num = current;
+          return RC::SUCCESS;
+        }
+      }
+      continue;
+    }
+
+    Frame *frame = nullptr;
+    RC     rc    = fsm_buffer_pool_->get_this_page(fsm_page, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get free space map page. page=%d, rc=%s", fsm_page, strrc(rc));
+      return rc;
+    }
+
+    // 只有从头到尾检查过整个页面，并且都是满的，才能设置 all_full 标记
+    const bool whole_page = entry_index(current) == 0 || (current == 1 && fsm_page == 1);
+    bool       found      = false;
+    bool       all_full   = true;
+
+    frame->read_latch();
+    auto          *header      = reinterpret_cast<FreeSpacePageHeader *>(frame->data());
+    const uint8_t *entries     = reinterpret_cast<const uint8_t *>(frame->data() + sizeof(FreeSpacePageHeader));
+    const bool     marked_full = header->all_full != 0;
+    if (!marked_full) {
+      for (; current < range_end; current++) {
+        const uint8_t entry = entries[entry_index(current)];
+        if (entry == FULL) {
+          continue;
+        }
+        all_full = false;
+        if (entry != UNKNOWN && entry < min_fill_class) {
+          continue;
+        }
+        if (!claimed_by_others(current, slot)) {
+          found = true;
+          break;
+        }
+      }
+    }
+    frame->read_unlatch();
+
+    if (found) {
+      fsm_buffer_pool_->unpin_page(frame);
+      page_num = current;
+      return RC::SUCCESS;
+    }
+
+    if (!marked_full && whole_page && all_full && range_end == fsm_page * entries_per_page_) {
+      // 加写锁之后重新检查一遍，期间可能有页面变成了空闲
+      frame->write_latch();
+      bool full = true;
+      for (int i = 0; i < entries_per_page_ && full; i++) {
+        full = (fsm_page == 1 && i == 0) || entries[i] == FULL;
+      }
+      if (full) {
+        header->all_full = 1;
+        frame->mark_dirty();
+      }
+      frame->write_unlatch();
+    }
+
+    fsm_buffer_pool_->unpin_page(frame);
+    current = range_end;
+  }
+  return RC::RECORD_EOF;
+}
+
+RC FreeSpaceMap::get(PageNum page_num, uint8_t &fill_class)
+{
+  const PageNum fsm_page = fsm_page_num(page_num);
+  if (fsm_page >= fsm_buffer_pool_->page_count()) {
+    fill_class = UNKNOWN;
+    return RC::SUCCESS;
+  }
+
+  Frame *frame = nullptr;
+  RC     rc    = fsm_buffer_pool_->get_this_page(fsm_page, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get free space map page. page=%d, rc=%s", fsm_page, strrc(rc));
+    return rc;
+  }
+
+  const char *entry = frame->data() + sizeof(FreeSpacePageHeader) + entry_index(page_num);
+
+  uint64_t version = 0;
+  if (frame->optimistic_read_begin(version)) {
+    fill_class = static_cast<uint8_t>(*entry);
+    if (frame->optimistic_read_validate(version)) {
+      fsm_buffer_pool_->unpin_page(frame);
+      return RC::SUCCESS;
+    }
+  }
+
+  frame->read_latch();
+  fill_class = static_cast<uint8_t>(*entry);
+  frame->read_unlatch();
+  fsm_buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::update(PageNum page_num, uint8_t fill_class)
+{
+  const PageNum fsm_page = fsm_page_num(page_num);
+
+  RC rc = ensure_fsm_page(fsm_page);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  Frame *frame = nullptr;
+  rc           = fsm_buffer_pool_->get_this_page(fsm_page, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get free space map page. page=%d, rc=%s", fsm_page, strrc(rc));
+    return rc;
+  }
+
+  auto *header = reinterpret_cast<FreeSpacePageHeader *>(frame->data());
+  auto *entry  = reinterpret_cast<uint8_t *>(frame->data() + sizeof(FreeSpacePageHeader) + entry_index(page_num));
+
+  // 大部分插入和删除都不会改变页面的空闲程度，这时不需要加写锁
+  uint64_t version = 0;
+  if (frame->optimistic_read_begin(version)) {
+    const bool unchanged = *entry == fill_class && (fill_class == FULL || header->all_full == 0);
+    if (frame->optimistic_read_validate(version) && unchanged) {
+      fsm_buffer_pool_->unpin_page(frame);
+      return RC::SUCCESS;
+    }
+  }
+
+  frame->write_latch();
+  *entry = fill_class;
+  if (fill_class != FULL) {
+    header->all_full = 0;
+  }
+  frame->mark_dirty();
+  frame->write_unlatch();
+  fsm_buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::ensure_fsm_page(PageNum fsm_page)
+{
+  if (fsm_page < fsm_buffer_pool_->page_count()) {
+    return RC::SUCCESS;
+  }
+
+  lock_guard guard(lock_);
+  while (fsm_buffer_pool_->page_count() <= fsm_page) {
+    Frame *frame = nullptr;
+    RC     rc    = fsm_buffer_pool_->allocate_page(&frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate free space map page. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+      return rc;
+    }
+
+    frame->write_latch();
+    memset(frame->data(), 0, frame->data_size());
+    frame->mark_dirty();
+    frame->write_unlatch();
+    fsm_buffer_pool_->unpin_page(frame);
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,144 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/sys/rc.h"
+#include "storage/buffer/page.h"
+#include "storage/clog/vacuous_log_handler.h"
+
+class BufferPoolManager;
+class DiskBufferPool;
+
+/**
+ * @brief 空闲空间表(free space map)
+ * @ingroup RecordManager
+ * @details 记录数据文件中每个页面的空闲程度(fill class)，插入记录时用来快速找到还有空闲位置的页面。
+ * 空闲空间表保存在单独的文件中，文件名是数据文件名加上 FILE_SUFFIX。除了 BufferPool 的元数据页面，
+ * 每个页面以 FreeSpacePageHeader 开头，后面每个字节记录一个数据页面的空闲程度，
+ * 空闲空间表的第 i 个页面管理数据页面 [(i-1)*N, i*N)，N 是每个页面可以记录的数据页面个数。
+ *
+ * 空闲空间表只是一个提示，分配页面和修改页面都不记录日志，异常重启之后可能与数据页面不一致：
+ * - 记录为有空闲位置，实际上已经满了：插入时会检查数据页面，发现满了就更新空闲空间表；
+ * - 记录为已满，实际上还有空闲位置：在这个页面上删除记录时会修正，在这之前会浪费一些空间；
+ * - 没有记录过(UNKNOWN)：新创建的空闲空间表或者没有刷盘的页面都是0，当作可能有空闲位置处理。
+ * 因此打开表时不需要遍历所有的数据页面，空闲空间表会在插入和删除的过程中逐渐修正。
+ *
+ * 并发插入时，每个线程按照线程ID映射到一个插入槽位，每个槽位记录自己正在插入的页面，
+ * 查找空闲页面时会跳过其它槽位正在使用的页面，这样并发插入的线程会分散到不同的页面上，减少页面锁的冲突。
+ */
+class FreeSpaceMap
+{
+public:
+  static constexpr const char *FILE_SUFFIX = ".fsm";
+
+  static constexpr uint8_t UNKNOWN        = 0;   ///< 没有记录过这个页面
+  static constexpr uint8_t FULL           = 1;   ///< 页面已经没有空闲位置
+  static constexpr uint8_t MAX_FILL_CLASS = 15;  ///< 页面是空的
+
+  static constexpr int INSERT_SLOT_NUM = 16;
+
+  /**
+   * @brief 空闲空间表页面的页头
+   */
+  struct FreeSpacePageHeader
+  {
+    /// 为1时表示这个页面记录的数据页面都已经满了，查找时可以跳过。只是一个提示，有页面变空闲时清零
+    int32_t all_full;
+    int32_t reserved;
+  };
+
+public:
+  FreeSpaceMap() = default;
+  ~FreeSpaceMap();
+
+  /**
+   * @brief 根据页面中空闲记录槽位的个数计算空闲程度，变长记录的页面使用空闲的字节数
+   * @return 没有空闲位置时返回 FULL，否则返回 (FULL, MAX_FILL_CLASS] 之间的值，空闲位置越多值越大
+   */
+  static uint8_t fill_class(int free_slots, int capacity);
+
+  /**
+   * @brief 计算至少有 free_size 空闲空间的页面的空闲程度下限
+   * @details 空闲程度不小于返回值的页面一定可以放下 free_size 大小的数据。变长记录按照字节计算空闲程度，
+   * 插入时根据记录的大小查找页面。返回值可能超过 MAX_FILL_CLASS，这时只能使用新的页面
+   */
+  static uint8_t required_fill_class(int free_size, int capacity);
+
+  /**
+   * @brief 打开数据文件对应的空闲空间表，文件不存在时创建一个新的
+   * @details 不会访问数据页面，新创建的空闲空间表中所有的页面都是 UNKNOWN
+   */
+  RC open(DiskBufferPool &data_buffer_pool);
+  void close();
+
+  /**
+   * @brief 查找一个可能还有空闲位置的数据页面
+   * @details 优先使用当前线程的插入槽位上次使用的页面。找到的页面不一定真的有空闲位置，
+   * 调用者需要加锁检查，如果已经满了，调用 update 更新之后重新查找。
+   * @param min_fill_class 页面的空闲程度至少是这个值，没有记录过(UNKNOWN)的页面总是可以返回
+   * @return 没有找到时返回 RC::RECORD_EOF，这时应该分配一个新的页面，然后调用 claim
+   */
+  RC find_free_page(PageNum &page_num, uint8_t min_fill_class = FULL + 1);
+
+  /**
+   * @brief 当前线程的插入槽位使用指定的页面，通常是新分配的页面
+   */
+  void claim(PageNum page_num);
+
+  /**
+   * @brief 更新数据页面的空闲程度
+   * @details 空闲程度没有变化时只做乐观读，不加页面写锁
+   */
+  RC update(PageNum page_num, uint8_t fill_class);
+
+  /**
+   * @brief 获取数据页面的空闲程度，没有记录过时返回 UNKNOWN
+   */
+  RC get(PageNum page_num, uint8_t &fill_class);
+
+  const string &filename() const { return file_name_; }
+
+private:
+  PageNum fsm_page_num(PageNum page_num) const { return 1 + page_num / entries_per_page_; }
+  int     entry_index(PageNum page_num) const { return page_num % entries_per_page_; }
+  int     thread_slot() const;
+  bool    claimed_by_others(PageNum page_num, int slot) const;
+
+  /**
+   * @brief 在数据页面 [begin, end) 中查找空闲程度至少为 min_fill_class 的页面
+   * @return 没有找到时返回 RC::RECORD_EOF
+   */
+  RC search(PageNum begin, PageNum end, int slot, uint8_t min_fill_class, PageNum &page_num);
+
+  /**
+   * @brief 确保记录指定数据页面的空闲空间表页面已经分配
+   */
+  RC ensure_fsm_page(PageNum fsm_page_num);
+
+private:
+  BufferPoolManager *bp_manager_       = nullptr;
+  DiskBufferPool    *data_buffer_pool_ = nullptr;
+  DiskBufferPool    *fsm_buffer_pool_  = nullptr;
+  VacuousLogHandler  log_handler_;  ///< 空闲空间表不需要恢复，不记录日志
+  string             file_name_;
+  int                entries_per_page_ = 0;
+
+  common::Mutex   lock_;  ///< 分配空闲空间表页面时使用
+  atomic<PageNum> search_start_{1};
+  atomic<PageNum> insert_pages_[INSERT_SLOT_NUM];
+};
@@ -0,0 +1,51 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include "storage/record/morsel_dispatcher.h"
+
+RC MorselDispatcher::init(DiskBufferPool &buffer_pool, int morsel_pages)
+{
+  if (morsel_pages <= 0) {
+    LOG_WARN("invalid morsel pages. morsel_pages=%d", morsel_pages);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  lock_guard guard(lock_);
+  morsel_pages_       = morsel_pages;
+  dispatched_morsels_ = 0;
+
+  // 第0个页面是 buffer pool 的元数据页面
+  RC rc = bp_iterator_.init(buffer_pool, 1);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init bp iterator. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+RC MorselDispatcher::next_morsel(vector<PageNum> &pages)
+{
+  pages.clear();
+
+  lock_guard guard(lock_);
+  while (static_cast<int>(pages.size()) < morsel_pages_ && bp_iterator_.has_next()) {
+    pages.push_back(bp_iterator_.next());
+  }
+  if (pages.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  bp_iterator_.prefetch();
+  dispatched_morsels_++;
+  return RC::SUCCESS;
+}
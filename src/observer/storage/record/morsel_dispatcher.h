@@ -0,0 +1,61 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#pragma once
+
+#include "common/lang/mutex.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+/**
+ * @brief 把一个文件中的数据页面分成多个 morsel，分给多个扫描线程
+ * @ingroup RecordManager
+ * @details 每个 morsel 是按照页面编号顺序排列的若干个已经分配的页面。扫描线程处理完一个 morsel 之后再来取下一个，
+ * 处理得快的线程会多取一些，不需要提前按照线程个数划分页面。
+ * 内部使用 BufferPoolIterator 遍历页面，取 morsel 时会预读后面的页面。
+ * 多个线程可以同时调用 next_morsel，使用的是 std::mutex，不受 CONCURRENCY 编译选项的影响。
+ */
+class MorselDispatcher
+{
+public:
+  static constexpr int DEFAULT_MORSEL_PAGES = 8;
+
+public:
+  MorselDispatcher()  = default;
+  ~MorselDispatcher() = default;
+
+  /**
+   * @param morsel_pages 每个 morsel 最多包含的页面个数
+   */
+  RC init(DiskBufferPool &buffer_pool, int morsel_pages = DEFAULT_MORSEL_PAGES);
+
+  /**
+   * @brief 获取下一个 morsel
+   * @param pages 返回 morsel 中的页面编号
+   * @return 所有的页面都已经分配出去时返回 RC::RECORD_EOF
+   */
+  RC next_morsel(vector<PageNum> &pages);
+
+  /**
+   * @brief 已经分配出去的 morsel 个数
+   */
+  int dispatched_morsels() const { return dispatched_morsels_; }
+
+private:
+  mutex              lock_;
+  BufferPoolIterator bp_iterator_;
+  int                morsel_pages_       = DEFAULT_MORSEL_PAGES;
+  int                dispatched_morsels_ = 0;
+};
@@ -37,6 +37,8 @@ string RecordOperation::to_string() const
     case Type::INSERT: return ret + "INSERT";
     case Type::DELETE: return ret + "DELETE";
     case Type::UPDATE: return ret + "UPDATE";
+    case Type::OVERFLOW_PAGE: return ret + "OVERFLOW_PAGE";
+    case Type::INSERT_BATCH: return ret + "INSERT_BATCH";
     default: return ret + "UNKNOWN";
   }
 }
@@ -61,6 +63,12 @@ string RecordLogHeader::to_string() const
     case RecordOperation::Type::UPDATE: {
       ss << ", slot_num:" << slot_num;
     } break;
+    case RecordOperation::Type::OVERFLOW_PAGE: {
+      ss << ", data_size:" << record_size;
+    } break;
+    case RecordOperation::Type::INSERT_BATCH: {
+      ss << ", record_num:" << record_num;
+    } break;
     default: {
       ss << ", unknown operation type";
     } break;
@@ -87,6 +95,11 @@ RC RecordLogHandler::init(
 
 // data is the column index in page
 RC RecordLogHandler::init_new_page(Frame *frame, PageNum page_num, span<const char> data)
+{
+  return init_new_page(frame, page_num, static_cast<int>(data.size() / sizeof(int)), data);
+}
+
+RC RecordLogHandler::init_new_page(Frame *frame, PageNum page_num, int column_num, span<const char> data)
 {
   const int        log_payload_size = RecordLogHeader::SIZE + data.size();
   vector<char>     log_payload(log_payload_size);
@@ -96,7 +109,7 @@ RC RecordLogHandler::init_new_page(Frame *frame, PageNum page_num, span<const ch
   header->page_num        = page_num;
   header->record_size     = record_size_;
   header->storage_format  = static_cast<int>(storage_format_);
-  header->column_num      = data.size() / sizeof(int);
+  header->column_num      = column_num;
   if (data.size() > 0) {
     memcpy(log_payload.data() + RecordLogHeader::SIZE, data.data(), data.size());
   }
@@ -111,15 +124,36 @@ RC RecordLogHandler::init_new_page(Frame *frame, PageNum page_num, span<const ch
 
 RC RecordLogHandler::insert_record(Frame *frame, const RID &rid, const char *record)
 {
-  const int        log_payload_size = RecordLogHeader::SIZE + record_size_;
+  return insert_record(frame, rid, span<const char>(record, record_size_));
+}
+
+RC RecordLogHandler::insert_record(Frame *frame, const RID &rid, span<const char> record)
+{
+  return append_record_log(frame, RecordOperation::Type::INSERT, rid, record);
+}
+
+RC RecordLogHandler::insert_records(Frame *frame, span<const SlotNum> slots, span<const char *const> records)
+{
+  ASSERT(slots.size() == records.size(), "slots and records must have the same size");
+
+  const int        record_num       = static_cast<int>(records.size());
+  const int        slots_size       = record_num * sizeof(SlotNum);
+  const int        log_payload_size = RecordLogHeader::SIZE + slots_size + record_num * record_size_;
   vector<char>     log_payload(log_payload_size);
   RecordLogHeader *header = reinterpret_cast<RecordLogHeader *>(log_payload.data());
   header->buffer_pool_id  = buffer_pool_id_;
-  header->operation_type  = RecordOperation(RecordOperation::Type::INSERT).type_id();
-  header->page_num        = rid.page_num;
-  header->slot_num        = rid.slot_num;
+  header->operation_type  = RecordOperation(RecordOperation::Type::INSERT_BATCH).type_id();
+  header->page_num        = frame->page_num();
+  header->record_num      = record_num;
   header->storage_format  = static_cast<int>(storage_format_);
-  memcpy(log_payload.data() + RecordLogHeader::SIZE, record, record_size_);
+
+  char *data = log_payload.data() + RecordLogHeader::SIZE;
+  memcpy(data, slots.data(), slots_size);
+  data += slots_size;
+  for (const char *record : records) {
+    memcpy(data, record, record_size_);
+    data += record_size_;
+  }
 
   LSN lsn = 0;
   RC  rc  = log_handler_->append(lsn, LogModule::Id::RECORD_MANAGER, std::move(log_payload));
@@ -131,15 +165,46 @@ RC RecordLogHandler::insert_record(Frame *frame, const RID &rid, const char *rec
 
 RC RecordLogHandler::update_record(Frame *frame, const RID &rid, const char *record)
 {
-  const int        log_payload_size = RecordLogHeader::SIZE + record_size_;
+  return update_record(frame, rid, span<const char>(record, record_size_));
+}
+
+RC RecordLogHandler::update_record(Frame *frame, const RID &rid, span<const char> record)
+{
+  return append_record_log(frame, RecordOperation::Type::UPDATE, rid, record);
+}
+
+RC RecordLogHandler::append_record_log(
+    Frame *frame, RecordOperation::Type type, const RID &rid, span<const char> record)
+{
+  const int        log_payload_size = RecordLogHeader::SIZE + record.size();
   vector<char>     log_payload(log_payload_size);
   RecordLogHeader *header = reinterpret_cast<RecordLogHeader *>(log_payload.data());
   header->buffer_pool_id  = buffer_pool_id_;
-  header->operation_type  = RecordOperation(RecordOperation::Type::UPDATE).type_id();
+  header->operation_type  = RecordOperation(type).type_id();
   header->page_num        = rid.page_num;
   header->slot_num        = rid.slot_num;
   header->storage_format  = static_cast<int>(storage_format_);
-  memcpy(log_payload.data() + RecordLogHeader::SIZE, record, record_size_);
+  memcpy(log_payload.data() + RecordLogHeader::SIZE, record.data(), record.size());
+
+  LSN lsn = 0;
+  RC  rc  = log_handler_->append(lsn, LogModule::Id::RECORD_MANAGER, std::move(log_payload));
+  if (OB_SUCC(rc) && lsn > 0) {
+    frame->set_lsn(lsn);
+  }
+  return rc;
+}
+
+RC RecordLogHandler::overflow_page(Frame *frame, span<const char> data)
+{
+  const int        log_payload_size = RecordLogHeader::SIZE + data.size();
+  vector<char>     log_payload(log_payload_size);
+  RecordLogHeader *header = reinterpret_cast<RecordLogHeader *>(log_payload.data());
+  header->buffer_pool_id  = buffer_pool_id_;
+  header->operation_type  = RecordOperation(RecordOperation::Type::OVERFLOW_PAGE).type_id();
+  header->page_num        = frame->page_num();
+  header->record_size     = static_cast<int32_t>(data.size());
+  header->storage_format  = static_cast<int>(storage_format_);
+  memcpy(log_payload.data() + RecordLogHeader::SIZE, data.data(), data.size());
 
   LSN lsn = 0;
   RC  rc  = log_handler_->append(lsn, LogModule::Id::RECORD_MANAGER, std::move(log_payload));
@@ -220,12 +285,18 @@ RC RecordLogReplayer::replay(const LogEntry &entry)
     case RecordOperation::Type::INSERT: {
       rc = replay_insert(*buffer_pool, *log_header);
     } break;
+    case RecordOperation::Type::INSERT_BATCH: {
+      rc = replay_insert_batch(*buffer_pool, *log_header);
+    } break;
     case RecordOperation::Type::DELETE: {
       rc = replay_delete(*buffer_pool, *log_header);
     } break;
     case RecordOperation::Type::UPDATE: {
       rc = replay_update(*buffer_pool, *log_header);
     } break;
+    case RecordOperation::Type::OVERFLOW_PAGE: {
+      rc = replay_overflow_page(*frame, *log_header);
+    } break;
     default: {
       LOG_WARN("unknown record operation type: %d", log_header->operation_type);
       return RC::INVALID_ARGUMENT;
@@ -275,7 +346,7 @@ RC RecordLogReplayer::replay_insert(DiskBufferPool &buffer_pool, const RecordLog
 
   const char *record = log_header.data;
   RID         rid(log_header.page_num, log_header.slot_num);
-  rc = record_page_handler->insert_record(record, &rid);
+  rc = record_page_handler->redo_insert_record(record, rid);
   if (OB_FAIL(rc)) {
     LOG_WARN("fail to recover insert record. page num=%d, slot num=%d, rc=%s", 
              log_header.page_num, log_header.slot_num, strrc(rc));
@@ -285,6 +356,35 @@ RC RecordLogReplayer::replay_insert(DiskBufferPool &buffer_pool, const RecordLog
   return rc;
 }
 
+RC RecordLogReplayer::replay_insert_batch(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header)
+{
+  VacuousLogHandler             vacuous_log_handler;
+  unique_ptr<RecordPageHandler> record_page_handler(
+      RecordPageHandler::create(StorageFormat(log_header.storage_format)));
+
+  RC rc = record_page_handler->init(buffer_pool, vacuous_log_handler, log_header.page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to init record page handler. page num=%d, rc=%s", log_header.page_num, strrc(rc));
+    return rc;
+  }
+
+  // 一条日志中的记录都在同一个页面，按照插入时的顺序重做
+  const SlotNum *slots       = reinterpret_cast<const SlotNum *>(log_header.data);
+  const char    *record      = log_header.data + log_header.record_num * sizeof(SlotNum);
+  const int      record_size = record_page_handler->record_real_size();
+  for (int i = 0; i < log_header.record_num; i++, record += record_size) {
+    RID rid(log_header.page_num, slots[i]);
+    rc = record_page_handler->redo_insert_record(record, rid);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("fail to recover insert record. page num=%d, slot num=%d, rc=%s", 
+               log_header.page_num, slots[i], strrc(rc));
+      return rc;
+    }
+  }
+
+  return rc;
+}
+
 RC RecordLogReplayer::replay_delete(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header)
 {
   VacuousLogHandler             vacuous_log_handler;
@@ -298,7 +398,7 @@ RC RecordLogReplayer::replay_delete(DiskBufferPool &buffer_pool, const RecordLog
   }
 
   RID rid(log_header.page_num, log_header.slot_num);
-  rc = record_page_handler->delete_record(&rid);
+  rc = record_page_handler->redo_delete_record(rid);
   if (OB_FAIL(rc)) {
     LOG_WARN("fail to recover delete record. page num=%d, slot num=%d, rc=%s", 
              log_header.page_num, log_header.slot_num, strrc(rc));
@@ -320,7 +420,7 @@ RC RecordLogReplayer::replay_update(DiskBufferPool &buffer_pool, const RecordLog
   }
 
   RID rid(header.page_num, header.slot_num);
-  rc = record_page_handler->update_record(rid, header.data);
+  rc = record_page_handler->redo_update_record(rid, header.data);
   if (OB_FAIL(rc)) {
     LOG_WARN("fail to recover update record. page num=%d, slot num=%d, rc=%s", 
              header.page_num, header.slot_num, strrc(rc));
@@ -329,3 +429,17 @@ RC RecordLogReplayer::replay_update(DiskBufferPool &buffer_pool, const RecordLog
 
   return rc;
 }
+
+RC RecordLogReplayer::replay_overflow_page(Frame &frame, const RecordLogHeader &log_header)
+{
+  if (log_header.record_size < 0 || log_header.record_size > frame.data_size()) {
+    LOG_WARN("invalid overflow page log. page num=%d, data size=%d", log_header.page_num, log_header.record_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  frame.write_latch();
+  memcpy(frame.data(), log_header.data, log_header.record_size);
+  frame.mark_dirty();
+  frame.write_unlatch();
+  return RC::SUCCESS;
+}
@@ -38,10 +38,12 @@ class RecordOperation
 public:
   enum class Type : int32_t
   {
-    INIT_PAGE,  /// 初始化空页面
-    INSERT,     /// 插入一条记录
-    DELETE,     /// 删除一条记录
-    UPDATE      /// 更新一条记录
+    INIT_PAGE,     /// 初始化空页面
+    INSERT,        /// 插入一条记录
+    DELETE,        /// 删除一条记录
+    UPDATE,        /// 更新一条记录
+    OVERFLOW_PAGE,  /// 写入一个溢出页面，日志中是页面的内容
+    INSERT_BATCH    /// 在一个页面中插入多条记录
   };
 
 public:
@@ -68,7 +70,8 @@ struct RecordLogHeader
   union
   {
     SlotNum slot_num;
-    int32_t record_size;
+    int32_t record_size;  ///< INIT_PAGE 时是记录的大小，OVERFLOW_PAGE 时是页面数据的大小
+    int32_t record_num;   ///< INSERT_BATCH 时是记录的个数
   };
 
   char data[0];
@@ -101,6 +104,12 @@ public:
    */
   RC init_new_page(Frame *frame, PageNum page_num, span<const char> data);
 
+  /**
+   * @brief 初始化一个新的页面，data 中除了每列一个 int 的 `column index`，还可以带有其它的列信息
+   * @details PAX 页面在 column index 之后记录每列的类型，重放时用来初始化 zone map
+   */
+  RC init_new_page(Frame *frame, PageNum page_num, int column_num, span<const char> data);
+
   /**
    * @brief 插入一条记录
    * @param frame 页帧
@@ -109,6 +118,20 @@ public:
    */
   RC insert_record(Frame *frame, const RID &rid, const char *record);
 
+  /**
+   * @brief 插入一条记录，日志中记录的是 record 的全部内容
+   * @details 变长格式的页面记录的是编码之后的行数据，长度由数据本身描述
+   */
+  RC insert_record(Frame *frame, const RID &rid, span<const char> record);
+
+  /**
+   * @brief 在同一个页面中插入多条定长的记录，只记录一条日志
+   * @details 日志数据的格式是 | 每条记录的 slot_num | 每条记录的内容 |
+   * @param slots 每条记录在页面中的位置
+   * @param records 每条记录的内容，与 slots 一一对应
+   */
+  RC insert_records(Frame *frame, span<const SlotNum> slots, span<const char *const> records);
+
   /**
    * @brief 删除一条记录
    * @param frame 页帧
@@ -124,6 +147,18 @@ public:
    * @details 更新数据时，通常只更新其中几个字段，这里记录所有数据，是可以优化的。
    */
   RC update_record(Frame *frame, const RID &rid, const char *record);
+  RC update_record(Frame *frame, const RID &rid, span<const char> record);
+
+  /**
+   * @brief 写入一个溢出页面
+   * @details 溢出页面只在分配之后写入一次，直接记录页面的内容，重放时复制到页面中
+   * @param frame 溢出页面的页帧
+   * @param data 页面中有效的数据，从页面的开始位置算起
+   */
+  RC overflow_page(Frame *frame, span<const char> data);
+
+private:
+  RC append_record_log(Frame *frame, RecordOperation::Type type, const RID &rid, span<const char> record);
 
 private:
   LogHandler   *log_handler_    = nullptr;
@@ -147,8 +182,10 @@ public:
 private:
   RC replay_init_page(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_insert(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
+  RC replay_insert_batch(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_delete(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_update(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
+  RC replay_overflow_page(Frame &frame, const RecordLogHeader &log_header);
 
 private:
   BufferPoolManager &bpm_;
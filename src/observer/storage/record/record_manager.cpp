@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include "storage/record/record_manager.h"
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "storage/common/condition_filter.h"
 #include "storage/trx/trx.h"
@@ -24,6 +25,8 @@ RecordPageHandler   *RecordPageHandler::create(StorageFormat format)
 {
   if (format == StorageFormat::ROW_FORMAT) {
     return new RowRecordPageHandler();
+  } else if (format == StorageFormat::VARLEN_FORMAT) {
+    return new VarlenRecordPageHandler();
   } else {
     return new PaxRecordPageHandler();
   }
@@ -95,7 +98,8 @@ RC RecordPageIterator::next(Record &record)
 
 RecordPageHandler::~RecordPageHandler() { cleanup(); }
 
-RC RecordPageHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, ReadWriteMode mode)
+RC RecordPageHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, ReadWriteMode mode,
+    BufferAccessHint hint /* = BufferAccessHint::NORMAL */)
 {
   if (disk_buffer_pool_ != nullptr) {
     if (frame_->page_num() == page_num) {
@@ -107,7 +111,7 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler,
   }
 
   RC ret = RC::SUCCESS;
-  if ((ret = buffer_pool.get_this_page(page_num, &frame_)) != RC::SUCCESS) {
+  if ((ret = buffer_pool.get_this_page(page_num, &frame_, hint)) != RC::SUCCESS) {
     LOG_ERROR("Failed to get page handle from disk buffer pool. ret=%d:%s", ret, strrc(ret));
     return ret;
   }
@@ -126,6 +130,7 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler,
   bitmap_      = data + PAGE_HEADER_SIZE;
 
   (void)log_handler_.init(log_handler, buffer_pool.id(), page_header_->record_real_size, storage_format_);
+  load_page_layout();
 
   LOG_TRACE("Successfully init page_num %d.", page_num);
   return ret;
@@ -153,6 +158,7 @@ RC RecordPageHandler::recover_init(DiskBufferPool &buffer_pool, PageNum page_num
   bitmap_           = data + PAGE_HEADER_SIZE;
 
   buffer_pool.recover_page(page_num);
+  load_page_layout();
 
   LOG_TRACE("Successfully init page_num %d.", page_num);
   return ret;
@@ -179,13 +185,13 @@ RC RecordPageHandler::init_empty_page(
   page_header_->record_real_size = record_size;
   page_header_->record_size      = align8(record_size);
   page_header_->record_capacity  = page_record_capacity(
-      BP_PAGE_DATA_SIZE, page_header_->record_size, column_num * sizeof(int) /* other fixed size*/);
+      frame_->data_size(), page_header_->record_size, column_num * sizeof(int) /* other fixed size*/);
   page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
   page_header_->data_offset    = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity)) +
                               column_num * sizeof(int) /* column index*/;
   this->fix_record_capacity();
   ASSERT(page_header_->data_offset + page_header_->record_capacity * page_header_->record_size 
-              <= BP_PAGE_DATA_SIZE, 
+              <= frame_->data_size(), 
          "Record overflow the page size");
 
   bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
@@ -227,13 +233,13 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
   page_header_->record_real_size = record_size;
   page_header_->record_size      = align8(record_size);
   page_header_->record_capacity =
-      page_record_capacity(BP_PAGE_DATA_SIZE, page_header_->record_size, page_header_->column_num * sizeof(int));
+      page_record_capacity(frame_->data_size(), page_header_->record_size, page_header_->column_num * sizeof(int));
   page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
   page_header_->data_offset    = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity)) +
                               column_num * sizeof(int) /* column index*/;
   this->fix_record_capacity();
   ASSERT(page_header_->data_offset + page_header_->record_capacity * page_header_->record_size 
-              <= BP_PAGE_DATA_SIZE, 
+              <= frame_->data_size(), 
          "Record overflow the page size");
 
   bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
@@ -303,6 +309,33 @@ RC RowRecordPageHandler::insert_record(const char *data, RID *rid)
   return RC::SUCCESS;
 }
 
+RC RowRecordPageHandler::insert_records(span<const char *const> records, RID *rids, int &inserted_num)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  vector<SlotNum> slots;
+  inserted_num = allocate_slots(static_cast<int>(records.size()), slots);
+  if (inserted_num == 0) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  RC rc = log_handler_.insert_records(frame_, slots, records.first(inserted_num));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert records. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  for (int i = 0; i < inserted_num; i++) {
+    memcpy(get_record_data(slots[i]), records[i], page_header_->record_real_size);
+    rids[i] = RID(get_page_num(), slots[i]);
+  }
+
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
 RC RowRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
 {
   if (rid.slot_num >= page_header_->record_capacity) {
@@ -321,160 +354,1350 @@ RC RowRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
   char *record_data = get_record_data(rid.slot_num);
   memcpy(record_data, data, page_header_->record_real_size);
 
-  frame_->mark_dirty();
+  frame_->mark_dirty();
+
+  return RC::SUCCESS;
+}
+
+RC RowRecordPageHandler::delete_record(const RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot delete record from page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (bitmap.get_bit(rid->slot_num)) {
+    bitmap.clear_bit(rid->slot_num);
+    page_header_->record_num--;
+    frame_->mark_dirty();
+
+    RC rc = log_handler_.delete_record(frame_, *rid);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+      // return rc; // ignore errors
+    }
+
+    return RC::SUCCESS;
+  } else {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+}
+
+RC RowRecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot delete record from page while the page is readonly");
+
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (bitmap.get_bit(rid.slot_num)) {
+    frame_->mark_dirty();
+
+    char *record_data = get_record_data(rid.slot_num);
+    if (record_data == data) {
+      // nothing to do
+    } else {
+      memcpy(record_data, data, page_header_->record_real_size);
+    }
+
+    RC rc = log_handler_.update_record(frame_, rid, data);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
+                disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+      // return rc; // ignore errors
+    }
+
+    return RC::SUCCESS;
+  } else {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+}
+
+RC RowRecordPageHandler::get_record(const RID &rid, Record &record)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  record.set_rid(rid);
+  record.set_data(get_record_data(rid.slot_num), page_header_->record_real_size);
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::insert_records(span<const char *const> records, RID *rids, int &inserted_num)
+{
+  RC rc        = RC::SUCCESS;
+  inserted_num = 0;
+  for (const char *record : records) {
+    rc = insert_record(record, &rids[inserted_num]);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+    inserted_num++;
+  }
+
+  // 已经插入了一部分时，剩下的记录放到其它页面中
+  if (rc == RC::RECORD_NOMEM && inserted_num > 0) {
+    rc = RC::SUCCESS;
+  }
+  return rc;
+}
+
+int RecordPageHandler::allocate_slots(int count, vector<SlotNum> &slots)
+{
+  count = min(count, page_header_->record_capacity - page_header_->record_num);
+  slots.resize(count);
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = -1;
+  for (int i = 0; i < count; i++) {
+    index = bitmap.next_unsetted_bit(index + 1);
+    bitmap.set_bit(index);
+    slots[i] = index;
+  }
+  page_header_->record_num += count;
+  return count;
+}
+
+PageNum RecordPageHandler::get_page_num() const
+{
+  if (nullptr == page_header_) {
+    return (PageNum)(-1);
+  }
+  return frame_->page_num();
+}
+
+bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+
+uint8_t RecordPageHandler::fill_class() const
+{
+  return FreeSpaceMap::fill_class(page_header_->record_capacity - page_header_->record_num, page_header_->record_capacity);
+}
+
+RC PaxRecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size, TableMeta *table_meta)
+{
+  // 没有表的元数据时，把整条记录当作一列
+  vector<int> column_lens;
+  vector<int> column_types;
+  if (table_meta == nullptr) {
+    column_lens.push_back(record_size);
+    column_types.push_back(static_cast<int>(AttrType::UNDEFINED));
+  } else {
+    for (int i = 0; i < table_meta->field_num(); ++i) {
+      const FieldMeta *field = table_meta->field(i);
+      ASSERT(i == field->field_id(), "i should be the col_id of fields[i]");
+      column_lens.push_back(field->len());
+      column_types.push_back(static_cast<int>(field->type()));
+    }
+  }
+
+  return init_pax_page(buffer_pool,
+      log_handler,
+      page_num,
+      record_size,
+      static_cast<int>(column_lens.size()),
+      column_lens.data(),
+      column_types.data(),
+      true /*write_log*/);
+}
+
+RC PaxRecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+    int record_size, int column_num, const char *col_idx_data)
+{
+  // 列索引记录的是每列的结束位置，所有列的总长度就是记录的大小，可以据此算出每列的长度
+  const int *column_index = reinterpret_cast<const int *>(col_idx_data);
+  const int *column_types = column_index + column_num;
+  if (column_num <= 0 || record_size <= 0 || column_index[column_num - 1] % record_size != 0) {
+    LOG_ERROR("Failed to init empty page: invalid column index. page_num=%d, record_size=%d, column_num=%d",
+              page_num, record_size, column_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int   record_capacity = column_index[column_num - 1] / record_size;
+  vector<int> column_lens(column_num);
+  for (int i = 0; i < column_num; i++) {
+    column_lens[i] = (column_index[i] - (i == 0 ? 0 : column_index[i - 1])) / record_capacity;
+  }
+
+  return init_pax_page(buffer_pool,
+      log_handler,
+      page_num,
+      record_size,
+      column_num,
+      column_lens.data(),
+      column_types,
+      false /*write_log*/);
+}
+
+RC PaxRecordPageHandler::init_pax_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+    int record_size, int column_num, const int *column_lens, const int *column_types, bool write_log)
+{
+  RC rc = init(buffer_pool, log_handler, page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page page_num:record_size %d:%d. rc=%s", page_num, record_size, strrc(rc));
+    return rc;
+  }
+
+  (void)log_handler_.init(log_handler, buffer_pool.id(), record_size, storage_format_);
+
+  // 列索引、zone map 和列的编码方式都是定长的，放在 bitmap 之后，列索引和 zone map 各自8字节对齐
+  const int column_meta_size = column_num * (sizeof(ColumnZoneMap) + sizeof(ColumnEncodingHeader));
+  page_header_->record_num       = 0;
+  page_header_->column_num       = column_num;
+  page_header_->record_real_size = record_size;
+  page_header_->record_size      = record_size;
+  page_header_->record_capacity  = page_record_capacity(
+      frame_->data_size(), record_size, column_num * sizeof(int) + column_meta_size + 16 /* align */);
+  page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
+  page_header_->data_offset    = align8(page_header_->col_idx_offset + column_num * sizeof(int)) + column_meta_size;
+  this->fix_record_capacity();
+  ASSERT(page_header_->data_offset + page_header_->record_capacity * page_header_->record_size 
+              <= frame_->data_size(), 
+         "Record overflow the page size");
+
+  bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
+  memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+
+  // column_index[i] store the end offset of column `i` or the start offset of column `i+1`
+  int *column_index = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  for (int i = 0; i < column_num; ++i) {
+    column_index[i] = column_lens[i] * page_header_->record_capacity + (i == 0 ? 0 : column_index[i - 1]);
+  }
+  ASSERT(column_num == 0 || column_index[column_num - 1] == record_size * page_header_->record_capacity,
+         "the sum of column length should be the record size");
+
+  ColumnZoneMap *zones = zone_maps();
+  for (int i = 0; i < column_num; ++i) {
+    zones[i].init(static_cast<AttrType>(column_types[i]), column_lens[i]);
+  }
+  memset(column_encodings(), 0, column_num * sizeof(ColumnEncodingHeader));
+  frame_->mark_dirty();
+
+  if (write_log) {
+    // 日志中记录列索引和每列的类型
+    vector<int> log_data(column_index, column_index + column_num);
+    log_data.insert(log_data.end(), column_types, column_types + column_num);
+    rc = log_handler_.init_new_page(frame_,
+        page_num,
+        column_num,
+        span(reinterpret_cast<const char *>(log_data.data()), log_data.size() * sizeof(int)));
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to init empty page: write log failed. page_num:record_size %d:%d. rc=%s", 
+                page_num, record_size, strrc(rc));
+      return rc;
+    }
+  }
+
+  return RC::SUCCESS;
+}
+
+ColumnZoneMap *PaxRecordPageHandler::zone_maps() const
+{
+  return reinterpret_cast<ColumnZoneMap *>(
+      frame_->data() + align8(page_header_->col_idx_offset + page_header_->column_num * sizeof(int)));
+}
+
+ColumnEncodingHeader *PaxRecordPageHandler::column_encodings() const
+{
+  return reinterpret_cast<ColumnEncodingHeader *>(
+      reinterpret_cast<char *>(zone_maps()) + page_header_->column_num * sizeof(ColumnZoneMap));
+}
+
+void PaxRecordPageHandler::seal()
+{
+  // 编码之后页面的大小不变，只有页面压缩能把省下的空间变成更少的 I/O。
+  // 不压缩的文件封存之后，每次扫描都要解码，还失去了 reference_chunk 零拷贝的好处
+  if (disk_buffer_pool_->compression() == PageCompression::NONE) {
+    return;
+  }
+
+  const ColumnZoneMap  *zones     = zone_maps();
+  ColumnEncodingHeader *encodings = column_encodings();
+  vector<char>          encoded;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    if (encodings[col_id].type() != ColumnEncoding::PLAIN) {
+      continue;
+    }
+
+    const int      raw_size = get_field_len(col_id) * page_header_->record_capacity;
+    char          *data     = get_field_data(0, col_id);
+    ColumnEncoding encoding = ColumnEncoder::encode(
+        zones[col_id].type(), get_field_len(col_id), data, page_header_->record_capacity, encoded);
+    if (encoding == ColumnEncoding::PLAIN) {
+      continue;
+    }
+
+    // 编码之后的数据放在这一列的开始位置，剩余的空间清零，方便页面压缩
+    memcpy(data, encoded.data(), encoded.size());
+    memset(data + encoded.size(), 0, raw_size - encoded.size());
+    encodings[col_id].encoding = static_cast<int32_t>(encoding);
+    encodings[col_id].size     = static_cast<int32_t>(encoded.size());
+  }
+  frame_->mark_dirty();
+}
+
+void PaxRecordPageHandler::unseal()
+{
+  ColumnEncodingHeader *encodings = column_encodings();
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    if (encodings[col_id].type() == ColumnEncoding::PLAIN) {
+      continue;
+    }
+
+    const int    field_len = get_field_len(col_id);
+    vector<char> decoded(field_len * page_header_->record_capacity);
+    char        *data = get_field_data(0, col_id);
+    ColumnEncoder::decode(encodings[col_id].type(), field_len, data, page_header_->record_capacity, decoded.data());
+    memcpy(data, decoded.data(), decoded.size());
+    encodings[col_id].encoding = static_cast<int32_t>(ColumnEncoding::PLAIN);
+    encodings[col_id].size     = 0;
+    frame_->mark_dirty();
+  }
+}
+
+const char *PaxRecordPageHandler::column_data(int col_id)
+{
+  const ColumnEncodingHeader &encoding = column_encodings()[col_id];
+  if (encoding.type() == ColumnEncoding::PLAIN) {
+    return get_field_data(0, col_id);
+  }
+
+  const int field_len = get_field_len(col_id);
+  decoded_columns_.resize(page_header_->column_num);
+  vector<char> &decoded = decoded_columns_[col_id];
+  decoded.resize(field_len * page_header_->record_capacity);
+  ColumnEncoder::decode(
+      encoding.type(), field_len, get_field_data(0, col_id), page_header_->record_capacity, decoded.data());
+  return decoded.data();
+}
+
+void PaxRecordPageHandler::read_field(SlotNum slot_num, int col_id, char *value) const
+{
+  const ColumnEncodingHeader &encoding = column_encodings()[col_id];
+  if (encoding.type() == ColumnEncoding::PLAIN) {
+    memcpy(value, get_field_data(slot_num, col_id), get_field_len(col_id));
+  } else {
+    ColumnEncoder::decode_one(encoding.type(), get_field_len(col_id), get_field_data(0, col_id), slot_num, value);
+  }
+}
+
+void PaxRecordPageHandler::write_fields(SlotNum slot_num, const char *data)
+{
+  ColumnZoneMap *zones  = zone_maps();
+  int            offset = 0;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    const int field_len = get_field_len(col_id);
+    memcpy(get_field_data(slot_num, col_id), data + offset, field_len);
+    zones[col_id].extend(data + offset);
+    offset += field_len;
+  }
+}
+
+void PaxRecordPageHandler::rebuild_zone_map(int col_id)
+{
+  ColumnZoneMap &zone = zone_maps()[col_id];
+  zone.clear();
+
+  const char *data      = column_data(col_id);
+  const int   field_len = get_field_len(col_id);
+  Bitmap      bitmap(bitmap_, page_header_->record_capacity);
+  for (int slot_num = bitmap.next_setted_bit(0); slot_num >= 0; slot_num = bitmap.next_setted_bit(slot_num + 1)) {
+    zone.extend(data + field_len * slot_num);
+  }
+}
+
+RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 删除过记录的页面可能已经封存了，写入之前先解码
+  unseal();
+
+  // 找到空闲位置
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = bitmap.next_unsetted_bit(0);
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+
+  RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  write_fields(index, data);
+  frame_->mark_dirty();
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    seal();
+  }
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::insert_records(span<const char *const> records, RID *rids, int &inserted_num)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  vector<SlotNum> slots;
+  inserted_num = allocate_slots(static_cast<int>(records.size()), slots);
+  if (inserted_num == 0) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 整批记录只解码和封存一次
+  unseal();
+
+  RC rc = log_handler_.insert_records(frame_, slots, records.first(inserted_num));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert records. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  for (int i = 0; i < inserted_num; i++) {
+    write_fields(slots[i], records[i]);
+    rids[i] = RID(get_page_num(), slots[i]);
+  }
+  frame_->mark_dirty();
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    seal();
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  unseal();
+
+  // 更新位图
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    bitmap.set_bit(rid.slot_num);
+    page_header_->record_num++;
+  }
+
+  write_fields(rid.slot_num, data);
+  frame_->mark_dirty();
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    seal();
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::delete_record(const RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot delete record from page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (bitmap.get_bit(rid->slot_num)) {
+    // 删除的值在边界上时，这一列的范围可能会缩小。删除只修改位图，已经封存的页面不需要解码
+    ColumnZoneMap *zones = zone_maps();
+    vector<int>    boundary_columns;
+    for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+      char value[ColumnZoneMap::MAX_VALUE_LEN];
+      if (!ColumnZoneMap::supported(zones[col_id].type(), get_field_len(col_id))) {
+        continue;
+      }
+      read_field(rid->slot_num, col_id, value);
+      if (zones[col_id].on_boundary(value)) {
+        boundary_columns.push_back(col_id);
+      }
+    }
+
+    bitmap.clear_bit(rid->slot_num);
+    page_header_->record_num--;
+    for (int col_id : boundary_columns) {
+      rebuild_zone_map(col_id);
+    }
+    frame_->mark_dirty();
+
+    RC rc = log_handler_.delete_record(frame_, *rid);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+      // return rc; // ignore errors
+    }
+
+    return RC::SUCCESS;
+  } else {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+}
+
+RC PaxRecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record in page while the page is readonly");
+
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  // 更新之后的页面保持未编码的状态，页面再次写满时才会重新封存
+  unseal();
+
+  // 原来的值在边界上并且发生了变化时，需要重新计算这一列的范围
+  ColumnZoneMap *zones  = zone_maps();
+  vector<int>    boundary_columns;
+  int            offset = 0;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    const char *old_value = get_field_data(rid.slot_num, col_id);
+    const int   field_len = get_field_len(col_id);
+    if (zones[col_id].on_boundary(old_value) && 0 != memcmp(old_value, data + offset, field_len)) {
+      boundary_columns.push_back(col_id);
+    }
+    offset += field_len;
+  }
+
+  write_fields(rid.slot_num, data);
+  for (int col_id : boundary_columns) {
+    rebuild_zone_map(col_id);
+  }
+  frame_->mark_dirty();
+
+  RC rc = log_handler_.update_record(frame_, rid, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  // 各列的数据不是连续存放的，需要复制出来组装成一条记录
+  RC rc = record.new_record(page_header_->record_real_size);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  int offset = 0;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    read_field(rid.slot_num, col_id, record.data() + offset);
+    offset += get_field_len(col_id);
+  }
+  record.set_rid(rid);
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
+{
+  // 只复制 chunk 中需要的列，连续的多条记录在列中也是连续存放的，一次复制
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const int col_id = chunk.column_ids(i);
+    if (col_id < 0 || col_id >= page_header_->column_num) {
+      LOG_WARN("invalid column id. col_id=%d, column num=%d", col_id, page_header_->column_num);
+      return RC::INVALID_ARGUMENT;
+    }
+
+    Column     &column    = chunk.column(i);
+    const char *data      = column_data(col_id);
+    const int   field_len = get_field_len(col_id);
+    for (int slot_num = bitmap.next_setted_bit(0); slot_num >= 0; ) {
+      int end_slot = bitmap.next_unsetted_bit(slot_num + 1);
+      if (end_slot < 0) {
+        end_slot = page_header_->record_capacity;
+      }
+
+      RC rc = column.append(const_cast<char *>(data + field_len * slot_num), end_slot - slot_num);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append data to chunk. page_num=%d, slot_num=%d, count=%d, col_id=%d, rc=%s", 
+                 get_page_num(), slot_num, end_slot - slot_num, col_id, strrc(rc));
+        return rc;
+      }
+
+      slot_num = end_slot < page_header_->record_capacity ? bitmap.next_setted_bit(end_slot + 1) : -1;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::reference_chunk(Chunk &chunk, vector<uint8_t> &select)
+{
+  select.clear();
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  for (int slot_num = bitmap.next_setted_bit(0); slot_num >= 0; slot_num = bitmap.next_setted_bit(slot_num + 1)) {
+    select.resize(slot_num + 1, 0);
+    select[slot_num] = 1;
+  }
+
+  const int rows = static_cast<int>(select.size());
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const int col_id = chunk.column_ids(i);
+    if (col_id < 0 || col_id >= page_header_->column_num) {
+      LOG_WARN("invalid column id. col_id=%d, column num=%d", col_id, page_header_->column_num);
+      return RC::INVALID_ARGUMENT;
+    }
+
+    Column &column = chunk.column(i);
+    if (column.is_varlen() || column.attr_len() != get_field_len(col_id)) {
+      LOG_WARN("column cannot reference page data. col_id=%d, attr_len=%d, field_len=%d", 
+               col_id, column.attr_len(), get_field_len(col_id));
+      return RC::INVALID_ARGUMENT;
+    }
+    // 编码的列引用的是解码之后的数据，在读取下一个页面之前有效
+    column.reference(const_cast<char *>(column_data(col_id)), rows);
+  }
+  return RC::SUCCESS;
+}
+
+bool PaxRecordPageHandler::may_match(const ZoneMapFilter &filter) const
+{
+  if (filter.empty() || page_header_->column_num <= 0) {
+    return true;
+  }
+  return filter.may_match(zone_maps(), page_header_->column_num);
+}
+
+char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id) const
+{
+  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  if (col_id == 0) {
+    return frame_->data() + page_header_->data_offset + (get_field_len(col_id) * slot_num);
+  } else {
+    return frame_->data() + page_header_->data_offset + col_idx[col_id - 1] + (get_field_len(col_id) * slot_num);
+  }
+}
+
+int PaxRecordPageHandler::get_field_len(int col_id) const
+{
+  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  if (col_id == 0) {
+    return col_idx[col_id] / page_header_->record_capacity;
+  } else {
+    return (col_idx[col_id] - col_idx[col_id - 1]) / page_header_->record_capacity;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int VarlenRecordPageHandler::insert_space(const VarlenRowFormat &format, const char *data)
+{
+  VarlenRowFormat::RowPlan plan;
+  format.plan(data, plan);
+  return plan.row_size + static_cast<int>(sizeof(VarlenRowFormat::Slot));
+}
+
+RC VarlenRecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size, TableMeta *table_meta)
+{
+  vector<int> column_descs;
+  VarlenRowFormat::make_column_descs(table_meta, record_size, column_descs);
+  return init_varlen_page(buffer_pool,
+      log_handler,
+      page_num,
+      record_size,
+      column_descs.data(),
+      static_cast<int>(column_descs.size()),
+      true /*write_log*/);
+}
+
+RC VarlenRecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+    int record_size, int col_num, const char *col_idx_data)
+{
+  return init_varlen_page(buffer_pool,
+      log_handler,
+      page_num,
+      record_size,
+      reinterpret_cast<const int *>(col_idx_data),
+      col_num,
+      false /*write_log*/);
+}
+
+RC VarlenRecordPageHandler::init_varlen_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+    int record_size, const int *column_descs, int column_num, bool write_log)
+{
+  RC rc = init(buffer_pool, log_handler, page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page page_num:record_size %d:%d. rc=%s", page_num, record_size, strrc(rc));
+    return rc;
+  }
+
+  (void)log_handler_.init(log_handler, buffer_pool.id(), record_size, storage_format_);
+
+  format_.init(column_descs, column_num, frame_->data_size());
+  if (format_.record_size() != record_size || format_.record_capacity() <= 0 ||
+      format_.min_row_size() + static_cast<int>(sizeof(VarlenRowFormat::Slot)) > format_.heap_capacity()) {
+    LOG_ERROR("Failed to init empty page: invalid record format. page_num=%d, record_size=%d, format record size=%d, "
+              "min row size=%d, heap capacity=%d",
+              page_num, record_size, format_.record_size(), format_.min_row_size(), format_.heap_capacity());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  page_header_->record_num       = 0;
+  page_header_->column_num       = column_num;
+  page_header_->record_real_size = record_size;
+  page_header_->record_size      = format_.min_row_size();
+  page_header_->record_capacity  = format_.record_capacity();
+  page_header_->col_idx_offset   = format_.col_idx_offset();
+  page_header_->data_offset      = format_.slot_dir_offset();
+
+  bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
+  memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+
+  VarlenPageHeader *header = varlen_header();
+  header->slot_count       = 0;
+  header->heap_offset      = frame_->data_size();
+  header->garbage_size     = 0;
+  header->reserved         = 0;
+
+  memcpy(frame_->data() + page_header_->col_idx_offset, column_descs, column_num * sizeof(int));
+  layout_loaded_ = true;
+  frame_->mark_dirty();
+
+  if (write_log) {
+    rc = log_handler_.init_new_page(
+        frame_, page_num, span(reinterpret_cast<const char *>(column_descs), column_num * sizeof(int)));
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to init empty page: write log failed. page_num:record_size %d:%d. rc=%s", 
+                page_num, record_size, strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void VarlenRecordPageHandler::load_page_layout()
+{
+  // 溢出页面和刚分配的页面上没有记录，不需要解析布局
+  layout_loaded_ = false;
+  if (page_header_->record_capacity <= 0 || page_header_->column_num <= 0 ||
+      page_header_->col_idx_offset + page_header_->column_num * static_cast<int>(sizeof(int)) > frame_->data_size()) {
+    return;
+  }
+
+  const int *column_descs = reinterpret_cast<const int *>(frame_->data() + page_header_->col_idx_offset);
+  if (!format_.same_as(column_descs, page_header_->column_num, frame_->data_size())) {
+    format_.init(column_descs, page_header_->column_num, frame_->data_size());
+  }
+  layout_loaded_ = true;
+}
+
+VarlenPageHeader *VarlenRecordPageHandler::varlen_header() const
+{
+  return reinterpret_cast<VarlenPageHeader *>(frame_->data() + format_.varlen_header_offset());
+}
+
+VarlenRowFormat::Slot *VarlenRecordPageHandler::slots() const
+{
+  return reinterpret_cast<VarlenRowFormat::Slot *>(frame_->data() + format_.slot_dir_offset());
+}
+
+char *VarlenRecordPageHandler::row_data(SlotNum slot_num) const { return frame_->data() + slots()[slot_num].offset; }
+
+int VarlenRecordPageHandler::free_space() const
+{
+  const VarlenPageHeader *header  = varlen_header();
+  const int               dir_end = format_.slot_dir_offset() + header->slot_count * sizeof(VarlenRowFormat::Slot);
+  return header->heap_offset - dir_end + header->garbage_size;
+}
+
+bool VarlenRecordPageHandler::is_full() const
+{
+  if (!layout_loaded_ || page_header_->record_num >= page_header_->record_capacity) {
+    return true;
+  }
+  return free_space() < format_.min_row_size() + static_cast<int>(sizeof(VarlenRowFormat::Slot));
+}
+
+uint8_t VarlenRecordPageHandler::fill_class() const
+{
+  if (is_full()) {
+    return FreeSpaceMap::FULL;
+  }
+  return FreeSpaceMap::fill_class(free_space(), format_.heap_capacity());
+}
+
+RC VarlenRecordPageHandler::check_slot(const RID &rid) const
+{
+  if (!layout_loaded_ || rid.slot_num < 0 || rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+  return RC::SUCCESS;
+}
+
+void VarlenRecordPageHandler::compact()
+{
+  VarlenPageHeader      *header = varlen_header();
+  VarlenRowFormat::Slot *slot   = slots();
+
+  // 行数据先复制出来，再从页面末尾开始依次放回去
+  const int    heap_size = frame_->data_size() - header->heap_offset;
+  vector<char> heap(frame_->data() + header->heap_offset, frame_->data() + frame_->data_size());
+
+  int offset = frame_->data_size();
+  for (int i = 0; i < header->slot_count; i++) {
+    if (slot[i].length == 0) {
+      continue;
+    }
+    offset -= slot[i].length;
+    memcpy(frame_->data() + offset, heap.data() + (slot[i].offset - (frame_->data_size() - heap_size)), slot[i].length);
+    slot[i].offset = static_cast<uint16_t>(offset);
+  }
+
+  header->heap_offset  = offset;
+  header->garbage_size = 0;
+}
+
+void VarlenRecordPageHandler::place_row(SlotNum slot_num, const char *row, int row_size)
+{
+  VarlenPageHeader      *header = varlen_header();
+  VarlenRowFormat::Slot *slot   = slots();
+
+  // 行目录先增长，然后再分配行数据，这样整理页面时也会考虑新的槽位
+  while (header->slot_count <= slot_num) {
+    slot[header->slot_count++] = VarlenRowFormat::Slot{0, 0};
+  }
+
+  const int dir_end = format_.slot_dir_offset() + header->slot_count * sizeof(VarlenRowFormat::Slot);
+  if (header->heap_offset - dir_end < row_size) {
+    compact();
+  }
+  ASSERT(header->heap_offset - dir_end >= row_size, "no enough space for row. row size=%d, free=%d",
+         row_size, header->heap_offset - dir_end);
+
+  header->heap_offset -= row_size;
+  memcpy(frame_->data() + header->heap_offset, row, row_size);
+  slot[slot_num] = VarlenRowFormat::Slot{static_cast<uint16_t>(header->heap_offset), static_cast<uint16_t>(row_size)};
+}
+
+RC VarlenRecordPageHandler::replace_row(SlotNum slot_num, const char *row, int row_size)
+{
+  VarlenPageHeader      *header   = varlen_header();
+  VarlenRowFormat::Slot &slot     = slots()[slot_num];
+  const int              old_size = slot.length;
+
+  // 新的数据不比原来的大，直接覆盖
+  if (row_size <= old_size) {
+    memmove(frame_->data() + slot.offset, row, row_size);
+    slot.length = static_cast<uint16_t>(row_size);
+    header->garbage_size += old_size - row_size;
+    return RC::SUCCESS;
+  }
+
+  if (free_space() + old_size < row_size) {
+    return RC::RECORD_NOMEM;
+  }
+
+  header->garbage_size += old_size;
+  slot = VarlenRowFormat::Slot{0, 0};
+  place_row(slot_num, row, row_size);
+  return RC::SUCCESS;
+}
+
+void VarlenRecordPageHandler::remove_row(SlotNum slot_num)
+{
+  VarlenPageHeader      *header = varlen_header();
+  VarlenRowFormat::Slot *slot   = slots();
+
+  header->garbage_size += slot[slot_num].length;
+  slot[slot_num] = VarlenRowFormat::Slot{0, 0};
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  bitmap.clear_bit(slot_num);
+  page_header_->record_num--;
+
+  // 回收行目录末尾空闲的槽位
+  while (header->slot_count > 0 && !bitmap.get_bit(header->slot_count - 1)) {
+    header->slot_count--;
+  }
+}
+
+RC VarlenRecordPageHandler::write_overflow(const char *data, int len, VarlenRowFormat::OverflowRef &ref)
+{
+  const int page_capacity = frame_->data_size() - static_cast<int>(sizeof(OverflowPageHeader));
+
+  Frame *frame = nullptr;
+  RC     rc    = disk_buffer_pool_->allocate_page(&frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate overflow page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  ref.length     = len;
+  ref.first_page = frame->page_num();
+
+  int offset = 0;
+  while (frame != nullptr) {
+    const int data_len   = min(page_capacity, len - offset);
+    Frame    *next_frame = nullptr;
+    if (offset + data_len < len) {
+      rc = disk_buffer_pool_->allocate_page(&next_frame);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to allocate overflow page. rc=%s", strrc(rc));
+        next_frame = nullptr;
+      }
+    }
+
+    frame->write_latch();
+    auto *header = reinterpret_cast<OverflowPageHeader *>(frame->data());
+    memset(&header->page_header, 0, sizeof(PageHeader));
+    header->next_page = next_frame != nullptr ? next_frame->page_num() : BP_INVALID_PAGE_NUM;
+    header->data_len  = data_len;
+    memcpy(frame->data() + sizeof(OverflowPageHeader), data + offset, data_len);
+
+    RC log_rc = log_handler_.overflow_page(frame, span(frame->data(), sizeof(OverflowPageHeader) + data_len));
+    if (OB_FAIL(log_rc)) {
+      LOG_ERROR("Failed to log overflow page. page_num=%d, rc=%s", frame->page_num(), strrc(log_rc));
+      // ignore errors
+    }
+    frame->mark_dirty();
+    frame->write_unlatch();
+    disk_buffer_pool_->unpin_page(frame);
+
+    offset += data_len;
+    frame = next_frame;
+  }
+
+  if (OB_FAIL(rc)) {
+    // 已经写入的溢出页面都要释放
+    free_overflow(ref);
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC VarlenRecordPageHandler::read_overflow(const VarlenRowFormat::OverflowRef &ref, char *data)
+{
+  int     offset   = 0;
+  PageNum page_num = ref.first_page;
+  while (page_num != BP_INVALID_PAGE_NUM && offset < ref.length) {
+    Frame *frame = nullptr;
+    RC     rc    = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get overflow page. page_num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    frame->read_latch();
+    const auto *header   = reinterpret_cast<const OverflowPageHeader *>(frame->data());
+    const int   data_len = min<int>(header->data_len, ref.length - offset);
+    memcpy(data + offset, frame->data() + sizeof(OverflowPageHeader), data_len);
+    page_num = header->next_page;
+    frame->read_unlatch();
+    disk_buffer_pool_->unpin_page(frame);
+
+    offset += data_len;
+  }
+
+  if (offset != ref.length) {
+    LOG_ERROR("overflow data is broken. first page=%d, length=%d, read=%d", ref.first_page, ref.length, offset);
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
+RC VarlenRecordPageHandler::free_overflow(const VarlenRowFormat::OverflowRef &ref)
+{
+  PageNum page_num = ref.first_page;
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    Frame *frame = nullptr;
+    RC     rc    = disk_buffer_pool_->get_this_page(page_num, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get overflow page. page_num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    frame->read_latch();
+    const PageNum next_page = reinterpret_cast<const OverflowPageHeader *>(frame->data())->next_page;
+    frame->read_unlatch();
+    disk_buffer_pool_->unpin_page(frame);
+
+    rc = disk_buffer_pool_->dispose_page(page_num);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to dispose overflow page. page_num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+    page_num = next_page;
+  }
+  return RC::SUCCESS;
+}
+
+RC VarlenRecordPageHandler::load_overflow_fields(const char *row, char *record)
+{
+  vector<VarlenRowFormat::OverflowRef> refs;
+  if (format_.overflow_refs(row, refs) == 0) {
+    return RC::SUCCESS;
+  }
+
+  for (int i = 0; i < format_.column_num(); i++) {
+    if (refs[i].length < 0) {
+      continue;
+    }
+    RC rc = read_overflow(refs[i], record + format_.field_offset(i));
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC VarlenRecordPageHandler::insert_record(const char *data, RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  if (is_full()) {
+    LOG_TRACE("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 先检查空间是否足够，放不下时不能修改页面，也不能分配溢出页面
+  VarlenRowFormat::RowPlan plan;
+  format_.plan(data, plan);
+
+  Bitmap    bitmap(bitmap_, page_header_->record_capacity);
+  const int index    = bitmap.next_unsetted_bit(0);
+  const int new_slot = index >= varlen_header()->slot_count ? sizeof(VarlenRowFormat::Slot) : 0;
+  if (free_space() < plan.row_size + new_slot) {
+    LOG_TRACE("Page has no enough space, page_num %d, row size %d, free space %d.", 
+              frame_->page_num(), plan.row_size, free_space());
+    return RC::RECORD_NOMEM;
+  }
+
+  vector<VarlenRowFormat::OverflowRef> refs(format_.column_num(), VarlenRowFormat::OverflowRef{-1, BP_INVALID_PAGE_NUM});
+  for (int i = 0; i < format_.column_num(); i++) {
+    if (!plan.overflow[i]) {
+      continue;
+    }
+    RC rc = write_overflow(data + format_.field_offset(i), plan.lengths[i], refs[i]);
+    if (OB_FAIL(rc)) {
+      for (int j = 0; j < i; j++) {
+        if (plan.overflow[j]) {
+          free_overflow(refs[j]);
+        }
+      }
+      return rc;
+    }
+  }
+
+  vector<char> row(plan.row_size);
+  format_.encode(data, plan, refs, row.data());
+
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+  place_row(index, row.data(), plan.row_size);
+
+  RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), span<const char>(row));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+  return RC::SUCCESS;
+}
+
+RC VarlenRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+{
+  if (!layout_loaded_ || rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  VarlenRowFormat::RowPlan plan;
+  format_.plan(data, plan);
+  for (int i = 0; i < format_.column_num(); i++) {
+    if (plan.overflow[i]) {
+      LOG_WARN("cannot recover record with overflow fields. rid=%s", rid.to_string().c_str());
+      return RC::UNSUPPORTED;
+    }
+  }
 
-  return RC::SUCCESS;
+  vector<char> row(plan.row_size);
+  format_.encode(data, plan, {}, row.data());
+  return redo_insert_record(row.data(), rid);
 }
 
-RC RowRecordPageHandler::delete_record(const RID *rid)
+RC VarlenRecordPageHandler::delete_record(const RID *rid)
 {
   ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
          "cannot delete record from page while the page is readonly");
 
-  Bitmap bitmap(bitmap_, page_header_->record_capacity);
-  if (bitmap.get_bit(rid->slot_num)) {
-    bitmap.clear_bit(rid->slot_num);
-    page_header_->record_num--;
-    frame_->mark_dirty();
+  RC rc = check_slot(*rid);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
 
-    RC rc = log_handler_.delete_record(frame_, *rid);
-    if (OB_FAIL(rc)) {
-      LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
-      // return rc; // ignore errors
-    }
+  vector<VarlenRowFormat::OverflowRef> refs;
+  format_.overflow_refs(row_data(rid->slot_num), refs);
 
-    return RC::SUCCESS;
-  } else {
-    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
-    return RC::RECORD_NOT_EXIST;
+  remove_row(rid->slot_num);
+  frame_->mark_dirty();
+
+  rc = log_handler_.delete_record(frame_, *rid);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  // 释放溢出页面的日志在删除记录的日志之后，重放删除记录时不需要处理溢出页面
+  for (const VarlenRowFormat::OverflowRef &ref : refs) {
+    if (ref.length >= 0) {
+      free_overflow(ref);
+    }
   }
+  return RC::SUCCESS;
 }
 
-RC RowRecordPageHandler::update_record(const RID &rid, const char *data)
+RC VarlenRecordPageHandler::update_record(const RID &rid, const char *data)
 {
-  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot delete record from page while the page is readonly");
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record in page while the page is readonly");
 
-  if (rid.slot_num >= page_header_->record_capacity) {
-    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
-              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
-    return RC::INVALID_ARGUMENT;
+  RC rc = check_slot(rid);
+  if (OB_FAIL(rc)) {
+    return rc;
   }
 
-  Bitmap bitmap(bitmap_, page_header_->record_capacity);
-  if (bitmap.get_bit(rid.slot_num)) {
-    frame_->mark_dirty();
+  // 页面中的空间不够时，尝试把更多的字段放到溢出页面
+  VarlenRowFormat::RowPlan plan;
+  const int                available = free_space() + slots()[rid.slot_num].length;
+  format_.plan(data, plan);
+  if (plan.row_size > available) {
+    format_.plan(data, available, plan);
+  }
+  if (plan.row_size > available) {
+    LOG_WARN("Page has no enough space for update, rid=%s, row size %d, free space %d.", 
+             rid.to_string().c_str(), plan.row_size, free_space());
+    return RC::RECORD_NOMEM;
+  }
 
-    char *record_data = get_record_data(rid.slot_num);
-    if (record_data == data) {
-      // nothing to do
-    } else {
-      memcpy(record_data, data, page_header_->record_real_size);
+  // 内容没有变化的溢出字段继续使用原来的溢出页面，比如事务只修改了事务字段
+  vector<VarlenRowFormat::OverflowRef> old_refs;
+  vector<VarlenRowFormat::OverflowRef> refs(format_.column_num(), VarlenRowFormat::OverflowRef{-1, BP_INVALID_PAGE_NUM});
+  format_.overflow_refs(row_data(rid.slot_num), old_refs);
+
+  vector<bool> reused(format_.column_num(), false);
+  vector<char> old_value;
+  for (int i = 0; i < format_.column_num(); i++) {
+    if (!plan.overflow[i]) {
+      continue;
     }
 
-    RC rc = log_handler_.update_record(frame_, rid, data);
+    const char *value = data + format_.field_offset(i);
+    if (old_refs[i].length == plan.lengths[i]) {
+      old_value.resize(old_refs[i].length);
+      rc = read_overflow(old_refs[i], old_value.data());
+      if (OB_SUCC(rc) && 0 == memcmp(old_value.data(), value, old_value.size())) {
+        refs[i]     = old_refs[i];
+        reused[i]   = true;
+        old_refs[i] = VarlenRowFormat::OverflowRef{-1, BP_INVALID_PAGE_NUM};
+        continue;
+      }
+    }
+
+    rc = write_overflow(value, plan.lengths[i], refs[i]);
     if (OB_FAIL(rc)) {
-      LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
-                disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
-      // return rc; // ignore errors
+      // 只释放这次新写入的溢出页面
+      for (int j = 0; j < i; j++) {
+        if (plan.overflow[j] && !reused[j]) {
+          free_overflow(refs[j]);
+        }
+      }
+      return rc;
     }
+  }
 
-    return RC::SUCCESS;
-  } else {
-    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
-    return RC::RECORD_NOT_EXIST;
+  vector<char> row(plan.row_size);
+  format_.encode(data, plan, refs, row.data());
+
+  rc = replace_row(rid.slot_num, row.data(), plan.row_size);
+  ASSERT(OB_SUCC(rc), "space has been checked before update. rc=%s", strrc(rc));
+  frame_->mark_dirty();
+
+  rc = log_handler_.update_record(frame_, rid, span<const char>(row));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
   }
+
+  for (const VarlenRowFormat::OverflowRef &ref : old_refs) {
+    if (ref.length >= 0) {
+      free_overflow(ref);
+    }
+  }
+  return RC::SUCCESS;
 }
 
-RC RowRecordPageHandler::get_record(const RID &rid, Record &record)
+RC VarlenRecordPageHandler::get_record(const RID &rid, Record &record)
 {
-  if (rid.slot_num >= page_header_->record_capacity) {
-    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
-              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
-    return RC::RECORD_INVALID_RID;
+  RC rc = check_slot(rid);
+  if (OB_FAIL(rc)) {
+    return rc;
   }
 
-  Bitmap bitmap(bitmap_, page_header_->record_capacity);
-  if (!bitmap.get_bit(rid.slot_num)) {
-    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
-    return RC::RECORD_NOT_EXIST;
+  rc = record.new_record(page_header_->record_real_size);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const char *row = row_data(rid.slot_num);
+  format_.decode(row, record.data());
+  rc = load_overflow_fields(row, record.data());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to load overflow fields. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
   }
 
   record.set_rid(rid);
-  record.set_data(get_record_data(rid.slot_num), page_header_->record_real_size);
   return RC::SUCCESS;
 }
 
-PageNum RecordPageHandler::get_page_num() const
+RC VarlenRecordPageHandler::get_chunk(Chunk &chunk)
 {
-  if (nullptr == page_header_) {
-    return (PageNum)(-1);
+  if (!layout_loaded_) {
+    return RC::SUCCESS;
   }
-  return frame_->page_num();
-}
 
-bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+  vector<char> record(page_header_->record_real_size);
+  Bitmap       bitmap(bitmap_, page_header_->record_capacity);
+  for (int slot_num = bitmap.next_setted_bit(0); slot_num >= 0; slot_num = bitmap.next_setted_bit(slot_num + 1)) {
+    const char *row = row_data(slot_num);
+    format_.decode(row, record.data());
+    RC rc = load_overflow_fields(row, record.data());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to load overflow fields. page_num=%d, slot_num=%d, rc=%s", 
+               get_page_num(), slot_num, strrc(rc));
+      return rc;
+    }
 
-RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
-{
-  // your code here
-  exit(-1);
+    for (int i = 0; i < chunk.column_num(); i++) {
+      const int col_id = chunk.column_ids(i);
+      rc               = chunk.column(i).append_one(record.data() + format_.field_offset(col_id));
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append data to chunk. page_num=%d, slot_num=%d, col_id=%d, rc=%s", 
+                 get_page_num(), slot_num, col_id, strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
 }
 
-RC PaxRecordPageHandler::delete_record(const RID *rid)
+RC VarlenRecordPageHandler::redo_insert_record(const char *log_data, const RID &rid)
 {
-  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
-         "cannot delete record from page while the page is readonly");
+  if (!layout_loaded_ || rid.slot_num < 0 || rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
 
   Bitmap bitmap(bitmap_, page_header_->record_capacity);
-  if (bitmap.get_bit(rid->slot_num)) {
-    bitmap.clear_bit(rid->slot_num);
-    page_header_->record_num--;
-    frame_->mark_dirty();
-
-    RC rc = log_handler_.delete_record(frame_, *rid);
-    if (OB_FAIL(rc)) {
-      LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
-      // return rc; // ignore errors
-    }
+  if (bitmap.get_bit(rid.slot_num)) {
+    return redo_update_record(rid, log_data);
+  }
 
-    return RC::SUCCESS;
-  } else {
-    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
-    return RC::RECORD_NOT_EXIST;
+  const int row_size = format_.row_size(log_data);
+  const int new_slot = rid.slot_num >= varlen_header()->slot_count
+                           ? (rid.slot_num + 1 - varlen_header()->slot_count) * sizeof(VarlenRowFormat::Slot)
+                           : 0;
+  if (free_space() < row_size + new_slot) {
+    LOG_WARN("Page has no enough space, rid=%s, row size %d, free space %d.", 
+             rid.to_string().c_str(), row_size, free_space());
+    return RC::RECORD_NOMEM;
   }
-}
 
-RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
-{
-  // your code here
-  exit(-1);
+  bitmap.set_bit(rid.slot_num);
+  page_header_->record_num++;
+  place_row(rid.slot_num, log_data, row_size);
+  frame_->mark_dirty();
+  return RC::SUCCESS;
 }
 
-// TODO: specify the column_ids that chunk needed. currenly we get all columns
-RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
+RC VarlenRecordPageHandler::redo_update_record(const RID &rid, const char *log_data)
 {
-  // your code here
-  exit(-1);
-}
+  RC rc = check_slot(rid);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
 
-char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
-{
-  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
-  if (col_id == 0) {
-    return frame_->data() + page_header_->data_offset + (get_field_len(col_id) * slot_num);
-  } else {
-    return frame_->data() + page_header_->data_offset + col_idx[col_id - 1] + (get_field_len(col_id) * slot_num);
+  rc = replace_row(rid.slot_num, log_data, format_.row_size(log_data));
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to redo update record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
   }
+  frame_->mark_dirty();
+  return RC::SUCCESS;
 }
 
-int PaxRecordPageHandler::get_field_len(int col_id)
+RC VarlenRecordPageHandler::redo_delete_record(const RID &rid)
 {
-  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
-  if (col_id == 0) {
-    return col_idx[col_id] / page_header_->record_capacity;
-  } else {
-    return (col_idx[col_id] - col_idx[col_id - 1]) / page_header_->record_capacity;
+  RC rc = check_slot(rid);
+  if (OB_FAIL(rc)) {
+    return rc;
   }
+
+  remove_row(rid.slot_num);
+  frame_->mark_dirty();
+  return RC::SUCCESS;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -488,12 +1711,16 @@ RC RecordFileHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler,
     return RC::RECORD_OPENNED;
   }
 
+  RC rc = free_space_map_.open(buffer_pool);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open free space map. rc=%s", strrc(rc));
+    return rc;
+  }
+
   disk_buffer_pool_ = &buffer_pool;
   log_handler_      = &log_handler;
   table_meta_       = table_meta;
 
-  RC rc = init_free_pages();
-
   LOG_INFO("open record file handle done. rc=%s", strrc(rc));
   return RC::SUCCESS;
 }
@@ -501,45 +1728,73 @@ RC RecordFileHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler,
 void RecordFileHandler::close()
 {
   if (disk_buffer_pool_ != nullptr) {
-    free_pages_.clear();
+    free_space_map_.close();
     disk_buffer_pool_ = nullptr;
     log_handler_      = nullptr;
     table_meta_       = nullptr;
   }
 }
 
-RC RecordFileHandler::init_free_pages()
+RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
 {
-  // 遍历当前文件上所有页面，找到没有满的页面
-  // 这个效率很低，会降低启动速度
-  // NOTE: 由于是初始化时的动作，所以不需要加锁控制并发
-
-  RC rc = RC::SUCCESS;
-
-  BufferPoolIterator bp_iterator;
-  bp_iterator.init(*disk_buffer_pool_, 1);
-  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
-  PageNum                       current_page_num = 0;
+  // 变长记录需要找到剩余空间足够大的页面
+  uint8_t min_fill_class = FreeSpaceMap::FULL + 1;
+  if (storage_format_ == StorageFormat::VARLEN_FORMAT) {
+    vector<int> column_descs;
+    VarlenRowFormat::make_column_descs(table_meta_, record_size, column_descs);
+
+    VarlenRowFormat format;
+    format.init(column_descs.data(), static_cast<int>(column_descs.size()), disk_buffer_pool_->page_data_size());
+    min_fill_class = FreeSpaceMap::required_fill_class(
+        VarlenRecordPageHandler::insert_space(format, data), format.heap_capacity());
+  }
 
-  while (bp_iterator.has_next()) {
-    current_page_num = bp_iterator.next();
+  return insert_into_free_page(min_fill_class, record_size, [data, rid](RecordPageHandler &record_page_handler) {
+    return record_page_handler.insert_record(data, rid);
+  });
+}
 
-    rc = record_page_handler->init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_ONLY);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, rc, strrc(rc));
-      return rc;
+RC RecordFileHandler::insert_records(span<const char *const> records, int record_size, RID *rids)
+{
+  RC     rc           = RC::SUCCESS;
+  size_t inserted_num = 0;
+  if (storage_format_ == StorageFormat::VARLEN_FORMAT) {
+    for (; inserted_num < records.size(); inserted_num++) {
+      rc = insert_record(records[inserted_num], record_size, &rids[inserted_num]);
+      if (OB_FAIL(rc)) {
+        break;
+      }
+    }
+  } else {
+    while (inserted_num < records.size()) {
+      span<const char *const> remaining = records.subspan(inserted_num);
+      RID                    *page_rids = rids + inserted_num;
+      int                     page_inserted_num = 0;
+      rc = insert_into_free_page(FreeSpaceMap::FULL + 1, record_size, [&](RecordPageHandler &record_page_handler) {
+        return record_page_handler.insert_records(remaining, page_rids, page_inserted_num);
+      });
+      if (OB_FAIL(rc)) {
+        break;
+      }
+      inserted_num += page_inserted_num;
     }
+  }
 
-    if (!record_page_handler->is_full()) {
-      free_pages_.insert(current_page_num);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to insert records. inserted=%d, total=%d, rc=%s",
+             static_cast<int>(inserted_num), static_cast<int>(records.size()), strrc(rc));
+    for (size_t i = 0; i < inserted_num; i++) {
+      RC rc2 = delete_record(&rids[i]);
+      if (OB_FAIL(rc2)) {
+        LOG_ERROR("failed to rollback inserted record. rid=%s, rc=%s", rids[i].to_string().c_str(), strrc(rc2));
+      }
     }
-    record_page_handler->cleanup();
   }
-  LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_pages_.size(), strrc(rc));
   return rc;
 }
 
-RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
+RC RecordFileHandler::insert_into_free_page(
+    uint8_t min_fill_class, int record_size, const function<RC(RecordPageHandler &)> &inserter)
 {
   RC ret = RC::SUCCESS;
 
@@ -547,31 +1802,37 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
   bool                          page_found       = false;
   PageNum                       current_page_num = 0;
 
-  // 当前要访问free_pages对象，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
-  lock_.lock();
-
-  // 找到没有填满的页面
-  while (!free_pages_.empty()) {
-    current_page_num = *free_pages_.begin();
-
+  // 找到没有填满的页面。空闲空间表只是一个提示，需要加上页面写锁之后再检查一次
+  while (OB_SUCC(ret = free_space_map_.find_free_page(current_page_num, min_fill_class))) {
     ret = record_page_handler->init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_WRITE);
     if (OB_FAIL(ret)) {
-      lock_.unlock();
       LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, ret, strrc(ret));
       return ret;
     }
 
     if (!record_page_handler->is_full()) {
-      page_found = true;
-      break;
+      ret = inserter(*record_page_handler);
+      if (ret != RC::RECORD_NOMEM) {
+        page_found = true;
+        break;
+      }
     }
+
+    // 页面已经满了，或者放不下这条变长记录，更新之后空闲程度会低于 min_fill_class，不会再找到这个页面
+    ret = free_space_map_.update(current_page_num, record_page_handler->fill_class());
     record_page_handler->cleanup();
-    free_pages_.erase(free_pages_.begin());
+    if (OB_FAIL(ret)) {
+      return ret;
+    }
   }
-  lock_.unlock();  // 如果找到了一个有效的页面，那么此时已经拿到了页面的写锁
 
-  // 找不到就分配一个新的页面
   if (!page_found) {
+    if (ret != RC::RECORD_EOF) {
+      LOG_WARN("failed to find free page. rc=%s", strrc(ret));
+      return ret;
+    }
+
+    // 找不到就分配一个新的页面
     Frame *frame = nullptr;
     if ((ret = disk_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
       LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
@@ -592,17 +1853,18 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
     // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
     frame->unpin();
 
-    // 这里的加锁顺序看起来与上面是相反的，但是不会出现死锁
-    // 上面的逻辑是先加lock锁，然后加页面写锁，这里是先加上
-    // 了页面写锁，然后加lock的锁，但是不会引起死锁。
-    // 为什么？
-    lock_.lock();
-    free_pages_.insert(current_page_num);
-    lock_.unlock();
+    free_space_map_.claim(current_page_num);
+
+    // 找到空闲位置
+    ret = inserter(*record_page_handler);
   }
 
-  // 找到空闲位置
-  return record_page_handler->insert_record(data, rid);
+  if (OB_FAIL(ret)) {
+    return ret;
+  }
+
+  // 这时还持有数据页面的写锁。加锁顺序总是先数据页面再空闲空间表页面，查找空闲页面时不会同时持有两者
+  return free_space_map_.update(current_page_num, record_page_handler->fill_class());
 }
 
 RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
@@ -633,18 +1895,12 @@ RC RecordFileHandler::delete_record(const RID *rid)
   }
 
   rc = record_page_handler->delete_record(rid);
-  // 📢 这里注意要清理掉资源，否则会与insert_record中的加锁顺序冲突而可能出现死锁
-  // delete record的加锁逻辑是拿到页面锁，删除指定记录，然后加上和释放record manager锁
-  // insert record是加上 record manager锁，然后拿到指定页面锁再释放record manager锁
-  record_page_handler->cleanup();
   if (OB_SUCC(rc)) {
-    // 因为这里已经释放了页面锁，并发时，其它线程可能又把该页面填满了，那就不应该再放入 free_pages_
-    // 中。但是这里可以不关心，因为在查找空闲页面时，会自动过滤掉已经满的页面
-    lock_.lock();
-    free_pages_.insert(rid->page_num);
-    LOG_TRACE("add free page %d to free page list", rid->page_num);
-    lock_.unlock();
+    // 与 insert_record 一样，持有数据页面的写锁时更新空闲空间表
+    rc = free_space_map_.update(rid->page_num, record_page_handler->fill_class());
+    LOG_TRACE("update free space of page %d", rid->page_num);
   }
+  record_page_handler->cleanup();
   return rc;
 }
 
@@ -721,10 +1977,10 @@ RC RecordFileScanner::open_scan(Table *table, DiskBufferPool &buffer_pool, Trx *
     return rc;
   }
   condition_filter_ = condition_filter;
-  if (table == nullptr || table->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
+  if (table == nullptr) {
     record_page_handler_ = new RowRecordPageHandler();
   } else {
-    record_page_handler_ = new PaxRecordPageHandler();
+    record_page_handler_ = RecordPageHandler::create(table->table_meta().storage_format());
   }
 
   return rc;
@@ -753,8 +2009,10 @@ RC RecordFileScanner::fetch_next_record()
   // 上个页面遍历完了，或者还没有开始遍历某个页面，那么就从一个新的页面开始遍历查找
   while (bp_iterator_.has_next()) {
     PageNum page_num = bp_iterator_.next();
+    bp_iterator_.prefetch();
     record_page_handler_->cleanup();
-    rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_);
+    rc = record_page_handler_->init(
+        *disk_buffer_pool_, *log_handler_, page_num, rw_mode_, BufferAccessHint::SEQUENTIAL);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
@@ -870,6 +2128,13 @@ RC ChunkFileScanner::close_scan()
   return RC::SUCCESS;
 }
 
+void ChunkFileScanner::release_page()
+{
+  if (record_page_handler_ != nullptr) {
+    record_page_handler_->cleanup();
+  }
+}
+
 RC ChunkFileScanner::open_scan_chunk(
     Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode)
 {
@@ -879,44 +2144,107 @@ RC ChunkFileScanner::open_scan_chunk(
   disk_buffer_pool_ = &buffer_pool;
   log_handler_      = &log_handler;
   rw_mode_          = mode;
+  zone_map_filter_  = ZoneMapFilter();
+  skipped_pages_    = 0;
+
+  morsel_dispatcher_ = nullptr;
+  morsel_pages_.clear();
+  morsel_pos_ = 0;
 
   RC rc = bp_iterator_.init(buffer_pool, 1);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
-  if (table == nullptr || table->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
+  if (table == nullptr) {
     record_page_handler_ = new RowRecordPageHandler();
   } else {
-    record_page_handler_ = new PaxRecordPageHandler();
+    record_page_handler_ = RecordPageHandler::create(table->table_meta().storage_format());
   }
 
   return rc;
 }
 
-RC ChunkFileScanner::next_chunk(Chunk &chunk)
+RC ChunkFileScanner::next_page_num(PageNum &page_num)
 {
-  RC rc = RC::SUCCESS;
+  if (morsel_dispatcher_ == nullptr) {
+    if (!bp_iterator_.has_next()) {
+      return RC::RECORD_EOF;
+    }
+    page_num = bp_iterator_.next();
+    bp_iterator_.prefetch();
+    return RC::SUCCESS;
+  }
 
-  while (bp_iterator_.has_next()) {
-    PageNum page_num = bp_iterator_.next();
+  if (morsel_pos_ >= morsel_pages_.size()) {
+    RC rc = morsel_dispatcher_->next_morsel(morsel_pages_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    morsel_pos_ = 0;
+  }
+  page_num = morsel_pages_[morsel_pos_++];
+  return RC::SUCCESS;
+}
+
+RC ChunkFileScanner::next_page()
+{
+  RC      rc       = RC::SUCCESS;
+  PageNum page_num = BP_INVALID_PAGE_NUM;
+  while (OB_SUCC(rc = next_page_num(page_num))) {
     record_page_handler_->cleanup();
-    rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_);
+    rc = record_page_handler_->init(
+        *disk_buffer_pool_, *log_handler_, page_num, rw_mode_, BufferAccessHint::SEQUENTIAL);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
-    rc = record_page_handler_->get_chunk(chunk);
-    if (rc == RC::SUCCESS) {
-      return rc;
-    } else if (rc == RC::RECORD_EOF) {
-      break;
-    } else {
-      LOG_WARN("failed to get chunk from page. page_num=%d, rc=%s", page_num, strrc(rc));
-      return rc;
+    if (!record_page_handler_->may_match(zone_map_filter_)) {
+      skipped_pages_++;
+      continue;
     }
+    return RC::SUCCESS;
   }
 
   record_page_handler_->cleanup();
-  return RC::RECORD_EOF;
+  return rc;
+}
+
+RC ChunkFileScanner::next_chunk(Chunk &chunk)
+{
+  RC rc = next_page();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = record_page_handler_->get_chunk(chunk);
+  if (rc == RC::RECORD_EOF) {
+    record_page_handler_->cleanup();
+  } else if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get chunk from page. page_num=%d, rc=%s", record_page_handler_->get_page_num(), strrc(rc));
+  }
+  return rc;
+}
+
+RC ChunkFileScanner::next_chunk(Chunk &chunk, vector<uint8_t> &select)
+{
+  RC rc = next_page();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = record_page_handler_->reference_chunk(chunk, select);
+  if (rc == RC::UNIMPLEMENTED) {
+    rc = record_page_handler_->get_chunk(chunk);
+    if (OB_SUCC(rc)) {
+      select.assign(chunk.rows(), 1);
+    }
+  }
+
+  if (rc == RC::RECORD_EOF) {
+    record_page_handler_->cleanup();
+  } else if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get chunk from page. page_num=%d, rc=%s", record_page_handler_->get_page_num(), strrc(rc));
+  }
+  return rc;
 }
@@ -18,8 +18,13 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/sstream.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/common/chunk.h"
+#include "storage/record/column_encoding.h"
+#include "storage/record/free_space_map.h"
+#include "storage/record/morsel_dispatcher.h"
 #include "storage/record/record.h"
 #include "storage/record/record_log.h"
+#include "storage/record/varlen_row_format.h"
+#include "storage/record/zone_map.h"
 #include "common/types.h"
 
 class LogHandler;
@@ -54,6 +59,8 @@ class Table;
  * - RecordFileScanner：可以用来遍历整个文件上的所有记录
  * - RecordPageIterator：可以用来遍历指定页面上的所有记录
  * - PageHeader：每个页面上都会记录的页面头信息
+ *
+ * 不定长的记录可以使用变长行存格式(VarlenRecordPageHandler)，超出一页的数据存放在溢出页面中。
  */
 
 /**
@@ -135,8 +142,10 @@ public:
    * @param buffer_pool 关联某个文件时，都通过buffer pool来做读写文件
    * @param page_num    当前处理哪个页面
    * @param mode        是否只读。在访问页面时，需要对页面加锁
+   * @param hint        访问页面的提示，全表扫描时使用 BufferAccessHint::SEQUENTIAL
    */
-  RC init(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, ReadWriteMode mode);
+  RC init(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, ReadWriteMode mode,
+      BufferAccessHint hint = BufferAccessHint::NORMAL);
 
   /**
    * @brief 数据库恢复时，与普通的运行场景有所不同，不做任何并发操作，也不需要加锁
@@ -154,7 +163,7 @@ public:
    * @param record_size 每个记录的大小
    * @param table_meta  表的元数据
    */
-  RC init_empty_page(
+  virtual RC init_empty_page(
       DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size, TableMeta *table_meta);
 
   /**
@@ -165,8 +174,8 @@ public:
    * @param col_num  表中包含的列数
    * @param col_idx_data 列索引数据
    */
-  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
-      int col_num, const char *col_idx_data);
+  virtual RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+      int record_size, int col_num, const char *col_idx_data);
 
   /**
    * @brief 操作结束后做的清理工作，比如释放页面、解锁
@@ -181,6 +190,16 @@ public:
    */
   virtual RC insert_record(const char *data, RID *rid) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 在当前页面中插入多条记录，直到页面放满或者全部插入
+   * @details 默认逐条调用 insert_record，定长格式的页面会把所有记录放在一条日志中
+   * @param records 要插入的记录
+   * @param rids 返回插入成功的记录的位置，至少有 records.size() 个
+   * @param inserted_num 返回插入成功的记录个数
+   * @return 一条记录也没有插入时返回 RC::RECORD_NOMEM
+   */
+  virtual RC insert_records(span<const char *const> records, RID *rids, int &inserted_num);
+
   /**
    * @brief 数据库恢复时，在指定位置插入数据
    *
@@ -218,17 +237,67 @@ public:
    */
   virtual RC get_chunk(Chunk &chunk) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 获取整个页面中指定列的所有记录，chunk 中的列直接引用页面中的数据，不做复制
+   * @details 引用的数据在页面释放(cleanup)之前有效。页面中被删除的位置也会出现在 chunk 中，
+   * 通过 select 区分，select[i] 为1表示第 i 行是有效的记录。
+   * @param select 返回每一行是否是有效的记录，大小与 chunk 的行数相同
+   */
+  virtual RC reference_chunk(Chunk &chunk, vector<uint8_t> &select) { return RC::UNIMPLEMENTED; }
+
+  /**
+   * @brief 日志重放时，重做插入记录的操作
+   * @details 参数是 RecordLogHandler 记录在日志中的数据，定长格式就是记录本身，变长格式是编码之后的行数据。
+   * 重放时不会再记录日志，也不会分配或者释放溢出页面，溢出页面由自己的日志恢复。
+   */
+  virtual RC redo_insert_record(const char *log_data, const RID &rid)
+  {
+    RID insert_rid = rid;
+    return insert_record(log_data, &insert_rid);
+  }
+
+  /**
+   * @brief 日志重放时，重做更新记录的操作
+   */
+  virtual RC redo_update_record(const RID &rid, const char *log_data) { return update_record(rid, log_data); }
+
+  /**
+   * @brief 日志重放时，重做删除记录的操作
+   */
+  virtual RC redo_delete_record(const RID &rid) { return delete_record(&rid); }
+
   /**
    * @brief 返回该记录页的页号
    */
   PageNum get_page_num() const;
 
+  /**
+   * @brief 每条记录的实际大小
+   */
+  int record_real_size() const { return page_header_->record_real_size; }
+
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
    */
-  bool is_full() const;
+  virtual bool is_full() const;
+
+  /**
+   * @brief 当前页面的空闲程度，参考 FreeSpaceMap::fill_class
+   */
+  virtual uint8_t fill_class() const;
+
+  /**
+   * @brief 根据页面中记录的统计信息判断页面中是否可能有满足条件的记录
+   * @details 返回 false 时扫描可以跳过这个页面。默认没有统计信息，总是返回 true
+   */
+  virtual bool may_match(const ZoneMapFilter &filter) const { return true; }
 
 protected:
+  /**
+   * @brief 页面加载之后(init/recover_init)调用，子类可以在这里解析自己的页面布局
+   */
+  virtual void load_page_layout() {}
+
   /**
    * @details
    * 前面在计算record_capacity时并没有考虑对齐，但第一个record需要8字节对齐
@@ -238,7 +307,7 @@ protected:
   void fix_record_capacity()
   {
     int32_t last_record_offset = page_header_->data_offset + page_header_->record_capacity * page_header_->record_size;
-    while (last_record_offset > BP_PAGE_DATA_SIZE) {
+    while (last_record_offset > frame_->data_size()) {
       page_header_->record_capacity -= 1;
       last_record_offset -= page_header_->record_size;
     }
@@ -254,6 +323,12 @@ protected:
     return frame_->data() + page_header_->data_offset + (page_header_->record_size * slot_num);
   }
 
+  /**
+   * @brief 按照槽位顺序分配最多 count 个空闲的槽位，更新位图和记录个数
+   * @return 分配到的槽位个数，页面已满时是0
+   */
+  int allocate_slots(int count, vector<SlotNum> &slots);
+
 protected:
   DiskBufferPool  *disk_buffer_pool_ = nullptr;  ///< 当前操作的buffer pool(文件)
   RecordLogHandler log_handler_;                 ///< 当前操作的日志处理器
@@ -284,6 +359,8 @@ public:
 
   virtual RC insert_record(const char *data, RID *rid) override;
 
+  virtual RC insert_records(span<const char *const> records, RID *rids, int &inserted_num) override;
+
   virtual RC recover_insert_record(const char *data, const RID &rid) override;
 
   virtual RC delete_record(const RID *rid) override;
@@ -304,10 +381,14 @@ public:
  * @ingroup RecordManager
  * @details PAX 格式实现，当前定长记录模式下每个页面的组织大概是这样的：
  * @code
- * | PageHeader | record allocate bitmap | column index  |
- * |------------|------------------------| ------------- |
+ * | PageHeader | record allocate bitmap | column index | column zone maps | column encodings |
+ * |------------|------------------------| ------------ | ---------------- | ---------------- |
  * | column1 | column2 | ..................... | columnN |
  * @endcode
+ * 每一列有一个 zone map(ColumnZoneMap)，记录页面中这一列的最小值和最大值，
+ * 扫描时可以根据下推的条件跳过整个页面，参考 may_match。
+ * 开启了页面压缩的文件，页面写满时，每一列选择一种编码方式(ColumnEncoder)压缩存放在这一列原来的位置上，称为封存(seal)。
+ * 读取时按需解码，修改已经封存的页面之前先把所有列解码回原始格式。
  * 更多细节可参考：docs/design/miniob-pax-storage.md
  */
 class PaxRecordPageHandler : public RecordPageHandler
@@ -315,6 +396,19 @@ class PaxRecordPageHandler : public RecordPageHandler
 public:
   PaxRecordPageHandler() : RecordPageHandler(StorageFormat::PAX_FORMAT) {}
 
+  /**
+   * @brief 初始化一个空的 PAX 页面，根据表的元数据生成列索引和 zone map
+   */
+  virtual RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+      int record_size, TableMeta *table_meta) override;
+
+  /**
+   * @brief 重放日志时初始化一个空的 PAX 页面
+   * @param col_idx_data 列索引，后面跟着每列的类型，都是 column_num 个 int
+   */
+  virtual RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+      int record_size, int column_num, const char *col_idx_data) override;
+
   /**
    * @brief 插入一条记录
    *
@@ -324,8 +418,14 @@ public:
    */
   virtual RC insert_record(const char *data, RID *rid) override;
 
+  virtual RC insert_records(span<const char *const> records, RID *rids, int &inserted_num) override;
+
+  virtual RC recover_insert_record(const char *data, const RID &rid) override;
+
   virtual RC delete_record(const RID *rid) override;
 
+  virtual RC update_record(const RID &rid, const char *data) override;
+
   /**
    * @brief 获取指定位置的记录数据
    *
@@ -342,13 +442,217 @@ public:
    */
   virtual RC get_chunk(Chunk &chunk) override;
 
+  /**
+   * @brief 每一列在页面中都是连续存放的，chunk 中的列直接引用页面中的列数据
+   * @details chunk 的行数是最后一条有效记录的位置加1。编码过的列引用的是解码到 handler 中的数据
+   */
+  virtual RC reference_chunk(Chunk &chunk, vector<uint8_t> &select) override;
+
+  /**
+   * @brief 使用每一列的 zone map 判断页面中是否可能有满足条件的记录
+   */
+  virtual bool may_match(const ZoneMapFilter &filter) const override;
+
+  /**
+   * @brief 获取指定列的 zone map
+   */
+  const ColumnZoneMap &zone_map(int col_id) const { return zone_maps()[col_id]; }
+
+  /**
+   * @brief 获取指定列的编码方式
+   */
+  const ColumnEncodingHeader &column_encoding(int col_id) const { return column_encodings()[col_id]; }
+
 private:
+  RC init_pax_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+      int column_num, const int *column_lens, const int *column_types, bool write_log);
+
+  ColumnZoneMap        *zone_maps() const;
+  ColumnEncodingHeader *column_encodings() const;
+
+  /**
+   * @brief 页面写满之后，对每一列编码。编码之后不比原始数据小的列保持原样
+   * @details 只有开启了页面压缩的文件才会封存。
+   * 编码的结果只由页面中的数据和文件的压缩方式决定，不记录日志。重放日志时修改页面之前会先解码，所以页面是否封存不影响恢复
+   */
+  void seal();
+
+  /**
+   * @brief 把已经编码的列解码回原始格式，修改页面中的数据之前调用
+   */
+  void unseal();
+
+  /**
+   * @brief 获取一列所有记录的原始格式的数据
+   * @details 没有编码的列直接返回页面中的数据，否则解码到 decoded_columns_ 中，在下一次解码这一列之前有效
+   */
+  const char *column_data(int col_id);
+
+  /**
+   * @brief 读取一个字段的原始格式的数据，复制到 value 中
+   */
+  void read_field(SlotNum slot_num, int col_id, char *value) const;
+
+  /**
+   * @brief 把一条记录的每个字段写入到各列中，并扩大 zone map 的范围
+   */
+  void write_fields(SlotNum slot_num, const char *data);
+
+  /**
+   * @brief 根据页面中现有的记录重新计算一列的范围，删除了边界上的值之后调用
+   */
+  void rebuild_zone_map(int col_id);
+
   // get the field data by `slot_num` and `column id`
-  char *get_field_data(SlotNum slot_num, int col_id);
+  char *get_field_data(SlotNum slot_num, int col_id) const;
 
   // get the field length by `column id`, all columns are fixed length.
-  int get_field_len(int col_id);
+  int get_field_len(int col_id) const;
+
+private:
+  vector<vector<char>> decoded_columns_;  ///< 解码之后的列数据，参考 column_data
 };
+
+/**
+ * @brief 溢出页面的页头
+ * @ingroup RecordManager
+ * @details 溢出页面与数据页面在同一个文件中。溢出页面 PageHeader 中的 record_capacity 是0，
+ * 遍历记录时会当作没有记录的页面跳过，查找空闲页面时会当作已经满了的页面。
+ */
+struct OverflowPageHeader
+{
+  PageHeader page_header;
+  PageNum    next_page;  ///< 下一个溢出页面，最后一个页面是 BP_INVALID_PAGE_NUM
+  int32_t    data_len;   ///< 当前页面中存放的数据长度
+};
+
+/**
+ * @brief 负责处理变长行存格式的页面中各种操作
+ * @ingroup RecordManager
+ * @details slotted page 格式，行目录从前向后增长，行数据从页面末尾向前分配：
+ * @code
+ * | PageHeader | record allocate bitmap | VarlenPageHeader | column descs |
+ * | slot0 | slot1 | ... | slotN |  ........  free space  ........  |
+ * | ............. | rowN | ... | row1 | row0 |
+ * @endcode
+ * 记录的槽位(slot num)在整个生命周期中保持不变，行数据在页面中的位置通过行目录查找，
+ * 删除或者更新之后留下的碎片在空间不够时整理。行的编码方式参考 VarlenRowFormat。
+ * 超长的字段存放在溢出页面中，溢出页面通过 next_page 串成链表，插入或更新时分配，删除或更新时释放。
+ * 与 RowRecordPageHandler 不同，get_record 返回的是解码之后的定长记录，数据复制到了 record 自己的内存中。
+ */
+class VarlenRecordPageHandler : public RecordPageHandler
+{
+public:
+  VarlenRecordPageHandler() : RecordPageHandler(StorageFormat::VARLEN_FORMAT) {}
+
+  /**
+   * @brief 一条记录插入到变长格式的页面中需要的空闲空间，用来在空闲空间表中查找页面
+   */
+  static int insert_space(const VarlenRowFormat &format, const char *data);
+
+  virtual RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+      int record_size, TableMeta *table_meta) override;
+
+  virtual RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+      int record_size, int col_num, const char *col_idx_data) override;
+
+  /**
+   * @brief 插入一条记录
+   * @return 页面中放不下这条记录时返回 RC::RECORD_NOMEM，这时页面没有任何修改
+   */
+  virtual RC insert_record(const char *data, RID *rid) override;
+
+  /**
+   * @brief 数据库恢复时，在指定位置插入数据。不会写日志，需要溢出页面的记录不支持
+   */
+  virtual RC recover_insert_record(const char *data, const RID &rid) override;
+
+  virtual RC delete_record(const RID *rid) override;
+
+  /**
+   * @brief 更新一条记录
+   * @details 溢出字段的内容没有变化时，继续使用原来的溢出页面。页面中的空间不够时，
+   * 会把更多的字段放到溢出页面，记录的位置不会改变
+   * @return 这样处理之后还是放不下时返回 RC::RECORD_NOMEM
+   */
+  virtual RC update_record(const RID &rid, const char *data) override;
+
+  /**
+   * @brief 获取指定位置的记录数据
+   *
+   * @param rid 指定的位置
+   * @param record 返回解码之后的定长记录，record 拥有这块内存
+   */
+  virtual RC get_record(const RID &rid, Record &record) override;
+
+  /**
+   * @brief 以 Chunk 格式获取整个页面中指定列的所有记录。变长字段可以使用变长的 Column
+   */
+  virtual RC get_chunk(Chunk &chunk) override;
+
+  virtual RC redo_insert_record(const char *log_data, const RID &rid) override;
+  virtual RC redo_update_record(const RID &rid, const char *log_data) override;
+  virtual RC redo_delete_record(const RID &rid) override;
+
+  /**
+   * @brief 行目录已满，或者剩余的空间放不下最小的一行时认为页面已经满了
+   */
+  virtual bool is_full() const override;
+
+  /**
+   * @brief 按照剩余的字节数计算空闲程度
+   */
+  virtual uint8_t fill_class() const override;
+
+protected:
+  virtual void load_page_layout() override;
+
+private:
+  RC init_varlen_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+      const int *column_descs, int column_num, bool write_log);
+
+  VarlenPageHeader      *varlen_header() const;
+  VarlenRowFormat::Slot *slots() const;
+  char                  *row_data(SlotNum slot_num) const;
+
+  /// 可以使用的空间，包括碎片
+  int free_space() const;
+  RC  check_slot(const RID &rid) const;
+
+  /**
+   * @brief 把行数据放到指定的槽位，调用者需要保证空间足够，槽位原来的数据需要先释放
+   */
+  void place_row(SlotNum slot_num, const char *row, int row_size);
+
+  /**
+   * @brief 替换一行数据，空间不够时返回 RC::RECORD_NOMEM
+   */
+  RC replace_row(SlotNum slot_num, const char *row, int row_size);
+
+  /**
+   * @brief 删除一行数据，不处理溢出页面
+   */
+  void remove_row(SlotNum slot_num);
+
+  /**
+   * @brief 整理页面，把所有的行数据紧凑地放到页面末尾
+   */
+  void compact();
+
+  RC write_overflow(const char *data, int len, VarlenRowFormat::OverflowRef &ref);
+  RC read_overflow(const VarlenRowFormat::OverflowRef &ref, char *data);
+  RC free_overflow(const VarlenRowFormat::OverflowRef &ref);
+
+  /**
+   * @brief 读取 row 中所有的溢出字段，放到定长记录中
+   */
+  RC load_overflow_fields(const char *row, char *record);
+
+private:
+  VarlenRowFormat format_;
+  bool            layout_loaded_ = false;  ///< 溢出页面或者未初始化的页面没有变长格式的布局
+};
+
 /**
  * @brief 管理整个文件中记录的增删改查
  * @ingroup RecordManager
@@ -362,7 +666,7 @@ public:
 
   /**
    * @brief 初始化
-   *
+   * @details 同时打开数据文件对应的空闲空间表，不需要遍历数据页面
    * @param buffer_pool 当前操作的是哪个文件
    */
   RC init(DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta);
@@ -388,6 +692,16 @@ public:
    */
   RC insert_record(const char *data, int record_size, RID *rid);
 
+  /**
+   * @brief 插入多条记录
+   * @details 定长格式时，一个页面中可以放下的记录在同一次页面加锁中插入，只记录一条日志。
+   * 变长格式的记录大小不同，逐条插入。插入失败时会删除这次已经插入的记录
+   * @param records     每条记录的内容
+   * @param record_size 记录大小
+   * @param rids        返回每条记录的标识符，至少有 records.size() 个
+   */
+  RC insert_records(span<const char *const> records, int record_size, RID *rids);
+
   /**
    * @brief 数据库恢复时，在指定文件指定位置插入数据
    *
@@ -401,19 +715,22 @@ public:
 
   RC visit_record(const RID &rid, function<bool(Record &)> updater);
 
+  FreeSpaceMap &free_space_map() { return free_space_map_; }
+
 private:
   /**
-   * @brief 初始化当前没有填满记录的页面，初始化free_pages_成员
+   * @brief 找到一个空闲程度不低于 min_fill_class 的页面，或者分配一个新的页面，调用 inserter 插入数据
+   * @details inserter 返回 RC::RECORD_NOMEM 时继续查找下一个页面。插入之后更新页面在空闲空间表中的状态
    */
-  RC init_free_pages();
+  RC insert_into_free_page(
+      uint8_t min_fill_class, int record_size, const function<RC(RecordPageHandler &)> &inserter);
 
 private:
-  DiskBufferPool        *disk_buffer_pool_ = nullptr;
-  LogHandler            *log_handler_      = nullptr;  ///< 记录日志的处理器
-  unordered_set<PageNum> free_pages_;                  ///< 没有填充满的页面集合
-  common::Mutex          lock_;  ///< 当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
-  StorageFormat          storage_format_;
-  TableMeta             *table_meta_;
+  DiskBufferPool *disk_buffer_pool_ = nullptr;
+  LogHandler     *log_handler_      = nullptr;  ///< 记录日志的处理器
+  FreeSpaceMap    free_space_map_;             ///< 记录每个页面的空闲程度
+  StorageFormat   storage_format_;
+  TableMeta      *table_meta_;
 };
 
 /**
@@ -504,6 +821,58 @@ public:
    */
   RC next_chunk(Chunk &chunk);
 
+  /**
+   * @brief 每次调用获取一个页面中的所有记录，尽量直接引用页面中的数据，不做复制
+   * @details 页面在下一次调用 next_chunk 或者 close_scan 之前一直被固定在 buffer pool 中，
+   * 并持有页面的锁，chunk 中引用的数据在这期间有效。chunk 中的列不能再追加数据。
+   * 页面格式不支持引用时，会复制数据到 chunk 中，这时 select 全部是1。
+   * @param select 返回每一行是否是有效的记录，select[i] 为0表示这一行在页面中已经被删除
+   */
+  RC next_chunk(Chunk &chunk, vector<uint8_t> &select);
+
+  /**
+   * @brief 提前释放当前页面的锁和固定
+   * @details 调用者已经把需要的数据从 chunk 中复制出去之后调用，不必等到下一次 next_chunk。
+   * 之后 next_chunk 返回的 chunk 中引用的数据不再有效
+   */
+  void release_page();
+
+  /**
+   * @brief 设置页面过滤条件，根据页面中每列的 zone map 跳过不可能有满足条件记录的页面
+   * @details 需要在 open_scan_chunk 之后调用。只是跳过页面，页面中的记录仍然需要调用者过滤
+   */
+  void set_zone_map_filter(ZoneMapFilter filter) { zone_map_filter_ = std::move(filter); }
+
+  /**
+   * @brief 从 dispatcher 中获取要扫描的页面，而不是按顺序扫描整个文件
+   * @details 需要在 open_scan_chunk 之后调用。多个扫描器共享一个 dispatcher 时，每个页面只会被其中一个扫描器读取，
+   * 用于多个线程并行扫描同一张表
+   */
+  void set_morsel_dispatcher(MorselDispatcher *dispatcher)
+  {
+    morsel_dispatcher_ = dispatcher;
+    morsel_pages_.clear();
+    morsel_pos_ = 0;
+  }
+
+  /**
+   * @brief 根据 zone map 跳过的页面个数
+   */
+  int skipped_pages() const { return skipped_pages_; }
+
+private:
+  /**
+   * @brief 移动到下一个可能有满足条件记录的页面
+   * @return 没有更多页面时返回 RC::RECORD_EOF
+   */
+  RC next_page();
+
+  /**
+   * @brief 获取下一个要扫描的页面编号
+   * @return 没有更多页面时返回 RC::RECORD_EOF
+   */
+  RC next_page_num(PageNum &page_num);
+
 private:
   Table *table_ = nullptr;  ///< 当前遍历的是哪张表。
 
@@ -513,4 +882,11 @@ private:
 
   BufferPoolIterator bp_iterator_;                    ///< 遍历buffer pool的所有页面
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
+
+  ZoneMapFilter zone_map_filter_;
+  int           skipped_pages_ = 0;
+
+  MorselDispatcher *morsel_dispatcher_ = nullptr;  ///< 不为空时从这里获取要扫描的页面
+  vector<PageNum>   morsel_pages_;                 ///< 当前 morsel 中的页面
+  size_t            morsel_pos_ = 0;               ///< 下一个要扫描的页面在 morsel_pages_ 中的位置
 };
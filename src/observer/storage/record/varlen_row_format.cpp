@@ -0,0 +1,198 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include "storage/record/varlen_row_format.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/string.h"
+#include "storage/record/record_manager.h"
+#include "storage/table/table_meta.h"
+
+void VarlenRowFormat::make_column_descs(const TableMeta *table_meta, int record_size, vector<int> &column_descs)
+{
+  column_descs.clear();
+  if (table_meta == nullptr) {
+    column_descs.push_back(-record_size);
+    return;
+  }
+
+  for (int i = 0; i < table_meta->field_num(); i++) {
+    const FieldMeta *field = table_meta->field(i);
+    column_descs.push_back(field->type() == AttrType::CHARS ? -field->len() : field->len());
+  }
+}
+
+int VarlenRowFormat::trimmed_length(const char *data, int len)
+{
+  while (len > 0 && data[len - 1] == 0) {
+    len--;
+  }
+  return len;
+}
+
+void VarlenRowFormat::init(const int *column_descs, int column_num, int page_data_size)
+{
+  column_descs_.assign(column_descs, column_descs + column_num);
+  field_offsets_.resize(column_num);
+  page_data_size_ = page_data_size;
+
+  record_size_  = 0;
+  min_row_size_ = 0;
+  for (int i = 0; i < column_num; i++) {
+    field_offsets_[i] = record_size_;
+    record_size_ += field_len(i);
+    min_row_size_ += is_varlen(i) ? LENGTH_SIZE : field_len(i);
+  }
+
+  // 页面布局：| PageHeader | bitmap | VarlenPageHeader | column descs | slot directory | free | rows |
+  // 按照每行最小的大小计算 bitmap 的大小，bitmap 只占很少的空间，行目录在插入时才增长
+  const int fixed_size = sizeof(PageHeader) + sizeof(VarlenPageHeader) + column_num * sizeof(int) + 8 /*align*/;
+  record_capacity_     = static_cast<int>((page_data_size - fixed_size) / (min_row_size_ + sizeof(Slot) + 0.125));
+
+  varlen_header_offset_ = (sizeof(PageHeader) + (record_capacity_ + 7) / 8 + 7) & ~7;
+  col_idx_offset_       = varlen_header_offset_ + sizeof(VarlenPageHeader);
+  slot_dir_offset_      = col_idx_offset_ + column_num * sizeof(int);
+
+  // 保证一个页面至少可以存放4行数据
+  max_row_size_ = max<int>((heap_capacity() - 4 * static_cast<int>(sizeof(Slot))) / 4, min_row_size_);
+}
+
+bool VarlenRowFormat::same_as(const int *column_descs, int column_num, int page_data_size) const
+{
+  return page_data_size_ == page_data_size && this->column_num() == column_num &&
+         std::equal(column_descs_.begin(), column_descs_.end(), column_descs);
+}
+
+void VarlenRowFormat::plan(const char *record, int max_row_size, RowPlan &plan) const
+{
+  const int column_num = this->column_num();
+  plan.lengths.resize(column_num);
+  plan.overflow.assign(column_num, false);
+  plan.row_size = 0;
+
+  for (int i = 0; i < column_num; i++) {
+    if (!is_varlen(i)) {
+      plan.lengths[i] = field_len(i);
+      plan.row_size += field_len(i);
+      continue;
+    }
+
+    const int len    = trimmed_length(record + field_offset(i), field_len(i));
+    plan.lengths[i]  = len;
+    plan.overflow[i] = len > MAX_INLINE_LEN;
+    plan.row_size += plan.overflow[i] ? OVERFLOW_SIZE : LENGTH_SIZE + len;
+  }
+
+  // 行太大时，把最长的字段放到溢出页面，直到足够小或者没有可以放到溢出页面的字段
+  while (plan.row_size > max_row_size) {
+    int longest = -1;
+    for (int i = 0; i < column_num; i++) {
+      if (is_varlen(i) && !plan.overflow[i] && (longest < 0 || plan.lengths[i] > plan.lengths[longest])) {
+        longest = i;
+      }
+    }
+    if (longest < 0 || LENGTH_SIZE + plan.lengths[longest] <= OVERFLOW_SIZE) {
+      break;
+    }
+
+    plan.overflow[longest] = true;
+    plan.row_size -= LENGTH_SIZE + plan.lengths[longest] - OVERFLOW_SIZE;
+  }
+}
+
+void VarlenRowFormat::encode(const char *record, const RowPlan &plan, const vector<OverflowRef> &refs, char *row) const
+{
+  char *pos = row;
+  for (int i = 0; i < column_num(); i++) {
+    const char *field = record + field_offset(i);
+    if (!is_varlen(i)) {
+      memcpy(pos, field, field_len(i));
+      pos += field_len(i);
+    } else if (plan.overflow[i]) {
+      const uint16_t flag = OVERFLOW_FLAG;
+      memcpy(pos, &flag, LENGTH_SIZE);
+      memcpy(pos + LENGTH_SIZE, &refs[i], sizeof(OverflowRef));
+      pos += OVERFLOW_SIZE;
+    } else {
+      const uint16_t len = static_cast<uint16_t>(plan.lengths[i]);
+      memcpy(pos, &len, LENGTH_SIZE);
+      memcpy(pos + LENGTH_SIZE, field, len);
+      pos += LENGTH_SIZE + len;
+    }
+  }
+}
+
+void VarlenRowFormat::decode(const char *row, char *record) const
+{
+  const char *pos = row;
+  for (int i = 0; i < column_num(); i++) {
+    char *field = record + field_offset(i);
+    if (!is_varlen(i)) {
+      memcpy(field, pos, field_len(i));
+      pos += field_len(i);
+      continue;
+    }
+
+    uint16_t len = 0;
+    memcpy(&len, pos, LENGTH_SIZE);
+    if (len & OVERFLOW_FLAG) {
+      memset(field, 0, field_len(i));
+      pos += OVERFLOW_SIZE;
+    } else {
+      memcpy(field, pos + LENGTH_SIZE, len);
+      memset(field + len, 0, field_len(i) - len);
+      pos += LENGTH_SIZE + len;
+    }
+  }
+}
+
+int VarlenRowFormat::overflow_refs(const char *row, vector<OverflowRef> &refs) const
+{
+  refs.assign(column_num(), OverflowRef{-1, BP_INVALID_PAGE_NUM});
+
+  int         count = 0;
+  const char *pos   = row;
+  for (int i = 0; i < column_num(); i++) {
+    if (!is_varlen(i)) {
+      pos += field_len(i);
+      continue;
+    }
+
+    uint16_t len = 0;
+    memcpy(&len, pos, LENGTH_SIZE);
+    if (len & OVERFLOW_FLAG) {
+      memcpy(&refs[i], pos + LENGTH_SIZE, sizeof(OverflowRef));
+      count++;
+      pos += OVERFLOW_SIZE;
+    } else {
+      pos += LENGTH_SIZE + len;
+    }
+  }
+  return count;
+}
+
+int VarlenRowFormat::row_size(const char *row) const
+{
+  const char *pos = row;
+  for (int i = 0; i < column_num(); i++) {
+    if (!is_varlen(i)) {
+      pos += field_len(i);
+      continue;
+    }
+
+    uint16_t len = 0;
+    memcpy(&len, pos, LENGTH_SIZE);
+    pos += (len & OVERFLOW_FLAG) ? OVERFLOW_SIZE : LENGTH_SIZE + len;
+  }
+  return static_cast<int>(pos - row);
+}
@@ -0,0 +1,174 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#pragma once
+
+#include "common/lang/vector.h"
+#include "storage/buffer/page.h"
+
+class TableMeta;
+
+/**
+ * @brief 变长行格式页面的页头，放在 PageHeader 和 bitmap 之后
+ * @ingroup RecordManager
+ */
+struct VarlenPageHeader
+{
+  int32_t slot_count;    ///< 行目录中已经使用的槽位个数，包括中间被删除的槽位
+  int32_t heap_offset;   ///< 行数据区的起始位置，行数据从页面末尾向前分配
+  int32_t garbage_size;  ///< 删除或更新留下的碎片大小，整理页面之后可以重新使用
+  int32_t reserved;
+};
+
+/**
+ * @brief 变长行格式，包括行在页面中的编码方式以及页面的布局
+ * @ingroup RecordManager
+ * @details 内存中的记录仍然是定长的，与 TableMeta 描述的一致，只是在页面中按照变长的格式存放：
+ * 定长字段原样存放；变长字段(CHARS)去掉末尾的0之后，以2字节的长度开头存放实际的数据。
+ * 长度的最高位是 OVERFLOW_FLAG 时，表示数据放在溢出页面中，后面跟着一个 OverflowRef。
+ * 一行在页面中的大小超过 max_row_size 时，会把最长的变长字段依次放到溢出页面中，
+ * 这样一个页面总是可以存放至少四行数据，超长的字段(超过一个页面)也可以保存。
+ *
+ * 每个字段用一个 int 描述(column desc)，正数表示定长字段的长度，负数表示变长字段的最大长度。
+ * 字段描述保存在每个页面中，页面的访问不依赖表的元数据，日志重放时也可以使用。
+ */
+class VarlenRowFormat
+{
+public:
+  /**
+   * @brief 行目录中的一项，记录一行数据在页面中的位置。页面不超过64K，所以使用2个字节
+   */
+  struct Slot
+  {
+    uint16_t offset;
+    uint16_t length;
+  };
+
+  /**
+   * @brief 存放在溢出页面中的字段，在行数据中保存的引用
+   */
+  struct OverflowRef
+  {
+    int32_t length;      ///< 字段的实际长度
+    PageNum first_page;  ///< 第一个溢出页面
+  };
+
+  /**
+   * @brief 一行数据的编码计划，每个字段一项
+   */
+  struct RowPlan
+  {
+    vector<int>  lengths;   ///< 每个字段在页面中存放的数据长度，变长字段是去掉末尾0之后的长度
+    vector<bool> overflow;  ///< 变长字段是否放到溢出页面
+    int          row_size = 0;
+  };
+
+  static constexpr uint16_t OVERFLOW_FLAG  = 0x8000;
+  static constexpr int      MAX_INLINE_LEN = OVERFLOW_FLAG - 1;
+  static constexpr int      LENGTH_SIZE    = static_cast<int>(sizeof(uint16_t));
+  static constexpr int      OVERFLOW_SIZE  = LENGTH_SIZE + static_cast<int>(sizeof(OverflowRef));
+
+public:
+  /**
+   * @brief 根据表的元数据生成字段描述，CHARS 字段是变长的
+   * @details 没有表的元数据时(比如单元测试)，把整条记录当作一个变长字段
+   */
+  static void make_column_descs(const TableMeta *table_meta, int record_size, vector<int> &column_descs);
+
+  /**
+   * @brief 去掉末尾的0之后的长度
+   */
+  static int trimmed_length(const char *data, int len);
+
+  /**
+   * @brief 初始化行格式以及页面布局
+   * @param page_data_size 页面中可以存放数据的大小
+   */
+  void init(const int *column_descs, int column_num, int page_data_size);
+
+  bool same_as(const int *column_descs, int column_num, int page_data_size) const;
+
+  int        column_num() const { return static_cast<int>(column_descs_.size()); }
+  const int *column_descs() const { return column_descs_.data(); }
+  bool       is_varlen(int col_id) const { return column_descs_[col_id] < 0; }
+  int        field_len(int col_id) const { return column_descs_[col_id] < 0 ? -column_descs_[col_id] : column_descs_[col_id]; }
+  int        field_offset(int col_id) const { return field_offsets_[col_id]; }
+
+  /// 内存中定长记录的大小
+  int record_size() const { return record_size_; }
+  /// 所有变长字段都为空时一行在页面中的大小
+  int min_row_size() const { return min_row_size_; }
+  /// 超过这个大小时，会把变长字段放到溢出页面
+  int max_row_size() const { return max_row_size_; }
+
+  /// 一个页面最多可以存放的行数，也就是 bitmap 的大小
+  int record_capacity() const { return record_capacity_; }
+  /// VarlenPageHeader 在页面中的偏移
+  int varlen_header_offset() const { return varlen_header_offset_; }
+  /// 字段描述在页面中的偏移
+  int col_idx_offset() const { return col_idx_offset_; }
+  /// 行目录在页面中的偏移
+  int slot_dir_offset() const { return slot_dir_offset_; }
+  /// 行目录和行数据可以使用的空间
+  int heap_capacity() const { return page_data_size_ - slot_dir_offset_; }
+  int page_data_size() const { return page_data_size_; }
+
+  /**
+   * @brief 计算一条定长记录在页面中如何存放
+   */
+  void plan(const char *record, RowPlan &plan) const { this->plan(record, max_row_size_, plan); }
+
+  /**
+   * @brief 计算一条定长记录在页面中如何存放，行的大小尽量不超过 max_row_size
+   * @details 更新记录时，页面中的空间不够，可以把更多的字段放到溢出页面，这样记录不需要移动
+   */
+  void plan(const char *record, int max_row_size, RowPlan &plan) const;
+
+  /**
+   * @brief 按照编码计划把记录编码到 row 中，row 至少有 plan.row_size 个字节
+   * @param refs 放到溢出页面中的字段引用，每个字段一项，只使用 plan.overflow 为 true 的项
+   */
+  void encode(const char *record, const RowPlan &plan, const vector<OverflowRef> &refs, char *row) const;
+
+  /**
+   * @brief 把行数据解码成定长记录
+   * @details 溢出字段的内容填0，通过 overflow_refs 获取引用之后由调用者读取
+   */
+  void decode(const char *row, char *record) const;
+
+  /**
+   * @brief 获取行数据中的溢出字段
+   * @param refs 每个字段一项，不是溢出字段的项 length 为 -1
+   * @return 溢出字段的个数
+   */
+  int overflow_refs(const char *row, vector<OverflowRef> &refs) const;
+
+  /**
+   * @brief 行数据在页面中的大小
+   */
+  int row_size(const char *row) const;
+
+private:
+  vector<int> column_descs_;
+  vector<int> field_offsets_;
+
+  int record_size_          = 0;
+  int min_row_size_         = 0;
+  int max_row_size_         = 0;
+  int page_data_size_       = 0;
+  int record_capacity_      = 0;
+  int varlen_header_offset_ = 0;
+  int col_idx_offset_       = 0;
+  int slot_dir_offset_      = 0;
+};
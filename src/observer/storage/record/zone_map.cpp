@@ -0,0 +1,133 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include "storage/record/zone_map.h"
+#include "common/lang/string.h"
+
+/**
+ * @brief 比较同一类型的两个列值
+ */
+static int compare_field(AttrType type, const char *left, const char *right)
+{
+  switch (type) {
+    case AttrType::INTS: {
+      int32_t l = 0, r = 0;
+      memcpy(&l, left, sizeof(l));
+      memcpy(&r, right, sizeof(r));
+      return l < r ? -1 : (l > r ? 1 : 0);
+    }
+    case AttrType::FLOATS: {
+      float l = 0, r = 0;
+      memcpy(&l, left, sizeof(l));
+      memcpy(&r, right, sizeof(r));
+      return l < r ? -1 : (l > r ? 1 : 0);
+    }
+    default: {
+      return 0;
+    }
+  }
+}
+
+bool ColumnZoneMap::supported(AttrType type, int len)
+{
+  return (type == AttrType::INTS || type == AttrType::FLOATS) && len > 0 && len <= MAX_VALUE_LEN;
+}
+
+void ColumnZoneMap::init(AttrType type, int len)
+{
+  memset(this, 0, sizeof(*this));
+  attr_type = static_cast<int32_t>(type);
+  attr_len  = len;
+}
+
+void ColumnZoneMap::clear()
+{
+  has_range = 0;
+  memset(min_value, 0, sizeof(min_value));
+  memset(max_value, 0, sizeof(max_value));
+}
+
+void ColumnZoneMap::extend(const char *value)
+{
+  if (!supported(type(), attr_len)) {
+    return;
+  }
+
+  if (!has_range) {
+    memcpy(min_value, value, attr_len);
+    memcpy(max_value, value, attr_len);
+    has_range = 1;
+    return;
+  }
+
+  if (compare_field(type(), value, min_value) < 0) {
+    memcpy(min_value, value, attr_len);
+  }
+  if (compare_field(type(), value, max_value) > 0) {
+    memcpy(max_value, value, attr_len);
+  }
+}
+
+bool ColumnZoneMap::on_boundary(const char *value) const
+{
+  if (!has_range) {
+    return false;
+  }
+  return compare_field(type(), value, min_value) <= 0 || compare_field(type(), value, max_value) >= 0;
+}
+
+Value ColumnZoneMap::min() const { return Value(type(), const_cast<char *>(min_value), attr_len); }
+Value ColumnZoneMap::max() const { return Value(type(), const_cast<char *>(max_value), attr_len); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ZoneMapFilter::add_condition(int col_id, CompOp comp, const Value &value)
+{
+  conditions_.push_back(Condition{col_id, comp, value});
+}
+
+bool ZoneMapFilter::may_match(const ColumnZoneMap *zone_maps, int column_num) const
+{
+  for (const Condition &condition : conditions_) {
+    if (condition.col_id < 0 || condition.col_id >= column_num) {
+      continue;
+    }
+    if (!may_match(zone_maps[condition.col_id], condition)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ZoneMapFilter::may_match(const ColumnZoneMap &zone_map, const Condition &condition)
+{
+  if (!zone_map.has_range || !ColumnZoneMap::supported(zone_map.type(), zone_map.attr_len) ||
+      condition.value.attr_type() != zone_map.type()) {
+    return true;
+  }
+
+  // 与向量化的比较一样直接比较原始的值
+  const AttrType type    = zone_map.type();
+  const int      min_cmp = compare_field(type, condition.value.data(), zone_map.min_value);
+  const int      max_cmp = compare_field(type, condition.value.data(), zone_map.max_value);
+  switch (condition.comp) {
+    case EQUAL_TO: return min_cmp >= 0 && max_cmp <= 0;
+    case LESS_EQUAL: return min_cmp >= 0;   // column <= value
+    case LESS_THAN: return min_cmp > 0;     // column < value
+    case GREAT_EQUAL: return max_cmp <= 0;  // column >= value
+    case GREAT_THAN: return max_cmp < 0;    // column > value
+    case NOT_EQUAL: return !(min_cmp == 0 && max_cmp == 0);
+    default: return true;
+  }
+}
@@ -0,0 +1,105 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#pragma once
+
+#include "common/lang/vector.h"
+#include "common/type/attr_type.h"
+#include "common/value.h"
+#include "sql/parser/parse_defs.h"
+
+/**
+ * @brief PAX 页面中一列的 zone map，记录页面中这一列的最小值、最大值以及空值的个数
+ * @ingroup RecordManager
+ * @details 保存在 PAX 页面的列索引之后，每列一项。只有定长的数值类型(INTS/FLOATS)维护最小值和最大值，
+ * 其它类型的列 has_range 总是 false，不会用来跳过页面。
+ * 插入和更新时扩大范围；删除的值恰好是最小值或最大值时，重新计算这一列的范围。
+ * 更新时不会缩小范围，所以范围可能比实际的大，但不会漏掉数据。
+ */
+struct ColumnZoneMap
+{
+  static constexpr int MAX_VALUE_LEN = 8;
+
+  int32_t attr_type;   ///< 列的类型，AttrType
+  int32_t attr_len;    ///< 列的长度
+  int32_t null_count;  ///< 空值的个数。当前还不支持 NULL，总是0
+  int32_t has_range;   ///< min_value 和 max_value 是否有效，页面中没有记录时是0
+  char    min_value[MAX_VALUE_LEN];
+  char    max_value[MAX_VALUE_LEN];
+
+  /**
+   * @brief 这个类型的列是否维护最小值和最大值
+   */
+  static bool supported(AttrType type, int len);
+
+  void init(AttrType type, int len);
+
+  /**
+   * @brief 清空范围，页面中没有记录时使用
+   */
+  void clear();
+
+  /**
+   * @brief 用一个新的值扩大范围
+   */
+  void extend(const char *value);
+
+  /**
+   * @brief value 是否是当前范围的边界，删除边界上的值之后需要重新计算范围
+   */
+  bool on_boundary(const char *value) const;
+
+  AttrType type() const { return static_cast<AttrType>(attr_type); }
+  Value    min() const;
+  Value    max() const;
+};
+
+/**
+ * @brief 根据下推的比较条件，使用 zone map 判断一个页面中是否可能有满足条件的记录
+ * @ingroup RecordManager
+ * @details 每个条件是"列 比较运算 常量"的形式，所有条件是 AND 的关系。
+ * 只要有一个条件在某一列的范围内不可能满足，整个页面就可以跳过。
+ */
+class ZoneMapFilter
+{
+public:
+  struct Condition
+  {
+    int    col_id;
+    CompOp comp;
+    Value  value;
+  };
+
+public:
+  /**
+   * @brief 增加一个"列 comp value"的条件
+   */
+  void add_condition(int col_id, CompOp comp, const Value &value);
+
+  bool                      empty() const { return conditions_.empty(); }
+  const vector<Condition> &conditions() const { return conditions_; }
+
+  /**
+   * @brief 判断 zone map 描述的页面中是否可能有满足所有条件的记录
+   * @param zone_maps  页面中每一列的 zone map
+   * @param column_num zone map 的个数
+   */
+  bool may_match(const ColumnZoneMap *zone_maps, int column_num) const;
+
+private:
+  static bool may_match(const ColumnZoneMap &zone_map, const Condition &condition);
+
+private:
+  vector<Condition> conditions_;
+};
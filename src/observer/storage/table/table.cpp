@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/string.h"
 #include "common/lang/span.h"
 #include "common/lang/algorithm.h"
+#include "common/lang/filesystem.h"
 #include "common/log/log.h"
 #include "common/global_context.h"
 #include "storage/db/db.h"
@@ -53,7 +54,7 @@ Table::~Table()
 }
 
 RC Table::create(Db *db, int32_t table_id, const char *path, const char *name, const char *base_dir,
-    span<const AttrInfoSqlNode> attributes, StorageFormat storage_format)
+    span<const AttrInfoSqlNode> attributes, StorageFormat storage_format, PageCompression compression)
 {
   if (table_id < 0) {
     LOG_WARN("invalid table id. table_id=%d, table_name=%s", table_id, name);
@@ -110,7 +111,7 @@ RC Table::create(Db *db, int32_t table_id, const char *path, const char *name, c
 
   string             data_file = table_data_file(base_dir, name);
   BufferPoolManager &bpm       = db->buffer_pool_manager();
-  rc                           = bpm.create_file(data_file.c_str());
+  rc                           = bpm.create_file(data_file.c_str(), 0 /*page_size*/, compression);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create disk buffer pool of data file. file name=%s", data_file.c_str());
     return rc;
@@ -158,19 +159,24 @@ RC Table::open(Db *db, const char *meta_file, const char *base_dir)
   const int index_num = table_meta_.index_num();
   for (int i = 0; i < index_num; i++) {
     const IndexMeta *index_meta = table_meta_.index(i);
-    const FieldMeta *field_meta = table_meta_.field(index_meta->field());
-    if (field_meta == nullptr) {
-      LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
-                name(), index_meta->name(), index_meta->field());
-      // skip cleanup
-      //  do all cleanup action in destructive Table function
-      return RC::INTERNAL;
+
+    vector<const FieldMeta *> field_metas;
+    for (const string &field_name : index_meta->fields()) {
+      const FieldMeta *field_meta = table_meta_.field(field_name.c_str());
+      if (field_meta == nullptr) {
+        LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
+                  name(), index_meta->name(), field_name.c_str());
+        // skip cleanup
+        //  do all cleanup action in destructive Table function
+        return RC::INTERNAL;
+      }
+      field_metas.push_back(field_meta);
     }
 
     BplusTreeIndex *index      = new BplusTreeIndex();
     string          index_file = table_index_file(base_dir, name(), index_meta->name());
 
-    rc = index->open(this, index_file.c_str(), *index_meta, *field_meta);
+    rc = index->open(this, index_file.c_str(), *index_meta, field_metas);
     if (rc != RC::SUCCESS) {
       delete index;
       LOG_ERROR("Failed to open index. table=%s, index=%s, file=%s, rc=%s",
@@ -210,6 +216,51 @@ RC Table::insert_record(Record &record)
   return rc;
 }
 
+RC Table::insert_records(span<Record> records)
+{
+  vector<const char *> datas(records.size());
+  vector<RID>          rids(records.size());
+  for (size_t i = 0; i < records.size(); i++) {
+    datas[i] = records[i].data();
+  }
+
+  RC rc = record_handler_->insert_records(datas, table_meta_.record_size(), rids.data());
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Insert records failed. table name=%s, rc=%s", table_meta_.name(), strrc(rc));
+    return rc;
+  }
+
+  for (size_t i = 0; i < records.size(); i++) {
+    records[i].set_rid(rids[i]);
+  }
+
+  size_t index_num = 0;
+  for (; index_num < indexes_.size(); index_num++) {
+    rc = indexes_[index_num]->insert_entries(datas, rids);
+    if (rc != RC::SUCCESS) {  // 可能出现了键值重复
+      break;
+    }
+  }
+  if (rc == RC::SUCCESS) {
+    return rc;
+  }
+
+  // 出错的索引中可能插入了一部分数据，都要删除
+  for (size_t i = 0; i <= index_num && i < indexes_.size(); i++) {
+    for (size_t j = 0; j < records.size(); j++) {
+      (void)indexes_[i]->delete_entry(datas[j], &rids[j]);
+    }
+  }
+  for (const RID &rid : rids) {
+    RC rc2 = record_handler_->delete_record(&rid);
+    if (rc2 != RC::SUCCESS) {
+      LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%d:%s",
+                name(), rc2, strrc(rc2));
+    }
+  }
+  return rc;
+}
+
 RC Table::visit_record(const RID &rid, function<bool(Record &)> visitor)
 {
   return record_handler_->visit_record(rid, visitor);
@@ -353,19 +404,26 @@ RC Table::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode m
   return rc;
 }
 
-RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name)
+RC Table::create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name, bool unique)
 {
-  if (common::is_blank(index_name) || nullptr == field_meta) {
+  if (common::is_blank(index_name) || field_metas.empty() ||
+      any_of(field_metas.begin(), field_metas.end(), [](const FieldMeta *field) { return field == nullptr; })) {
     LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", name());
     return RC::INVALID_ARGUMENT;
   }
 
+  if (static_cast<int>(field_metas.size()) > IndexFileHeader::MAX_ATTR_NUM) {
+    LOG_INFO("Too many fields in index. table=%s, index=%s, field num=%d, max=%d",
+             name(), index_name, static_cast<int>(field_metas.size()), IndexFileHeader::MAX_ATTR_NUM);
+    return RC::INVALID_ARGUMENT;
+  }
+
   IndexMeta new_index_meta;
 
-  RC rc = new_index_meta.init(index_name, *field_meta);
+  RC rc = new_index_meta.init(index_name, field_metas, unique);
   if (rc != RC::SUCCESS) {
     LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s", 
-             name(), index_name, field_meta->name());
+             name(), index_name, field_metas[0]->name());
     return rc;
   }
 
@@ -373,7 +431,7 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
   BplusTreeIndex *index      = new BplusTreeIndex();
   string          index_file = table_index_file(base_dir_.c_str(), name(), index_name);
 
-  rc = index->create(this, index_file.c_str(), new_index_meta, *field_meta);
+  rc = index->create(this, index_file.c_str(), new_index_meta, field_metas);
   if (rc != RC::SUCCESS) {
     delete index;
     LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
@@ -393,19 +451,20 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
   while (OB_SUCC(rc = scanner.next(record))) {
     rc = index->insert_entry(record.data(), &record.rid());
     if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
-               name(), index_name, strrc(rc));
-      return rc;
+      break;
     }
   }
+  scanner.close_scan();
   if (RC::RECORD_EOF == rc) {
     rc = RC::SUCCESS;
   } else {
+    // 比如唯一索引遇到了重复的数据。删除创建了一半的索引，这样可以使用同样的名字重新创建
     LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
              name(), index_name, strrc(rc));
+    delete index;
+    filesystem::remove(index_file);
     return rc;
   }
-  scanner.close_scan();
   LOG_INFO("inserted all records into new index. table=%s, index=%s", name(), index_name);
 
   indexes_.push_back(index);
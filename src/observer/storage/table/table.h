@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/types.h"
 #include "common/lang/span.h"
 #include "common/lang/functional.h"
+#include "storage/buffer/page_compressor.h"
 
 struct RID;
 class Record;
@@ -50,9 +51,11 @@ public:
    * @param base_dir 表数据存放的路径
    * @param attribute_count 字段个数
    * @param attributes 字段
+   * @param compression 数据文件的页面压缩算法。索引文件不压缩
    */
   RC create(Db *db, int32_t table_id, const char *path, const char *name, const char *base_dir,
-      span<const AttrInfoSqlNode> attributes, StorageFormat storage_format);
+      span<const AttrInfoSqlNode> attributes, StorageFormat storage_format,
+      PageCompression compression = PageCompression::NONE);
 
   /**
    * 打开一个表
@@ -76,14 +79,26 @@ public:
    * @param record[in/out] 传入的数据包含具体的数据，插入成功会通过此字段返回RID
    */
   RC insert_record(Record &record);
+
+  /**
+   * @brief 在当前的表中插入多条记录
+   * @details 记录文件中同一个页面的记录一起插入，索引也是按照索引逐个批量插入。
+   * 任何一条记录插入失败时，这一批记录都不会插入
+   * @param records[in/out] 插入成功会通过每条记录返回RID
+   */
+  RC insert_records(span<Record> records);
   RC delete_record(const Record &record);
   RC delete_record(const RID &rid);
   RC get_record(const RID &rid, Record &record);
 
   RC recover_insert_record(Record &record);
 
-  // TODO refactor
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name);
+  /**
+   * @brief 创建索引
+   * @param field_metas 索引包含的字段，多个字段时创建联合索引，键值按照字段的顺序比较
+   * @param unique 是否是唯一索引。表中已经有重复的数据时创建失败，返回 RECORD_DUPLICATE_KEY
+   */
+  RC create_index(Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name, bool unique = false);
 
   RC get_record_scanner(RecordFileScanner &scanner, Trx *trx, ReadWriteMode mode);
 
@@ -91,6 +106,8 @@ public:
 
   RecordFileHandler *record_handler() const { return record_handler_; }
 
+  DiskBufferPool *data_buffer_pool() const { return data_buffer_pool_; }
+
   /**
    * @brief 可以在页面锁保护的情况下访问记录
    * @details 当前是在事务中访问记录，为了提供一个“原子性”的访问模式
@@ -120,8 +137,14 @@ private:
 
 public:
   Index *find_index(const char *index_name) const;
+
+  /**
+   * @brief 查找以指定字段开头的索引
+   */
   Index *find_index_by_field(const char *field_name) const;
 
+  const vector<Index *> &indexes() const { return indexes_; }
+
 private:
   Db                *db_ = nullptr;
   string             base_dir_;
@@ -15,6 +15,8 @@ See the Mulan PSL v2 for more details. */
 #include "storage/trx/mvcc_trx.h"
 #include "storage/db/db.h"
 #include "storage/field/field.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
 #include "storage/trx/mvcc_trx_log.h"
 #include "common/lang/algorithm.h"
 
@@ -111,6 +113,33 @@ LogReplayer *MvccTrxKit::create_log_replayer(Db &db, LogHandler &log_handler)
   return new MvccTrxLogReplayer(db, *this, log_handler);
 }
 
+LSN MvccTrxKit::min_active_lsn(LSN lsn)
+{
+  lock_.lock();
+  for (Trx *trx : trxes_) {
+    LSN first_lsn = static_cast<MvccTrx *>(trx)->first_lsn();
+    if (first_lsn >= 0 && first_lsn < lsn) {
+      lsn = first_lsn;
+    }
+  }
+  lock_.unlock();
+  return lsn;
+}
+
+bool MvccTrxKit::has_active_trx(int32_t low, int32_t high, const Trx *except)
+{
+  lock_.lock();
+  for (Trx *trx : trxes_) {
+    const int32_t trx_id = static_cast<MvccTrx *>(trx)->active_trx_id_.load();
+    if (trx != except && trx_id >= 0 && trx_id >= low && trx_id <= high) {
+      lock_.unlock();
+      return true;
+    }
+  }
+  lock_.unlock();
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 MvccTrx::MvccTrx(MvccTrxKit &kit, LogHandler &log_handler) : trx_kit_(kit), log_handler_(log_handler)
@@ -121,6 +150,7 @@ MvccTrx::MvccTrx(MvccTrxKit &kit, LogHandler &log_handler, int32_t trx_id)
 {
   started_    = true;
   recovering_ = true;
+  active_trx_id_.store(trx_id);
 }
 
 MvccTrx::~MvccTrx() {}
@@ -134,12 +164,20 @@ RC MvccTrx::insert_record(Table *table, Record &record)
   begin_field.set_int(record, -trx_id_);
   end_field.set_int(record, trx_kit_.max_trx_id());
 
-  RC rc = table->insert_record(record);
+  RC   rc     = table->insert_record(record);
+  bool purged = true;
+  while (rc == RC::RECORD_DUPLICATE_KEY && purged) {
+    rc = purge_deleted_unique_entries(table, record, purged);
+    if (OB_SUCC(rc)) {
+      rc = purged ? table->insert_record(record) : RC::RECORD_DUPLICATE_KEY;
+    }
+  }
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to insert record into table. rc=%s", strrc(rc));
     return rc;
   }
 
+  record_first_lsn();
   rc = log_handler_.insert_record(trx_id_, table, record.rid());
   ASSERT(rc == RC::SUCCESS, "failed to append insert record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
          trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
@@ -148,6 +186,51 @@ RC MvccTrx::insert_record(Table *table, Record &record)
   return rc;
 }
 
+RC MvccTrx::insert_records(Table *table, span<Record> records)
+{
+  Field begin_field;
+  Field end_field;
+  trx_fields(table, begin_field, end_field);
+
+  for (Record &record : records) {
+    begin_field.set_int(record, -trx_id_);
+    end_field.set_int(record, trx_kit_.max_trx_id());
+  }
+
+  RC   rc     = table->insert_records(records);
+  bool purged = true;
+  while (rc == RC::RECORD_DUPLICATE_KEY && purged) {
+    // 不知道是哪条记录冲突，每条记录都检查一下
+    purged = false;
+    for (Record &record : records) {
+      bool record_purged = false;
+      rc                 = purge_deleted_unique_entries(table, record, record_purged);
+      if (OB_FAIL(rc)) {
+        break;
+      }
+      purged = purged || record_purged;
+    }
+    if (OB_SUCC(rc)) {
+      rc = purged ? table->insert_records(records) : RC::RECORD_DUPLICATE_KEY;
+    }
+  }
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to insert records into table. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // 事务日志仍然每条记录一条，提交和回滚时按照记录处理
+  record_first_lsn();
+  for (Record &record : records) {
+    rc = log_handler_.insert_record(trx_id_, table, record.rid());
+    ASSERT(rc == RC::SUCCESS, "failed to append insert record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
+           trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
+
+    operations_.push_back(Operation(Operation::Type::INSERT, table, record.rid()));
+  }
+  return rc;
+}
+
 RC MvccTrx::delete_record(Table *table, Record &record)
 {
   Field begin_field;
@@ -177,6 +260,7 @@ RC MvccTrx::delete_record(Table *table, Record &record)
     return delete_result;
   }
 
+  record_first_lsn();
   rc = log_handler_.delete_record(trx_id_, table, record.rid());
   ASSERT(rc == RC::SUCCESS, "failed to append delete record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
       trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
@@ -260,11 +344,101 @@ void MvccTrx::trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_fi
   end_xid_field.set_field(&trx_fields[1]);
 }
 
+void MvccTrx::record_first_lsn()
+{
+  if (first_lsn_.load() < 0) {
+    first_lsn_.store(log_handler_.current_lsn());
+  }
+}
+
+RC MvccTrx::purge_deleted_unique_entries(Table *table, const Record &record, bool &purged)
+{
+  purged = false;
+
+  Field begin_xid_field, end_xid_field;
+  trx_fields(table, begin_xid_field, end_xid_field);
+
+  for (Index *index : table->indexes()) {
+    if (!index->index_meta().unique()) {
+      continue;
+    }
+
+    list<RID> rids;
+    RC        rc = index->get_entries(record.data(), rids);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get index entries. table=%s, index=%s, rc=%s",
+               table->name(), index->index_meta().name(), strrc(rc));
+      return rc;
+    }
+
+    for (const RID &rid : rids) {
+      Record old_record;
+      rc = table->get_record(rid, old_record);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get record of index entry. table=%s, index=%s, rid=%s, rc=%s",
+                 table->name(), index->index_meta().name(), rid.to_string().c_str(), strrc(rc));
+        return rc;
+      }
+
+      // 事务号在 [begin xid, end xid] 范围内的事务能看到已经提交的记录。
+      // 当前事务自己删除的记录还没有提交，其它事务号不小于 begin xid 的事务都能看到它
+      const int32_t begin_xid = begin_xid_field.get_int(old_record);
+      const int32_t end_xid   = end_xid_field.get_int(old_record);
+      bool          visible   = true;
+      if (end_xid == -trx_id_) {
+        visible = begin_xid > 0 && trx_kit_.has_active_trx(begin_xid, trx_kit_.max_trx_id(), this);
+      } else if (end_xid > 0 && end_xid != trx_kit_.max_trx_id()) {
+        visible = trx_kit_.has_active_trx(begin_xid, end_xid, nullptr);
+      }
+      if (visible) {
+        continue;
+      }
+
+      rc = index->delete_entry(old_record.data(), &rid);
+      if (OB_SUCC(rc)) {
+        LOG_TRACE("purge deleted unique index entry. table=%s, index=%s, rid=%s",
+                  table->name(), index->index_meta().name(), rid.to_string().c_str());
+        purged = true;
+      } else if (rc == RC::RECORD_NOT_EXIST) {
+        // 其它事务已经删除了这条数据
+        purged = true;
+      } else {
+        LOG_WARN("failed to purge unique index entry. table=%s, index=%s, rid=%s, rc=%s",
+                 table->name(), index->index_meta().name(), rid.to_string().c_str(), strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC MvccTrx::restore_unique_entries(Table *table, const Record &record)
+{
+  for (Index *index : table->indexes()) {
+    if (!index->index_meta().unique()) {
+      continue;
+    }
+
+    list<RID> rids;
+    RC        rc = index->get_entries(record.data(), rids);
+    if (OB_SUCC(rc) && rids.empty()) {
+      rc = index->insert_entry(record.data(), &record.rid());
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to restore unique index entry. table=%s, index=%s, rid=%s, rc=%s",
+               table->name(), index->index_meta().name(), record.rid().to_string().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 RC MvccTrx::start_if_need()
 {
   if (!started_) {
     ASSERT(operations_.empty(), "try to start a new trx while operations is not empty");
     trx_id_ = trx_kit_.next_trx_id();
+    active_trx_id_.store(trx_id_);
     LOG_DEBUG("current thread change to new trx with %d", trx_id_);
     started_ = true;
   }
@@ -340,6 +514,8 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
   }
 
   operations_.clear();
+  first_lsn_.store(-1);
+  active_trx_id_.store(-1);
 
   LOG_TRACE("append trx commit log. trx id=%d, commit_xid=%d, rc=%s", trx_id_, commit_xid, strrc(rc));
   return rc;
@@ -390,7 +566,8 @@ RC MvccTrx::rollback()
         Field begin_xid_field, end_xid_field;
         trx_fields(table, begin_xid_field, end_xid_field);
 
-        auto record_updater = [this, &end_xid_field](Record &record) -> bool {
+        Record restored_record;
+        auto   record_updater = [this, &end_xid_field, &restored_record](Record &record) -> bool {
           if (recovering_ && end_xid_field.get_int(record) != -trx_id_) {
             return false;
           }
@@ -400,12 +577,21 @@ RC MvccTrx::rollback()
                 end_xid_field.get_int(record), trx_id_);
 
           end_xid_field.set_int(record, trx_kit_.max_trx_id());
+          restored_record.copy_data(record.data(), record.len());
+          restored_record.set_rid(record.rid());
           return true;
         };
 
         rc = table->visit_record(rid, record_updater);
         ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
                rid.to_string().c_str(), strrc(rc));
+
+        // 删除之后又插入了相同的键值时，唯一索引中的数据可能被清理掉了。后插入的记录已经先回滚了
+        if (restored_record.len() > 0) {
+          rc = restore_unique_entries(table, restored_record);
+          ASSERT(rc == RC::SUCCESS, "failed to restore unique index entries while rollback. rid=%s, rc=%s",
+                 rid.to_string().c_str(), strrc(rc));
+        }
       } break;
 
       default: {
@@ -419,6 +605,8 @@ RC MvccTrx::rollback()
   if (!recovering_) {
     rc = log_handler_.rollback(trx_id_);
   }
+  first_lsn_.store(-1);
+  active_trx_id_.store(-1);
   LOG_TRACE("append trx rollback log. trx id=%d, rc=%s", trx_id_, strrc(rc));
   return rc;
 }
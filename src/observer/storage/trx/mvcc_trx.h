@@ -44,12 +44,21 @@ public:
 
   LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) override;
 
+  LSN min_active_lsn(LSN lsn) override;
+
 public:
   int32_t next_trx_id();
 
 public:
   int32_t max_trx_id() const;
 
+  /**
+   * @brief 是否有已经开始的事务，事务号在 [low, high] 范围内
+   * @details 用来判断删除的记录是否还对某个事务可见
+   * @param except 不检查这个事务，为空时检查所有的事务
+   */
+  bool has_active_trx(int32_t low, int32_t high, const Trx *except);
+
 private:
   vector<FieldMeta> fields_;  // 存储事务数据需要用到的字段元数据，所有表结构都需要带的
 
@@ -77,6 +86,7 @@ public:
   virtual ~MvccTrx();
 
   RC insert_record(Table *table, Record &record) override;
+  RC insert_records(Table *table, span<Record> records) override;
   RC delete_record(Table *table, Record &record) override;
 
   /**
@@ -99,10 +109,39 @@ public:
 
   int32_t id() const override { return trx_id_; }
 
+  /// @brief 事务日志的起始位置，还没有写日志时返回-1
+  LSN first_lsn() const { return first_lsn_.load(); }
+
 private:
   RC   commit_with_trx_id(int32_t commit_id);
+  /**
+   * @brief 写事务日志之前调用，记录事务日志的起始位置
+   * @details 记录的是写日志之前的LSN，不会大于事务第一条日志的LSN。
+   * 做检查点时先获取当前的LSN，再查看活跃事务的起始位置，这样不会漏掉检查点之前写入日志的事务
+   */
+  void record_first_lsn();
   void trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const;
 
+  /**
+   * @brief 删除唯一索引中与记录冲突，但是指向已经删除的记录的数据
+   * @details 删除记录时不会删除索引数据，唯一索引中留下的旧数据会导致相同键值的记录无法再插入。
+   * 插入返回 RECORD_DUPLICATE_KEY 之后调用，删除这些旧数据再重新插入。删除索引数据时会检查 RID，
+   * 多个事务同时清理同一条数据也只会删除一次，最终只有一个事务能插入成功。
+   * 只清理其它事务都看不到的记录：已经提交删除，并且没有活跃事务的事务号在记录的可见范围内；
+   * 或者是当前事务自己删除的，并且没有其它活跃事务能看到它。后者回滚时会恢复索引数据，参考 rollback
+   * @param table 插入的表
+   * @param record 插入失败的记录
+   * @param[out] purged 是否删除了索引数据
+   */
+  RC purge_deleted_unique_entries(Table *table, const Record &record, bool &purged);
+
+  /**
+   * @brief 回滚删除操作时，恢复记录在唯一索引中被清理掉的数据
+   * @details 参考 purge_deleted_unique_entries。重启恢复时也会回滚，所以不记录清理过哪些数据，
+   * 而是检查唯一索引中有没有这个键值
+   */
+  RC restore_unique_entries(Table *table, const Record &record);
+
 private:
   static const int32_t MAX_TRX_ID = numeric_limits<int32_t>::max();
 
@@ -116,4 +155,8 @@ private:
   bool              started_    = false;
   bool              recovering_ = false;
   OperationSet      operations_;
+  atomic<LSN>       first_lsn_{-1};  ///< 事务日志的起始位置，检查点线程会并发读取
+  atomic<int32_t>   active_trx_id_{-1};  ///< 开始之后是事务号，结束之后是-1，其它事务判断记录是否可见时读取
+
+  friend class MvccTrxKit;
 };
@@ -132,6 +132,8 @@ RC MvccTrxLogHandler::rollback(int32_t trx_id)
       lsn, LogModule::Id::TRANSACTION, span<const char>(reinterpret_cast<const char *>(&log_entry), sizeof(log_entry)));
 }
 
+LSN MvccTrxLogHandler::current_lsn() const { return log_handler_.current_lsn(); }
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 MvccTrxLogReplayer::MvccTrxLogReplayer(Db &db, MvccTrxKit &trx_kit, LogHandler &log_handler)
   : db_(db), trx_kit_(trx_kit), log_handler_(log_handler)
@@ -141,7 +143,7 @@ RC MvccTrxLogReplayer::replay(const LogEntry &entry)
 {
   RC rc = RC::SUCCESS;
 
-  // 由于当前没有check point，所以所有的事务都重做。
+  // 检查点会把重放的起点放到所有活跃事务的第一条日志之前，所以检查点之后看到的事务日志都是完整的
 
   ASSERT(entry.module().id() == LogModule::Id::TRANSACTION, "invalid log module id: %d", entry.module().id());
 
@@ -156,6 +158,7 @@ RC MvccTrxLogReplayer::replay(const LogEntry &entry)
   if (trx_iter == trx_map_.end()) {
     trx = static_cast<MvccTrx *>(trx_kit_.create_trx(log_handler_, header->trx_id));
     // trx = new MvccTrx(trx_kit_, log_handler_, header->trx_id);
+    trx_map_.emplace(header->trx_id, trx);
   } else {
     trx = trx_iter->second;
   }
@@ -180,7 +183,7 @@ RC MvccTrxLogReplayer::on_done()
   for (auto &pair : trx_map_) {
     MvccTrx *trx = pair.second;
     trx->rollback(); // 恢复时的rollback，可能遇到之前已经回滚一半的事务又再次调用回滚的情况
-    delete pair.second;
+    trx_kit_.destroy_trx(trx);
   }
   trx_map_.clear();
 
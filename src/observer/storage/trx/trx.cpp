@@ -43,3 +43,15 @@ TrxKit *TrxKit::create(const char *name)
   
   return trx_kit;
 }
+
+RC Trx::insert_records(Table *table, span<Record> records)
+{
+  RC rc = RC::SUCCESS;
+  for (Record &record : records) {
+    rc = insert_record(table, record);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+  }
+  return rc;
+}
@@ -129,6 +129,14 @@ public:
 
   virtual LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) = 0;
 
+  /**
+   * @brief 所有活跃事务日志起始位置中最小的LSN
+   * @details 做检查点时使用。检查点之前开始、还没有结束的事务，恢复时要从它的第一条日志开始重放，
+   * 否则恢复结束时无法回滚它
+   * @param lsn 没有活跃事务或者活跃事务都还没有写日志时，返回这个值
+   */
+  virtual LSN min_active_lsn(LSN lsn) { return lsn; }
+
 public:
   static TrxKit *create(const char *name);
 };
@@ -147,6 +155,12 @@ public:
   virtual RC delete_record(Table *table, Record &record)                    = 0;
   virtual RC visit_record(Table *table, Record &record, ReadWriteMode mode) = 0;
 
+  /**
+   * @brief 插入多条记录
+   * @details 默认逐条调用 insert_record，出错时前面已经插入的记录由事务回滚
+   */
+  virtual RC insert_records(Table *table, span<Record> records);
+
   virtual RC start_if_need() = 0;
   virtual RC commit()        = 0;
   virtual RC rollback()      = 0;
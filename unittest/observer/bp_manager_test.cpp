@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai.wyl on 2021
 //
 
+#include "common/lang/thread.h"
+#include "common/lang/vector.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "gtest/gtest.h"
 
@@ -125,6 +127,412 @@ TEST(test_frame_manager, test_frame_manager_simple_lru)
   frame_manager.cleanup();
 }
 
+TEST(test_frame_manager, test_frame_manager_sharded)
+{
+  const int pool_num  = 4;
+  const int shard_num = 4;
+
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(pool_num, shard_num));
+  ASSERT_EQ(shard_num, frame_manager.shard_num());
+  ASSERT_EQ(static_cast<size_t>(pool_num * DEFAULT_ITEM_NUM_PER_POOL), frame_manager.total_frame_num());
+
+  test_get(frame_manager);
+
+  // 每个分片的页帧是独立分配的，某个分片满了不影响其它分片，所以这里一直分配直到所有页帧都用完
+  const int     buffer_pool_id = 0;
+  list<Frame *> used_list;
+  for (PageNum page_num = 0; used_list.size() < frame_manager.total_frame_num(); page_num++) {
+    ASSERT_LT(page_num, static_cast<PageNum>(frame_manager.total_frame_num() * 10));
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+    if (frame != nullptr) {
+      used_list.push_back(frame);
+    }
+  }
+  ASSERT_EQ(used_list.size(), frame_manager.frame_num());
+  ASSERT_EQ(nullptr, frame_manager.alloc(buffer_pool_id, 1 << 20));
+
+  // 释放一个页帧后，同一个分片中的页面就可以分配了
+  Frame  *freed_frame    = used_list.front();
+  PageNum freed_page_num = freed_frame->page_num();
+  used_list.pop_front();
+  ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, freed_page_num, freed_frame));
+  Frame *realloc_frame = frame_manager.alloc(buffer_pool_id, freed_page_num);
+  ASSERT_NE(nullptr, realloc_frame);
+  used_list.push_back(realloc_frame);
+
+  for (Frame *frame : used_list) {
+    ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, frame->page_num(), frame));
+  }
+  ASSERT_EQ(0, frame_manager.frame_num());
+
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_manager_purge_sharded)
+{
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(2, 2));
+
+  const int     buffer_pool_id = 0;
+  list<Frame *> used_list;
+  for (PageNum page_num = 0; used_list.size() < frame_manager.total_frame_num(); page_num++) {
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+    if (frame != nullptr) {
+      frame->unpin();
+      used_list.push_back(frame);
+    }
+  }
+
+  // 淘汰时只会选择目标页面所在分片中的页帧
+  const PageNum new_page_num = static_cast<PageNum>(frame_manager.total_frame_num() * 10);
+  ASSERT_EQ(nullptr, frame_manager.alloc(buffer_pool_id, new_page_num));
+
+  int purged = frame_manager.purge_frames(FrameId(buffer_pool_id, new_page_num), 1, [](Frame *) { return RC::SUCCESS; });
+  ASSERT_EQ(1, purged);
+
+  Frame *new_frame = frame_manager.alloc(buffer_pool_id, new_page_num);
+  ASSERT_NE(nullptr, new_frame);
+  ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, new_page_num, new_frame));
+
+  for (Frame *frame : frame_manager.find_list(buffer_pool_id)) {
+    ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, frame->page_num(), frame));
+  }
+  ASSERT_EQ(0, frame_manager.frame_num());
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_manager_sharded_concurrency)
+{
+  const int thread_num      = 8;
+  const int page_per_thread = 32;
+  const int loop_num        = 200;
+
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(4, 4));
+
+  // 每个线程操作自己的一批页面，分配、查找再释放，最后页帧都应该被释放掉
+  auto worker = [&frame_manager](int thread_index) {
+    const int buffer_pool_id = thread_index;
+    for (int loop = 0; loop < loop_num; loop++) {
+      vector<Frame *> frames;
+      for (PageNum page_num = 0; page_num < page_per_thread; page_num++) {
+        Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+        ASSERT_NE(nullptr, frame);
+        frames.push_back(frame);
+      }
+
+      for (PageNum page_num = 0; page_num < page_per_thread; page_num++) {
+        Frame *frame = frame_manager.get(buffer_pool_id, page_num);
+        ASSERT_EQ(frames[page_num], frame);
+        frame->unpin();
+      }
+
+      for (PageNum page_num = 0; page_num < page_per_thread; page_num++) {
+        ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, page_num, frames[page_num]));
+      }
+    }
+  };
+
+  vector<thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(0, frame_manager.frame_num());
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_manager_huge_page)
+{
+  const int pool_num  = 4;
+  const int shard_num = 2;
+
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(pool_num, shard_num, nullptr, "huge_page", "interleave"));
+
+  // 没有预留大页时会退化成透明大页或者普通页面，但是页帧都在同一块内存中
+  const FrameArena &arena = frame_manager.arena();
+  printf("frame arena page type: %s, memory size: %ld, numa applied: %d\n",
+         arena.page_type_name(), arena.memory_size(), arena.numa_applied());
+  ASSERT_EQ(static_cast<size_t>(pool_num * DEFAULT_ITEM_NUM_PER_POOL), arena.frame_num());
+  ASSERT_EQ(arena.frame_num(), frame_manager.total_frame_num());
+  ASSERT_EQ(0, arena.memory_size() % (2 * 1024 * 1024));
+
+  const int       buffer_pool_id = 0;
+  vector<Frame *> used_list;
+  for (PageNum page_num = 0; used_list.size() < frame_manager.total_frame_num(); page_num++) {
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+    if (frame != nullptr) {
+      ASSERT_GE(frame, arena.frames());
+      ASSERT_LT(frame, arena.frames() + arena.frame_num());
+      frame->clear_page();
+      used_list.push_back(frame);
+    }
+  }
+
+  for (Frame *frame : used_list) {
+    ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, frame->page_num(), frame));
+  }
+  ASSERT_EQ(0, frame_manager.frame_num());
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_arena_options)
+{
+  vector<int> nodes;
+  ASSERT_EQ(RC::SUCCESS, FrameArena::parse_nodes("0,2-4, 7", nodes));
+  ASSERT_EQ(vector<int>({0, 2, 3, 4, 7}), nodes);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, FrameArena::parse_nodes("3-1", nodes));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, FrameArena::parse_nodes("a", nodes));
+
+  FrameArena arena;
+  ASSERT_EQ(RC::INVALID_ARGUMENT, arena.init(16, "unknown"));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, arena.init(16, nullptr, "unknown"));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, arena.init(16, nullptr, "bind"));
+  ASSERT_EQ(RC::SUCCESS, arena.init(16, "normal", "bind:0"));
+  ASSERT_EQ(FrameArena::PageType::NORMAL, arena.page_type());
+  arena.cleanup();
+  ASSERT_EQ(RC::SUCCESS, arena.init(16, "NORMAL", "none"));
+  ASSERT_FALSE(arena.numa_applied());
+  arena.cleanup();
+
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::INVALID_ARGUMENT, frame_manager.init(1, 1, nullptr, "unknown"));
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(1, 1, nullptr, "normal"));
+  ASSERT_EQ(static_cast<size_t>(DEFAULT_ITEM_NUM_PER_POOL), frame_manager.total_frame_num());
+}
+
+TEST(test_frame_manager, test_frame_replacer_create)
+{
+  ASSERT_NE(nullptr, FrameReplacer::create(nullptr));
+  ASSERT_NE(nullptr, FrameReplacer::create(""));
+  ASSERT_NE(nullptr, FrameReplacer::create("lru"));
+  ASSERT_NE(nullptr, FrameReplacer::create("CLOCK"));
+  ASSERT_NE(nullptr, FrameReplacer::create("2q"));
+  ASSERT_EQ(nullptr, FrameReplacer::create("unknown"));
+
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::INVALID_ARGUMENT, frame_manager.init(1, 1, "unknown"));
+}
+
+/**
+ * @brief 先反复访问一些热点页面，再扫描与内存容量相同数量的页面，返回扫描后还留在内存中的热点页面个数
+ */
+int hot_pages_after_scan(const char *replacer, BufferAccessHint scan_hint = BufferAccessHint::NORMAL, int scan_times = 1)
+{
+  BPFrameManager frame_manager("Test");
+  EXPECT_EQ(RC::SUCCESS, frame_manager.init(1, 1, replacer));
+
+  const int     buffer_pool_id = 0;
+  const PageNum hot_page_num   = 8;
+  const PageNum scan_begin     = 1000;
+  const PageNum scan_page_num  = static_cast<PageNum>(frame_manager.total_frame_num()) * scan_times;
+
+  for (PageNum page_num = 0; page_num < hot_page_num; page_num++) {
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+    EXPECT_NE(frame, nullptr);
+    frame->unpin();
+  }
+  for (int i = 0; i < 2; i++) {
+    for (PageNum page_num = 0; page_num < hot_page_num; page_num++) {
+      Frame *frame = frame_manager.get(buffer_pool_id, page_num);
+      EXPECT_NE(frame, nullptr);
+      frame->unpin();
+    }
+  }
+
+  auto purger = [](Frame *) { return RC::SUCCESS; };
+  for (PageNum page_num = scan_begin; page_num < scan_begin + scan_page_num; page_num++) {
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num, scan_hint);
+    if (frame == nullptr) {
+      EXPECT_EQ(1, frame_manager.purge_frames(FrameId(buffer_pool_id, page_num), 1, purger));
+      frame = frame_manager.alloc(buffer_pool_id, page_num, scan_hint);
+    }
+    EXPECT_NE(frame, nullptr);
+    frame->unpin();
+  }
+
+  int hot_count = 0;
+  for (PageNum page_num = 0; page_num < hot_page_num; page_num++) {
+    Frame *frame = frame_manager.get(buffer_pool_id, page_num);
+    if (frame != nullptr) {
+      frame->unpin();
+      hot_count++;
+    }
+  }
+
+  for (Frame *frame : frame_manager.find_list(buffer_pool_id)) {
+    frame_manager.free(buffer_pool_id, frame->page_num(), frame);
+  }
+  EXPECT_EQ(RC::SUCCESS, frame_manager.cleanup());
+  return hot_count;
+}
+
+TEST(test_frame_manager, test_frame_replacer_scan_resistance)
+{
+  // LRU 会被扫描的页面冲掉，CLOCK 和 2Q 会保留反复访问的页面
+  ASSERT_EQ(0, hot_pages_after_scan("lru"));
+  ASSERT_EQ(8, hot_pages_after_scan("2q"));
+  ASSERT_EQ(8, hot_pages_after_scan("clock"));
+}
+
+TEST(test_frame_manager, test_frame_manager_sequential_hint)
+{
+  // 顺序访问的页面放在淘汰顺序的冷端，扫描再多的页面也只会淘汰扫描过的页面
+  for (const char *replacer : {"lru", "2q", "clock"}) {
+    ASSERT_EQ(8, hot_pages_after_scan(replacer, BufferAccessHint::SEQUENTIAL, 4)) << replacer;
+  }
+}
+
+TEST(test_frame_manager, test_clock_replacer_lock_free_access)
+{
+  ClockFrameReplacer replacer;
+  ASSERT_TRUE(replacer.lock_free_access());
+  ASSERT_FALSE(LruFrameReplacer().lock_free_access());
+
+  Frame scanned;
+  Frame accessed;
+  Frame normal;
+  replacer.insert(&scanned, BufferAccessHint::SEQUENTIAL);
+  replacer.insert(&accessed, BufferAccessHint::SEQUENTIAL);
+  replacer.insert(&normal, BufferAccessHint::NORMAL);
+
+  // 访问只设置访问标记，顺序访问的页帧还在 FIFO 队列中，淘汰时才移动到环上
+  replacer.access(&accessed, BufferAccessHint::NORMAL);
+  ASSERT_TRUE(accessed.referenced());
+  replacer.access(&scanned, BufferAccessHint::SEQUENTIAL);
+  ASSERT_FALSE(scanned.referenced());
+
+  auto next_victim = [&replacer]() {
+    Frame *victim = nullptr;
+    replacer.foreach_victim([&victim](Frame *frame) {
+      victim = frame;
+      return false;
+    });
+    if (victim != nullptr) {
+      replacer.remove(victim);
+    }
+    return victim;
+  };
+
+  ASSERT_EQ(&scanned, next_victim());
+  ASSERT_EQ(2, static_cast<int>(replacer.size()));
+  ASSERT_EQ(&normal, next_victim());
+  ASSERT_EQ(&accessed, next_victim());
+  ASSERT_FALSE(accessed.referenced());
+  ASSERT_EQ(nullptr, next_victim());
+}
+
+TEST(test_frame_manager, test_frame_manager_stats)
+{
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(1));
+
+  const int     buffer_pool_id = 1;
+  list<Frame *> used_list;
+  for (PageNum page_num = 0; used_list.size() < frame_manager.total_frame_num(); page_num++) {
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+    ASSERT_NE(nullptr, frame);
+    used_list.push_back(frame);
+  }
+  ASSERT_EQ(static_cast<int64_t>(used_list.size()), frame_manager.stats().misses.load());
+
+  Frame *frame = frame_manager.get(buffer_pool_id, 0);
+  ASSERT_NE(nullptr, frame);
+  frame->unpin();
+  ASSERT_EQ(nullptr, frame_manager.get(buffer_pool_id, -1));
+  ASSERT_EQ(1, frame_manager.stats().hits.load());
+
+  used_list.front()->mark_dirty();
+
+  unordered_map<int32_t, BPFrameManager::Residency> residency;
+  frame_manager.residency(residency);
+  ASSERT_EQ(1, residency.size());
+  ASSERT_EQ(static_cast<int>(used_list.size()), residency[buffer_pool_id].frames);
+  ASSERT_EQ(1, residency[buffer_pool_id].dirty);
+  ASSERT_EQ(static_cast<int>(used_list.size()), residency[buffer_pool_id].pinned);
+
+  // 所有页帧都被固定时无法淘汰
+  const PageNum new_page_num = static_cast<PageNum>(used_list.size());
+  ASSERT_EQ(0, frame_manager.purge_frames(FrameId(buffer_pool_id, new_page_num), 1, [](Frame *) { return RC::SUCCESS; }));
+  ASSERT_EQ(1, frame_manager.stats().pin_waits.load());
+
+  used_list.back()->unpin();
+  ASSERT_EQ(1, frame_manager.purge_frames(FrameId(buffer_pool_id, new_page_num), 1, [](Frame *) { return RC::SUCCESS; }));
+  ASSERT_EQ(1, frame_manager.stats().evictions.load());
+  used_list.pop_back();
+
+  for (Frame *frame : used_list) {
+    frame->clear_dirty();
+    ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, frame->page_num(), frame));
+  }
+  ASSERT_EQ(0, frame_manager.frame_num());
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_manager_resize)
+{
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(2, 2, nullptr, nullptr, nullptr, 4 /*max_pool_num*/));
+  ASSERT_EQ(2, frame_manager.pool_num());
+  ASSERT_EQ(4, frame_manager.max_pool_num());
+
+  int  flushed = 0;
+  auto flusher = [&flushed](Frame *frame) {
+    frame->clear_dirty();
+    flushed++;
+    return RC::SUCCESS;
+  };
+
+  ASSERT_EQ(RC::INVALID_ARGUMENT, frame_manager.resize(1, flusher));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, frame_manager.resize(5, flusher));
+
+  ASSERT_EQ(RC::SUCCESS, frame_manager.resize(4, flusher));
+  ASSERT_EQ(static_cast<size_t>(4 * DEFAULT_ITEM_NUM_PER_POOL), frame_manager.total_frame_num());
+
+  const int       buffer_pool_id = 1;
+  vector<Frame *> used_list;
+  for (PageNum page_num = 0; used_list.size() < frame_manager.total_frame_num(); page_num++) {
+    ASSERT_LT(page_num, static_cast<PageNum>(frame_manager.total_frame_num() * 10));
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+    if (frame != nullptr) {
+      frame->mark_dirty();
+      used_list.push_back(frame);
+    }
+  }
+
+  // 被固定的页帧不能淘汰，缩小失败
+  ASSERT_EQ(RC::LOCKED_CONCURRENCY_CONFLICT, frame_manager.resize(3, flusher));
+  ASSERT_EQ(4, frame_manager.pool_num());
+
+  for (Frame *frame : used_list) {
+    frame->unpin();
+  }
+
+  // 移除的两个内存池中的脏页都要先刷新
+  ASSERT_EQ(RC::SUCCESS, frame_manager.resize(2, flusher));
+  ASSERT_EQ(2, frame_manager.pool_num());
+  ASSERT_EQ(static_cast<size_t>(2 * DEFAULT_ITEM_NUM_PER_POOL), frame_manager.total_frame_num());
+  ASSERT_EQ(2 * DEFAULT_ITEM_NUM_PER_POOL, flushed);
+  ASSERT_EQ(static_cast<size_t>(2 * DEFAULT_ITEM_NUM_PER_POOL), frame_manager.frame_num());
+
+  // 缩小之后再扩展，页帧可以重新使用
+  ASSERT_EQ(RC::SUCCESS, frame_manager.resize(3, flusher));
+  Frame *frame = frame_manager.alloc(buffer_pool_id, -1);
+  ASSERT_NE(nullptr, frame);
+  ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, -1, frame));
+
+  for (Frame *frame : frame_manager.find_list(buffer_pool_id)) {
+    ASSERT_EQ(RC::SUCCESS, frame_manager.free(buffer_pool_id, frame->page_num(), frame));
+  }
+  ASSERT_EQ(0, frame_manager.frame_num());
+  frame_manager.cleanup();
+}
+
 int main(int argc, char **argv)
 {
 
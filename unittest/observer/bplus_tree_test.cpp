@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 #include "common/lang/memory.h"
 #include "common/lang/filesystem.h"
+#include "common/lang/thread.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/index/bplus_tree.h"
@@ -350,7 +351,9 @@ TEST(test_bplus_tree, test_leaf_index_node_handle)
           index_file_header.leaf_max_size));
   BplusTreeMiniTransaction mtr(tree_handler);
 
-  Frame frame;
+  Frame             frame;
+  std::vector<char> page_buffer(BP_PAGE_SIZE);
+  frame.set_page(reinterpret_cast<Page *>(page_buffer.data()), BP_PAGE_SIZE);
 
   KeyComparator key_comparator;
   key_comparator.init(AttrType::INTS, 4);
@@ -432,7 +435,9 @@ TEST(test_bplus_tree, test_internal_index_node_handle)
           index_file_header.leaf_max_size));
   BplusTreeMiniTransaction mtr(tree_handler);
 
-  Frame frame;
+  Frame             frame;
+  std::vector<char> page_buffer(BP_PAGE_SIZE);
+  frame.set_page(reinterpret_cast<Page *>(page_buffer.data()), BP_PAGE_SIZE);
 
   KeyComparator key_comparator;
   key_comparator.init(AttrType::INTS, 4);
@@ -568,6 +573,165 @@ TEST(test_bplus_tree, test_chars)
   ASSERT_EQ(2, count);
 }
 
+TEST(test_bplus_tree, test_multi_attrs)
+{
+  LoggerFactory::init_default("test_multi_attrs.log");
+
+  VacuousLogHandler log_handler;
+
+  filesystem::path test_directory("bplus_tree");
+  filesystem::path buffer_pool_file = test_directory / "multi_attrs.btree";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  // 键值是 (CHARS(4), INTS)
+  AttrType         attr_types[]   = {AttrType::CHARS, AttrType::INTS};
+  int              attr_lengths[] = {4, sizeof(int)};
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler, *buffer_pool, attr_types, attr_lengths, ORDER, ORDER));
+  ASSERT_EQ(2, handler.file_header().attr_num);
+  ASSERT_EQ(8, handler.file_header().attr_length);
+
+  const int record_num = 200;
+  auto      make_key   = [](int i, char *key) {
+    memset(key, 0, 8);
+    snprintf(key, 4, "k%d", i % 10);
+    memcpy(key + 4, &i, sizeof(i));
+  };
+
+  char key[8];
+  RID  rid;
+  for (int i = record_num - 1; i >= 0; i--) {
+    make_key(i, key);
+    rid.page_num = 0;
+    rid.slot_num = i;
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(key, &rid));
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  // 先按照第一个字段排序，再按照第二个字段排序
+  vector<int> expected_slots;
+  for (int i = 0; i < 10; i++) {
+    for (int j = i; j < record_num; j += 10) {
+      expected_slots.push_back(j);
+    }
+  }
+
+  vector<int> slots;
+  {
+    BplusTreeScanner scanner(handler);
+    ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, true, nullptr, 0, true));
+    while (RC::SUCCESS == scanner.next_entry(rid)) {
+      slots.push_back(rid.slot_num);
+    }
+  }
+  ASSERT_EQ(expected_slots, slots);
+
+  // [("k3", 53), ("k3", 143))
+  char left_key[8];
+  char right_key[8];
+  make_key(53, left_key);
+  make_key(143, right_key);
+  slots.clear();
+  {
+    BplusTreeScanner scanner(handler);
+    ASSERT_EQ(RC::SUCCESS, scanner.open(left_key, 8, true, right_key, 8, false));
+    while (RC::SUCCESS == scanner.next_entry(rid)) {
+      slots.push_back(rid.slot_num);
+    }
+  }
+  ASSERT_EQ(vector<int>({53, 63, 73, 83, 93, 103, 113, 123, 133}), slots);
+}
+
+TEST(test_bplus_tree, test_unique)
+{
+  LoggerFactory::init_default("test_unique.log");
+
+  VacuousLogHandler log_handler;
+
+  filesystem::path test_directory("bplus_tree");
+  filesystem::path buffer_pool_file = test_directory / "unique.btree";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  AttrType         attr_types[]   = {AttrType::INTS};
+  int              attr_lengths[] = {sizeof(int)};
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler, *buffer_pool, attr_types, attr_lengths, ORDER, ORDER, true));
+  ASSERT_TRUE(handler.file_header().unique);
+
+  const int record_num = 200;
+  RID       rid;
+  for (int i = 0; i < record_num; i++) {
+    rid.page_num = 2;
+    rid.slot_num = i;
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&i), &rid));
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  // 键值相同的数据，不管 RID 是否相同都不能插入
+  for (int i = 0; i < record_num; i += 7) {
+    rid.page_num = 3;
+    rid.slot_num = i;
+    ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, handler.insert_entry(reinterpret_cast<const char *>(&i), &rid));
+    rid.page_num = 2;
+    ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, handler.insert_entry(reinterpret_cast<const char *>(&i), &rid));
+  }
+
+  // 删除时 RID 必须匹配，不会删除其它记录的数据
+  int key      = 50;
+  rid.page_num = 3;
+  rid.slot_num = key;
+  ASSERT_EQ(RC::RECORD_NOT_EXIST, handler.delete_entry(reinterpret_cast<const char *>(&key), &rid));
+  rid.page_num = 2;
+  ASSERT_EQ(RC::SUCCESS, handler.delete_entry(reinterpret_cast<const char *>(&key), &rid));
+  rid.page_num = 3;
+  ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid));
+  ASSERT_TRUE(handler.validate_tree());
+
+  int         left_key  = 48;
+  int         right_key = 52;
+  vector<int> slots;
+  {
+    BplusTreeScanner scanner(handler);
+    ASSERT_EQ(RC::SUCCESS,
+        scanner.open(reinterpret_cast<const char *>(&left_key), sizeof(int), true,
+            reinterpret_cast<const char *>(&right_key), sizeof(int), false));
+    while (RC::SUCCESS == scanner.next_entry(rid)) {
+      slots.push_back(rid.page_num * 1000 + rid.slot_num);
+    }
+  }
+  ASSERT_EQ(vector<int>({2048, 2049, 3050, 2051}), slots);
+
+  slots.clear();
+  {
+    BplusTreeScanner scanner(handler);
+    ASSERT_EQ(RC::SUCCESS,
+        scanner.open(reinterpret_cast<const char *>(&left_key), sizeof(int), false,
+            reinterpret_cast<const char *>(&right_key), sizeof(int), true));
+    while (RC::SUCCESS == scanner.next_entry(rid)) {
+      slots.push_back(rid.page_num * 1000 + rid.slot_num);
+    }
+  }
+  ASSERT_EQ(vector<int>({2049, 3050, 2051, 2052}), slots);
+}
+
 TEST(test_bplus_tree, test_scanner)
 {
   LoggerFactory::init_default("test.log");
@@ -826,6 +990,88 @@ TEST(test_bplus_tree, test_bplus_tree_insert)
   handler = nullptr;
 }
 
+TEST(test_bplus_tree, test_bplus_tree_optimistic_read)
+{
+  filesystem::path test_directory("bplus_tree");
+  filesystem::path buffer_pool_file = test_directory / "test_bplus_tree_optimistic_read.btree";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  VacuousLogHandler log_handler;
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler, *buffer_pool, AttrType::INTS, sizeof(int), ORDER, ORDER));
+
+  // 偶数一直存在，读线程查找偶数的同时，写线程插入再删除奇数，让节点不断地分裂与合并
+  const int key_num      = 2000;
+  const int reader_num   = 4;
+  const int writer_num   = 2;
+  const int reader_loops = 5;
+  for (int key = 0; key < key_num; key += 2) {
+    RID rid(key / page_size, key % page_size);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&key, &rid));
+  }
+
+  atomic<int> errors{0};
+  auto        reader = [&]() {
+    for (int loop = 0; loop < reader_loops; loop++) {
+      for (int key = 0; key < key_num; key += 2) {
+        // 扫描到下一个叶子节点时加锁失败会返回 LOCKED_NEED_WAIT，由调用方重试
+        list<RID> rids;
+        RC        rc = RC::LOCKED_NEED_WAIT;
+        while (rc == RC::LOCKED_NEED_WAIT) {
+          rids.clear();
+          rc = handler.get_entry((const char *)&key, sizeof(key), rids);
+        }
+        if (OB_FAIL(rc) || rids.size() != 1 || rids.front() != RID(key / page_size, key % page_size)) {
+          errors++;
+        }
+      }
+    }
+  };
+  auto writer = [&](int index) {
+    for (int key = 1 + 2 * index; key < key_num; key += 2 * writer_num) {
+      RID rid(key / page_size, key % page_size);
+      if (OB_FAIL(handler.insert_entry((const char *)&key, &rid))) {
+        errors++;
+      }
+    }
+    for (int key = 1 + 2 * index; key < key_num; key += 2 * writer_num) {
+      RID rid(key / page_size, key % page_size);
+      if (OB_FAIL(handler.delete_entry((const char *)&key, &rid))) {
+        errors++;
+      }
+    }
+  };
+
+  vector<thread> threads;
+  for (int i = 0; i < reader_num; i++) {
+    threads.emplace_back(reader);
+  }
+  for (int i = 0; i < writer_num; i++) {
+    threads.emplace_back(writer, i);
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(0, errors.load());
+  ASSERT_TRUE(handler.validate_tree());
+
+  BplusTreeHandler::OptimisticStats &stats = handler.optimistic_stats();
+  LOG_INFO("optimistic read stats: success=%ld, conflict=%ld", stats.success.load(), stats.conflict.load());
+  ASSERT_GT(stats.success.load(), 0);
+
+  handler.close();
+}
+
 int main(int argc, char **argv)
 {
 
@@ -0,0 +1,136 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include <string.h>
+
+#include "storage/record/column_encoding.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+/**
+ * @brief 编码之后分别整列解码和逐个解码，结果都应该与原始数据相同
+ */
+static void check_round_trip(
+    AttrType type, int attr_len, const vector<char> &values, ColumnEncoding expected_encoding)
+{
+  const int    count = static_cast<int>(values.size()) / attr_len;
+  vector<char> encoded;
+  ASSERT_EQ(expected_encoding, ColumnEncoder::encode(type, attr_len, values.data(), count, encoded));
+  if (expected_encoding == ColumnEncoding::PLAIN) {
+    ASSERT_TRUE(encoded.empty());
+    return;
+  }
+  ASSERT_LT(encoded.size(), values.size());
+
+  vector<char> decoded(values.size());
+  ColumnEncoder::decode(expected_encoding, attr_len, encoded.data(), count, decoded.data());
+  ASSERT_EQ(0, memcmp(values.data(), decoded.data(), values.size()));
+
+  vector<char> value(attr_len);
+  for (int i = 0; i < count; i++) {
+    ColumnEncoder::decode_one(expected_encoding, attr_len, encoded.data(), i, value.data());
+    ASSERT_EQ(0, memcmp(values.data() + i * attr_len, value.data(), attr_len)) << "index=" << i;
+  }
+}
+
+static vector<char> make_ints(const vector<int32_t> &ints)
+{
+  vector<char> values(ints.size() * sizeof(int32_t));
+  memcpy(values.data(), ints.data(), values.size());
+  return values;
+}
+
+static vector<char> make_chars(const vector<string> &strings, int attr_len)
+{
+  vector<char> values(strings.size() * attr_len, 0);
+  for (size_t i = 0; i < strings.size(); i++) {
+    memcpy(values.data() + i * attr_len, strings[i].data(), min<size_t>(strings[i].size(), attr_len));
+  }
+  return values;
+}
+
+TEST(ColumnEncoding, for_bitpack)
+{
+  // 取值范围很小的整数
+  vector<int32_t> ints;
+  for (int i = 0; i < 1000; i++) {
+    ints.push_back(1000000 + (i * 7919) % 100);
+  }
+  check_round_trip(AttrType::INTS, 4, make_ints(ints), ColumnEncoding::FOR_BITPACK);
+
+  // 包含负数，并且差值超过 int32_t 的范围
+  ints.clear();
+  for (int i = 0; i < 1000; i++) {
+    ints.push_back(i % 2 == 0 ? INT32_MIN + i : INT32_MAX - i);
+  }
+  vector<char> encoded;
+  vector<char> values = make_ints(ints);
+  ASSERT_EQ(ColumnEncoding::PLAIN, ColumnEncoder::encode(AttrType::INTS, 4, values.data(), 1000, encoded));
+
+  // 有序的整数，行程编码无法压缩
+  ints.clear();
+  for (int i = 0; i < 1000; i++) {
+    ints.push_back(i - 500);
+  }
+  check_round_trip(AttrType::INTS, 4, make_ints(ints), ColumnEncoding::FOR_BITPACK);
+}
+
+TEST(ColumnEncoding, rle)
+{
+  vector<int32_t> ints;
+  for (int i = 0; i < 1000; i++) {
+    ints.push_back(i / 100 * 1000003);
+  }
+  check_round_trip(AttrType::INTS, 4, make_ints(ints), ColumnEncoding::RLE);
+
+  vector<char> floats(1000 * sizeof(float));
+  for (int i = 0; i < 1000; i++) {
+    float value = (i / 250) * 1.5f;
+    memcpy(floats.data() + i * sizeof(float), &value, sizeof(value));
+  }
+  check_round_trip(AttrType::FLOATS, 4, floats, ColumnEncoding::RLE);
+
+  // 所有值都相同
+  check_round_trip(AttrType::CHARS, 16, make_chars(vector<string>(500, "same value"), 16), ColumnEncoding::RLE);
+}
+
+TEST(ColumnEncoding, dictionary)
+{
+  const vector<string> cities = {"beijing", "shanghai", "hangzhou", "shenzhen", "chengdu"};
+  vector<string>       strings;
+  for (int i = 0; i < 1000; i++) {
+    strings.push_back(cities[(i * 31) % cities.size()]);
+  }
+  check_round_trip(AttrType::CHARS, 16, make_chars(strings, 16), ColumnEncoding::DICTIONARY);
+
+  // 值都不相同，无法压缩
+  strings.clear();
+  for (int i = 0; i < 1000; i++) {
+    strings.push_back("name_" + to_string(i * 7919));
+  }
+  check_round_trip(AttrType::CHARS, 16, make_chars(strings, 16), ColumnEncoding::PLAIN);
+}
+
+TEST(ColumnEncoding, single_value)
+{
+  check_round_trip(AttrType::INTS, 4, make_ints({42}), ColumnEncoding::PLAIN);
+  check_round_trip(AttrType::INTS, 4, make_ints(vector<int32_t>(100, -7)), ColumnEncoding::FOR_BITPACK);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
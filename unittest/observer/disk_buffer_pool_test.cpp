@@ -132,6 +132,321 @@ TEST(BufferPool, create)
   ASSERT_EQ(buffer_pool->id(), buffer_pool2->id());
 }
 
+TEST(BufferPool, prefetch)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "prefetch.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  // 预读的页面会成批提交给 io_uring
+  BufferPoolManager bpm(0 /*memory_size*/, 1 /*frame_shard_num*/, nullptr /*frame_replacer*/, "io_uring");
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>(), 8 /*prefetch_depth*/));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  const int page_num = 200;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    memcpy(frame->data(), &i, sizeof(i));
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  // 重新打开文件，所有的页面都不在内存中了
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  BufferPoolPrefetcher::Stats &stats = bpm.get_prefetcher().stats();
+  const int64_t                hit   = stats.hit.load();
+  const int64_t                miss  = stats.miss.load();
+
+  BufferPoolIterator iterator;
+  ASSERT_EQ(RC::SUCCESS, iterator.init(*buffer_pool, 1));
+  int count = 0;
+  while (iterator.has_next()) {
+    PageNum page = iterator.next();
+    iterator.prefetch();
+
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(page, &frame, BufferAccessHint::SEQUENTIAL));
+    frame->read_latch();
+    int value = -1;
+    memcpy(&value, frame->data(), sizeof(value));
+    frame->read_unlatch();
+    ASSERT_EQ(count, value);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+    count++;
+  }
+  ASSERT_EQ(page_num, count);
+
+  // 每个页面要么由预读线程加载，要么同步读取
+  ASSERT_EQ(page_num, stats.hit.load() - hit + stats.miss.load() - miss);
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, all_frames_pinned)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "all_frames_pinned.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  // 只有一个内存池，所有的页帧都在同一个分片中
+  BufferPoolManager bpm(1 /*memory_size*/, 1 /*frame_shard_num*/);
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+  const int frame_num = bpm.get_frame_manager().pool_num() * DEFAULT_ITEM_NUM_PER_POOL;
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  const int page_num = frame_num + 10;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  // 文件头页面一直被固定，其它页帧都固定之后，再获取新的页面要返回错误而不是一直等待
+  vector<Frame *> pinned_frames;
+  for (int i = 1; i < frame_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(i, &frame));
+    pinned_frames.push_back(frame);
+  }
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::BUFFERPOOL_NOBUF, buffer_pool->get_this_page(frame_num, &frame));
+
+  // 释放一个页帧之后就可以获取了
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(pinned_frames.back()));
+  pinned_frames.pop_back();
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(frame_num, &frame));
+  pinned_frames.push_back(frame);
+
+  for (Frame *pinned_frame : pinned_frames) {
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(pinned_frame));
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, dispose_pinned_page)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "dispose_pinned_page.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+
+  // 页面一直被固定时，释放页面要返回错误而不是一直等待
+  ASSERT_EQ(RC::LOCKED_CONCURRENCY_CONFLICT, buffer_pool->dispose_page(page_num));
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(page_num));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, page_cleaner)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "page_cleaner.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  // 只有一个内存池的页帧
+  BufferPoolManager bpm(BP_PAGE_SIZE * DEFAULT_ITEM_NUM_PER_POOL);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, bpm.get_page_cleaner().init(50, 60));
+  ASSERT_EQ(RC::SUCCESS,
+      bpm.init(make_unique<VacuousDoubleWriteBuffer>(), 0 /*prefetch_depth*/, 50 /*high*/, 20 /*low*/));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  BPFrameManager &frame_manager = bpm.get_frame_manager();
+  const int       total_num     = static_cast<int>(frame_manager.total_frame_num());
+  const int       page_num      = total_num * 3 / 4;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    frame->write_latch();
+    memcpy(frame->data(), &i, sizeof(i));
+    frame->mark_dirty();
+    frame->write_unlatch();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  // 后台线程可能已经刷过了
+  bpm.get_page_cleaner().clean();
+
+  vector<pair<LSN, FrameId>> dirty_frames;
+  frame_manager.dirty_frames(dirty_frames);
+  ASSERT_LE(static_cast<int>(dirty_frames.size()) * 100, total_num * 50);
+  ASSERT_GT(bpm.get_page_cleaner().stats().flushed.load(), 0);
+
+  // 刷下去的页面可以正确读回来
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(i + 1, &frame));
+    int value = -1;
+    memcpy(&value, frame->data(), sizeof(value));
+    ASSERT_EQ(i, value);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, page_cleaner_skip_closing)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "page_cleaner_skip_closing.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  const int page_num = 10;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  // 正在关闭的 buffer pool 还能从管理器中找到，但是刷脏时要跳过，由关闭的线程自己刷新
+  bpm.mark_closing(*buffer_pool);
+  DiskBufferPool *found = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.get_buffer_pool(buffer_pool->id(), found));
+  ASSERT_TRUE(found->closing());
+
+  int flushed = -1;
+  ASSERT_EQ(RC::SUCCESS, bpm.get_page_cleaner().flush_all(flushed));
+  ASSERT_EQ(0, flushed);
+
+  // 关闭之后 buffer pool 就从管理器中删除了
+  const int32_t buffer_pool_id = buffer_pool->id();
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->close_file());
+  ASSERT_EQ(RC::INTERNAL, bpm.get_buffer_pool(buffer_pool_id, found));
+}
+
+TEST(BufferPool, resize_sized_frame_managers)
+{
+  const int64_t     pool_size = static_cast<int64_t>(BP_PAGE_SIZE) * DEFAULT_ITEM_NUM_PER_POOL;
+  BufferPoolManager bpm(8 * pool_size);
+
+  BPFrameManager *frame_manager = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.get_frame_manager(BP_MIN_PAGE_SIZE, frame_manager));
+  auto expected_pool_num = [&](int64_t memory_size) {
+    const int64_t sized_pool_size = static_cast<int64_t>(BP_MIN_PAGE_SIZE) * DEFAULT_ITEM_NUM_PER_POOL;
+    return static_cast<int>(max(memory_size / BufferPoolManager::SIZED_FRAME_MEMORY_DIVISOR / sized_pool_size,
+                                (int64_t)1));
+  };
+  ASSERT_EQ(expected_pool_num(8 * pool_size), frame_manager->pool_num());
+
+  // 其它页面大小的页帧管理器按比例调整
+  ASSERT_EQ(RC::SUCCESS, bpm.resize(16 * pool_size));
+  ASSERT_EQ(16 * pool_size, bpm.memory_size());
+  ASSERT_EQ(expected_pool_num(16 * pool_size), frame_manager->pool_num());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.resize(4 * pool_size));
+  ASSERT_EQ(expected_pool_num(4 * pool_size), frame_manager->pool_num());
+}
+
+TEST(BufferPool, page_size)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  // 页面先写入 double write buffer，不同大小的页面在同一个共享文件中
+  auto bpm   = make_unique<BufferPoolManager>();
+  auto dblwr = make_unique<DiskDoubleWriteBuffer>(*bpm, 16 /*max_pages*/);
+  ASSERT_EQ(RC::SUCCESS, dblwr->open_file((test_directory / "dblwr.db").c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm->init(std::move(dblwr)));
+
+  ASSERT_EQ(RC::INVALID_ARGUMENT, bpm->create_file((test_directory / "invalid.bp").c_str(), 1000));
+  ASSERT_EQ(RC::INVALID_ARGUMENT, bpm->create_file((test_directory / "invalid.bp").c_str(), 2 * BP_MAX_PAGE_SIZE));
+
+  const int         page_sizes[] = {BP_MIN_PAGE_SIZE, 0, BP_MAX_PAGE_SIZE};
+  const int         page_num     = 50;
+  VacuousLogHandler log_handler;
+  for (int page_size : page_sizes) {
+    filesystem::path bp_file = test_directory / ("page_size_" + to_string(page_size) + ".bp");
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(bp_file.c_str(), page_size));
+
+    DiskBufferPool *buffer_pool = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, bp_file.c_str(), buffer_pool));
+    const int expected_size = page_size > 0 ? page_size : BP_PAGE_SIZE;
+    ASSERT_EQ(expected_size, buffer_pool->page_size());
+    ASSERT_EQ(expected_size, buffer_pool->frame_manager().page_size());
+
+    for (int i = 0; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+      ASSERT_EQ(expected_size, frame->page_size());
+      memset(frame->data(), i % 128, frame->data_size());
+      frame->mark_dirty();
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+    }
+    ASSERT_EQ(RC::SUCCESS, bpm->close_file(bp_file.c_str()));
+  }
+
+  // 重新启动，页面大小从文件头中读取
+  bpm   = make_unique<BufferPoolManager>();
+  dblwr = make_unique<DiskDoubleWriteBuffer>(*bpm, 16 /*max_pages*/);
+  ASSERT_EQ(RC::SUCCESS, dblwr->open_file((test_directory / "dblwr.db").c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm->init(std::move(dblwr)));
+  for (int page_size : page_sizes) {
+    filesystem::path bp_file = test_directory / ("page_size_" + to_string(page_size) + ".bp");
+
+    DiskBufferPool *buffer_pool = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, bp_file.c_str(), buffer_pool));
+    ASSERT_EQ(page_size > 0 ? page_size : BP_PAGE_SIZE, buffer_pool->page_size());
+    ASSERT_EQ(page_num, buffer_pool_page_count(buffer_pool));
+
+    for (int i = 0; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(i + 1, &frame));
+      ASSERT_EQ(i % 128, frame->data()[0]);
+      ASSERT_EQ(i % 128, frame->data()[frame->data_size() - 1]);
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+    }
+    ASSERT_EQ(RC::SUCCESS, bpm->close_file(bp_file.c_str()));
+  }
+
+  // 默认页面大小以外的每种页面大小有一个页帧管理器
+  int frame_manager_num = 0;
+  bpm->foreach_frame_manager([&frame_manager_num](BPFrameManager &) { frame_manager_num++; });
+  ASSERT_EQ(3, frame_manager_num);
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
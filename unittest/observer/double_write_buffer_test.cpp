@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai on 2024/04/19
 //
 
+#include <chrono>
 #include <filesystem>
 
 #include "gtest/gtest.h"
@@ -201,6 +202,89 @@ TEST(DoubleWriteBuffer, single_file_exception)
   bpm  = nullptr;
 }
 
+TEST(DoubleWriteBuffer, flush_throughput)
+{
+  /*
+  分配一批页面并修改，全部刷新到 double write buffer，比较不同批次大小下刷新的吞吐量。
+  每一批页面只需要 fsync 一次共享文件，以及一次页面所在的文件。
+  重新打开后检查页面内容是否正确
+  */
+  filesystem::path directory("double_write_buffer_test_throughput_dir");
+
+  const int page_num = 512;
+  for (int max_pages : {16, DiskDoubleWriteBuffer::DEFAULT_MAX_PAGES}) {
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+
+    filesystem::path buffer_pool_filename         = directory / "buffer_pool.bp";
+    filesystem::path double_write_buffer_filename = directory / "double_write_buffer.dwb";
+
+    auto              bpm = make_unique<BufferPoolManager>();
+    VacuousLogHandler log_handler;
+    auto              double_write_buffer = make_unique<DiskDoubleWriteBuffer>(*bpm, max_pages);
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer->open_file(double_write_buffer_filename.c_str()));
+    DiskDoubleWriteBuffer *dblwr_buffer = double_write_buffer.get();
+    ASSERT_EQ(bpm->init(std::move(double_write_buffer)), RC::SUCCESS);
+
+    DiskBufferPool *buffer_pool = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(buffer_pool_filename.c_str()));
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, buffer_pool_filename.c_str(), buffer_pool));
+
+    vector<PageNum> page_nums;
+    for (int i = 0; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+      memset(frame->data(), i % 128, BP_PAGE_DATA_SIZE);
+      frame->mark_dirty();
+      page_nums.push_back(frame->page_num());
+      frame->unpin();
+    }
+
+    // 分配页面时也可能刷新页面，只统计下面这次刷新
+    ASSERT_EQ(RC::SUCCESS, dblwr_buffer->flush_page());
+    DiskDoubleWriteBuffer::Stats &stats       = dblwr_buffer->stats();
+    const int64_t                 old_pages   = stats.pages.load();
+    const int64_t                 old_batches = stats.batches.load();
+    const int64_t                 old_fsyncs  = stats.fsyncs.load();
+    const int64_t                 old_bytes   = stats.bytes.load();
+
+    auto start = chrono::steady_clock::now();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->flush_all_pages());
+    ASSERT_EQ(RC::SUCCESS, dblwr_buffer->flush_page());
+    auto elapsed_us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+    const int64_t pages   = stats.pages.load() - old_pages;
+    const int64_t batches = stats.batches.load() - old_batches;
+    const int64_t fsyncs  = stats.fsyncs.load() - old_fsyncs;
+    const int64_t bytes   = stats.bytes.load() - old_bytes;
+    // 包括文件头页面
+    ASSERT_EQ(pages, page_num + 1);
+    ASSERT_EQ(batches, (page_num + max_pages) / max_pages);
+    ASSERT_EQ(fsyncs, 2 * batches);
+    cout << "double write buffer batch=" << max_pages << ": " << pages << " pages, " << batches << " batches, "
+         << fsyncs << " fsyncs, " << elapsed_us << "us, " << bytes / max(elapsed_us, (int64_t)1) << "MB/s" << endl;
+
+    bpm = nullptr;
+
+    bpm                 = make_unique<BufferPoolManager>();
+    double_write_buffer = make_unique<DiskDoubleWriteBuffer>(*bpm, max_pages);
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer->open_file(double_write_buffer_filename.c_str()));
+    ASSERT_EQ(bpm->init(std::move(double_write_buffer)), RC::SUCCESS);
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, buffer_pool_filename.c_str(), buffer_pool));
+
+    for (int i = 0; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(page_nums[i], &frame));
+      ASSERT_EQ(frame->data()[0], i % 128);
+      ASSERT_EQ(frame->data()[BP_PAGE_DATA_SIZE - 1], i % 128);
+      frame->unpin();
+    }
+    bpm = nullptr;
+  }
+
+  filesystem::remove_all(directory);
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -232,6 +232,40 @@ TEST(ArithmeticExpr, get_column)
   }
 }
 
+TEST(FieldExpr, get_column)
+{
+  // 表扫描只读取用到的列时，列在 chunk 中的位置与 field_id 不同
+  const int int_len = sizeof(int);
+  const int count   = 8;
+  auto      column1 = std::make_unique<Column>(AttrType::INTS, int_len, count);
+  auto      column2 = std::make_unique<Column>(AttrType::INTS, int_len, count);
+  for (int i = 0; i < count; ++i) {
+    int value1 = i;
+    int value2 = i * 10;
+    column1->append_one((char *)&value1);
+    column2->append_one((char *)&value2);
+  }
+  Chunk chunk;
+  chunk.add_column(std::move(column1), 3);
+  chunk.add_column(std::move(column2), 7);
+  ASSERT_EQ(chunk.find_column(3), 0);
+  ASSERT_EQ(chunk.find_column(7), 1);
+  ASSERT_EQ(chunk.find_column(0), -1);
+
+  FieldMeta field_meta("col7", AttrType::INTS, 0, int_len, true, 7);
+  FieldExpr field_expr(Field(nullptr, &field_meta));
+  Column    column;
+  ASSERT_EQ(field_expr.get_column(chunk, column), RC::SUCCESS);
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(column.get_value(i).get_int(), i * 10);
+  }
+
+  FieldMeta missing_field_meta("col5", AttrType::INTS, 0, int_len, true, 5);
+  FieldExpr missing_field_expr(Field(nullptr, &missing_field_meta));
+  Column    missing_column;
+  ASSERT_NE(missing_field_expr.get_column(chunk, missing_column), RC::SUCCESS);
+}
+
 TEST(ValueExpr, value_expr_test)
 {
   ValueExpr value_expr1(Value(1));
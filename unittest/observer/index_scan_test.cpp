@@ -0,0 +1,575 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include <filesystem>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/index_scan_physical_operator.h"
+#include "sql/operator/table_get_logical_operator.h"
+#include "sql/optimizer/physical_plan_generator.h"
+#include "storage/db/db.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace common;
+
+/**
+ * @brief 表 t(id, value, score)，id 和 value 上有索引，score 上没有索引
+ * @details id 从 0 到 record_num_ - 1，value 是 id % 100
+ */
+class IndexScanTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directories(test_directory_);
+
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("index_scan_db", test_directory_.c_str(), "vacuous", "vacuous"));
+
+    vector<AttrInfoSqlNode> attr_infos(3);
+    attr_infos[0].name   = "id";
+    attr_infos[0].type   = AttrType::INTS;
+    attr_infos[0].length = 4;
+    attr_infos[1].name   = "value";
+    attr_infos[1].type   = AttrType::INTS;
+    attr_infos[1].length = 4;
+    attr_infos[2].name   = "score";
+    attr_infos[2].type   = AttrType::INTS;
+    attr_infos[2].length = 4;
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", attr_infos));
+    table_ = db_->find_table("t");
+    ASSERT_NE(nullptr, table_);
+
+    trx_ = db_->trx_kit().create_trx(db_->log_handler());
+    ASSERT_EQ(RC::SUCCESS, table_->create_index(trx_, {table_->table_meta().field("id")}, "t_id"));
+    ASSERT_EQ(RC::SUCCESS, table_->create_index(trx_, {table_->table_meta().field("value")}, "t_value"));
+
+    for (int i = 0; i < record_num_; i++) {
+      Value  values[3] = {Value(i), Value(i % 100), Value(i)};
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table_->make_record(3, values, record));
+      ASSERT_EQ(RC::SUCCESS, table_->insert_record(record));
+    }
+  }
+
+  void TearDown() override
+  {
+    db_->trx_kit().destroy_trx(trx_);
+    db_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  unique_ptr<Expression> compare(const char *field_name, CompOp comp, const Value &value, bool value_on_left = false)
+  {
+    auto field_expr = make_unique<FieldExpr>(table_, table_->table_meta().field(field_name));
+    auto value_expr = make_unique<ValueExpr>(value);
+    if (value_on_left) {
+      return make_unique<ComparisonExpr>(comp, std::move(value_expr), std::move(field_expr));
+    }
+    return make_unique<ComparisonExpr>(comp, std::move(field_expr), std::move(value_expr));
+  }
+
+  /**
+   * @brief 生成物理计划并执行，返回查询到的 id。执行之后清空 predicates
+   */
+  void run(vector<unique_ptr<Expression>> &predicates, unique_ptr<PhysicalOperator> &oper, vector<int> &ids)
+  {
+    TableGetLogicalOperator table_get_oper(table_, ReadWriteMode::READ_ONLY);
+    table_get_oper.set_predicates(std::move(predicates));
+    predicates.clear();
+
+    PhysicalPlanGenerator generator;
+    ASSERT_EQ(RC::SUCCESS, generator.create(table_get_oper, oper));
+
+    ids.clear();
+    ASSERT_EQ(RC::SUCCESS, oper->open(trx_));
+    RC rc = RC::SUCCESS;
+    while (OB_SUCC(rc = oper->next())) {
+      Value value;
+      ASSERT_EQ(RC::SUCCESS, oper->current_tuple()->find_cell(TupleCellSpec("t", "id"), value));
+      ids.push_back(value.get_int());
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    ASSERT_EQ(RC::SUCCESS, oper->close());
+  }
+
+  static vector<int> range(int begin, int end)
+  {
+    vector<int> ids;
+    for (int i = begin; i < end; i++) {
+      ids.push_back(i);
+    }
+    return ids;
+  }
+
+protected:
+  filesystem::path test_directory_ = "index_scan_test";
+  const int        record_num_     = 1000;
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+  Trx             *trx_   = nullptr;
+};
+
+TEST_F(IndexScanTest, single_bound)
+{
+  unique_ptr<PhysicalOperator> oper;
+  vector<int>                  ids;
+
+  vector<unique_ptr<Expression>> predicates;
+  predicates.push_back(compare("id", LESS_THAN, Value(10)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_EQ(range(0, 10), ids);
+
+  predicates.push_back(compare("id", GREAT_EQUAL, Value(990)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_EQ(range(990, 1000), ids);
+
+  // 值在左边：995 < id
+  predicates.push_back(compare("id", LESS_THAN, Value(995), true /*value_on_left*/));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_EQ(range(996, 1000), ids);
+}
+
+TEST_F(IndexScanTest, merge_bounds)
+{
+  unique_ptr<PhysicalOperator> oper;
+  vector<int>                  ids;
+
+  // id > 100 and id >= 200 and id <= 300 and id < 250，相当于 id between 200 and 249
+  vector<unique_ptr<Expression>> predicates;
+  predicates.push_back(compare("id", GREAT_THAN, Value(100)));
+  predicates.push_back(compare("id", GREAT_EQUAL, Value(200)));
+  predicates.push_back(compare("id", LESS_EQUAL, Value(300)));
+  predicates.push_back(compare("id", LESS_THAN, Value(250)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_EQ(range(200, 250), ids);
+
+  // 相同的值上同时有开区间和闭区间，使用开区间
+  predicates.push_back(compare("id", GREAT_EQUAL, Value(500)));
+  predicates.push_back(compare("id", GREAT_THAN, Value(500)));
+  predicates.push_back(compare("id", LESS_THAN, Value(505)));
+  predicates.push_back(compare("id", LESS_EQUAL, Value(505)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_EQ(range(501, 505), ids);
+
+  // 范围是空的
+  predicates.push_back(compare("id", GREAT_THAN, Value(600)));
+  predicates.push_back(compare("id", LESS_THAN, Value(500)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_TRUE(ids.empty());
+
+  predicates.push_back(compare("id", GREAT_THAN, Value(600)));
+  predicates.push_back(compare("id", LESS_EQUAL, Value(600)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_TRUE(ids.empty());
+}
+
+TEST_F(IndexScanTest, choose_index)
+{
+  unique_ptr<PhysicalOperator> oper;
+  vector<int>                  ids;
+
+  // value 上是等值条件，优先使用 t_value
+  vector<unique_ptr<Expression>> predicates;
+  predicates.push_back(compare("id", GREAT_THAN, Value(500)));
+  predicates.push_back(compare("value", EQUAL_TO, Value(7)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_EQ(string("t_value ON t"), oper->param());
+  sort(ids.begin(), ids.end());
+  ASSERT_EQ(vector<int>({507, 607, 707, 807, 907}), ids);
+
+  // id 上有两个边界，value 上只有一个边界
+  predicates.push_back(compare("value", GREAT_THAN, Value(10)));
+  predicates.push_back(compare("id", GREAT_THAN, Value(100)));
+  predicates.push_back(compare("id", LESS_THAN, Value(120)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_EQ(string("t_id ON t"), oper->param());
+  ASSERT_EQ(range(111, 120), ids);
+
+  // name 上没有索引，不等于不能使用索引，类型与字段不同的值也不能使用索引
+  predicates.push_back(compare("score", EQUAL_TO, Value(3)));
+  predicates.push_back(compare("id", NOT_EQUAL, Value(4)));
+  predicates.push_back(compare("value", LESS_THAN, Value(3.5f)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::TABLE_SCAN, oper->type());
+  ASSERT_EQ(vector<int>({3}), ids);
+}
+
+TEST_F(IndexScanTest, composite_index)
+{
+  const TableMeta &table_meta = table_->table_meta();
+  ASSERT_EQ(RC::SUCCESS,
+      table_->create_index(trx_, {table_meta.field("value"), table_meta.field("score")}, "t_value_score"));
+
+  unique_ptr<PhysicalOperator> oper;
+  vector<int>                  ids;
+
+  // 只有第一个字段上有条件时，与 t_value 的分数相同，使用先创建的 t_value
+  vector<unique_ptr<Expression>> predicates;
+  predicates.push_back(compare("value", EQUAL_TO, Value(7)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(string("t_value ON t"), oper->param());
+  ASSERT_EQ(vector<int>({7, 107, 207, 307, 407, 507, 607, 707, 807, 907}), ids);
+
+  // 第一个字段等值，第二个字段是范围
+  predicates.push_back(compare("value", EQUAL_TO, Value(7)));
+  predicates.push_back(compare("score", GREAT_THAN, Value(500)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(string("t_value_score ON t"), oper->param());
+  ASSERT_EQ(vector<int>({507, 607, 707, 807, 907}), ids);
+
+  predicates.push_back(compare("score", LESS_EQUAL, Value(307)));
+  predicates.push_back(compare("value", EQUAL_TO, Value(7)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(string("t_value_score ON t"), oper->param());
+  ASSERT_EQ(vector<int>({7, 107, 207, 307}), ids);
+
+  // 所有字段都是等值条件
+  predicates.push_back(compare("value", EQUAL_TO, Value(7)));
+  predicates.push_back(compare("score", EQUAL_TO, Value(307)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(string("t_value_score ON t"), oper->param());
+  ASSERT_EQ(vector<int>({307}), ids);
+
+  // 第一个字段不是等值条件时，第二个字段上的条件不能用来缩小范围
+  predicates.push_back(compare("value", GREAT_EQUAL, Value(98)));
+  predicates.push_back(compare("score", LESS_THAN, Value(200)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(PhysicalOperatorType::INDEX_SCAN, oper->type());
+  ASSERT_EQ(vector<int>({98, 198, 99, 199}), ids);
+
+  // 补齐之后范围是空的
+  predicates.push_back(compare("value", EQUAL_TO, Value(7)));
+  predicates.push_back(compare("score", LESS_THAN, Value(numeric_limits<int>::min())));
+  run(predicates, oper, ids);
+  ASSERT_EQ(string("t_value_score ON t"), oper->param());
+  ASSERT_TRUE(ids.empty());
+
+  // 插入和删除记录时会维护联合索引
+  Value  values[3] = {Value(record_num_), Value(7), Value(300)};
+  Record record;
+  ASSERT_EQ(RC::SUCCESS, table_->make_record(3, values, record));
+  ASSERT_EQ(RC::SUCCESS, table_->insert_record(record));
+
+  predicates.push_back(compare("value", EQUAL_TO, Value(7)));
+  predicates.push_back(compare("score", GREAT_EQUAL, Value(207)));
+  predicates.push_back(compare("score", LESS_EQUAL, Value(307)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(vector<int>({207, record_num_, 307}), ids);
+
+  ASSERT_EQ(RC::SUCCESS, table_->delete_record(record));
+  predicates.push_back(compare("value", EQUAL_TO, Value(7)));
+  predicates.push_back(compare("score", GREAT_EQUAL, Value(207)));
+  predicates.push_back(compare("score", LESS_EQUAL, Value(307)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(vector<int>({207, 307}), ids);
+}
+
+TEST_F(IndexScanTest, reopen_composite_index)
+{
+  const TableMeta &table_meta = table_->table_meta();
+  ASSERT_EQ(RC::SUCCESS,
+      table_->create_index(trx_, {table_meta.field("score"), table_meta.field("value")}, "t_score_value"));
+
+  db_->trx_kit().destroy_trx(trx_);
+  db_.reset();
+
+  db_ = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db_->init("index_scan_db", test_directory_.c_str(), "vacuous", "vacuous"));
+  table_ = db_->find_table("t");
+  ASSERT_NE(nullptr, table_);
+  trx_ = db_->trx_kit().create_trx(db_->log_handler());
+
+  const IndexMeta *index_meta = table_->table_meta().index("t_score_value");
+  ASSERT_NE(nullptr, index_meta);
+  ASSERT_EQ(vector<string>({"score", "value"}), index_meta->fields());
+  ASSERT_EQ(vector<string>({"id"}), table_->table_meta().index("t_id")->fields());
+
+  unique_ptr<PhysicalOperator>   oper;
+  vector<int>                    ids;
+  vector<unique_ptr<Expression>> predicates;
+  predicates.push_back(compare("score", EQUAL_TO, Value(123)));
+  predicates.push_back(compare("value", EQUAL_TO, Value(23)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(string("t_score_value ON t"), oper->param());
+  ASSERT_EQ(vector<int>({123}), ids);
+}
+
+TEST_F(IndexScanTest, unique_index)
+{
+  const TableMeta &table_meta = table_->table_meta();
+
+  // value 上有重复的数据，不能创建唯一索引。失败之后可以使用相同的名字重新创建
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, table_->create_index(trx_, {table_meta.field("value")}, "t_unique", true));
+  ASSERT_EQ(nullptr, table_->table_meta().index("t_unique"));
+  ASSERT_EQ(RC::SUCCESS, table_->create_index(trx_, {table_meta.field("score")}, "t_unique", true));
+  ASSERT_TRUE(table_->table_meta().index("t_unique")->unique());
+
+  // score 重复的记录插入失败，也不会影响原来的数据
+  Value  values[3] = {Value(record_num_), Value(0), Value(500)};
+  Record record;
+  ASSERT_EQ(RC::SUCCESS, table_->make_record(3, values, record));
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, table_->insert_record(record));
+
+  unique_ptr<PhysicalOperator>   oper;
+  vector<int>                    ids;
+  vector<unique_ptr<Expression>> predicates;
+  predicates.push_back(compare("score", EQUAL_TO, Value(500)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(string("t_unique ON t"), oper->param());
+  ASSERT_EQ(vector<int>({500}), ids);
+
+  // 插入失败时，其它索引中的数据也回滚了
+  predicates.push_back(compare("value", EQUAL_TO, Value(0)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(vector<int>({0, 100, 200, 300, 400, 500, 600, 700, 800, 900}), ids);
+
+  // 唯一索引上的等值查询优先于其它的等值查询
+  predicates.push_back(compare("id", EQUAL_TO, Value(321)));
+  predicates.push_back(compare("score", EQUAL_TO, Value(321)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(string("t_unique ON t"), oper->param());
+  ASSERT_EQ(vector<int>({321}), ids);
+
+  // 删除之后可以重新插入
+  Value  new_values[3] = {Value(record_num_), Value(1), Value(record_num_)};
+  Record new_record;
+  ASSERT_EQ(RC::SUCCESS, table_->make_record(3, new_values, new_record));
+  ASSERT_EQ(RC::SUCCESS, table_->insert_record(new_record));
+  ASSERT_EQ(RC::SUCCESS, table_->make_record(3, new_values, record));
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, table_->insert_record(record));
+  ASSERT_EQ(RC::SUCCESS, table_->delete_record(new_record));
+  ASSERT_EQ(RC::SUCCESS, table_->insert_record(record));
+
+  predicates.push_back(compare("score", GREAT_EQUAL, Value(record_num_ - 1)));
+  run(predicates, oper, ids);
+  ASSERT_EQ(vector<int>({record_num_ - 1, record_num_}), ids);
+}
+
+TEST(UniqueIndex, mvcc_delete_and_reinsert)
+{
+  filesystem::path test_directory = "unique_index_mvcc_test";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directories(test_directory);
+
+  auto db = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db->init("unique_index_db", test_directory.c_str(), "mvcc", "vacuous"));
+
+  vector<AttrInfoSqlNode> attr_infos(2);
+  attr_infos[0].name   = "k";
+  attr_infos[0].type   = AttrType::INTS;
+  attr_infos[0].length = 4;
+  attr_infos[1].name   = "v";
+  attr_infos[1].type   = AttrType::INTS;
+  attr_infos[1].length = 4;
+  ASSERT_EQ(RC::SUCCESS, db->create_table("t", attr_infos));
+  Table *table = db->find_table("t");
+  ASSERT_NE(nullptr, table);
+
+  TrxKit &trx_kit = db->trx_kit();
+  Trx    *trx     = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, table->create_index(trx, {table->table_meta().field("k")}, "t_k", true));
+  trx_kit.destroy_trx(trx);
+  Index *index = table->find_index("t_k");
+  ASSERT_NE(nullptr, index);
+
+  auto insert = [&](Trx *trx, int k, int v, Record &record) {
+    Value values[2] = {Value(k), Value(v)};
+    RC    rc        = table->make_record(2, values, record);
+    return OB_SUCC(rc) ? trx->insert_record(table, record) : rc;
+  };
+
+  Record record;
+  trx = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, insert(trx, 5, 1, record));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  trx_kit.destroy_trx(trx);
+
+  // 删除还没有提交时，其它事务不能插入相同键值的数据
+  Trx *delete_trx = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, delete_trx->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, delete_trx->delete_record(table, record));
+
+  Record new_record;
+  trx = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, insert(trx, 5, 2, new_record));
+
+  // 删除提交之后，删除之前开始的事务仍然能看到旧的记录，不能清理旧的索引数据
+  ASSERT_EQ(RC::SUCCESS, delete_trx->commit());
+  trx_kit.destroy_trx(delete_trx);
+  Trx *writer = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, insert(writer, 5, 2, new_record));
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, insert(trx, 5, 2, new_record));
+
+  list<RID> rids;
+  ASSERT_EQ(RC::SUCCESS, index->get_entries(record.data(), rids));
+  ASSERT_EQ(1, static_cast<int>(rids.size()));
+  ASSERT_EQ(record.rid(), rids.front());
+  Record old_record;
+  ASSERT_EQ(RC::SUCCESS, table->get_record(rids.front(), old_record));
+  ASSERT_EQ(RC::SUCCESS, trx->visit_record(table, old_record, ReadWriteMode::READ_ONLY));
+
+  // 旧的事务结束之后，旧的索引数据会被替换掉
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  trx_kit.destroy_trx(trx);
+  ASSERT_EQ(RC::SUCCESS, insert(writer, 5, 2, new_record));
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  trx_kit.destroy_trx(writer);
+
+  rids.clear();
+  ASSERT_EQ(RC::SUCCESS, index->get_entries(new_record.data(), rids));
+  ASSERT_EQ(1, static_cast<int>(rids.size()));
+  ASSERT_EQ(new_record.rid(), rids.front());
+
+  // 新插入的数据还没有删除，仍然不能插入相同键值的数据
+  Record another_record;
+  trx = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, insert(trx, 5, 3, another_record));
+  ASSERT_EQ(RC::SUCCESS, insert(trx, 6, 3, another_record));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  trx_kit.destroy_trx(trx);
+
+  // 同一个事务删除之后再插入相同键值的数据，回滚之后恢复旧的索引数据
+  trx = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, trx->delete_record(table, new_record));
+  ASSERT_EQ(RC::SUCCESS, insert(trx, 5, 4, another_record));
+  rids.clear();
+  ASSERT_EQ(RC::SUCCESS, index->get_entries(another_record.data(), rids));
+  ASSERT_EQ(1, static_cast<int>(rids.size()));
+  ASSERT_EQ(another_record.rid(), rids.front());
+  ASSERT_EQ(RC::SUCCESS, trx->rollback());
+  trx_kit.destroy_trx(trx);
+
+  rids.clear();
+  ASSERT_EQ(RC::SUCCESS, index->get_entries(new_record.data(), rids));
+  ASSERT_EQ(1, static_cast<int>(rids.size()));
+  ASSERT_EQ(new_record.rid(), rids.front());
+
+  // 其它事务还能看到自己删除的记录时，不能清理
+  trx = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  Trx *reader = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, trx->delete_record(table, new_record));
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, insert(trx, 5, 4, another_record));
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+  trx_kit.destroy_trx(reader);
+
+  ASSERT_EQ(RC::SUCCESS, insert(trx, 5, 4, another_record));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  trx_kit.destroy_trx(trx);
+
+  rids.clear();
+  ASSERT_EQ(RC::SUCCESS, index->get_entries(another_record.data(), rids));
+  ASSERT_EQ(1, static_cast<int>(rids.size()));
+  ASSERT_EQ(another_record.rid(), rids.front());
+
+  db.reset();
+  filesystem::remove_all(test_directory);
+}
+
+TEST(CompositeIndex, truncated_char_bound)
+{
+  filesystem::path test_directory = "composite_index_char_test";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directories(test_directory);
+
+  auto db = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db->init("composite_index_db", test_directory.c_str(), "vacuous", "vacuous"));
+
+  vector<AttrInfoSqlNode> attr_infos(2);
+  attr_infos[0].name   = "name";
+  attr_infos[0].type   = AttrType::CHARS;
+  attr_infos[0].length = 4;
+  attr_infos[1].name   = "num";
+  attr_infos[1].type   = AttrType::INTS;
+  attr_infos[1].length = 4;
+  ASSERT_EQ(RC::SUCCESS, db->create_table("t", attr_infos));
+  Table *table = db->find_table("t");
+  ASSERT_NE(nullptr, table);
+
+  Trx *trx = db->trx_kit().create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS,
+      table->create_index(trx, {table->table_meta().field("name"), table->table_meta().field("num")}, "t_name_num"));
+  db->trx_kit().destroy_trx(trx);
+  Index *index = table->find_index("t_name_num");
+  ASSERT_NE(nullptr, index);
+
+  // 最后一个字节是 0xFF 的字符串，截断之后作为边界时不能加一
+  const vector<string> names = {"AB", "AB\xFF", "AB\xFF\xFF", "AC"};
+  vector<RID>          rids;
+  for (size_t i = 0; i < names.size(); i++) {
+    Value  values[2] = {Value(names[i].c_str()), Value(static_cast<int>(i))};
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->make_record(2, values, record));
+    ASSERT_EQ(RC::SUCCESS, table->insert_record(record));
+    rids.push_back(record.rid());
+  }
+
+  auto scan = [&](const Value *left, const Value *right) {
+    span<const Value> left_values  = left == nullptr ? span<const Value>() : span<const Value>(left, 1);
+    span<const Value> right_values = right == nullptr ? span<const Value>() : span<const Value>(right, 1);
+
+    vector<RID>   result;
+    IndexScanner *scanner = index->create_scanner(left_values, false, right_values, false);
+    EXPECT_NE(nullptr, scanner);
+    if (scanner == nullptr) {
+      return result;
+    }
+    RID rid;
+    while (OB_SUCC(scanner->next_entry(&rid))) {
+      result.push_back(rid);
+    }
+    scanner->destroy();
+    return result;
+  };
+
+  // name > 'AB\xFF\xFF1'
+  const Value long_value("AB\xFF\xFF" "1");
+  ASSERT_EQ(vector<RID>({rids[3]}), scan(&long_value, nullptr));
+  // name < 'AB\xFF\xFF1'
+  ASSERT_EQ(vector<RID>({rids[0], rids[1], rids[2]}), scan(nullptr, &long_value));
+
+  db.reset();
+  filesystem::remove_all(test_directory);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_INFO);
+  return RUN_ALL_TESTS();
+}
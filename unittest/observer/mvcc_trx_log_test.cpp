@@ -13,7 +13,9 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <memory>
 #include <vector>
 #include <string>
@@ -24,8 +26,10 @@ See the Mulan PSL v2 for more details. */
 #include "gtest/gtest.h"
 #include "storage/db/db.h"
 #include "storage/table/table.h"
+#include "storage/index/index.h"
 #include "storage/record/record.h"
 #include "storage/trx/mvcc_trx.h"
+#include "storage/common/meta_util.h"
 #include "common/thread/thread_pool_executor.h"
 
 using namespace std;
@@ -715,6 +719,282 @@ TEST(MvccTrxLog, wal_rollback_abnormal)
   db.reset();
 }
 
+/// 读取数据库元数据文件中记录的检查点LSN
+static LSN read_check_point_lsn(const filesystem::path &db_path, const char *dbname)
+{
+  ifstream meta_file(db_meta_file(db_path.c_str(), dbname));
+  LSN      lsn = 0;
+  meta_file >> lsn;
+  return lsn;
+}
+
+/// 使用指定目录恢复数据库，返回恢复花费的时间以及每张表可见的记录数
+static void recover_db(const filesystem::path &db_path, const char *dbname, const vector<string> &table_names,
+    chrono::microseconds &recover_time, vector<int> &visible_counts)
+{
+  auto start = chrono::steady_clock::now();
+  auto db    = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db->init(dbname, db_path.c_str(), "mvcc", "disk"));
+  recover_time = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+
+  Trx *trx = db->trx_kit().create_trx(db->log_handler());
+  trx->start_if_need();
+  for (const string &table_name : table_names) {
+    Table *table = db->find_table(table_name.c_str());
+    ASSERT_NE(table, nullptr);
+
+    RecordFileScanner scanner;
+    ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, nullptr, ReadWriteMode::READ_ONLY));
+    int    visible_count = 0;
+    Record record;
+    while (OB_SUCC(scanner.next(record))) {
+      if (OB_SUCC(trx->visit_record(table, record, ReadWriteMode::READ_ONLY))) {
+        visible_count++;
+      }
+    }
+    visible_counts.push_back(visible_count);
+  }
+  db->trx_kit().destroy_trx(trx);
+}
+
+TEST(MvccTrxLog, wal_batch_insert)
+{
+  /*
+  创建一个带索引的表，在一个事务中批量插入一些数据并提交，在另一个事务中批量插入一些数据并回滚。
+  检查索引中的数据，然后从日志中恢复出一个新的数据库，检查记录是否一致。
+  */
+  filesystem::path test_directory("mvcc_trx_log_test_batch_insert");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const char      *dbname           = "test_db";
+  const char      *dbname2          = "test_db2";
+  filesystem::path db_path          = test_directory / dbname;
+  filesystem::path db_path2         = test_directory / dbname2;
+  const char      *trx_kit_name     = "mvcc";
+  const char      *log_handler_name = "disk";
+
+  filesystem::create_directories(db_path);
+  filesystem::create_directories(db_path2);
+
+  auto db = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db->init(dbname, db_path.c_str(), trx_kit_name, log_handler_name));
+
+  vector<AttrInfoSqlNode> attr_infos(2);
+  attr_infos[0].name   = "id";
+  attr_infos[0].type   = AttrType::INTS;
+  attr_infos[0].length = 4;
+  attr_infos[1].name   = "value";
+  attr_infos[1].type   = AttrType::INTS;
+  attr_infos[1].length = 4;
+  ASSERT_EQ(RC::SUCCESS, db->create_table("t", attr_infos));
+
+  Table *table = db->find_table("t");
+  ASSERT_NE(table, nullptr);
+
+  TrxKit &trx_kit = db->trx_kit();
+  Trx    *trx     = trx_kit.create_trx(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, table->create_index(trx, {table->table_meta().field("id")}, "t_id"));
+  trx_kit.destroy_trx(trx);
+  ASSERT_EQ(RC::SUCCESS, db->sync());
+
+  // id 按照倒序插入
+  auto make_records = [table](int begin, int end, vector<Record> &records) {
+    records.resize(end - begin);
+    for (int i = begin; i < end; i++) {
+      Value values[2] = {Value(end - 1 - i + begin), Value(i)};
+      ASSERT_EQ(RC::SUCCESS, table->make_record(2, values, records[i - begin]));
+    }
+  };
+
+  const int      commit_num   = 1000;
+  const int      rollback_num = 500;
+  vector<Record> records;
+
+  trx = trx_kit.create_trx(db->log_handler());
+  trx->start_if_need();
+  make_records(0, commit_num, records);
+  ASSERT_EQ(RC::SUCCESS, trx->insert_records(table, records));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  trx_kit.destroy_trx(trx);
+
+  trx = trx_kit.create_trx(db->log_handler());
+  trx->start_if_need();
+  make_records(commit_num, commit_num + rollback_num, records);
+  ASSERT_EQ(RC::SUCCESS, trx->insert_records(table, records));
+  ASSERT_EQ(RC::SUCCESS, trx->rollback());
+  trx_kit.destroy_trx(trx);
+
+  // 回滚的记录也从索引中删除了，剩下的记录按照 id 排序
+  Index *index = table->find_index("t_id");
+  ASSERT_NE(index, nullptr);
+  IndexScanner *index_scanner = index->create_scanner(nullptr, 0, true, nullptr, 0, true);
+  ASSERT_NE(index_scanner, nullptr);
+  int index_count = 0;
+  RID rid;
+  while (OB_SUCC(index_scanner->next_entry(&rid))) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->get_record(rid, record));
+    const int id = *reinterpret_cast<const int *>(record.data() + table->table_meta().field("id")->offset());
+    ASSERT_EQ(index_count, id);
+    index_count++;
+  }
+  index_scanner->destroy();
+  ASSERT_EQ(commit_num, index_count);
+
+  DiskLogHandler &log_handler = static_cast<DiskLogHandler &>(db->log_handler());
+  ASSERT_EQ(RC::SUCCESS, log_handler.wait_lsn(log_handler.current_lsn()));
+
+  filesystem::copy(db_path, db_path2, filesystem::copy_options::recursive);
+
+  auto db2 = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db2->init(dbname2, db_path2.c_str(), trx_kit_name, log_handler_name));
+  Table *table2 = db2->find_table("t");
+  ASSERT_NE(table2, nullptr);
+
+  Trx *trx2 = db2->trx_kit().create_trx(db2->log_handler());
+  trx2->start_if_need();
+  RecordFileScanner scanner2;
+  ASSERT_EQ(RC::SUCCESS, table2->get_record_scanner(scanner2, nullptr, ReadWriteMode::READ_ONLY));
+  int    visible_count = 0;
+  Record record;
+  while (OB_SUCC(scanner2.next(record))) {
+    if (OB_SUCC(trx2->visit_record(table2, record, ReadWriteMode::READ_ONLY))) {
+      visible_count++;
+    }
+  }
+  ASSERT_EQ(commit_num, visible_count);
+  db2->trx_kit().destroy_trx(trx2);
+
+  db2.reset();
+  db.reset();
+}
+
+TEST(MvccTrxLog, fuzzy_checkpoint)
+{
+  /*
+  插入一批数据后，在一个事务还没有结束的时候做检查点，然后再插入一些数据。
+  分别复制检查点之前和之后的数据库文件，比较从两个副本恢复需要重放的日志条数和花费的时间。
+  没有结束的事务在检查点之前写了日志，从检查点恢复时也要能回滚它。
+  */
+  filesystem::path test_directory("mvcc_trx_log_test");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const char      *dbname          = "test_db";
+  filesystem::path db_path         = test_directory / dbname;
+  filesystem::path no_ckpt_db_path = test_directory / "no_checkpoint";
+  filesystem::path ckpt_db_path    = test_directory / "checkpoint";
+  filesystem::create_directories(db_path);
+
+  auto db = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db->init(dbname, db_path.c_str(), "mvcc", "disk"));
+
+  const int      table_num = 2;
+  vector<string> table_names;
+  for (int i = 0; i < table_num; i++) {
+    table_names.push_back("table_" + to_string(i));
+  }
+
+  const int               field_num = 4;
+  vector<AttrInfoSqlNode> attr_infos;
+  for (int i = 0; i < field_num; i++) {
+    AttrInfoSqlNode attr_info;
+    attr_info.name   = string("field_") + to_string(i);
+    attr_info.type   = AttrType::INTS;
+    attr_info.length = 4;
+    attr_infos.push_back(attr_info);
+  }
+
+  for (const string &table_name : table_names) {
+    ASSERT_EQ(RC::SUCCESS, db->create_table(table_name.c_str(), attr_infos));
+  }
+  ASSERT_EQ(RC::SUCCESS, db->sync());
+
+  TrxKit &trx_kit    = db->trx_kit();
+  auto    insert_trx = [&](Trx *trx, int value) {
+    for (const string &table_name : table_names) {
+      Table *table = db->find_table(table_name.c_str());
+      ASSERT_NE(table, nullptr);
+
+      vector<Value> values(field_num);
+      for (Value &v : values) {
+        v.set_int(value);
+      }
+
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table->make_record(values.size(), values.data(), record));
+      ASSERT_EQ(RC::SUCCESS, trx->insert_record(table, record));
+    }
+  };
+
+  const int insert_num = 200;
+  for (int i = 0; i < insert_num; i++) {
+    Trx *trx = trx_kit.create_trx(db->log_handler());
+    trx->start_if_need();
+    insert_trx(trx, i);
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    trx_kit.destroy_trx(trx);
+  }
+
+  // 这个事务在检查点时还没有结束
+  Trx *active_trx = trx_kit.create_trx(db->log_handler());
+  active_trx->start_if_need();
+  insert_trx(active_trx, -1);
+
+  LogHandler &log_handler = db->log_handler();
+  ASSERT_EQ(RC::SUCCESS, log_handler.wait_lsn(log_handler.current_lsn()));
+  filesystem::copy(db_path, no_ckpt_db_path, filesystem::copy_options::recursive);
+
+  const LSN lsn_before_checkpoint = log_handler.current_lsn();
+  ASSERT_EQ(RC::SUCCESS, db->sync());
+
+  const int more_insert_num = 10;
+  for (int i = 0; i < more_insert_num; i++) {
+    Trx *trx = trx_kit.create_trx(db->log_handler());
+    trx->start_if_need();
+    insert_trx(trx, insert_num + i);
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    trx_kit.destroy_trx(trx);
+  }
+
+  ASSERT_EQ(RC::SUCCESS, log_handler.wait_lsn(log_handler.current_lsn()));
+  filesystem::copy(db_path, ckpt_db_path, filesystem::copy_options::recursive);
+
+  const LSN no_ckpt_lsn = read_check_point_lsn(no_ckpt_db_path, dbname);
+  const LSN ckpt_lsn    = read_check_point_lsn(ckpt_db_path, dbname);
+  // 检查点不能越过活跃事务的第一条日志
+  ASSERT_GT(ckpt_lsn, no_ckpt_lsn);
+  ASSERT_LT(ckpt_lsn, lsn_before_checkpoint);
+
+  auto count_entries = [&log_handler](LSN start_lsn) {
+    int count = 0;
+    EXPECT_EQ(RC::SUCCESS, log_handler.iterate([&count](LogEntry &) { count++; return RC::SUCCESS; }, start_lsn));
+    return count;
+  };
+  const int no_ckpt_entries = count_entries(no_ckpt_lsn);
+  const int ckpt_entries    = count_entries(ckpt_lsn);
+  ASSERT_LT(ckpt_entries * 10, no_ckpt_entries);
+
+  active_trx->rollback();
+  trx_kit.destroy_trx(active_trx);
+  db.reset();
+
+  chrono::microseconds no_ckpt_time, ckpt_time;
+  vector<int>          no_ckpt_counts, ckpt_counts;
+  recover_db(no_ckpt_db_path, dbname, table_names, no_ckpt_time, no_ckpt_counts);
+  recover_db(ckpt_db_path, dbname, table_names, ckpt_time, ckpt_counts);
+
+  cout << "recover without checkpoint: replay " << no_ckpt_entries << " log entries, " << no_ckpt_time.count()
+       << "us" << endl
+       << "recover with checkpoint: replay " << ckpt_entries << " log entries, " << ckpt_time.count() << "us"
+       << endl;
+
+  // 没有结束的事务都回滚了
+  ASSERT_EQ(no_ckpt_counts, vector<int>(table_num, insert_num));
+  ASSERT_EQ(ckpt_counts, vector<int>(table_num, insert_num + more_insert_num));
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,334 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sys/stat.h>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "common/log/log.h"
+#include "common/lang/random.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/buffer/page_compressor.h"
+#include "storage/clog/vacuous_log_handler.h"
+
+using namespace std;
+using namespace common;
+
+static void fill_random(vector<char> &data, mt19937 &generator)
+{
+  uniform_int_distribution<int> distribution(0, 255);
+  for (char &c : data) {
+    c = static_cast<char>(distribution(generator));
+  }
+}
+
+/// 模拟页面中的数据：一些重复的记录，后面是空闲空间
+static void fill_records(char *data, int size, int record_num)
+{
+  memset(data, 0, size);
+  for (int i = 0; i < record_num; i++) {
+    int written = snprintf(data + i * 32, size - i * 32, "id=%08d,name=record_%d,", i, i % 7);
+    if (written <= 0 || (i + 2) * 32 > size) {
+      break;
+    }
+  }
+}
+
+static void check_round_trip(const PageCompressor &compressor, const vector<char> &src)
+{
+  vector<char> compressed(src.size() + src.size() / 255 + 16);
+  const int compressed_size = compressor.compress(src.data(), src.size(), compressed.data(), compressed.size());
+  ASSERT_GE(compressed_size, 0);
+
+  vector<char> decompressed(src.size());
+  ASSERT_EQ(static_cast<int>(src.size()),
+      compressor.decompress(compressed.data(), compressed_size, decompressed.data(), decompressed.size()));
+  ASSERT_EQ(src, decompressed);
+}
+
+TEST(PageCompressor, compression_name)
+{
+  ASSERT_EQ(PageCompression::LZ4, page_compression_from_string("lz4"));
+  ASSERT_EQ(PageCompression::LZ4, page_compression_from_string("LZ4"));
+  ASSERT_EQ(PageCompression::NONE, page_compression_from_string("none"));
+  ASSERT_EQ(PageCompression::UNKNOWN, page_compression_from_string("zip"));
+  ASSERT_STREQ("lz4", page_compression_to_string(PageCompression::LZ4));
+
+  ASSERT_EQ(nullptr, PageCompressor::get(PageCompression::NONE));
+  ASSERT_NE(nullptr, PageCompressor::get(PageCompression::LZ4));
+}
+
+TEST(PageCompressor, lz4_round_trip)
+{
+  const PageCompressor &compressor = *PageCompressor::get(PageCompression::LZ4);
+  mt19937               generator(20261017);
+
+  // 很短的数据没有匹配，只有字面量
+  for (int size = 0; size < 32; size++) {
+    vector<char> data(size);
+    fill_random(data, generator);
+    check_round_trip(compressor, data);
+  }
+
+  vector<char> zeros(BP_PAGE_SIZE, 0);
+  check_round_trip(compressor, zeros);
+
+  vector<char> random_data(BP_PAGE_SIZE);
+  fill_random(random_data, generator);
+  check_round_trip(compressor, random_data);
+
+  for (int page_size = BP_MIN_PAGE_SIZE; page_size <= BP_MAX_PAGE_SIZE; page_size *= 2) {
+    vector<char> records(page_size);
+    fill_records(records.data(), page_size, page_size / 64);
+    check_round_trip(compressor, records);
+  }
+}
+
+TEST(PageCompressor, lz4_ratio)
+{
+  const PageCompressor &compressor = *PageCompressor::get(PageCompression::LZ4);
+
+  vector<char> page(BP_PAGE_SIZE);
+  fill_records(page.data(), page.size(), 100);
+  vector<char> compressed(BP_PAGE_SIZE);
+  const int    compressed_size = compressor.compress(page.data(), page.size(), compressed.data(), compressed.size());
+  ASSERT_GT(compressed_size, 0);
+  ASSERT_LT(compressed_size, BP_PAGE_SIZE / 4);
+
+  // 随机数据压缩不了，空间不够时返回-1
+  mt19937 generator(1);
+  fill_random(page, generator);
+  ASSERT_EQ(-1, compressor.compress(page.data(), page.size(), compressed.data(), BP_PAGE_SIZE / 2));
+}
+
+TEST(PageCompressor, lz4_corrupted)
+{
+  const PageCompressor &compressor = *PageCompressor::get(PageCompression::LZ4);
+
+  vector<char> page(BP_PAGE_SIZE);
+  fill_records(page.data(), page.size(), 100);
+  vector<char> compressed(BP_PAGE_SIZE);
+  const int    compressed_size = compressor.compress(page.data(), page.size(), compressed.data(), compressed.size());
+  ASSERT_GT(compressed_size, 0);
+
+  // 输出空间不够
+  vector<char> output(BP_PAGE_SIZE);
+  ASSERT_EQ(-1, compressor.decompress(compressed.data(), compressed_size, output.data(), BP_PAGE_SIZE / 2));
+
+  // 数据被截断，不能越界访问
+  for (int size = 0; size < compressed_size; size += 7) {
+    const int ret = compressor.decompress(compressed.data(), size, output.data(), output.size());
+    ASSERT_NE(BP_PAGE_SIZE, ret);
+  }
+
+  // 第一个序列的匹配偏移量超出了已经输出的数据
+  const char invalid[] = {0x10, 'a', 0x10, 0x00, 0x00};
+  ASSERT_EQ(-1, compressor.decompress(invalid, sizeof(invalid), output.data(), output.size()));
+}
+
+TEST(PageCompressor, compressed_buffer_pool)
+{
+  filesystem::path test_directory("page_compressor");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const int         page_num = 100;
+  VacuousLogHandler log_handler;
+
+  // 分别测试直接写页面与通过 double write buffer 批量写页面
+  for (bool use_dblwr : {false, true}) {
+    filesystem::path bp_file    = test_directory / (use_dblwr ? "dblwr.bp" : "direct.bp");
+    filesystem::path dblwr_file = test_directory / "dblwr.db";
+    filesystem::path raw_file   = test_directory / (use_dblwr ? "dblwr_raw.bp" : "direct_raw.bp");
+
+    auto make_bpm = [&]() {
+      auto bpm = make_unique<BufferPoolManager>();
+      if (use_dblwr) {
+        auto dblwr = make_unique<DiskDoubleWriteBuffer>(*bpm, 16 /*max_pages*/);
+        EXPECT_EQ(RC::SUCCESS, dblwr->open_file(dblwr_file.c_str()));
+        EXPECT_EQ(RC::SUCCESS, bpm->init(std::move(dblwr)));
+      } else {
+        EXPECT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+      }
+      return bpm;
+    };
+
+    auto bpm = make_bpm();
+    ASSERT_EQ(RC::INVALID_ARGUMENT, bpm->create_file(bp_file.c_str(), 0, PageCompression::UNKNOWN));
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(bp_file.c_str(), 0, PageCompression::LZ4));
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(raw_file.c_str()));
+
+    for (const filesystem::path &file : {bp_file, raw_file}) {
+      DiskBufferPool *buffer_pool = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, file.c_str(), buffer_pool));
+
+      // 最后一个页面是随机数据，压缩不了，原样写入
+      mt19937 generator(page_num);
+      for (int i = 0; i < page_num; i++) {
+        Frame *frame = nullptr;
+        ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+        if (i == page_num - 1) {
+          vector<char> data(frame->data_size());
+          fill_random(data, generator);
+          memcpy(frame->data(), data.data(), data.size());
+        } else {
+          fill_records(frame->data(), frame->data_size(), i + 1);
+        }
+        frame->mark_dirty();
+        ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+      }
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->flush_all_pages());
+      if (use_dblwr) {
+        ASSERT_EQ(RC::SUCCESS, static_cast<DiskDoubleWriteBuffer *>(bpm->get_dblwr_buffer())->flush_page());
+      }
+
+      if (file == bp_file) {
+        ASSERT_EQ(PageCompression::LZ4, buffer_pool->compression());
+        ASSERT_EQ(page_num - 1, buffer_pool->stats().compressed_writes.load());
+        ASSERT_EQ(1, buffer_pool->stats().raw_writes.load());
+      } else {
+        ASSERT_EQ(PageCompression::NONE, buffer_pool->compression());
+        ASSERT_EQ(0, buffer_pool->stats().compressed_writes.load());
+      }
+      ASSERT_EQ(RC::SUCCESS, bpm->close_file(file.c_str()));
+    }
+
+    // 压缩文件的大小不变，占用的磁盘空间更少。有的文件系统不支持打洞，就只能检查文件的大小
+    struct stat compressed_stat, raw_stat;
+    ASSERT_EQ(0, stat(bp_file.c_str(), &compressed_stat));
+    ASSERT_EQ(0, stat(raw_file.c_str(), &raw_stat));
+    ASSERT_EQ(raw_stat.st_size, compressed_stat.st_size);
+    cout << "compressed file: " << compressed_stat.st_blocks * 512 << " bytes on disk, raw file: "
+         << raw_stat.st_blocks * 512 << " bytes on disk" << endl;
+    ASSERT_LE(compressed_stat.st_blocks, raw_stat.st_blocks);
+
+    // 重新打开之后读取到的是解压后的页面，预读也一样
+    bpm = make_bpm();
+    DiskBufferPool *buffer_pool = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, bp_file.c_str(), buffer_pool));
+    ASSERT_EQ(page_num + 1, buffer_pool->page_count());
+
+    vector<PageNum> prefetch_pages = {1, 2, 3};
+    int             loaded         = 0;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->prefetch_pages(prefetch_pages, loaded));
+    ASSERT_EQ(3, loaded);
+
+    mt19937      generator(page_num);
+    vector<char> expected(buffer_pool->page_data_size());
+    for (int i = 0; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(i + 1, &frame));
+      if (i == page_num - 1) {
+        fill_random(expected, generator);
+      } else {
+        fill_records(expected.data(), expected.size(), i + 1);
+      }
+      ASSERT_EQ(0, memcmp(expected.data(), frame->data(), expected.size())) << "page " << i + 1;
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+    }
+    ASSERT_EQ(RC::SUCCESS, bpm->close_file(bp_file.c_str()));
+  }
+}
+
+TEST(PageCompressor, prefetch_corrupted_page)
+{
+  filesystem::path test_directory("page_compressor");
+  filesystem::path bp_file = test_directory / "corrupted.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  VacuousLogHandler log_handler;
+  const int         page_num = 3;
+
+  auto bpm = make_unique<BufferPoolManager>();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(bp_file.c_str(), 0, PageCompression::LZ4));
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, bp_file.c_str(), buffer_pool));
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    fill_records(frame->data(), frame->data_size(), i + 1);
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+  const int page_size = buffer_pool->page_size();
+  ASSERT_EQ(RC::SUCCESS, bpm->close_file(bp_file.c_str()));
+
+  // 把第2个页面的压缩数据长度改成非法的值，解压时会失败
+  {
+    CompressedPageHeader header;
+    header.magic           = CompressedPageHeader::MAGIC;
+    header.compression     = static_cast<int32_t>(PageCompression::LZ4);
+    header.compressed_size = -1;
+    fstream file(bp_file, ios::in | ios::out | ios::binary);
+    file.seekp(static_cast<streamoff>(2) * page_size);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  }
+
+  bpm = make_unique<BufferPoolManager>();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  // 加载失败的页面不会留在内存中
+  vector<PageNum> prefetch_pages = {1, 2, 3};
+  int             loaded         = 0;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->prefetch_pages(prefetch_pages, loaded));
+  ASSERT_EQ(2, loaded);
+  ASSERT_EQ(nullptr, buffer_pool->frame_manager().get(buffer_pool->id(), 2));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::IOERR_READ, buffer_pool->get_this_page(2, &frame));
+
+  // 模拟预读线程正在加载页面时，另一个线程等待这个页面。加载失败之后，等待的线程要拿到错误而不是页面数据
+  Frame *prefetch_frame =
+      buffer_pool->frame_manager().alloc(buffer_pool->id(), 2, BufferAccessHint::SEQUENTIAL, true /*for_prefetch*/);
+  ASSERT_NE(nullptr, prefetch_frame);
+  ASSERT_TRUE(prefetch_frame->loading());
+
+  RC     waiter_rc = RC::SUCCESS;
+  thread waiter([&]() {
+    Frame *waiter_frame = nullptr;
+    waiter_rc           = buffer_pool->get_this_page(2, &waiter_frame);
+  });
+  this_thread::sleep_for(chrono::milliseconds(100));
+  prefetch_frame->write_unlatch();
+  if (OB_FAIL(buffer_pool->frame_manager().try_free(buffer_pool->id(), 2, prefetch_frame))) {
+    prefetch_frame->unpin();
+  }
+  waiter.join();
+  ASSERT_EQ(RC::IOERR_READ, waiter_rc);
+
+  // 其它页面不受影响
+  for (PageNum page : {1, 3}) {
+    vector<char> expected(buffer_pool->page_data_size());
+    fill_records(expected.data(), expected.size(), page);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(page, &frame));
+    ASSERT_EQ(0, memcmp(expected.data(), frame->data(), expected.size())) << "page " << page;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm->close_file(bp_file.c_str()));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_INFO);
+  return RUN_ALL_TESTS();
+}
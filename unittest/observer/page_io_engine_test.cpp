@@ -0,0 +1,102 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/16.
+//
+
+#include <fcntl.h>
+#include <filesystem>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "storage/buffer/page.h"
+#include "storage/buffer/page_io_engine.h"
+
+using namespace std;
+
+/// Page 只描述了页面的头部，按照默认的页面大小申请内存
+static Page *page_at(vector<char> &buffer, int index)
+{
+  return reinterpret_cast<Page *>(buffer.data() + (int64_t)index * BP_PAGE_SIZE);
+}
+
+static void test_page_io_engine(const char *engine_name)
+{
+  filesystem::path directory("page_io_engine_test_dir");
+  filesystem::remove_all(directory);
+  filesystem::create_directories(directory);
+
+  filesystem::path filename = directory / engine_name;
+  int              fd       = open(filename.c_str(), O_CREAT | O_RDWR, 0644);
+  ASSERT_GE(fd, 0);
+
+  unique_ptr<PageIoEngine> engine = PageIoEngine::create(engine_name);
+  ASSERT_NE(engine, nullptr);
+
+  const int             page_num = 200;
+  vector<char>          pages(page_num * BP_PAGE_SIZE);
+  vector<PageIoRequest> requests;
+  for (int i = 0; i < page_num; i++) {
+    memset(page_at(pages, i)->data, i % 128, BP_PAGE_DATA_SIZE);
+    page_at(pages, i)->lsn = i;
+    requests.push_back(PageIoRequest::make_write(fd, (int64_t)i * BP_PAGE_SIZE, page_at(pages, i), BP_PAGE_SIZE));
+  }
+  ASSERT_EQ(RC::SUCCESS, engine->submit(requests));
+
+  vector<char> read_pages(page_num * BP_PAGE_SIZE);
+  requests.clear();
+  for (int i = page_num - 1; i >= 0; i--) {
+    requests.push_back(
+        PageIoRequest::make_read(fd, (int64_t)i * BP_PAGE_SIZE, page_at(read_pages, i), BP_PAGE_SIZE));
+  }
+  ASSERT_EQ(RC::SUCCESS, engine->submit(requests));
+  for (int i = 0; i < page_num; i++) {
+    ASSERT_EQ(0, memcmp(page_at(pages, i), page_at(read_pages, i), BP_PAGE_SIZE));
+  }
+
+  ASSERT_EQ(engine->stats().requests.load(), 2 * page_num);
+  if (0 == strcmp(engine->name(), "io_uring")) {
+    // 一批请求只需要很少的系统调用
+    ASSERT_LT(engine->stats().syscalls.load(), page_num);
+  }
+
+  // 单个请求
+  vector<char> page_buffer(BP_PAGE_SIZE);
+  Page        *page = page_at(page_buffer, 0);
+  ASSERT_EQ(RC::SUCCESS, engine->read(fd, BP_PAGE_SIZE, page, BP_PAGE_SIZE));
+  ASSERT_EQ(0, memcmp(page_at(pages, 1), page, BP_PAGE_SIZE));
+
+  // 读取超过文件尾
+  ASSERT_EQ(RC::IOERR_READ, engine->read(fd, (int64_t)page_num * BP_PAGE_SIZE, page, BP_PAGE_SIZE));
+
+  requests.clear();
+  requests.push_back(PageIoRequest::make_read(fd, 0, page_at(read_pages, 0), BP_PAGE_SIZE));
+  requests.push_back(PageIoRequest::make_read(fd, (int64_t)page_num * BP_PAGE_SIZE, page, BP_PAGE_SIZE));
+  ASSERT_EQ(RC::IOERR_READ, engine->submit(requests));
+  ASSERT_EQ(RC::SUCCESS, requests[0].rc);
+  ASSERT_EQ(RC::IOERR_READ, requests[1].rc);
+
+  close(fd);
+  filesystem::remove_all(directory);
+}
+
+TEST(PageIoEngine, sync) { test_page_io_engine("sync"); }
+
+TEST(PageIoEngine, io_uring) { test_page_io_engine("io_uring"); }
+
+TEST(PageIoEngine, unknown) { ASSERT_EQ(nullptr, PageIoEngine::create("unknown")); }
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
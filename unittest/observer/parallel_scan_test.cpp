@@ -0,0 +1,279 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created on 2026/10/17.
+//
+
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/aggregate_vec_physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/db/db.h"
+#include "storage/record/morsel_dispatcher.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace common;
+
+TEST(MorselDispatcher, dispatch_all_pages)
+{
+  VacuousLogHandler log_handler;
+
+  const char *file_name = "morsel_dispatcher.bp";
+  filesystem::remove(file_name);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, file_name, bp));
+
+  // 分配一些页面，再释放其中一部分，释放的页面不应该被分配出去
+  const int       page_num = 100;
+  vector<PageNum> allocated;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    allocated.push_back(frame->page_num());
+    ASSERT_EQ(RC::SUCCESS, bp->unpin_page(frame));
+  }
+  set<PageNum> expected_pages;
+  for (int i = 0; i < page_num; i++) {
+    if (i % 7 == 3) {
+      ASSERT_EQ(RC::SUCCESS, bp->dispose_page(allocated[i]));
+    } else {
+      expected_pages.insert(allocated[i]);
+    }
+  }
+
+  const int        morsel_pages = 3;
+  MorselDispatcher dispatcher;
+  ASSERT_EQ(RC::SUCCESS, dispatcher.init(*bp, morsel_pages));
+
+  mutex           lock;
+  vector<PageNum> dispatched_pages;
+  vector<thread>  threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&]() {
+      vector<PageNum> pages;
+      while (dispatcher.next_morsel(pages) == RC::SUCCESS) {
+        ASSERT_FALSE(pages.empty());
+        ASSERT_LE(static_cast<int>(pages.size()), morsel_pages);
+        lock_guard guard(lock);
+        dispatched_pages.insert(dispatched_pages.end(), pages.begin(), pages.end());
+      }
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  // 每个页面只会分配一次
+  ASSERT_EQ(expected_pages.size(), dispatched_pages.size());
+  ASSERT_EQ(expected_pages, set<PageNum>(dispatched_pages.begin(), dispatched_pages.end()));
+  ASSERT_EQ((static_cast<int>(expected_pages.size()) + morsel_pages - 1) / morsel_pages,
+      dispatcher.dispatched_morsels());
+
+  vector<PageNum> pages;
+  ASSERT_EQ(RC::RECORD_EOF, dispatcher.next_morsel(pages));
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+}
+
+class ParallelScanTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directories(test_directory_);
+
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("parallel_scan_db", test_directory_.c_str(), "vacuous", "vacuous"));
+
+    vector<AttrInfoSqlNode> attr_infos(2);
+    attr_infos[0].name   = "id";
+    attr_infos[0].type   = AttrType::INTS;
+    attr_infos[0].length = 4;
+    attr_infos[1].name   = "value";
+    attr_infos[1].type   = AttrType::INTS;
+    attr_infos[1].length = 4;
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", attr_infos, StorageFormat::PAX_FORMAT));
+    table_ = db_->find_table("t");
+    ASSERT_NE(nullptr, table_);
+
+    for (int i = 0; i < record_num_; i++) {
+      Value  values[2] = {Value(i), Value(i % 100)};
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table_->make_record(2, values, record));
+      ASSERT_EQ(RC::SUCCESS, table_->insert_record(record));
+    }
+  }
+
+  void TearDown() override
+  {
+    db_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  const FieldMeta *value_field() const { return table_->table_meta().field("value"); }
+
+  unique_ptr<TableScanVecPhysicalOperator> create_scan(int parallelism, int min_id)
+  {
+    auto scan = make_unique<TableScanVecPhysicalOperator>(table_, ReadWriteMode::READ_ONLY);
+    if (min_id >= 0) {
+      vector<unique_ptr<Expression>> predicates;
+      predicates.push_back(make_unique<ComparisonExpr>(CompOp::GREAT_EQUAL,
+          make_unique<FieldExpr>(table_, table_->table_meta().field("id")),
+          make_unique<ValueExpr>(Value(min_id))));
+      scan->set_predicates(std::move(predicates));
+    }
+    scan->set_parallelism(parallelism);
+    return scan;
+  }
+
+  int64_t expected_sum(int min_id) const
+  {
+    int64_t sum = 0;
+    for (int i = max(min_id, 0); i < record_num_; i++) {
+      sum += i % 100;
+    }
+    return sum;
+  }
+
+protected:
+  filesystem::path test_directory_ = "parallel_scan_test";
+  const int        record_num_     = 20000;
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+};
+
+TEST_F(ParallelScanTest, sum_in_workers)
+{
+  FieldExpr value_expr(table_, value_field());
+  for (int parallelism : {1, 2, 4}) {
+    for (int min_id : {-1, 12345}) {
+      auto scan = create_scan(parallelism, min_id);
+      ASSERT_EQ(RC::SUCCESS, scan->open(nullptr));
+
+      vector<int64_t> sums(scan->parallelism(), 0);
+      vector<int>     rows(scan->parallelism(), 0);
+      RC              rc = scan->parallel_scan([&](int worker_id, Chunk &chunk) {
+        Column column;
+        RC     rc = value_expr.get_column(chunk, column);
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+        const int *data = reinterpret_cast<const int *>(column.data());
+        for (int i = 0; i < column.count(); i++) {
+          sums[worker_id] += data[i];
+        }
+        rows[worker_id] += column.count();
+        return RC::SUCCESS;
+      });
+      ASSERT_EQ(RC::SUCCESS, rc);
+      ASSERT_EQ(RC::SUCCESS, scan->close());
+
+      int64_t total_sum  = 0;
+      int     total_rows = 0;
+      for (int i = 0; i < scan->parallelism(); i++) {
+        total_sum += sums[i];
+        total_rows += rows[i];
+      }
+      EXPECT_EQ(expected_sum(min_id), total_sum) << "parallelism=" << parallelism << ", min_id=" << min_id;
+      EXPECT_EQ(record_num_ - max(min_id, 0), total_rows);
+    }
+  }
+}
+
+TEST_F(ParallelScanTest, consumer_error_stops_scan)
+{
+  auto scan = create_scan(4, -1);
+  ASSERT_EQ(RC::SUCCESS, scan->open(nullptr));
+
+  atomic<int> chunks(0);
+  RC          rc = scan->parallel_scan([&](int, Chunk &) {
+    return ++chunks >= 3 ? RC::INTERNAL : RC::SUCCESS;
+  });
+  ASSERT_EQ(RC::INTERNAL, rc);
+  ASSERT_EQ(RC::SUCCESS, scan->close());
+}
+
+TEST_F(ParallelScanTest, page_released_after_next)
+{
+  DiskBufferPool *bp        = table_->data_buffer_pool();
+  auto            pin_count = [bp](PageNum page_num) {
+    Frame *frame = nullptr;
+    EXPECT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &frame));
+    const int count = frame->pin_count() - 1;
+    bp->unpin_page(frame);
+    return count;
+  };
+
+  // 零拷贝时，页面一直固定到下一次 next
+  auto  scan = create_scan(1, -1);
+  Chunk chunk;
+  ASSERT_EQ(RC::SUCCESS, scan->open(nullptr));
+  ASSERT_EQ(RC::SUCCESS, scan->next(chunk));
+  ASSERT_EQ(1, pin_count(1));
+  ASSERT_EQ(RC::SUCCESS, scan->next(chunk));
+  ASSERT_EQ(0, pin_count(1));
+  ASSERT_EQ(RC::SUCCESS, scan->close());
+  ASSERT_EQ(0, pin_count(2));
+
+  // 有过滤条件时数据已经复制出来，next 返回时页面就释放了
+  scan = create_scan(1, 0);
+  ASSERT_EQ(RC::SUCCESS, scan->open(nullptr));
+  ASSERT_EQ(RC::SUCCESS, scan->next(chunk));
+  ASSERT_LT(0, chunk.rows());
+  ASSERT_EQ(0, pin_count(1));
+  ASSERT_EQ(RC::SUCCESS, scan->close());
+}
+
+TEST_F(ParallelScanTest, partial_aggregation)
+{
+  for (int parallelism : {1, 4}) {
+    for (int min_id : {-1, 777}) {
+      AggregateExpr aggregate_expr(AggregateExpr::Type::SUM, make_unique<FieldExpr>(table_, value_field()));
+      AggregateVecPhysicalOperator aggregate_oper({&aggregate_expr});
+      aggregate_oper.add_child(create_scan(parallelism, min_id));
+
+      ASSERT_EQ(RC::SUCCESS, aggregate_oper.open(nullptr));
+
+      // 聚合结果只有一行
+      Chunk chunk;
+      ASSERT_EQ(RC::SUCCESS, aggregate_oper.next(chunk));
+      ASSERT_EQ(1, chunk.column_num());
+      ASSERT_EQ(1, chunk.rows());
+      EXPECT_EQ(expected_sum(min_id), chunk.get_value(0, 0).get_int())
+          << "parallelism=" << parallelism << ", min_id=" << min_id;
+      ASSERT_EQ(RC::RECORD_EOF, aggregate_oper.next(chunk));
+      ASSERT_EQ(RC::SUCCESS, aggregate_oper.close());
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_INFO);
+  return RUN_ALL_TESTS();
+}
@@ -64,6 +64,36 @@ TEST(ParserTest, DISABLED_group_by_test)
   }
 }
 
+TEST(ParserTest, show_buffer_pool_status_test)
+{
+  {
+    ParsedSqlResult result;
+    const char     *sql = "show buffer pool status;";
+    ASSERT_EQ(parse(sql, &result), RC::SUCCESS);
+    ASSERT_EQ(result.sql_nodes().size(), 1);
+    ASSERT_EQ(result.sql_nodes().front()->flag, SCF_SHOW_BUFFER_POOL_STATUS);
+  }
+  {
+    ParsedSqlResult result;
+    const char     *sql = "SHOW  Buffer\n POOL\tstatus;";
+    ASSERT_EQ(parse(sql, &result), RC::SUCCESS);
+    ASSERT_EQ(result.sql_nodes().front()->flag, SCF_SHOW_BUFFER_POOL_STATUS);
+  }
+  // buffer、pool、status 不是保留字，仍然可以做表名和列名
+  {
+    ParsedSqlResult result;
+    const char     *sql = "create table buffer(pool int, status int);";
+    ASSERT_EQ(parse(sql, &result), RC::SUCCESS);
+    ASSERT_EQ(result.sql_nodes().front()->flag, SCF_CREATE_TABLE);
+  }
+  {
+    ParsedSqlResult result;
+    const char     *sql = "select status from buffer where pool = 1;";
+    ASSERT_EQ(parse(sql, &result), RC::SUCCESS);
+    ASSERT_EQ(result.sql_nodes().front()->flag, SCF_SELECT);
+  }
+}
+
 int main(int argc, char **argv)
 {
 
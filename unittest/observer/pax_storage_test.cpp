@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 #include <sstream>
 #include <filesystem>
 #include <utility>
+#include <unordered_set>
 
 #define protected public
 #define private public
@@ -36,13 +37,14 @@ using namespace common;
 class PaxRecordFileScannerWithParam : public testing::TestWithParam<int>
 {};
 
-TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
+TEST_P(PaxRecordFileScannerWithParam, test_file_iterator)
 {
   int               record_insert_num = GetParam();
   VacuousLogHandler log_handler;
 
   const char *record_manager_file = "record_manager.bp";
   filesystem::remove(record_manager_file);
+  filesystem::remove(string(record_manager_file) + FreeSpaceMap::FILE_SUFFIX);
 
   BufferPoolManager *bpm = new BufferPoolManager();
   ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
@@ -169,6 +171,7 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
   ASSERT_EQ(rc, RC::RECORD_EOF);
   ASSERT_EQ(count, rids.size() / 2);
 
+  file_handler.close();
   bpm->close_file(record_manager_file);
   delete bpm;
 }
@@ -176,7 +179,7 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
 class PaxPageHandlerTestWithParam : public testing::TestWithParam<int>
 {};
 
-TEST_P(PaxPageHandlerTestWithParam, DISABLED_PaxPageHandler)
+TEST_P(PaxPageHandlerTestWithParam, PaxPageHandler)
 {
   int               record_num = GetParam();
   VacuousLogHandler log_handler;
@@ -340,6 +343,577 @@ TEST_P(PaxPageHandlerTestWithParam, DISABLED_PaxPageHandler)
   delete bpm;
 }
 
+TEST(PaxZoneMap, page_zone_map)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "pax_zone_map.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+
+  const int record_size = 12;  // 4 + 4 + 4
+  TableMeta table_meta;
+  table_meta.fields_.resize(3);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::FLOATS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+  table_meta.fields_[2].attr_type_ = AttrType::CHARS;
+  table_meta.fields_[2].attr_len_  = 4;
+  table_meta.fields_[2].field_id_  = 2;
+
+  PaxRecordPageHandler page_handler;
+  ASSERT_EQ(RC::SUCCESS, page_handler.init_empty_page(*bp, log_handler, frame->page_num(), record_size, &table_meta));
+  ASSERT_FALSE(page_handler.zone_map(0).has_range);
+
+  // 插入 10..19，浮点列是整数列的一半
+  vector<RID> rids;
+  char        buf[record_size];
+  memcpy(buf + 8, "abcd", 4);
+  for (int i = 10; i < 20; i++) {
+    float float_val = i / 2.0f;
+    memcpy(buf, &i, sizeof(i));
+    memcpy(buf + 4, &float_val, sizeof(float_val));
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, page_handler.insert_record(buf, &rid));
+    rids.push_back(rid);
+  }
+
+  ASSERT_TRUE(page_handler.zone_map(0).has_range);
+  ASSERT_EQ(page_handler.zone_map(0).min().get_int(), 10);
+  ASSERT_EQ(page_handler.zone_map(0).max().get_int(), 19);
+  ASSERT_FLOAT_EQ(page_handler.zone_map(1).min().get_float(), 5.0f);
+  ASSERT_FLOAT_EQ(page_handler.zone_map(1).max().get_float(), 9.5f);
+  ASSERT_EQ(page_handler.zone_map(0).null_count, 0);
+  ASSERT_FALSE(page_handler.zone_map(2).has_range);  // 字符串不维护 zone map
+
+  auto may_match = [&page_handler](int col_id, CompOp comp, const Value &value) {
+    ZoneMapFilter filter;
+    filter.add_condition(col_id, comp, value);
+    return page_handler.may_match(filter);
+  };
+
+  ASSERT_TRUE(may_match(0, EQUAL_TO, Value(15)));
+  ASSERT_FALSE(may_match(0, EQUAL_TO, Value(20)));
+  ASSERT_FALSE(may_match(0, LESS_THAN, Value(10)));
+  ASSERT_TRUE(may_match(0, LESS_EQUAL, Value(10)));
+  ASSERT_FALSE(may_match(0, GREAT_THAN, Value(19)));
+  ASSERT_TRUE(may_match(0, GREAT_EQUAL, Value(19)));
+  ASSERT_TRUE(may_match(0, NOT_EQUAL, Value(10)));
+  ASSERT_FALSE(may_match(1, GREAT_THAN, Value(9.5f)));
+  ASSERT_TRUE(may_match(1, LESS_THAN, Value(5.5f)));
+  ASSERT_TRUE(may_match(0, EQUAL_TO, Value(2.0f)));  // 类型不同时不能跳过
+  ASSERT_TRUE(may_match(2, EQUAL_TO, Value("zzzz")));
+
+  // 多个条件同时满足时才可能匹配
+  ZoneMapFilter filter;
+  filter.add_condition(0, GREAT_EQUAL, Value(12));
+  filter.add_condition(1, LESS_THAN, Value(5.0f));
+  ASSERT_FALSE(page_handler.may_match(filter));
+
+  // 删除边界上的值之后范围会缩小，删除中间的值不影响范围
+  ASSERT_EQ(RC::SUCCESS, page_handler.delete_record(&rids[0]));
+  ASSERT_EQ(RC::SUCCESS, page_handler.delete_record(&rids[9]));
+  ASSERT_EQ(RC::SUCCESS, page_handler.delete_record(&rids[5]));
+  ASSERT_EQ(page_handler.zone_map(0).min().get_int(), 11);
+  ASSERT_EQ(page_handler.zone_map(0).max().get_int(), 18);
+  ASSERT_FLOAT_EQ(page_handler.zone_map(1).min().get_float(), 5.5f);
+  ASSERT_FALSE(may_match(0, LESS_EQUAL, Value(10)));
+
+  // 更新边界上的值
+  int int_val = 100;
+  memcpy(buf, &int_val, sizeof(int_val));
+  float float_val = 7.0f;
+  memcpy(buf + 4, &float_val, sizeof(float_val));
+  ASSERT_EQ(RC::SUCCESS, page_handler.update_record(rids[1], buf));
+  ASSERT_EQ(page_handler.zone_map(0).min().get_int(), 12);
+  ASSERT_EQ(page_handler.zone_map(0).max().get_int(), 100);
+  ASSERT_FLOAT_EQ(page_handler.zone_map(1).min().get_float(), 6.0f);
+
+  // 页面中的记录都删除之后没有范围
+  for (int i = 1; i < 9; i++) {
+    if (i != 5) {
+      ASSERT_EQ(RC::SUCCESS, page_handler.delete_record(&rids[i]));
+    }
+  }
+  ASSERT_FALSE(page_handler.zone_map(0).has_range);
+
+  ASSERT_EQ(RC::SUCCESS, page_handler.cleanup());
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(PaxZoneMap, chunk_scanner_skip_pages)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "pax_zone_map_scanner.bp";
+  filesystem::remove(record_manager_file);
+  filesystem::remove(string(record_manager_file) + FreeSpaceMap::FILE_SUFFIX);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  TableMeta table_meta;
+  table_meta.fields_.resize(2);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::INTS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta));
+
+  // 按顺序插入，每个页面中第一列的范围互不重叠
+  const int record_num = 10000;
+  for (int i = 0; i < record_num; i++) {
+    int  buf[2] = {i, record_num - i};
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(reinterpret_cast<const char *>(buf), sizeof(buf), &rid));
+  }
+
+  Table table;
+  table.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+
+  auto scan = [&](ZoneMapFilter filter, int &rows, int &skipped_pages) {
+    ChunkFileScanner chunk_scanner;
+    ASSERT_EQ(RC::SUCCESS, chunk_scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY));
+    chunk_scanner.set_zone_map_filter(std::move(filter));
+
+    Chunk     chunk;
+    FieldMeta fm;
+    fm.init("col1", AttrType::INTS, 0, 4, true, 0);
+    chunk.add_column(make_unique<Column>(fm, 2048), 0);
+
+    RC rc = RC::SUCCESS;
+    rows  = 0;
+    while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
+      rows += chunk.rows();
+      chunk.reset_data();
+    }
+    ASSERT_EQ(rc, RC::RECORD_EOF);
+    skipped_pages = chunk_scanner.skipped_pages();
+    chunk_scanner.close_scan();
+  };
+
+  int rows          = 0;
+  int skipped_pages = 0;
+  scan(ZoneMapFilter(), rows, skipped_pages);
+  ASSERT_EQ(rows, record_num);
+  ASSERT_EQ(skipped_pages, 0);
+
+  // 只有一个页面可能包含 5000
+  const int page_count = bp->page_count() - 1;
+  ZoneMapFilter equal_filter;
+  equal_filter.add_condition(0, EQUAL_TO, Value(5000));
+  scan(std::move(equal_filter), rows, skipped_pages);
+  ASSERT_GT(rows, 0);
+  ASSERT_LT(rows, record_num);
+  ASSERT_EQ(skipped_pages, page_count - 1);
+
+  ZoneMapFilter empty_filter;
+  empty_filter.add_condition(0, GREAT_THAN, Value(record_num));
+  scan(std::move(empty_filter), rows, skipped_pages);
+  ASSERT_EQ(rows, 0);
+  ASSERT_EQ(skipped_pages, page_count);
+
+  // 第二列是递减的，范围条件落在最后几个页面中
+  ZoneMapFilter range_filter;
+  range_filter.add_condition(1, LESS_EQUAL, Value(100));
+  scan(std::move(range_filter), rows, skipped_pages);
+  ASSERT_GE(rows, 100);
+  ASSERT_GT(skipped_pages, page_count / 2);
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(PaxZeroCopy, reference_chunk)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "pax_zero_copy.bp";
+  filesystem::remove(record_manager_file);
+  filesystem::remove(string(record_manager_file) + FreeSpaceMap::FILE_SUFFIX);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  TableMeta table_meta;
+  table_meta.fields_.resize(2);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::CHARS;
+  table_meta.fields_[1].attr_len_  = 8;
+  table_meta.fields_[1].field_id_  = 1;
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta));
+
+  struct
+  {
+    int  value;
+    char name[8];
+  } record_data;
+
+  const int   record_num = 3000;
+  vector<RID> rids;
+  for (int i = 0; i < record_num; i++) {
+    record_data.value = i;
+    snprintf(record_data.name, sizeof(record_data.name), "n%d", i);
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(reinterpret_cast<const char *>(&record_data), sizeof(record_data), &rid));
+    rids.push_back(rid);
+  }
+
+  // 删除 value 是3的倍数的记录，包括每个页面的第一条记录
+  int64_t expected_sum = 0;
+  for (int i = 0; i < record_num; i++) {
+    if (i % 3 == 0) {
+      ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+    } else {
+      expected_sum += i;
+    }
+  }
+
+  Table table;
+  table.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+
+  ChunkFileScanner chunk_scanner;
+  ASSERT_EQ(RC::SUCCESS, chunk_scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY));
+
+  FieldMeta fm1, fm2;
+  fm1.init("col1", AttrType::INTS, 0, 4, true, 0);
+  fm2.init("col2", AttrType::CHARS, 4, 8, true, 1);
+  Chunk chunk;
+  chunk.add_column(make_unique<Column>(fm1), 0);
+  chunk.add_column(make_unique<Column>(fm2), 1);
+
+  RC              rc    = RC::SUCCESS;
+  int             count = 0;
+  int64_t         sum   = 0;
+  vector<uint8_t> select;
+  while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk, select))) {
+    ASSERT_EQ(static_cast<int>(select.size()), chunk.rows());
+    for (int i = 0; i < chunk.rows(); i++) {
+      const int value = chunk.get_value(0, i).get_int();
+      ASSERT_EQ(select[i] != 0, value % 3 != 0);
+      if (select[i]) {
+        count++;
+        sum += value;
+        ASSERT_EQ(chunk.get_value(1, i).get_string(), "n" + to_string(value));
+      }
+    }
+    chunk.reset_data();
+  }
+  ASSERT_EQ(rc, RC::RECORD_EOF);
+  ASSERT_EQ(count, record_num - (record_num + 2) / 3);
+  ASSERT_EQ(sum, expected_sum);
+  chunk_scanner.close_scan();
+
+  // 引用了页面数据的 Column 不能再追加数据
+  int value = 0;
+  ASSERT_NE(RC::SUCCESS, chunk.column(0).append_one(reinterpret_cast<char *>(&value)));
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(PaxColumnEncoding, seal_full_page)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "pax_column_encoding.bp";
+  ::remove(record_manager_file);
+
+  // 只有开启了页面压缩的文件才会封存页面
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file, 0, PageCompression::LZ4));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+
+  const int record_size = 20;  // 4 + 4 + 12
+  TableMeta table_meta;
+  table_meta.fields_.resize(3);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::INTS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+  table_meta.fields_[2].attr_type_ = AttrType::CHARS;
+  table_meta.fields_[2].attr_len_  = 12;
+  table_meta.fields_[2].field_id_  = 2;
+
+  const vector<string> cities = {"beijing", "shanghai", "hangzhou", "chengdu"};
+  auto make_record = [&cities](int i, char *buf) {
+    const int group = i / 50;
+    memset(buf, 0, record_size);
+    memcpy(buf, &i, sizeof(i));
+    memcpy(buf + 4, &group, sizeof(group));
+    memcpy(buf + 8, cities[i % cities.size()].c_str(), cities[i % cities.size()].size());
+  };
+
+  PaxRecordPageHandler page_handler;
+  ASSERT_EQ(RC::SUCCESS, page_handler.init_empty_page(*bp, log_handler, frame->page_num(), record_size, &table_meta));
+
+  // 页面写满之前不编码
+  char        buf[record_size];
+  vector<RID> rids;
+  for (int i = 0; ; i++) {
+    make_record(i, buf);
+    RID rid;
+    RC  rc = page_handler.insert_record(buf, &rid);
+    if (rc == RC::RECORD_NOMEM) {
+      break;
+    }
+    ASSERT_EQ(RC::SUCCESS, rc);
+    rids.push_back(rid);
+    if (!page_handler.is_full()) {
+      ASSERT_EQ(page_handler.column_encoding(0).type(), ColumnEncoding::PLAIN);
+    }
+  }
+
+  const int record_num = static_cast<int>(rids.size());
+  ASSERT_GT(record_num, 100);
+  ASSERT_EQ(page_handler.column_encoding(0).type(), ColumnEncoding::FOR_BITPACK);
+  ASSERT_EQ(page_handler.column_encoding(1).type(), ColumnEncoding::RLE);
+  ASSERT_EQ(page_handler.column_encoding(2).type(), ColumnEncoding::DICTIONARY);
+
+  auto check_record = [&](int i, const RID &rid) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, page_handler.get_record(rid, record));
+    make_record(i, buf);
+    ASSERT_EQ(0, memcmp(record.data(), buf, record_size)) << "i=" << i;
+  };
+  for (int i = 0; i < record_num; i++) {
+    check_record(i, rids[i]);
+  }
+
+  // 整页读取时解码
+  FieldMeta fm1, fm2, fm3;
+  fm1.init("col1", AttrType::INTS, 0, 4, true, 0);
+  fm2.init("col2", AttrType::INTS, 4, 4, true, 1);
+  fm3.init("col3", AttrType::CHARS, 8, 12, true, 2);
+  Chunk chunk;
+  chunk.add_column(make_unique<Column>(fm1), 0);
+  chunk.add_column(make_unique<Column>(fm2), 1);
+  chunk.add_column(make_unique<Column>(fm3), 2);
+  ASSERT_EQ(RC::SUCCESS, page_handler.get_chunk(chunk));
+  ASSERT_EQ(chunk.rows(), record_num);
+  for (int i = 0; i < record_num; i++) {
+    ASSERT_EQ(chunk.get_value(0, i).get_int(), i);
+    ASSERT_EQ(chunk.get_value(1, i).get_int(), i / 50);
+    ASSERT_EQ(chunk.get_value(2, i).get_string(), cities[i % cities.size()]);
+  }
+
+  // 删除只修改位图，页面保持编码的状态，删除边界上的值时根据解码的数据重新计算 zone map
+  ASSERT_EQ(RC::SUCCESS, page_handler.delete_record(&rids[0]));
+  ASSERT_EQ(page_handler.column_encoding(0).type(), ColumnEncoding::FOR_BITPACK);
+  ASSERT_EQ(page_handler.zone_map(0).min().get_int(), 1);
+  ASSERT_EQ(page_handler.zone_map(0).max().get_int(), record_num - 1);
+
+  Chunk           ref_chunk;
+  vector<uint8_t> select;
+  ref_chunk.add_column(make_unique<Column>(fm1), 0);
+  ref_chunk.add_column(make_unique<Column>(fm3), 2);
+  ASSERT_EQ(RC::SUCCESS, page_handler.reference_chunk(ref_chunk, select));
+  ASSERT_EQ(ref_chunk.rows(), record_num);
+  ASSERT_EQ(select[0], 0);
+  for (int i = 1; i < record_num; i++) {
+    ASSERT_EQ(select[i], 1);
+    ASSERT_EQ(ref_chunk.get_value(0, i).get_int(), i);
+    ASSERT_EQ(ref_chunk.get_value(1, i).get_string(), cities[i % cities.size()]);
+  }
+
+  // 修改之前解码，更新之后的页面不再编码
+  make_record(record_num + 100, buf);
+  ASSERT_EQ(RC::SUCCESS, page_handler.update_record(rids[1], buf));
+  ASSERT_EQ(page_handler.column_encoding(0).type(), ColumnEncoding::PLAIN);
+  ASSERT_EQ(page_handler.column_encoding(2).type(), ColumnEncoding::PLAIN);
+  check_record(record_num + 100, rids[1]);
+  for (int i = 2; i < record_num; i++) {
+    check_record(i, rids[i]);
+  }
+
+  // 再次写满时重新编码
+  make_record(0, buf);
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, page_handler.insert_record(buf, &rid));
+  ASSERT_EQ(rid, rids[0]);
+  ASSERT_TRUE(page_handler.is_full());
+  ASSERT_EQ(page_handler.column_encoding(2).type(), ColumnEncoding::DICTIONARY);
+  check_record(0, rids[0]);
+  check_record(record_num + 100, rids[1]);
+  for (int i = 2; i < record_num; i++) {
+    check_record(i, rids[i]);
+  }
+
+  ASSERT_EQ(RC::SUCCESS, page_handler.cleanup());
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(PaxColumnEncoding, no_seal_without_compression)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "pax_no_seal.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+
+  const int record_size = 8;
+  TableMeta table_meta;
+  table_meta.fields_.resize(2);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::INTS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+
+  PaxRecordPageHandler page_handler;
+  ASSERT_EQ(RC::SUCCESS, page_handler.init_empty_page(*bp, log_handler, frame->page_num(), record_size, &table_meta));
+
+  // 全部是相同的值，压缩的文件中会使用 RLE 编码
+  int record_num = 0;
+  for (;; record_num++) {
+    int buf[2] = {1, 1};
+    RID rid;
+    RC  rc = page_handler.insert_record(reinterpret_cast<const char *>(buf), &rid);
+    if (rc == RC::RECORD_NOMEM) {
+      break;
+    }
+    ASSERT_EQ(RC::SUCCESS, rc);
+  }
+  ASSERT_TRUE(page_handler.is_full());
+  ASSERT_EQ(page_handler.column_encoding(0).type(), ColumnEncoding::PLAIN);
+  ASSERT_EQ(page_handler.column_encoding(1).type(), ColumnEncoding::PLAIN);
+
+  // 没有封存的页面，reference_chunk 直接引用页面中的数据
+  FieldMeta fm1;
+  fm1.init("col1", AttrType::INTS, 0, 4, true, 0);
+  Chunk           chunk;
+  vector<uint8_t> select;
+  chunk.add_column(make_unique<Column>(fm1), 0);
+  ASSERT_EQ(RC::SUCCESS, page_handler.reference_chunk(chunk, select));
+  ASSERT_EQ(chunk.rows(), record_num);
+  const char *page_begin = frame->data();
+  const char *page_end   = page_begin + frame->data_size();
+  ASSERT_GE(chunk.column(0).data(), page_begin);
+  ASSERT_LT(chunk.column(0).data(), page_end);
+
+  ASSERT_EQ(RC::SUCCESS, page_handler.cleanup());
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(PaxRecordFileHandler, batch_insert)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "pax_batch_insert.bp";
+  filesystem::remove(record_manager_file);
+  filesystem::remove(string(record_manager_file) + FreeSpaceMap::FILE_SUFFIX);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  const int record_size = 8;
+  TableMeta table_meta;
+  table_meta.fields_.resize(2);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::INTS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta));
+
+  auto make_record = [](int i, char *buf) {
+    const int group = i / 100;
+    memcpy(buf, &i, sizeof(i));
+    memcpy(buf + 4, &group, sizeof(group));
+  };
+
+  // 先插入一条记录，批量插入时会先填满这个页面
+  char first_record[record_size];
+  make_record(0, first_record);
+  RID first_rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(first_record, record_size, &first_rid));
+
+  const int            record_num = 5000;
+  vector<char>         datas((record_num - 1) * record_size);
+  vector<const char *> records;
+  for (int i = 1; i < record_num; i++) {
+    char *buf = datas.data() + (i - 1) * record_size;
+    make_record(i, buf);
+    records.push_back(buf);
+  }
+  vector<RID> rids(records.size());
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_records(records, record_size, rids.data()));
+  rids.insert(rids.begin(), first_rid);
+
+  // 记录分布在多个页面上，第一个页面写满了
+  ASSERT_GT(bp->page_count(), 3);
+  ASSERT_EQ(first_rid.page_num, rids[1].page_num);
+  uint8_t fill_class = FreeSpaceMap::UNKNOWN;
+  ASSERT_EQ(RC::SUCCESS, file_handler.free_space_map().get(first_rid.page_num, fill_class));
+  ASSERT_EQ(FreeSpaceMap::FULL, fill_class);
+
+  unordered_set<RID, RIDHash> rid_set(rids.begin(), rids.end());
+  ASSERT_EQ(rids.size(), rid_set.size());
+
+  char buf[record_size];
+  for (int i = 0; i < record_num; i++) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(rids[i], record));
+    make_record(i, buf);
+    ASSERT_EQ(0, memcmp(record.data(), buf, record_size)) << "i=" << i;
+  }
+
+  file_handler.close();
+  bpm.close_file(record_manager_file);
+}
+
 INSTANTIATE_TEST_SUITE_P(PaxFileScannerTests, PaxRecordFileScannerWithParam, testing::Values(1, 10, 100, 1000, 2000, 10000));
 
 INSTANTIATE_TEST_SUITE_P(PaxPageTests, PaxPageHandlerTestWithParam, testing::Values(1, 10, 100, 337));
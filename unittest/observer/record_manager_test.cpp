@@ -15,6 +15,8 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 #include <sstream>
 #include <filesystem>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 
 #include "storage/buffer/disk_buffer_pool.h"
@@ -122,12 +124,122 @@ TEST(RecordPageHandler, test_record_page_handler)
   delete record_page_handle;
 }
 
+TEST(RecordPageHandler, varlen_record_page_handler)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_varlen.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+  bp->unpin_page(frame);
+
+  // 没有表的元数据时，整条记录是一个变长字段，末尾的0不占用页面空间
+  const int               record_size = 1000;
+  VarlenRecordPageHandler page_handler;
+  ASSERT_EQ(RC::SUCCESS, page_handler.init_empty_page(*bp, log_handler, page_num, record_size, nullptr));
+  ASSERT_FALSE(page_handler.is_full());
+  ASSERT_EQ(FreeSpaceMap::MAX_FILL_CLASS, page_handler.fill_class());
+
+  // 短记录可以放很多条，比定长格式多得多
+  char         buf[record_size];
+  vector<RID>  rids;
+  vector<string> values;
+  RC           rc = RC::SUCCESS;
+  while (true) {
+    string value = "record-" + to_string(rids.size());
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, value.data(), value.size());
+
+    RID rid;
+    rc = page_handler.insert_record(buf, &rid);
+    if (rc == RC::RECORD_NOMEM) {
+      break;
+    }
+    ASSERT_EQ(RC::SUCCESS, rc);
+    ASSERT_EQ(page_num, rid.page_num);
+    rids.push_back(rid);
+    values.push_back(value);
+  }
+  ASSERT_TRUE(page_handler.is_full());
+  ASSERT_GT(static_cast<int>(rids.size()), bp->page_data_size() / record_size * 10);
+
+  Record record;
+  for (size_t i = 0; i < rids.size(); i++) {
+    ASSERT_EQ(RC::SUCCESS, page_handler.get_record(rids[i], record));
+    ASSERT_EQ(record_size, record.len());
+    ASSERT_EQ(values[i], string(record.data()));
+    ASSERT_EQ(0, record.data()[record_size - 1]);
+  }
+
+  // 删除一半的记录，空出来的空间在整理页面之后可以放下更长的记录
+  for (size_t i = 0; i < rids.size(); i += 2) {
+    ASSERT_EQ(RC::SUCCESS, page_handler.delete_record(&rids[i]));
+  }
+  ASSERT_EQ(RC::RECORD_NOT_EXIST, page_handler.get_record(rids[0], record));
+  ASSERT_FALSE(page_handler.is_full());
+
+  memset(buf, 'a', sizeof(buf));
+  RID long_rid;
+  ASSERT_EQ(RC::SUCCESS, page_handler.insert_record(buf, &long_rid));
+  ASSERT_EQ(rids[0].slot_num, long_rid.slot_num);
+  ASSERT_EQ(RC::SUCCESS, page_handler.get_record(long_rid, record));
+  ASSERT_EQ(0, memcmp(buf, record.data(), record_size));
+
+  // 更新为短的记录，再更新回长的记录
+  memset(buf, 0, sizeof(buf));
+  memcpy(buf, "short", 5);
+  ASSERT_EQ(RC::SUCCESS, page_handler.update_record(long_rid, buf));
+  ASSERT_EQ(RC::SUCCESS, page_handler.get_record(long_rid, record));
+  ASSERT_EQ(string("short"), string(record.data()));
+
+  memset(buf, 'b', sizeof(buf));
+  ASSERT_EQ(RC::SUCCESS, page_handler.update_record(long_rid, buf));
+  ASSERT_EQ(RC::SUCCESS, page_handler.get_record(long_rid, record));
+  ASSERT_EQ(0, memcmp(buf, record.data(), record_size));
+
+  // 遍历页面中所有的记录
+  int                count = 0;
+  RecordPageIterator iterator;
+  iterator.init(&page_handler);
+  while (iterator.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, iterator.next(record));
+    count++;
+  }
+  ASSERT_EQ(static_cast<int>(rids.size() / 2) + 1, count);
+
+  // 按照 Chunk 获取，CHARS 的值去掉了末尾的0
+  Chunk chunk;
+  auto  column = make_unique<Column>();
+  column->init_varlen(AttrType::CHARS, record_size, count);
+  chunk.add_column(std::move(column), 0);
+  ASSERT_EQ(RC::SUCCESS, page_handler.get_chunk(chunk));
+  ASSERT_EQ(count, chunk.rows());
+  for (int i = 0; i < chunk.rows(); i++) {
+    Value value = chunk.get_value(0, i);
+    ASSERT_TRUE(value.length() == record_size || value.to_string().rfind("record-", 0) == 0);
+  }
+
+  page_handler.cleanup();
+  bpm.close_file(record_manager_file);
+}
+
 TEST(RecordFileScanner, test_record_file_iterator)
 {
   VacuousLogHandler log_handler;
 
   const char *record_manager_file = "record_manager.bp";
   filesystem::remove(record_manager_file);
+  filesystem::remove(string(record_manager_file) + FreeSpaceMap::FILE_SUFFIX);
 
   BufferPoolManager *bpm = new BufferPoolManager();
   ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
@@ -200,10 +312,247 @@ TEST(RecordFileScanner, test_record_file_iterator)
   file_scanner.close_scan();
   ASSERT_EQ(count, rids.size() / 2);
 
+  file_handler.close();
   bpm->close_file(record_manager_file);
   delete bpm;
 }
 
+TEST(RecordFileHandler, free_space_map)
+{
+  ASSERT_EQ(FreeSpaceMap::FULL, FreeSpaceMap::fill_class(0, 100));
+  ASSERT_EQ(FreeSpaceMap::MAX_FILL_CLASS, FreeSpaceMap::fill_class(100, 100));
+  ASSERT_LT(FreeSpaceMap::fill_class(1, 100), FreeSpaceMap::fill_class(50, 100));
+  ASSERT_GT(FreeSpaceMap::fill_class(1, 100), FreeSpaceMap::FULL);
+
+  VacuousLogHandler log_handler;
+
+  filesystem::path directory("record_manager_fsm");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path record_manager_file = directory / "record_manager.bp";
+  filesystem::path fsm_file            = directory / (string("record_manager.bp") + FreeSpaceMap::FILE_SUFFIX);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file.c_str()));
+
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file.c_str(), bp));
+
+  const int   record_insert_num = 2000;
+  char        record_data[64]   = {0};
+  vector<RID> rids;
+  {
+    RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr));
+    ASSERT_TRUE(filesystem::exists(fsm_file));
+
+    for (int i = 0; i < record_insert_num; i++) {
+      RID rid;
+      ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+      rids.push_back(rid);
+    }
+    ASSERT_GT(bp->page_count(), 3);
+
+    // 前面的页面都是满的，最后一个页面可能还有空闲
+    FreeSpaceMap &free_space_map = file_handler.free_space_map();
+    uint8_t       fill_class     = FreeSpaceMap::UNKNOWN;
+    ASSERT_EQ(RC::SUCCESS, free_space_map.get(rids.front().page_num, fill_class));
+    ASSERT_EQ(FreeSpaceMap::FULL, fill_class);
+
+    // 删除第一个页面上的一条记录
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids.front()));
+    ASSERT_EQ(RC::SUCCESS, free_space_map.get(rids.front().page_num, fill_class));
+    ASSERT_NE(FreeSpaceMap::FULL, fill_class);
+    ASSERT_NE(FreeSpaceMap::UNKNOWN, fill_class);
+  }
+
+  // 重新打开之后不需要遍历数据页面，空闲空间表中记录的信息都还在
+  RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr));
+
+  uint8_t fill_class = FreeSpaceMap::UNKNOWN;
+  ASSERT_EQ(RC::SUCCESS, file_handler.free_space_map().get(rids.front().page_num, fill_class));
+  ASSERT_NE(FreeSpaceMap::FULL, fill_class);
+
+  // 新的记录插入到删除过记录的第一个页面上
+  const int32_t page_count = bp->page_count();
+  RID           rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+  ASSERT_EQ(rids.front().page_num, rid.page_num);
+  ASSERT_EQ(page_count, bp->page_count());
+
+  // 空闲空间表丢失时重新创建，所有的页面都当作可能有空闲位置，插入时逐渐修正。
+  // 现在只有最后一个页面还有空闲位置，插入时会依次检查前面的页面
+  file_handler.close();
+  ASSERT_TRUE(filesystem::remove(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr));
+  ASSERT_EQ(RC::SUCCESS, file_handler.free_space_map().get(rids.front().page_num, fill_class));
+  ASSERT_EQ(FreeSpaceMap::UNKNOWN, fill_class);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+  }
+  ASSERT_EQ(page_count, bp->page_count());
+  ASSERT_EQ(rids.back().page_num, rid.page_num);
+  for (PageNum page_num = 1; page_num < rids.back().page_num; page_num++) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.free_space_map().get(page_num, fill_class));
+    ASSERT_EQ(FreeSpaceMap::FULL, fill_class);
+  }
+
+  file_handler.close();
+  bpm.close_file(record_manager_file.c_str());
+}
+
+TEST(RecordFileHandler, varlen_overflow)
+{
+  VacuousLogHandler log_handler;
+
+  filesystem::path directory("record_manager_varlen");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path record_manager_file = directory / "record_manager.bp";
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file.c_str()));
+
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file.c_str(), bp));
+
+  RecordFileHandler file_handler(StorageFormat::VARLEN_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr));
+
+  // 记录比一个页面还大，只能放到溢出页面中
+  const int    record_size = bp->page_data_size() * 3;
+  vector<char> record_data(record_size, 0);
+  vector<RID>  rids;
+  for (int i = 0; i < 10; i++) {
+    const int len = (i % 2 == 0) ? record_size : 100;
+    memset(record_data.data(), 'a' + i, len);
+    memset(record_data.data() + len, 0, record_size - len);
+
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data.data(), record_size, &rid));
+    rids.push_back(rid);
+  }
+
+  Record record;
+  for (int i = 0; i < 10; i++) {
+    const int len = (i % 2 == 0) ? record_size : 100;
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(rids[i], record));
+    ASSERT_EQ(record_size, record.len());
+    for (int j = 0; j < record_size; j++) {
+      ASSERT_EQ(j < len ? 'a' + i : 0, record.data()[j]) << "record " << i << ", offset " << j;
+    }
+  }
+
+  // 删除记录之后溢出页面会被释放，重新插入时不需要分配新的页面
+  const int32_t page_count = bp->page_count();
+  ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[0]));
+  memset(record_data.data(), 'z', record_size);
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data.data(), record_size, &rid));
+  ASSERT_EQ(page_count, bp->page_count());
+
+  // 更新时把长记录改成短记录，溢出页面也会被释放
+  ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rids[2], [](Record &record) {
+    memset(record.data(), 0, record.len());
+    memcpy(record.data(), "short", 5);
+    return true;
+  }));
+  ASSERT_EQ(RC::SUCCESS, file_handler.get_record(rids[2], record));
+  ASSERT_EQ(string("short"), string(record.data()));
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data.data(), record_size, &rid));
+  ASSERT_EQ(page_count, bp->page_count());
+
+  // 溢出页面上没有记录，遍历所有页面时会跳过
+  int count = 0;
+  for (PageNum page_num = 1; page_num < bp->page_count(); page_num++) {
+    VarlenRecordPageHandler page_handler;
+    ASSERT_EQ(RC::SUCCESS, page_handler.init(*bp, log_handler, page_num, ReadWriteMode::READ_ONLY));
+
+    RecordPageIterator iterator;
+    iterator.init(&page_handler);
+    while (iterator.has_next()) {
+      ASSERT_EQ(RC::SUCCESS, iterator.next(record));
+      count++;
+    }
+    page_handler.cleanup();
+  }
+  ASSERT_EQ(11, count);
+
+  file_handler.close();
+  bpm.close_file(record_manager_file.c_str());
+}
+
+TEST(RecordFileHandler, concurrent_insert)
+{
+  VacuousLogHandler log_handler;
+
+  filesystem::path directory("record_manager_concurrent_insert");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path  record_manager_file = directory / "record_manager.bp";
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file.c_str()));
+
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file.c_str(), bp));
+
+  RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr));
+
+  // 每个线程插入一些记录，同时删除其中的一部分，最后检查记录都在，并且没有重复的 RID
+  const int                 thread_num        = 4;
+  const int                 record_insert_num = 5000;
+  vector<thread>            threads;
+  vector<pair<RID, string>> records[thread_num];
+  atomic<int>               failed_count{0};
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&, t]() {
+      char record_data[32] = {0};
+      for (int i = 0; i < record_insert_num; i++) {
+        snprintf(record_data, sizeof(record_data), "%d-%d", t, i);
+        RID rid;
+        if (OB_FAIL(file_handler.insert_record(record_data, sizeof(record_data), &rid))) {
+          failed_count++;
+          return;
+        }
+        if (i % 3 == 0) {
+          if (OB_FAIL(file_handler.delete_record(&rid))) {
+            failed_count++;
+            return;
+          }
+        } else {
+          records[t].emplace_back(rid, record_data);
+        }
+      }
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(0, failed_count.load());
+
+  unordered_set<RID, RIDHash> all_rids;
+  for (int t = 0; t < thread_num; t++) {
+    for (const auto &[rid, data] : records[t]) {
+      ASSERT_TRUE(all_rids.insert(rid).second);
+
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, file_handler.get_record(rid, record));
+      ASSERT_STREQ(data.c_str(), record.data());
+    }
+  }
+
+  file_handler.close();
+  bpm.close_file(record_manager_file.c_str());
+}
+
 TEST(RecordManager, durability)
 {
   /*
@@ -355,6 +704,201 @@ TEST(RecordManager, durability)
   bpm2.close_file(record_manager_file.c_str());
 }
 
+TEST(RecordManager, varlen_durability)
+{
+  /*
+   * 测试场景：
+   * 1. 使用变长格式，插入长短不一的记录，其中一些需要溢出页面
+   * 2. 随机进行更新和删除操作
+   * 3. 从日志中恢复数据，检查记录是否恢复
+   */
+  filesystem::path directory("record_manager_varlen_durability");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path record_manager_file = directory / "record_manager.bp";
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+
+  DiskLogHandler        log_handler;
+  IntegratedLogReplayer log_replayer(bpm);
+  ASSERT_EQ(log_handler.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler.replay(log_replayer, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler.start(), RC::SUCCESS);
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(bpm.create_file(record_manager_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(log_handler, record_manager_file.c_str(), buffer_pool), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler(StorageFormat::VARLEN_FORMAT);
+  ASSERT_EQ(record_file_handler.init(*buffer_pool, log_handler, nullptr), RC::SUCCESS);
+
+  const int        record_size = 10000;
+  IntegerGenerator length_random(0, record_size);
+  IntegerGenerator char_random('a', 'z');
+  auto             make_record = [&]() {
+    string record(record_size, 0);
+    // 大部分是短记录，少数超过 max_row_size 需要溢出页面
+    const int len = (char_random.next() == 'a') ? length_random.next() : length_random.next() % 200;
+    memset(record.data(), char_random.next(), len);
+    return record;
+  };
+
+  unordered_map<RID, string, RIDHash> record_map;
+  for (int i = 0; i < 1000; i++) {
+    string record = make_record();
+    RID    rid;
+    ASSERT_EQ(record_file_handler.insert_record(record.data(), record_size, &rid), RC::SUCCESS);
+    record_map.emplace(rid, record);
+  }
+
+  IntegerGenerator operation_random(0, 1);
+  for (int i = 0; i < 500; i++) {
+    IntegerGenerator record_random(0, record_map.size() - 1);
+    auto             iter = record_map.begin();
+    advance(iter, record_random.next());
+    RID rid = iter->first;
+    if (operation_random.next() == 0) {
+      string new_record = make_record();
+      ASSERT_EQ(record_file_handler.visit_record(rid,
+                    [&new_record](Record &record) {
+                      memcpy(record.data(), new_record.data(), new_record.size());
+                      return true;
+                    }),
+          RC::SUCCESS);
+      record_map[rid] = new_record;
+    } else {
+      ASSERT_EQ(record_file_handler.delete_record(&rid), RC::SUCCESS);
+      record_map.erase(rid);
+    }
+  }
+
+  // 把还没有完全刷盘的文件复制出来，关闭之后从日志中恢复
+  filesystem::path record_manager_file_copy = directory / "record_manager_copy.bp";
+  filesystem::copy_file(record_manager_file, record_manager_file_copy);
+  record_file_handler.close();
+  bpm.close_file(record_manager_file.c_str());
+  filesystem::remove(record_manager_file);
+  ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
+
+  DiskLogHandler    log_handler2;
+  BufferPoolManager bpm2;
+  ASSERT_EQ(RC::SUCCESS, bpm2.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *buffer_pool2 = nullptr;
+  filesystem::copy(record_manager_file_copy, record_manager_file);
+  ASSERT_EQ(bpm2.open_file(log_handler2, record_manager_file.c_str(), buffer_pool2), RC::SUCCESS);
+
+  IntegratedLogReplayer log_replayer2(bpm2);
+  ASSERT_EQ(log_handler2.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.replay(log_replayer2, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.start(), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler2(StorageFormat::VARLEN_FORMAT);
+  ASSERT_EQ(record_file_handler2.init(*buffer_pool2, log_handler2, nullptr), RC::SUCCESS);
+  for (const auto &[rid, record] : record_map) {
+    Record record_data;
+    ASSERT_EQ(record_file_handler2.get_record(rid, record_data), RC::SUCCESS);
+    ASSERT_EQ(memcmp(record_data.data(), record.data(), record.size()), 0);
+  }
+
+  record_file_handler2.close();
+  ASSERT_EQ(log_handler2.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.await_termination(), RC::SUCCESS);
+  bpm2.close_file(record_manager_file.c_str());
+}
+
+TEST(RecordManager, batch_insert_durability)
+{
+  /*
+   * 测试场景：
+   * 1. 插入几条记录，让第一个页面上还有空闲位置
+   * 2. 批量插入很多记录，分布在多个页面上
+   * 3. 从日志中恢复数据，检查记录是否恢复
+   */
+  filesystem::path directory("record_manager_batch_durability");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path record_manager_file = directory / "record_manager.bp";
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+
+  DiskLogHandler        log_handler;
+  IntegratedLogReplayer log_replayer(bpm);
+  ASSERT_EQ(log_handler.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler.replay(log_replayer, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler.start(), RC::SUCCESS);
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(bpm.create_file(record_manager_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(log_handler, record_manager_file.c_str(), buffer_pool), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(record_file_handler.init(*buffer_pool, log_handler, nullptr), RC::SUCCESS);
+
+  const int record_size       = 100;
+  const int single_insert_num = 10;
+  const int batch_insert_num  = 3000;
+
+  vector<string> record_datas;
+  for (int i = 0; i < single_insert_num + batch_insert_num; i++) {
+    string record_data = "record " + to_string(i);
+    record_data.resize(record_size, 'x');
+    record_datas.push_back(record_data);
+  }
+
+  vector<RID> rids(record_datas.size());
+  for (int i = 0; i < single_insert_num; i++) {
+    ASSERT_EQ(record_file_handler.insert_record(record_datas[i].data(), record_size, &rids[i]), RC::SUCCESS);
+  }
+
+  vector<const char *> records;
+  for (int i = single_insert_num; i < static_cast<int>(record_datas.size()); i++) {
+    records.push_back(record_datas[i].data());
+  }
+  ASSERT_EQ(record_file_handler.insert_records(records, record_size, rids.data() + single_insert_num), RC::SUCCESS);
+
+  // 批量插入的记录先填满第一个页面
+  ASSERT_EQ(rids[0].page_num, rids[single_insert_num].page_num);
+  ASSERT_NE(rids[0].page_num, rids.back().page_num);
+  unordered_set<RID, RIDHash> rid_set(rids.begin(), rids.end());
+  ASSERT_EQ(rids.size(), rid_set.size());
+
+  filesystem::path record_manager_file_copy = directory / "record_manager_copy.bp";
+  filesystem::copy_file(record_manager_file, record_manager_file_copy);
+  bpm.close_file(record_manager_file.c_str());
+  filesystem::remove(record_manager_file);
+  ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
+
+  DiskLogHandler    log_handler2;
+  BufferPoolManager bpm2;
+  ASSERT_EQ(RC::SUCCESS, bpm2.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *buffer_pool2 = nullptr;
+  filesystem::copy(record_manager_file_copy, record_manager_file);
+  ASSERT_EQ(bpm2.open_file(log_handler2, record_manager_file.c_str(), buffer_pool2), RC::SUCCESS);
+
+  IntegratedLogReplayer log_replayer2(bpm2);
+  ASSERT_EQ(log_handler2.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.replay(log_replayer2, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.start(), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler2(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(record_file_handler2.init(*buffer_pool2, log_handler2, nullptr), RC::SUCCESS);
+  for (size_t i = 0; i < rids.size(); i++) {
+    Record record;
+    ASSERT_EQ(record_file_handler2.get_record(rids[i], record), RC::SUCCESS);
+    ASSERT_EQ(memcmp(record.data(), record_datas[i].data(), record_size), 0) << "i=" << i;
+  }
+
+  ASSERT_EQ(log_handler2.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.await_termination(), RC::SUCCESS);
+  bpm2.close_file(record_manager_file.c_str());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);